@@ -0,0 +1,181 @@
+/*
+ * ForellenWächter - ADC-Tabellen gegen die bisherigen Formeln (Host)
+ * Tabellen & Festkomma siehe src/adc_lut.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src adc_lut_compare.cpp -o adc_lut_compare
+ *   ./adc_lut_compare
+ *
+ * Für jeden Rohwert 0-4095 (und für TDS/DO über 0-30°C Wassertemperatur)
+ * wird der neue Pfad (Lut12 + Festkomma wie readPH()/readTDS()/
+ * readDissolvedOxygen()/readBatteryVoltage()) mit der bisherigen
+ * Gleitkomma-Formel verglichen. Die ADC-Kennlinie ist dabei die ideale
+ * Gerade raw * 3.3 / 4095, damit nur Tabellen- und Rundungsfehler sichtbar
+ * werden. Zusätzlich:
+ * - eine nichtlineare Kennlinie (Modell ähnlich esp_adc_cal bei 11 dB) wird
+ *   von der 65-Punkte-Tabelle nachgebildet
+ * - Laufzeit beider Pfade (nur Anhaltswert, Host-CPU mit FPU; Eingaben über
+ *   volatile, damit der Compiler die Formeln nicht vorab ausrechnet)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "adc_lut.h"
+
+// Wie im Hauptcode
+#define BATTERY_R1 10000.0
+#define BATTERY_R2 3300.0
+constexpr int32_t BATTERY_DIVIDER_Q10 = dividerQ10(BATTERY_R1, BATTERY_R2);
+
+// Erlaubte Abweichung neu ↔ alt
+const float MAX_MV = 1.0f;
+const float MAX_PH = 0.02f;
+const float MAX_TDS = 2.0f;          // ppm
+const float MAX_DO = 0.02f;          // mg/L
+const float MAX_BATTERY = 0.01f;     // V
+const float MAX_CURVE_MV = 3.0f;     // Interpolation der nichtlinearen Kennlinie
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, float worst, float limit, const char* unit) {
+  printf("%s %-44s max %.4f %s (Grenze %.3f)\n", ok ? "✅" : "❌", what, worst, unit, limit);
+  if (!ok) failures++;
+}
+
+static float clampf(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// BISHERIGE FORMELN (v1.6.1 vor den Tabellen)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static float oldVoltage(float raw) { return raw * 3.3f / 4095.0f; }
+
+static float oldPH(float raw) {
+  return clampf(7.0f + (2.5f - oldVoltage(raw)) * 3.5f, 0, 14);
+}
+
+static float oldTDS(float raw, float waterTemp) {
+  float tempCoeff = 1.0f + 0.02f * (waterTemp - 25.0f);
+  float v = oldVoltage(raw) / tempCoeff;
+  return clampf((133.42f * powf(v, 3) - 255.86f * powf(v, 2) + 857.39f * v) * 0.5f, 0, 1000);
+}
+
+static float oldDO(float raw, float waterTemp) {
+  float doSaturation = 9.09f * (1.0f - 0.024f * (waterTemp - 20.0f));
+  return clampf(oldVoltage(raw) / 1.5f * doSaturation, 0, 20);
+}
+
+static float oldBattery(float raw) {
+  return oldVoltage(raw) * (BATTERY_R1 + BATTERY_R2) / BATTERY_R2;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// NEUER PFAD (wie im Hauptcode)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+Lut12 adcLut;
+Lut12 tdsLut;
+
+static float newPH(int raw) {
+  int32_t mv = adcLut.lookup(raw);
+  int32_t ph100 = 700 + (2500 - mv) * 35 / 100;
+  return clampf(ph100 / 100.0f, 0, 14);
+}
+
+static float newTDS(int raw, float waterTemp) {
+  int32_t compMv = tdsCompensateMv(adcLut.lookup(raw), lroundf(waterTemp * 10));
+  return clampf(tdsLut.lookup(compMv) / 10.0f, 0, 1000);
+}
+
+static float newDO(int raw, float waterTemp) {
+  int32_t mv = adcLut.lookup(raw);
+  int32_t temp10 = lroundf(waterTemp * 10);
+  int32_t doSaturation100 = (909 * (10000 - 24 * (temp10 - 200)) + 5000) / 10000;
+  return clampf((mv * doSaturation100 + 750) / 1500 / 100.0f, 0, 20);
+}
+
+static float newBattery(int raw) {
+  return applyDividerMv(adcLut.lookup(raw), BATTERY_DIVIDER_Q10) / 1000.0f;
+}
+
+// Nichtlineare Kennlinie: Offset unten, linear, Abflachung oberhalb ~2.5 V
+// (Modell, keine gemessenen eFuse-Daten)
+static float curveMv(int raw) {
+  float mv = 142.0f + raw * 0.8f;
+  if (mv > 2500.0f) mv = 2500.0f + (mv - 2500.0f) * (1.0f - (mv - 2500.0f) / 2400.0f);
+  return mv;
+}
+
+int main() {
+  adcLut.build([](int raw) { return raw * 3300.0f / 4095.0f; });
+  buildTdsLut(tdsLut);
+
+  float worstMv = 0, worstPH = 0, worstTDS = 0, worstDO = 0, worstBattery = 0;
+  for (int raw = 0; raw <= 4095; raw++) {
+    worstMv = fmaxf(worstMv, fabsf(adcLut.lookup(raw) - oldVoltage(raw) * 1000.0f));
+    worstPH = fmaxf(worstPH, fabsf(newPH(raw) - oldPH(raw)));
+    worstBattery = fmaxf(worstBattery, fabsf(newBattery(raw) - oldBattery(raw)));
+    for (float t = 0; t <= 30.0f; t += 0.5f) {
+      worstTDS = fmaxf(worstTDS, fabsf(newTDS(raw, t) - oldTDS(raw, t)));
+      worstDO = fmaxf(worstDO, fabsf(newDO(raw, t) - oldDO(raw, t)));
+    }
+  }
+
+  printf("═══ Tabelle + Festkomma gegen bisherige Formeln (ideale ADC-Gerade) ═══\n");
+  check(worstMv <= MAX_MV, "raw → mV", worstMv, MAX_MV, "mV");
+  check(worstPH <= MAX_PH, "pH (Standard-Kalibrierung)", worstPH, MAX_PH, "pH");
+  check(worstTDS <= MAX_TDS, "TDS (Standard-Kurve, 0-30°C)", worstTDS, MAX_TDS, "ppm");
+  check(worstDO <= MAX_DO, "Sauerstoff (0-30°C)", worstDO, MAX_DO, "mg/L");
+  check(worstBattery <= MAX_BATTERY, "Batterie (Spannungsteiler)", worstBattery, MAX_BATTERY, "V");
+
+  // Nichtlineare Kennlinie: Tabelle muss sie zwischen den Stützstellen treffen
+  Lut12 curveLut;
+  curveLut.build(curveMv);
+  float worstCurve = 0, worstLinear = 0;
+  for (int raw = 0; raw <= 4095; raw++) {
+    worstCurve = fmaxf(worstCurve, fabsf(curveLut.lookup(raw) - curveMv(raw)));
+    worstLinear = fmaxf(worstLinear, fabsf(oldVoltage(raw) * 1000.0f - curveMv(raw)));
+  }
+  printf("\n═══ Nichtlineare Kennlinie (Modell) ═══\n");
+  check(worstCurve <= MAX_CURVE_MV, "Tabelle ↔ Kennlinie", worstCurve, MAX_CURVE_MV, "mV");
+  printf("   (bisherige Formel raw * 3.3 / 4095 liegt bis %.0f mV daneben)\n", worstLinear);
+
+  // Laufzeit: ein Messzyklus pH + TDS + DO + Batterie. Rohwerte und Temperatur
+  // kommen über volatile, sonst rechnet der Compiler powf() & Co. schon beim
+  // Übersetzen bzw. einmal statt pro Runde aus.
+  const int ROUNDS = 200;
+  static int raws[4096];
+  srand(1);
+  for (int i = 0; i < 4096; i++) raws[i] = rand() % 4096;
+  volatile int* rawIn = raws;
+  volatile float waterTemp = 12.5f;
+  volatile float sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < 4096; i++) {
+      int raw = rawIn[i];
+      float t = waterTemp;
+      sink = sink + oldPH(raw) + oldTDS(raw, t) + oldDO(raw, t) + oldBattery(raw);
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < 4096; i++) {
+      int raw = rawIn[i];
+      float t = waterTemp;
+      sink = sink + newPH(raw) + newTDS(raw, t) + newDO(raw, t) + newBattery(raw);
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  double nsOld = std::chrono::duration<double, std::nano>(t1 - t0).count() / (ROUNDS * 4096.0);
+  double nsNew = std::chrono::duration<double, std::nano>(t2 - t1).count() / (ROUNDS * 4096.0);
+  printf("\n═══ Laufzeit pro Messzyklus (Host mit FPU, nur Anhaltswert) ═══\n");
+  printf("   Formeln %.1f ns, Tabellen %.1f ns\n", nsOld, nsNew);
+  printf("   (Auf dem ESP32 nicht gemessen; dort zählt vor allem, dass readAdcMilliVolts()\n"
+         "    10 x 10 ms auf den ADC wartet - die Rechnung ist daneben vernachlässigbar)\n");
+
+  printf("\n%s ADC-Vergleich: %d Fehler\n", failures ? "❌" : "✅", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * ForellenWächter - Belüftungs-Simulation (Host)
+ * Vergleicht Regelstrategien an einem einfachen Teich-Modell
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src aeration_sim.cpp -o aeration_sim
+ *   ./aeration_sim [tage] [mittlere Lufttemperatur °C]
+ *
+ * Modell (Euler, 5s Schritt wie SENSOR_INTERVAL):
+ * - Wassertemperatur folgt der Lufttemperatur (Tagesgang) mit Zeitkonstante,
+ *   Belüftung kühlt leicht (Verdunstung)
+ * - Sauerstoff: Sättigung abhängig von Temperatur, natürliche Wiederbelüftung,
+ *   Gebläse-Eintrag, Zehrung von Fischen/Biofilm (steigt mit Temperatur)
+ * - Sensorrauschen auf DO und Temperatur
+ *
+ * Zusätzlich wird geprüft, dass eine Notfall-Anforderung (force, z.B. pH
+ * außerhalb des Bereichs) die Mindest-Pause überspringt, die Mindest-Laufzeit
+ * danach aber weiter gilt.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "aeration.h"
+
+// Grenzwerte wie troutParams im Hauptcode
+const float TEMP_MAX = 14.0;
+const float DO_MIN = 6.0;
+const float DO_OPTIMAL = 9.0;
+
+const uint32_t STEP_MS = 5000;
+
+float airMean = 15.0;               // Warme Periode: hier zählt die Belüftung
+
+struct Pond {
+  float temp = 11.0;                 // °C
+  float dissolvedOxygen = 9.0;       // mg/L
+};
+
+// Sauerstoff-Sättigung in Süßwasser (mg/L), Näherung nach APHA
+float doSaturation(float t) {
+  return 14.62f - 0.3898f * t + 0.006969f * t * t - 0.00005897f * t * t * t;
+}
+
+float airTemperature(float hours) {
+  float day = fmodf(hours, 24.0f);
+  return airMean + 6.0f * sinf((day - 9.0f) / 24.0f * 2.0f * (float)M_PI);  // Max 15 Uhr
+}
+
+void stepPond(Pond& p, bool aerating, float hours, float dtHours) {
+  const float thermalTau = 18.0f;    // h, Wasser folgt Luft träge
+  const float aerationCooling = 0.05f;  // °C/h
+  const float kLaNatural = 0.08f;    // 1/h Oberfläche
+  const float kLaBlower = 1.2f;      // 1/h mit Gebläse
+  const float respiration20 = 0.45f; // mg/L/h bei 20°C
+
+  p.temp += (airTemperature(hours) - p.temp) / thermalTau * dtHours;
+  if (aerating) p.temp -= aerationCooling * dtHours;
+
+  float sat = doSaturation(p.temp);
+  float kLa = kLaNatural + (aerating ? kLaBlower : 0);
+  float respiration = respiration20 * powf(1.07f, p.temp - 20.0f);
+  p.dissolvedOxygen += (kLa * (sat - p.dissolvedOxygen) - respiration) * dtHours;
+  if (p.dissolvedOxygen < 0) p.dissolvedOxygen = 0;
+}
+
+// Deterministisches Rauschen (±amplitude)
+float noise(float amplitude) {
+  return ((rand() % 2001) / 1000.0f - 1.0f) * amplitude;
+}
+
+enum Strategy { LEGACY, HYSTERESIS, PI };
+
+struct Result {
+  float duty;
+  float energyWh;
+  uint32_t switches;
+  float minutesBelowDoMin;
+  float minDO;
+  float minutesAboveTempMax;
+};
+
+Result run(Strategy strategy, bool useDO, int days) {
+  srand(42);
+  Pond pond;
+  AerationConfig cfg;
+  cfg.mode = strategy == PI ? AERATION_PI : AERATION_HYSTERESIS;
+  AerationController controller;
+  ActuatorStats stats;
+  Result r = {0, 0, 0, 0, 99, 0};
+
+  bool aerating = false;
+  uint32_t steps = (uint32_t)days * 24 * 3600 * 1000 / STEP_MS;
+  for (uint32_t i = 0; i < steps; i++) {
+    uint32_t now = i * STEP_MS;
+    float hours = now / 3600000.0f;
+
+    float measuredDO = pond.dissolvedOxygen + noise(0.15f);
+    float measuredTemp = pond.temp + noise(0.05f);
+
+    if (strategy == LEGACY) {
+      // Bisheriges controlAeration(): jede Grenzwertverletzung schaltet sofort
+      aerating = useDO ? measuredDO < DO_OPTIMAL : measuredTemp > TEMP_MAX;
+    } else if (useDO) {
+      aerating = controller.update(cfg, DO_OPTIMAL - measuredDO, cfg.doBand, false, now);
+    } else {
+      aerating = controller.update(cfg, measuredTemp - TEMP_MAX, cfg.tempBand, false, now);
+    }
+    stats.track(aerating, now);
+
+    stepPond(pond, aerating, hours, STEP_MS / 3600000.0f);
+
+    if (pond.dissolvedOxygen < DO_MIN) r.minutesBelowDoMin += STEP_MS / 60000.0f;
+    if (pond.temp > TEMP_MAX) r.minutesAboveTempMax += STEP_MS / 60000.0f;
+    if (pond.dissolvedOxygen < r.minDO) r.minDO = pond.dissolvedOxygen;
+  }
+
+  r.duty = stats.duty();
+  r.energyWh = stats.energyWh(cfg.blowerWatts);
+  r.switches = stats.switches;
+  return r;
+}
+
+void report(const char* name, const Result& r, int days) {
+  printf("%-12s  Duty %5.1f%%  Energie %7.0f Wh  Schaltungen/Tag %7.1f  "
+         "DO<min %6.0f min  DO min %5.2f  T>max %6.0f min\n",
+         name, r.duty * 100, r.energyWh, (float)r.switches / days,
+         r.minutesBelowDoMin, r.minDO, r.minutesAboveTempMax);
+}
+
+// Notfall-Einschalten während der Mindest-Pause (Rückgabe: Anzahl Fehler)
+int checkForce() {
+  AerationConfig cfg;
+  AerationController controller;
+  int failures = 0;
+  auto check = [&](bool ok, const char* what) {
+    printf("%s %s\n", ok ? "✅" : "❌", what);
+    if (!ok) failures++;
+  };
+
+  // DO zu niedrig → an; nach minOnMs DO gut → aus, Mindest-Pause läuft
+  uint32_t t = 0;
+  controller.update(cfg, 2.0f, cfg.doBand, false, t);
+  t += cfg.minOnMs;
+  bool on = controller.update(cfg, -1.0f, cfg.doBand, false, t);
+  check(!on, "Regler schaltet nach Mindest-Laufzeit aus");
+
+  // Regelabweichung allein wartet die Mindest-Pause ab
+  t += STEP_MS;
+  on = controller.update(cfg, 2.0f, cfg.doBand, false, t);
+  check(!on, "Regelanforderung wartet Mindest-Pause ab");
+
+  // pH außerhalb des Bereichs: sofort an, obwohl minOffMs nicht abgelaufen ist
+  t += STEP_MS;
+  on = controller.update(cfg, -1.0f, cfg.doBand, true, t);
+  check(on, "force schaltet sofort ein (Mindest-Pause übersprungen)");
+
+  // Notfall vorbei: Mindest-Laufzeit gilt weiter
+  t += STEP_MS;
+  on = controller.update(cfg, -1.0f, cfg.doBand, false, t);
+  check(on, "nach force gilt die Mindest-Laufzeit");
+  t += cfg.minOnMs;
+  on = controller.update(cfg, -1.0f, cfg.doBand, false, t);
+  check(!on, "nach Mindest-Laufzeit wieder aus");
+
+  // PI-Modus mit Duty 0: force greift ebenfalls sofort
+  cfg.mode = AERATION_PI;
+  AerationController pi;
+  pi.update(cfg, 2.0f, cfg.doBand, true, 0);
+  pi.update(cfg, -5.0f, cfg.doBand, false, cfg.minOnMs);
+  on = pi.update(cfg, -5.0f, cfg.doBand, true, cfg.minOnMs + STEP_MS);
+  check(on, "force im PI-Modus während der Mindest-Pause");
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  int days = argc > 1 ? atoi(argv[1]) : 7;
+  if (days < 1) days = 1;
+  if (argc > 2) airMean = atof(argv[2]);
+
+  const char* names[3] = {"Alt", "Hysterese", "PI"};
+  for (int useDO = 1; useDO >= 0; useDO--) {
+    printf("\n═══ Regelgröße: %s (%d Tage, Luft %.1f°C) ═══\n",
+           useDO ? "Sauerstoff" : "Temperatur", days, airMean);
+    for (int s = LEGACY; s <= PI; s++) {
+      report(names[s], run((Strategy)s, useDO, days), days);
+    }
+  }
+
+  printf("\n═══ Notfall-Belüftung ═══\n");
+  return checkForce() ? 1 : 0;
+}
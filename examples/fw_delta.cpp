@@ -0,0 +1,395 @@
+/*
+ * ForellenWächter - Delta-Firmware erzeugen, anwenden, prüfen (Host)
+ * Patch-Format siehe src/delta_patch.h
+ *
+ * Kompilieren (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src fw_delta.cpp -o fw_delta
+ *
+ * Benutzung:
+ *   ./fw_delta diff  alt.bin neu.bin patch.fwd    Patch erzeugen
+ *   ./fw_delta apply alt.bin patch.fwd neu.bin    Patch anwenden (wie auf dem ESP32)
+ *   ./fw_delta selftest [anzahl]                  Erzeugte Image-Paare prüfen
+ *
+ * Der Differ folgt bsdiff 4.3 (Suffix-Array, ungefähre Übereinstimmungen mit
+ * Differenz-Bytes). Verschobener Code ändert viele Adressen um denselben Betrag,
+ * deshalb bestehen die Differenz-Daten überwiegend aus Nullen → RLE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include "delta_patch.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DIFF (bsdiff-Hauptschleife)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Suffix-Vergleich auf 1 KB begrenzt: lange 0xFF-Füllbereiche bleiben schnell
+static const size_t SA_COMPARE_LIMIT = 1024;
+
+static size_t matchLen(const uint8_t* a, size_t an, const uint8_t* b, size_t bn) {
+  size_t i = 0;
+  while (i < an && i < bn && a[i] == b[i]) i++;
+  return i;
+}
+
+static int compareLimited(const uint8_t* a, size_t an, const uint8_t* b, size_t bn) {
+  size_t n = std::min(std::min(an, bn), SA_COMPARE_LIMIT);
+  int c = memcmp(a, b, n);
+  if (c != 0 || n == SA_COMPARE_LIMIT) return c;
+  return an < bn ? -1 : (an > bn ? 1 : 0);
+}
+
+static std::vector<uint32_t> suffixArray(const Bytes& old) {
+  std::vector<uint32_t> sa(old.size() + 1);
+  for (size_t i = 0; i < sa.size(); i++) sa[i] = i;
+  const uint8_t* p = old.data();
+  size_t n = old.size();
+  std::sort(sa.begin(), sa.end(), [p, n](uint32_t a, uint32_t b) {
+    int c = compareLimited(p + a, n - a, p + b, n - b);
+    return c != 0 ? c < 0 : a < b;
+  });
+  return sa;
+}
+
+static size_t search(const std::vector<uint32_t>& sa, const Bytes& old,
+                     const uint8_t* target, size_t targetLen,
+                     size_t st, size_t en, size_t& pos) {
+  while (en - st >= 2) {
+    size_t x = st + (en - st) / 2;
+    if (compareLimited(old.data() + sa[x], old.size() - sa[x], target, targetLen) < 0) st = x;
+    else en = x;
+  }
+  size_t a = matchLen(old.data() + sa[st], old.size() - sa[st], target, targetLen);
+  size_t b = matchLen(old.data() + sa[en], old.size() - sa[en], target, targetLen);
+  pos = a > b ? sa[st] : sa[en];
+  return a > b ? a : b;
+}
+
+static void put32(Bytes& out, uint32_t v) {
+  uint8_t b[4];
+  deltaPut32(b, v);
+  out.insert(out.end(), b, b + 4);
+}
+
+// Differenz-Bytes als RLE: Null-Läufe und Literal-Läufe à max. 128
+static void appendRle(Bytes& out, const uint8_t* diff, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    size_t run = 0;
+    while (i + run < len && diff[i + run] == 0 && run < 128) run++;
+    if (run > 0) {
+      out.push_back(DELTA_RLE_ZERO - 1 + run);
+      i += run;
+      continue;
+    }
+    size_t lit = 0;
+    while (i + lit < len && lit < 128 && !(diff[i + lit] == 0 && i + lit + 1 < len && diff[i + lit + 1] == 0)) lit++;
+    out.push_back(lit - 1);
+    out.insert(out.end(), diff + i, diff + i + lit);
+    i += lit;
+  }
+}
+
+static void appendBlock(Bytes& out, const Bytes& old, const Bytes& img,
+                        size_t newStart, size_t oldStart, size_t diffLen,
+                        size_t extraLen, int32_t seek) {
+  put32(out, diffLen);
+  put32(out, extraLen);
+  put32(out, (uint32_t)seek);
+  Bytes diff(diffLen);
+  for (size_t i = 0; i < diffLen; i++) diff[i] = img[newStart + i] - old[oldStart + i];
+  appendRle(out, diff.data(), diffLen);
+  out.insert(out.end(), img.begin() + newStart + diffLen, img.begin() + newStart + diffLen + extraLen);
+}
+
+static void sha256(const Bytes& data, uint8_t out[32]) {
+  Sha256 h;
+  h.update(data.data(), data.size());
+  h.finish(out);
+}
+
+Bytes makePatch(const Bytes& old, const Bytes& img) {
+  Bytes out(DELTA_HEADER_SIZE);
+  memcpy(out.data(), DELTA_MAGIC, 4);
+  deltaPut32(out.data() + 4, old.size());
+  deltaPut32(out.data() + 8, img.size());
+  sha256(old, out.data() + 12);
+  sha256(img, out.data() + 44);
+
+  std::vector<uint32_t> sa = suffixArray(old);
+  const ssize_t oldSize = old.size(), newSize = img.size();
+  ssize_t scan = 0, len = 0, lastScan = 0, lastPos = 0, lastOffset = 0;
+  size_t pos = 0;
+
+  while (scan < newSize) {
+    ssize_t oldScore = 0;
+    ssize_t scsc;
+    for (scsc = scan += len; scan < newSize; scan++) {
+      len = search(sa, old, img.data() + scan, newSize - scan, 0, oldSize, pos);
+      for (; scsc < scan + len; scsc++) {
+        if (scsc + lastOffset < oldSize && old[scsc + lastOffset] == img[scsc]) oldScore++;
+      }
+      if ((len == oldScore && len != 0) || len > oldScore + 8) break;
+      if (scan + lastOffset < oldSize && old[scan + lastOffset] == img[scan]) oldScore--;
+    }
+
+    if (len != oldScore || scan == newSize) {
+      // Vorwärts ab letzter Übereinstimmung verlängern
+      ssize_t s = 0, sf = 0, lenf = 0;
+      for (ssize_t i = 0; lastScan + i < scan && lastPos + i < oldSize;) {
+        if (old[lastPos + i] == img[lastScan + i]) s++;
+        i++;
+        if (s * 2 - i > sf * 2 - lenf) { sf = s; lenf = i; }
+      }
+
+      // Rückwärts ab neuer Übereinstimmung verlängern
+      ssize_t lenb = 0;
+      if (scan < newSize) {
+        ssize_t sb = 0;
+        s = 0;
+        for (ssize_t i = 1; scan >= lastScan + i && (ssize_t)pos >= i; i++) {
+          if (old[pos - i] == img[scan - i]) s++;
+          if (s * 2 - i > sb * 2 - lenb) { sb = s; lenb = i; }
+        }
+      }
+
+      // Überlappung aufteilen
+      if (lastScan + lenf > scan - lenb) {
+        ssize_t overlap = (lastScan + lenf) - (scan - lenb);
+        ssize_t ss = 0, lens = 0;
+        s = 0;
+        for (ssize_t i = 0; i < overlap; i++) {
+          if (img[lastScan + lenf - overlap + i] == old[lastPos + lenf - overlap + i]) s++;
+          if (img[scan - lenb + i] == old[pos - lenb + i]) s--;
+          if (s > ss) { ss = s; lens = i + 1; }
+        }
+        lenf += lens - overlap;
+        lenb -= lens;
+      }
+
+      appendBlock(out, old, img, lastScan, lastPos, lenf,
+                  (scan - lenb) - (lastScan + lenf),
+                  (int32_t)((pos - lenb) - (lastPos + lenf)));
+
+      lastScan = scan - lenb;
+      lastPos = pos - lenb;
+      lastOffset = pos - scan;
+    }
+  }
+  return out;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// APPLY (gleicher Patcher wie auf dem ESP32)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct ApplyContext {
+  const Bytes* old;
+  Bytes* out;
+  bool wrongBase;
+};
+
+static bool readOld(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+  ApplyContext* c = (ApplyContext*)ctx;
+  if ((size_t)offset + len > c->old->size()) return false;
+  memcpy(buf, c->old->data() + offset, len);
+  return true;
+}
+
+static bool writeNew(void* ctx, const uint8_t* buf, size_t len) {
+  ApplyContext* c = (ApplyContext*)ctx;
+  c->out->insert(c->out->end(), buf, buf + len);
+  return true;
+}
+
+// Basis prüfen wie onDeltaHeader() in der Firmware
+static bool checkHeader(void* ctx, const DeltaHeader& h) {
+  ApplyContext* c = (ApplyContext*)ctx;
+  uint8_t digest[32];
+  sha256(*c->old, digest);
+  c->wrongBase = h.oldSize != c->old->size() || memcmp(digest, h.oldHash, 32) != 0;
+  return !c->wrongBase;
+}
+
+// Patch in Stücken wechselnder Größe einspeisen (wie AT+HTTPREAD)
+DeltaStatus applyPatch(const Bytes& old, const Bytes& patch, Bytes& out, size_t maxChunk) {
+  ApplyContext ctx = {&old, &out, false};
+  DeltaPatcher patcher;
+  patcher.begin(readOld, writeNew, checkHeader, &ctx);
+  DeltaStatus status = DELTA_OK;
+  size_t offset = 0;
+  while (offset < patch.size() && (status == DELTA_OK || status == DELTA_DONE)) {
+    size_t n = 1 + rand() % maxChunk;
+    if (n > patch.size() - offset) n = patch.size() - offset;
+    status = patcher.feed(patch.data() + offset, n);
+    offset += n;
+  }
+  return status;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SELBSTTEST MIT ERZEUGTEN IMAGE-PAAREN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Pseudo-Firmware: Code-Blöcke mit 32-Bit-Adressen, Konstanten, 0xFF-Füllung
+static Bytes makeImage(size_t size) {
+  Bytes img;
+  img.reserve(size);
+  while (img.size() < size) {
+    int kind = rand() % 10;
+    size_t n = 64 + rand() % 2048;
+    if (kind < 6) {
+      for (size_t i = 0; i < n; i += 4) {
+        uint32_t word = (rand() % 3 == 0) ? 0x400D0000 + (rand() % 0x40000) * 4 : rand();
+        for (int b = 0; b < 4; b++) img.push_back(word >> (8 * b));
+      }
+    } else if (kind < 8) {
+      const char* text = "ForellenWaechter Sensorwert Alarm Sauerstoff Temperatur ";
+      for (size_t i = 0; i < n; i++) img.push_back(text[(i + rand() % 3) % strlen(text)]);
+    } else {
+      img.insert(img.end(), n, 0xFF);
+    }
+  }
+  img.resize(size);
+  return img;
+}
+
+// Neue Version: Code eingefügt/entfernt, Adressen verschoben, einzelne Änderungen
+static Bytes mutateImage(const Bytes& old) {
+  Bytes img = old;
+  int edits = 2 + rand() % 6;
+  for (int e = 0; e < edits; e++) {
+    size_t at = rand() % img.size();
+    switch (rand() % 3) {
+      case 0: {
+        Bytes ins = makeImage(16 + rand() % 4096);
+        img.insert(img.begin() + at, ins.begin(), ins.end());
+        break;
+      }
+      case 1: {
+        size_t n = std::min<size_t>(16 + rand() % 4096, img.size() - at);
+        img.erase(img.begin() + at, img.begin() + at + n);
+        break;
+      }
+      default:
+        for (int i = 0; i < 32; i++) img[rand() % img.size()] = rand();
+        break;
+    }
+  }
+  // Adressen hinter dem Einfügepunkt wandern (Relokation)
+  uint32_t shift = (rand() % 256) * 4;
+  for (size_t i = 0; i + 4 <= img.size(); i += 4) {
+    uint32_t w = deltaGet32(&img[i]);
+    if ((w & 0xFFFC0000) == 0x400C0000 || (w & 0xFFFF0000) == 0x400D0000) deltaPut32(&img[i], w + shift);
+  }
+  return img;
+}
+
+static int selftest(int count) {
+  int failures = 0;
+  size_t totalNew = 0, totalPatch = 0;
+  for (int t = 0; t < count; t++) {
+    srand(1000 + t);
+    Bytes old = makeImage(64 * 1024 + rand() % (512 * 1024));
+    Bytes img = mutateImage(old);
+    Bytes patch = makePatch(old, img);
+    totalNew += img.size();
+    totalPatch += patch.size();
+
+    Bytes out;
+    DeltaStatus s = applyPatch(old, patch, out, 1 + rand() % 2048);
+    bool ok = s == DELTA_DONE && out == img;
+
+    // Beschädigter Patch muss abgelehnt werden
+    Bytes broken = patch;
+    broken[DELTA_HEADER_SIZE + rand() % (broken.size() - DELTA_HEADER_SIZE)] ^= 0x5A;
+    Bytes brokenOut;
+    DeltaStatus sb = applyPatch(old, broken, brokenOut, 1024);
+    bool rejected = sb != DELTA_DONE && sb != DELTA_OK;
+
+    // Falsche Basis muss vor dem ersten Schreibzugriff abgelehnt werden
+    Bytes otherBase = old;
+    otherBase[rand() % otherBase.size()] ^= 1;
+    Bytes baseOut;
+    DeltaStatus sw = applyPatch(otherBase, patch, baseOut, 1024);
+    bool baseRejected = sw == DELTA_ERR_HEADER && baseOut.empty();
+
+    if (!ok || !rejected || !baseRejected) failures++;
+    printf("%s Paar %2d: alt %7zu  neu %7zu  Patch %7zu (%5.1f%%)  %s / beschädigt %s / Basis %s\n",
+           ok && rejected && baseRejected ? "✅" : "❌", t, old.size(), img.size(), patch.size(),
+           100.0 * patch.size() / img.size(), deltaStatusName(s), deltaStatusName(sb),
+           deltaStatusName(sw));
+  }
+  printf("\nPatch-Größe gesamt: %.1f%% der neuen Images, RAM Patcher: %zu Bytes\n",
+         100.0 * totalPatch / totalNew, sizeof(DeltaPatcher));
+  printf("%s %d/%d Paare fehlerfrei\n", failures ? "❌" : "✅", count - failures, count);
+  return failures ? 1 : 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DATEIEN & MAIN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static bool readFile(const char* path, Bytes& data) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "❌ %s nicht lesbar\n", path);
+    return false;
+  }
+  data.clear();
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+static bool writeFile(const char* path, const Bytes& data) {
+  FILE* f = fopen(path, "wb");
+  if (!f || fwrite(data.data(), 1, data.size(), f) != data.size()) {
+    fprintf(stderr, "❌ %s nicht schreibbar\n", path);
+    if (f) fclose(f);
+    return false;
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && strcmp(argv[1], "selftest") == 0) {
+    return selftest(argc > 2 ? atoi(argv[2]) : 10);
+  }
+
+  if (argc == 5 && strcmp(argv[1], "diff") == 0) {
+    Bytes old, img;
+    if (!readFile(argv[2], old) || !readFile(argv[3], img)) return 1;
+    Bytes patch = makePatch(old, img);
+    if (!writeFile(argv[4], patch)) return 1;
+    printf("✅ Patch %zu Bytes (%.1f%% von %zu)\n", patch.size(), 100.0 * patch.size() / img.size(), img.size());
+    return 0;
+  }
+
+  if (argc == 5 && strcmp(argv[1], "apply") == 0) {
+    Bytes old, patch, out;
+    if (!readFile(argv[2], old) || !readFile(argv[3], patch)) return 1;
+    DeltaStatus s = applyPatch(old, patch, out, 1024);
+    if (s != DELTA_DONE) {
+      fprintf(stderr, "❌ Patch fehlgeschlagen: %s\n", deltaStatusName(s));
+      return 1;
+    }
+    if (!writeFile(argv[4], out)) return 1;
+    printf("✅ %zu Bytes geschrieben, SHA-256 geprüft\n", out.size());
+    return 0;
+  }
+
+  fprintf(stderr, "Benutzung:\n"
+                  "  %s diff  alt.bin neu.bin patch.fwd\n"
+                  "  %s apply alt.bin patch.fwd neu.bin\n"
+                  "  %s selftest [anzahl]\n", argv[0], argv[0], argv[0]);
+  return 2;
+}
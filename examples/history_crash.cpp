@@ -0,0 +1,150 @@
+/*
+ * ForellenWächter - Chart-Historie: Absturz beim Schreiben (Host, Linux/macOS)
+ * Ablage siehe src/history_log.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src history_crash.cpp -o history_crash
+ *   ./history_crash [Runden] [Datei]
+ *
+ * Ein Kindprozess hängt History-Punkte an die Ring-Datei an, jeden Datensatz in
+ * drei Teilen (wie SD-Sektoren bzw. FAT-Puffer) und wird nach zufälliger Zeit mit
+ * SIGKILL beendet - auch mitten im Datensatz. Danach je Runde:
+ * 1. Wiederherstellen wie beim Boot (Dauer wird gemessen)
+ * 2. Neuester Punkt = letzter vollständig geschriebener, keine Lücken, Werte korrekt
+ * 3. Nächster Lauf setzt bei seq + 1 fort und überschreibt den abgerissenen Slot
+ * Zum Schluss: beschädigter Datensatz in der Mitte → Kette endet dort.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "history_log.h"
+
+// Messwerte als Funktion der seq, damit sich jeder Punkt nachprüfen lässt
+static HistoryLogRecord sample(uint32_t seq) {
+  HistoryLogRecord r = {};
+  r.seq = seq;
+  r.time = 1784000000 + seq * 300;
+  float values[HLOG_CHANNELS] = {
+    12.0f + sinf(seq * 0.02f) * 3, 18.0f + sinf(seq * 0.03f) * 6, 7.2f + (seq % 7) * 0.01f,
+    180.0f + seq % 23, 9.5f - (seq % 11) * 0.1f, 40.0f + seq % 5, 55.5f
+  };
+  for (uint8_t c = 0; c < HLOG_CHANNELS; c++) r.values[c] = historyLogEncode(values[c], c);
+  if (seq % 97 == 0) r.values[HLOG_DO] = historyLogEncode(NAN, HLOG_DO);   // Sensor fehlt
+  historyLogSeal(r);
+  return r;
+}
+
+static HistoryLogRange restore(int fd, bool& valuesOk) {
+  valuesOk = true;
+  return historyLogRestore(
+    [fd](uint32_t offset, uint8_t* buf, size_t len) {
+      ssize_t n = pread(fd, buf, len, offset);
+      return n > 0 ? (size_t)n : 0;
+    },
+    [&valuesOk](uint32_t, const HistoryLogRecord& r) {
+      HistoryLogRecord expected = sample(r.seq);
+      if (memcmp(&r, &expected, sizeof(r)) != 0) valuesOk = false;
+    });
+}
+
+// Kindprozess: ab seq anhängen, bis SIGKILL kommt; jede fertige seq über die Pipe melden
+static void writer(int fd, uint32_t seq, int ack) {
+  const size_t cuts[] = {0, 9, 17, sizeof(HistoryLogRecord)};
+  for (;; seq++) {
+    HistoryLogRecord r = sample(seq);
+    for (int part = 0; part < 3; part++) {
+      size_t from = cuts[part], to = cuts[part + 1];
+      if (pwrite(fd, (const uint8_t*)&r + from, to - from, historyLogOffset(seq) + from) != (ssize_t)(to - from)) _exit(2);
+      for (volatile int spin = rand() % 2000; spin > 0; spin--) {}
+    }
+    if (write(ack, &seq, sizeof(seq)) != sizeof(seq)) _exit(3);
+  }
+}
+
+int main(int argc, char** argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 300;
+  const char* path = argc > 2 ? argv[2] : "/tmp/history_crash.bin";
+  unlink(path);
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) { perror(path); return 1; }
+
+  printf("Datensatz: %zu Byte, Ring: %d Slots (%zu Byte), im RAM: %d Punkte\n",
+         sizeof(HistoryLogRecord), HISTORY_LOG_SLOTS, HISTORY_LOG_SLOTS * sizeof(HistoryLogRecord),
+         HISTORY_LOG_POINTS);
+
+  srand(7);
+  int failures = 0, torn = 0;
+  double maxRestoreUs = 0;
+  uint32_t lastAck = 0;
+
+  for (int round = 0; round < rounds; round++) {
+    bool valuesOk;
+    auto t0 = std::chrono::steady_clock::now();
+    HistoryLogRange range = restore(fd, valuesOk);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    if (us > maxRestoreUs) maxRestoreUs = us;
+
+    // Der letzte Datensatz kann fertig sein, bevor seine Meldung durch die Pipe ging
+    uint32_t expectedCount = range.last < HISTORY_LOG_POINTS ? range.last : HISTORY_LOG_POINTS;
+    bool ok = valuesOk && (range.last == lastAck || range.last == lastAck + 1) &&
+              range.count() == expectedCount;
+    if (!ok) {
+      printf("❌ Runde %d: seq %u-%u (%u Punkte), bestätigt bis %u, Werte %s\n", round, range.first,
+             range.last, range.count(), lastAck, valuesOk ? "ok" : "falsch");
+      failures++;
+    }
+
+    // Abgerissener Datensatz hinter dem neuesten?
+    HistoryLogRecord next;
+    if (pread(fd, &next, sizeof(next), historyLogOffset(range.last + 1)) == sizeof(next) &&
+        !historyLogValid(next) && next.seq == range.last + 1) {
+      torn++;
+    }
+
+    int ack[2];
+    if (pipe(ack) != 0) { perror("pipe"); return 1; }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(ack[0]);
+      srand(round);
+      writer(fd, range.last + 1, ack[1]);
+    }
+    close(ack[1]);
+    usleep(200 + rand() % 3000);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+
+    uint32_t seq;
+    lastAck = range.last;
+    while (read(ack[0], &seq, sizeof(seq)) == sizeof(seq)) lastAck = seq;
+    close(ack[0]);
+  }
+
+  bool valuesOk;
+  HistoryLogRange range = restore(fd, valuesOk);
+  printf("%s %d Abbrüche: neueste seq %u, %u Punkte, %d mitten im Datensatz, Wiederherstellen max. %.0f µs\n",
+         failures ? "❌" : "✅", rounds, range.last, range.count(), torn, maxRestoreUs);
+
+  // Bitfehler in der Mitte: nur die lückenlose Kette dahinter kommt zurück
+  uint32_t broken = range.last - 100;
+  uint8_t junk = 0x5A;
+  if (pwrite(fd, &junk, 1, historyLogOffset(broken) + 6) != 1) return 1;
+  HistoryLogRange cut = restore(fd, valuesOk);
+  bool cutOk = valuesOk && cut.last == range.last && cut.first == broken + 1;
+  printf("%s Beschädigter Datensatz %u: Kette %u-%u\n", cutOk ? "✅" : "❌", broken, cut.first, cut.last);
+
+  // Leere bzw. fremde Datei: nichts wiederherstellen
+  if (ftruncate(fd, 0) != 0) return 1;
+  HistoryLogRange empty = restore(fd, valuesOk);
+  printf("%s Leere Datei: %u Punkte\n", empty.last == 0 ? "✅" : "❌", empty.count());
+
+  close(fd);
+  unlink(path);
+  return failures || !cutOk || empty.last ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * ForellenWächter - Chart-Ausdünnung an aufgezeichneten Logs vergleichen (Host)
+ * Verfahren siehe src/downsample.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src history_downsample.cpp -o history_downsample
+ *   ./history_downsample [punkte] [SD-Log.csv ...]
+ *
+ * SD-Logs (/logs/JJJJ-MM-TT.csv) haben die Kopfzeile "timestamp,<Felder>,alarmReason".
+ * Ohne Datei wird ein Tag mit kurzen Temperaturspitzen und O₂-Einbrüchen erzeugt.
+ *
+ * Kennzahlen je Reihe (kleiner = besser):
+ * - Spitze: Abweichung von Minimum/Maximum der Originaldaten
+ * - Max-Fehler: größte Abweichung der linear verbundenen Chart-Linie vom Original
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "downsample.h"
+
+struct Series {
+  std::string name;
+  std::vector<float> values;
+};
+
+struct Selection {
+  std::vector<float> x;              // Index im Original (Bucket-Zeitachse)
+  std::vector<float> y;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// EINGABE
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static std::vector<std::string> splitCsv(const char* line) {
+  std::vector<std::string> cols;
+  std::string cur;
+  bool quoted = false;
+  for (const char* p = line; *p && *p != '\n' && *p != '\r'; p++) {
+    if (*p == '"') quoted = !quoted;
+    else if (*p == ',' && !quoted) { cols.push_back(cur); cur.clear(); }
+    else cur += *p;
+  }
+  cols.push_back(cur);
+  return cols;
+}
+
+static bool loadCsv(const char* path, std::vector<Series>& series) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "❌ %s nicht lesbar\n", path);
+    return false;
+  }
+  char line[1024];
+  if (!fgets(line, sizeof(line), f)) { fclose(f); return false; }
+  std::vector<std::string> header = splitCsv(line);
+
+  // Spalte 0 = timestamp, letzte = alarmReason; Serien beim ersten Log anlegen
+  if (series.empty()) {
+    for (size_t c = 1; c + 1 < header.size(); c++) series.push_back({header[c], {}});
+  }
+  while (fgets(line, sizeof(line), f)) {
+    std::vector<std::string> cols = splitCsv(line);
+    for (size_t c = 1; c + 1 < cols.size() && c - 1 < series.size(); c++) {
+      series[c - 1].values.push_back(atof(cols[c].c_str()));
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+// Ein Tag bei 5 min Intervall (wie HISTORY_SIZE): Tagesgang plus kurze Ereignisse
+static void synthesize(std::vector<Series>& series) {
+  Series temp = {"waterTemp", {}}, oxygen = {"dissolvedOxygen", {}}, ph = {"ph", {}};
+  srand(7);
+  for (int i = 0; i < 288; i++) {
+    float hours = i / 12.0f;
+    float t = 11.5f + 1.5f * sinf((hours - 9) / 24 * 2 * (float)M_PI) + (rand() % 100 - 50) / 500.0f;
+    float o = 9.0f - 0.8f * sinf((hours - 9) / 24 * 2 * (float)M_PI) + (rand() % 100 - 50) / 300.0f;
+    if (i == 100 || i == 101) t += 2.8f;            // Warmwasser-Einlauf, 10 min
+    if (i >= 200 && i <= 201) o -= 3.5f;            // Gebläse-Ausfall
+    if (i == 250) o -= 2.0f;
+    temp.values.push_back(t);
+    oxygen.values.push_back(o);
+    ph.values.push_back(7.2f + (rand() % 100 - 50) / 2000.0f + (i == 150 ? 0.9f : 0));
+  }
+  series = {temp, oxygen, ph};
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// VERFAHREN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Bisher: jeder n-te Wert
+static Selection everyNth(const std::vector<float>& v, uint32_t target) {
+  Selection s;
+  uint32_t step = v.size() > target ? (v.size() + target - 1) / target : 1;
+  for (uint32_t i = 0; i < v.size(); i += step) {
+    s.x.push_back(i);
+    s.y.push_back(v[i]);
+  }
+  return s;
+}
+
+static Selection minMax(const std::vector<float>& v, uint32_t target) {
+  Selection s;
+  MinMaxDecimator d;
+  d.begin(v.size(), target);
+  for (float value : v) {
+    d.push(value, [&s](uint32_t i, float y) {
+      s.x.push_back(i);
+      s.y.push_back(y);
+    });
+  }
+  return s;
+}
+
+static Selection lttb(const std::vector<float>& v, uint32_t target) {
+  Selection s;
+  lttbSelect(v.size(), target,
+             [](uint32_t i) { return (float)i; },
+             [&v](uint32_t i) { return v[i]; },
+             [&](uint32_t i) {
+               s.x.push_back(i);
+               s.y.push_back(v[i]);
+             });
+  return s;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// BEWERTUNG
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static float peakError(const std::vector<float>& v, const Selection& s) {
+  float vMin = v[0], vMax = v[0], sMin = s.y[0], sMax = s.y[0];
+  for (float x : v) { vMin = fminf(vMin, x); vMax = fmaxf(vMax, x); }
+  for (float y : s.y) { sMin = fminf(sMin, y); sMax = fmaxf(sMax, y); }
+  return fmaxf(vMax - sMax, sMin - vMin);
+}
+
+static float maxLineError(const std::vector<float>& v, const Selection& s) {
+  float worst = 0;
+  size_t k = 0;
+  for (size_t i = 0; i < v.size(); i++) {
+    while (k + 1 < s.x.size() && s.x[k + 1] <= i) k++;
+    float y = s.y[k];
+    if (k + 1 < s.x.size() && s.x[k + 1] > s.x[k]) {
+      float f = (i - s.x[k]) / (s.x[k + 1] - s.x[k]);
+      y = s.y[k] + f * (s.y[k + 1] - s.y[k]);
+    }
+    worst = fmaxf(worst, fabsf(y - v[i]));
+  }
+  return worst;
+}
+
+int main(int argc, char** argv) {
+  uint32_t target = argc > 1 ? atoi(argv[1]) : 96;
+  if (target < 4) target = 4;
+
+  std::vector<Series> series;
+  if (argc > 2) {
+    for (int a = 2; a < argc; a++) {
+      if (!loadCsv(argv[a], series)) return 1;
+    }
+  } else {
+    synthesize(series);
+    printf("Keine Logs angegeben - synthetischer Tag mit Spitzen\n");
+  }
+
+  printf("Ziel: %u Punkte\n\n", target);
+  printf("%-18s %7s │ %-22s │ %-22s │ %-22s\n", "Reihe", "Werte", "jeder n-te", "Min/Max", "LTTB");
+  printf("%-18s %7s │ %6s %6s %8s │ %6s %6s %8s │ %6s %6s %8s\n", "", "",
+         "Punkte", "Spitze", "MaxFehl", "Punkte", "Spitze", "MaxFehl", "Punkte", "Spitze", "MaxFehl");
+
+  for (const Series& s : series) {
+    if (s.values.size() < 3) continue;
+    Selection sel[3] = {everyNth(s.values, target), minMax(s.values, target), lttb(s.values, target)};
+    printf("%-18s %7zu", s.name.c_str(), s.values.size());
+    for (const Selection& x : sel) {
+      printf(" │ %6zu %6.2f %8.2f", x.y.size(), peakError(s.values, x), maxLineError(s.values, x));
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,395 @@
+/*
+ * ForellenWächter - HTTPS-Pool gegen einen lokalen TLS-Server (Host, Linux)
+ * Pool siehe src/https_pool.h
+ *
+ * Kompilieren & starten (PC, OpenSSL-Entwicklerpakete nötig):
+ *   g++ -std=c++17 -O2 -pthread -I../src https_pool_tls.cpp -o https_pool_tls -lssl -lcrypto
+ *   ./https_pool_tls
+ *
+ * WiFiClientSecure wird hier mit OpenSSL nachgebildet, der Server läuft im selben
+ * Prozess (selbstsigniertes Zertifikat, HTTP/1.1 Keep-Alive). Geprüft wird:
+ * 1. Wiederverwendung: viele Requests, ein Handshake
+ * 2. Haltezeit je acquire(): DynDNS-Verbindung überlebt 5 min, Standard nicht
+ * 3. Server schließt Idle-Verbindung → neuer Handshake statt Fehler
+ * 4. Externe Verbindungen (Telegram) zählen gegen HTTPS_POOL_SIZE
+ * 5. Parallele Tasks: nie mehr als HTTPS_POOL_SIZE TLS-Verbindungen gleichzeitig
+ * 6. Wenig Heap: kein neuer Handshake; http:// geht nie durch den Pool
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// ESP32-ERSATZ (millis, Heap, Mutex, WiFiClientSecure)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static std::atomic<long> clockOffsetMs{0};   // Zeitsprung für Idle-Tests
+
+unsigned long millis() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return duration_cast<milliseconds>(steady_clock::now() - start).count() + clockOffsetMs;
+}
+
+struct EspHeap {
+  uint32_t freeHeap = 200000;
+  uint32_t getFreeHeap() const { return freeHeap; }
+} ESP;
+
+typedef std::mutex* SemaphoreHandle_t;
+#define portMAX_DELAY 0
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex; }
+inline bool xSemaphoreTake(SemaphoreHandle_t m, int) { m->lock(); return true; }
+inline bool xSemaphoreGive(SemaphoreHandle_t m) { m->unlock(); return true; }
+
+#define strlcpy hostStrlcpy
+inline size_t hostStrlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = std::min(len, size - 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+
+static std::atomic<int> clientTlsOpen{0};    // Gleichzeitig offene TLS-Verbindungen
+static std::atomic<int> clientTlsMax{0};
+
+class WiFiClientSecure {
+public:
+  ~WiFiClientSecure() { stop(); }
+
+  void setInsecure() {}
+  void setTimeout(int seconds) { timeoutSec = seconds; }
+
+  int connect(const char* host, uint16_t port, int timeoutMs) {
+    stop();
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0) return 0;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    bool ok = ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) { stop(); return 0; }
+
+    ssl = SSL_new(context());
+    SSL_set_fd(ssl, fd);
+    SSL_set_tlsext_host_name(ssl, host);
+    if (SSL_connect(ssl) != 1) { stop(); return 0; }
+    int open = ++clientTlsOpen;
+    int max = clientTlsMax;
+    while (open > max && !clientTlsMax.compare_exchange_weak(max, open)) {}
+    counted = true;
+    return 1;
+  }
+
+  // Wie beim ESP32: offen, solange der Server weder close_notify noch FIN geschickt hat
+  uint8_t connected() {
+    if (!ssl) return 0;
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    char c;
+    int n = SSL_peek(ssl, &c, 1);
+    int err = n > 0 ? SSL_ERROR_NONE : SSL_get_error(ssl, n);
+    fcntl(fd, F_SETFL, flags);
+    if (err == SSL_ERROR_NONE || err == SSL_ERROR_WANT_READ) return 1;
+    ERR_clear_error();
+    return 0;
+  }
+
+  void stop() {
+    if (ssl) {
+      SSL_shutdown(ssl);
+      SSL_free(ssl);
+      ssl = nullptr;
+    }
+    if (fd >= 0) close(fd);
+    fd = -1;
+    if (counted) clientTlsOpen--;
+    counted = false;
+  }
+
+  // Ein GET mit Keep-Alive; liefert den Statuscode (≤ 0 bei Fehler)
+  int get(const char* path) {
+    char req[128];
+    int len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: test\r\n\r\n", path);
+    if (!ssl || SSL_write(ssl, req, len) != len) return -1;
+    std::string response;
+    char buf[256];
+    while (response.find("\r\n\r\nOK") == std::string::npos) {
+      int n = SSL_read(ssl, buf, sizeof(buf));
+      if (n <= 0) return -1;
+      response.append(buf, n);
+    }
+    return atoi(response.c_str() + 9);
+  }
+
+private:
+  SSL* ssl = nullptr;
+  int fd = -1;
+  int timeoutSec = 10;
+  bool counted = false;
+
+  static SSL_CTX* context() {
+    static SSL_CTX* ctx = [] {
+      SSL_CTX* c = SSL_CTX_new(TLS_client_method());
+      SSL_CTX_set_verify(c, SSL_VERIFY_NONE, nullptr);   // wie setInsecure()
+      return c;
+    }();
+    return ctx;
+  }
+};
+
+#include "https_pool.h"
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TLS-SERVER (im Prozess)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class TlsServer {
+public:
+  std::atomic<int> handshakes{0};
+  std::atomic<int> requests{0};
+  std::atomic<int> idleMs{0};          // > 0: Server schließt ruhende Verbindungen
+
+  bool start() {
+    ctx = SSL_CTX_new(TLS_server_method());
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    if (!key || SSL_CTX_use_certificate(ctx, cert) != 1 || SSL_CTX_use_PrivateKey(ctx, key) != 1) return false;
+    X509_free(cert);
+    EVP_PKEY_free(key);
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 16) != 0) return false;
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    acceptThread = std::thread([this] { acceptLoop(); });
+    return true;
+  }
+
+  void stop() {
+    shutdown(listenFd, SHUT_RDWR);
+    close(listenFd);
+    acceptThread.join();
+  }
+
+  uint16_t port = 0;
+
+private:
+  SSL_CTX* ctx = nullptr;
+  int listenFd = -1;
+  std::thread acceptThread;
+
+  void acceptLoop() {
+    for (;;) {
+      int fd = accept(listenFd, nullptr, nullptr);
+      if (fd < 0) break;
+      std::thread([this, fd] { serve(fd); }).detach();
+    }
+  }
+
+  void serve(int fd) {
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    if (SSL_accept(ssl) == 1) {
+      handshakes++;
+      if (idleMs > 0) {
+        timeval tv = {idleMs / 1000, (idleMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      }
+      std::string buffer;
+      char buf[256];
+      for (;;) {
+        int n = SSL_read(ssl, buf, sizeof(buf));
+        if (n <= 0) break;             // Client weg oder Idle-Timeout
+        buffer.append(buf, n);
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) != std::string::npos) {
+          buffer.erase(0, end + 4);
+          requests++;
+          static const char ok[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK";
+          SSL_write(ssl, ok, sizeof(ok) - 1);
+        }
+      }
+      SSL_shutdown(ssl);
+    }
+    SSL_free(ssl);
+    close(fd);
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TESTS
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "✅" : "❌", what);
+  if (!ok) failures++;
+}
+
+// Ein Request wie sendHTTPPost(): acquire → Request → release
+static int request(HttpsPool& pool, const char* url, unsigned long keep = HTTPS_IDLE_TIMEOUT) {
+  WiFiClientSecure* client = pool.acquire(url, keep);
+  if (!client) return 0;
+  int code = client->get("/");
+  pool.release(client, code > 0);
+  return code;
+}
+
+int main() {
+  TlsServer server;
+  if (!server.start()) { ERR_print_errors_fp(stderr); return 1; }
+
+  char urlA[64], urlB[64];
+  snprintf(urlA, sizeof(urlA), "https://127.0.0.1:%u/update", server.port);
+  snprintf(urlB, sizeof(urlB), "https://localhost:%u/hook", server.port);
+  char line[160];
+
+  // 1. Wiederverwendung
+  {
+    HttpsPool pool;
+    int ok = 0;
+    for (int i = 0; i < 20; i++) ok += request(pool, urlA) == 200;
+    HttpsPoolStats s = pool.getStats();
+    snprintf(line, sizeof(line), "Keep-Alive: %d/20 Requests, %u Handshake(s), %u wiederverwendet, Handshake %u ms",
+             ok, s.handshakes, s.reuses, s.lastHandshakeMs);
+    check(ok == 20 && s.handshakes == 1 && s.reuses == 19, line);
+  }
+
+  // 2. Haltezeit: DynDNS (alle 5 min) mit längerer Haltezeit, Webhook mit Standard
+  {
+    HttpsPool pool;
+    request(pool, urlA, 300000 + 30000);
+    request(pool, urlB);
+    clockOffsetMs += 300000;           // 5 min später
+    pool.maintain();
+    int open = pool.openConnections();
+    request(pool, urlA, 300000 + 30000);
+    HttpsPoolStats s = pool.getStats();
+    snprintf(line, sizeof(line), "Haltezeit: nach 5 min %d Verbindung offen, DynDNS wiederverwendet (%u Handshakes)",
+             open, s.handshakes);
+    check(open == 1 && s.reuses == 1 && s.handshakes == 2, line);
+  }
+
+  // 3. Server schließt ruhende Verbindung selbst
+  {
+    HttpsPool pool;
+    server.idleMs = 300;
+    int first = request(pool, urlA);
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    int second = request(pool, urlA);
+    HttpsPoolStats s = pool.getStats();
+    snprintf(line, sizeof(line), "Server-Timeout: %d, dann %d mit neuem Handshake (%u)", first, second, s.handshakes);
+    check(first == 200 && second == 200 && s.handshakes == 2 && s.reuses == 0, line);
+    server.idleMs = 0;
+  }
+
+  // 4. Externe Verbindung (Telegram) zählt mit
+  {
+    HttpsPool pool;
+    bool reserved = pool.reserveExternal();
+    WiFiClientSecure* a = pool.acquire(urlA);
+    WiFiClientSecure* b = pool.acquire(urlB);       // Limit erreicht: extern + a
+    bool full = a && !b && pool.openConnections() == HTTPS_POOL_SIZE;
+    bool noMore = !pool.reserveExternal();          // a in Benutzung, nichts zu verdrängen
+    pool.release(a, true);
+    b = pool.acquire(urlB);                         // verdrängt a
+    int code = b ? b->get("/") : 0;
+    if (b) pool.release(b, true);
+    bool evicted = pool.reserveExternal() == true;  // verdrängt b
+    int open = pool.openConnections();
+    pool.releaseExternal();
+    pool.releaseExternal();
+    snprintf(line, sizeof(line), "Extern: Limit %d inkl. Telegram, Verdrängung der Idle-Verbindung (%d offen)",
+             HTTPS_POOL_SIZE, open);
+    check(reserved && full && noMore && code == 200 && evicted && open == 2 && pool.openConnections() == 0, line);
+  }
+
+  // 5. Parallele Tasks (Webhook, DynDNS, Telemetrie ...) gegen zwei Hosts
+  {
+    HttpsPool pool;
+    clientTlsMax = clientTlsOpen.load();
+    int base = clientTlsOpen;
+    std::atomic<int> ok{0}, busy{0}, errors{0};
+    std::atomic<bool> done{false};
+    std::thread monitor([&] {
+      while (!done) {
+        if (pool.openConnections() > HTTPS_POOL_SIZE) errors++;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    });
+    std::vector<std::thread> tasks;
+    for (int t = 0; t < 6; t++) {
+      tasks.emplace_back([&, t] {
+        for (int i = 0; i < 40; i++) {
+          int code = request(pool, (i + t) % 2 ? urlA : urlB);
+          if (code == 200) ok++;
+          else if (code == 0) busy++;
+          else errors++;
+        }
+      });
+    }
+    for (auto& t : tasks) t.join();
+    done = true;
+    monitor.join();
+    HttpsPoolStats s = pool.getStats();
+    snprintf(line, sizeof(line), "Parallel: %d ok, %d abgewiesen, max. %d TLS gleichzeitig, %u Handshakes, %d Fehler",
+             ok.load(), busy.load(), clientTlsMax - base, s.handshakes, errors.load());
+    check(ok + busy == 240 && ok > 0 && errors == 0 && clientTlsMax - base <= HTTPS_POOL_SIZE, line);
+  }
+
+  // 6. Wenig Heap und Klartext-URL
+  {
+    HttpsPool pool;
+    request(pool, urlA);
+    ESP.freeHeap = 10000;
+    WiFiClientSecure* b = pool.acquire(urlB);
+    int open = pool.openConnections();
+    ESP.freeHeap = 200000;
+    bool plain = pool.acquire("http://127.0.0.1/x") == nullptr && !HttpsPool::isHttps("http://127.0.0.1/x");
+    snprintf(line, sizeof(line), "Wenig Heap: kein Handshake, Idle-Verbindungen geschlossen (%d offen); http:// nie im Pool", open);
+    check(!b && open == 0 && pool.getStats().failures == 1 && plain, line);
+  }
+
+  server.stop();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * ForellenWächter - v1.3 SD-Flush mit Resets mitten im Schreiben (Host)
+ * Batch-Logik siehe src/sd_batch.h, Ablauf wie flushToSD() in
+ * src/ForellenWaechter_v1.3_DeepSleep.ino
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src sd_batch_sim.cpp -o sd_batch_sim
+ *   ./sd_batch_sim [Wakeups]
+ *
+ * Simuliert werden Wakeups mit RTC-Puffer (überlebt den Reset) und einer
+ * SD-Karte im Speicher. Während eines Flushs kommt zufällig ein Reset nach
+ * einer beliebigen Anzahl geschriebener Bytes (auch mitten in einer Zeile),
+ * gelegentlich fehlt die Karte oder der Strom fällt ganz aus (RTC-RAM weg).
+ * Am Ende muss jede Messung und jedes Ereignis genau einmal in der Datei
+ * stehen - außer denen, die beim Stromausfall im RTC-RAM lagen oder wegen
+ * vollem Puffer verworfen wurden - und jede Zeile muss vollständig sein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include "sd_batch.h"
+
+#define RTC_LOG_CAPACITY 48
+#define RTC_EVENT_CAPACITY 8
+#define SD_FLUSH_EVERY_N_WAKES 12
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SD-KARTE IM SPEICHER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct Reset {};                       // Reset mitten im Schreiben
+
+std::map<std::string, std::string> sdFiles;
+long writeBudget = -1;                 // Bytes bis zum Reset, -1 = kein Reset
+bool sdPresent = true;
+
+void sdAppend(const std::string& path, const std::string& data) {
+  if (writeBudget >= 0 && (long)data.size() > writeBudget) {
+    sdFiles[path] += data.substr(0, writeBudget);
+    writeBudget = 0;
+    throw Reset();
+  }
+  if (writeBudget >= 0) writeBudget -= data.size();
+  sdFiles[path] += data;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// RTC-RAM (überlebt Resets, nicht aber Stromausfall)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct RtcLogRecord { uint32_t boot; };
+struct RtcEventRecord { uint32_t boot; char value[16]; };
+
+struct Rtc {
+  RtcLogRecord log[RTC_LOG_CAPACITY];
+  uint8_t logCount = 0;
+  RtcEventRecord events[RTC_EVENT_CAPACITY];
+  uint8_t eventCount = 0;
+  int wakesSinceFlush = 0;
+  SdPendingBatch pendingLog = {};
+  SdPendingBatch pendingEvents = {};
+} rtc;
+
+std::set<uint32_t> droppedLog, droppedEvents;
+
+void logToSD(uint32_t boot) {
+  if (rtc.logCount >= RTC_LOG_CAPACITY) {
+    droppedLog.insert(rtc.log[0].boot);
+    memmove(&rtc.log[0], &rtc.log[1], sizeof(RtcLogRecord) * (RTC_LOG_CAPACITY - 1));
+    rtc.logCount = RTC_LOG_CAPACITY - 1;
+  }
+  rtc.log[rtc.logCount++].boot = boot;
+}
+
+void logEvent(uint32_t boot) {
+  if (rtc.eventCount >= RTC_EVENT_CAPACITY) {
+    droppedEvents.insert(rtc.events[0].boot);
+    memmove(&rtc.events[0], &rtc.events[1], sizeof(RtcEventRecord) * (RTC_EVENT_CAPACITY - 1));
+    rtc.eventCount = RTC_EVENT_CAPACITY - 1;
+  }
+  RtcEventRecord& ev = rtc.events[rtc.eventCount++];
+  ev.boot = boot;
+  snprintf(ev.value, sizeof(ev.value), "EV%lu", (unsigned long)boot);
+}
+
+bool shouldFlushSD(bool alarm) {
+  if (rtc.logCount == 0 && rtc.eventCount == 0) return false;
+  if (rtc.pendingLog.active || rtc.pendingEvents.active) return true;
+  if (alarm) return true;
+  if (rtc.logCount >= RTC_LOG_CAPACITY || rtc.eventCount >= RTC_EVENT_CAPACITY) return true;
+  return rtc.wakesSinceFlush >= SD_FLUSH_EVERY_N_WAKES;
+}
+
+std::string logFilename(uint32_t boot) {
+  char name[24];
+  snprintf(name, sizeof(name), "/log_%04lu.csv", (unsigned long)(boot / 288));
+  return name;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// FLUSH (wie beginBatchFile() / flushToSD() in der Firmware)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+bool beginBatchFile(const std::string& path, uint32_t fileId, SdPendingBatch& pending,
+                    const char* header) {
+  if (!sdPresent) return false;
+  auto it = sdFiles.find(path);
+  uint32_t size = it != sdFiles.end() ? it->second.size() : 0;
+  int last = size > 0 ? it->second.back() : '\n';
+
+  if (!sdBatchPending(pending, fileId) && last != '\n') {
+    sdAppend(path, "\n");
+    size++;
+  }
+
+  if (sdBatchBegin(pending, fileId, size)) {
+    sdFiles[path].resize(pending.offset);
+    size = pending.offset;
+  }
+  if (size == 0 && header) sdAppend(path, std::string(header) + "\n");
+  return true;
+}
+
+void flushToSD() {
+  while (rtc.logCount > 0) {
+    std::string filename = logFilename(rtc.log[0].boot);
+    uint32_t day = rtc.log[0].boot / 288;
+    int count = 1;
+    while (count < rtc.logCount && rtc.log[count].boot / 288 == day) count++;
+
+    if (!beginBatchFile(filename, day, rtc.pendingLog, "Boot,WaterTemp")) return;
+    std::string rows;
+    for (int i = 0; i < count; i++) {
+      char line[40];
+      snprintf(line, sizeof(line), "%lu,%.2f\n", (unsigned long)rtc.log[i].boot,
+               10 + (rtc.log[i].boot % 500) / 100.0);
+      rows += line;
+    }
+    // In kleinen Stücken schreiben wie file.printf() - Reset kann überall treffen
+    for (size_t pos = 0; pos < rows.size(); pos += 7) sdAppend(filename, rows.substr(pos, 7));
+
+    sdBatchDone(rtc.pendingLog);
+    memmove(&rtc.log[0], &rtc.log[count], sizeof(RtcLogRecord) * (rtc.logCount - count));
+    rtc.logCount -= count;
+  }
+
+  if (rtc.eventCount > 0 && beginBatchFile("/events.log", 0, rtc.pendingEvents, nullptr)) {
+    int count = rtc.eventCount;
+    for (int i = 0; i < count; i++) {
+      char line[48];
+      snprintf(line, sizeof(line), "%lu,TYPE,%s\n", (unsigned long)rtc.events[i].boot,
+               rtc.events[i].value);
+      sdAppend("/events.log", line);
+    }
+    sdBatchDone(rtc.pendingEvents);
+    memmove(&rtc.events[0], &rtc.events[count], sizeof(RtcEventRecord) * (rtc.eventCount - count));
+    rtc.eventCount -= count;
+  }
+  rtc.wakesSinceFlush = 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// AUSWERTUNG
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct FileCheck {
+  std::map<uint32_t, int> seen;        // boot → Anzahl Zeilen
+  int badLines = 0;                    // unvollständig oder unlesbar
+  bool ordered = true;
+};
+
+void checkFile(const std::string& content, bool csv, FileCheck& c, uint32_t& lastBoot) {
+  size_t pos = 0;
+  bool first = true;
+  while (pos < content.size()) {
+    size_t end = content.find('\n', pos);
+    if (end == std::string::npos) { c.badLines++; break; }   // Letzte Zeile ohne \n
+    std::string line = content.substr(pos, end - pos);
+    pos = end + 1;
+    if (csv && first && line == "Boot,WaterTemp") { first = false; continue; }
+    first = false;
+
+    unsigned long boot;
+    char rest[32];
+    bool ok = csv ? sscanf(line.c_str(), "%lu,%31s", &boot, rest) == 2 && strlen(rest) >= 5
+                  : sscanf(line.c_str(), "%lu,TYPE,EV%31s", &boot, rest) == 2 &&
+                    strtoul(rest, nullptr, 10) == boot;
+    if (!ok) { c.badLines++; continue; }
+    if (boot <= lastBoot) c.ordered = false;
+    lastBoot = boot;
+    c.seen[boot]++;
+  }
+}
+
+int main(int argc, char** argv) {
+  int wakes = argc > 1 ? atoi(argv[1]) : 20000;
+  srand(26);
+
+  // Regeln ohne Simulation: Wiederholung kürzt nur dieselbe Datei
+  SdPendingBatch p = {};
+  bool rulesOk = !sdBatchBegin(p, 7, 1000) &&          // Batch in Tag 7 beginnt bei 1000
+                 sdBatchBegin(p, 7, 1234) && p.offset == 1000 &&   // Reset → auf 1000 kürzen
+                 !sdBatchBegin(p, 8, 1500) && p.offset == 1500;    // Tag 7 verworfen → Tag 8 nicht kürzen
+  sdBatchDone(p);
+  rulesOk = rulesOk && !sdBatchPending(p, 8) && !sdBatchBegin(p, 8, 900) && p.offset == 900;
+  printf("%s Regeln: Kürzen nur bei Wiederholung derselben Datei\n", rulesOk ? "✅" : "❌");
+
+  std::set<uint32_t> expectedLog, expectedEvents, powerLost;
+  int resets = 0, powerFails = 0, missingCard = 0, flushes = 0;
+
+  for (uint32_t boot = 1; boot <= (uint32_t)wakes; boot++) {
+    // Messung und ab und zu ein Ereignis in den RTC-Puffer
+    logToSD(boot);
+    expectedLog.insert(boot);
+    if (boot % 5 == 0) {
+      logEvent(boot);
+      expectedEvents.insert(boot);
+    }
+    rtc.wakesSinceFlush++;
+
+    bool alarm = rand() % 40 == 0;
+    if (!shouldFlushSD(alarm)) continue;
+
+    // Ab und zu fehlt die Karte, regelmäßig auch länger (RTC-Puffer läuft voll)
+    sdPresent = rand() % 25 != 0 && boot % 4000 < 3900;
+    if (!sdPresent) missingCard++;
+    writeBudget = rand() % 3 == 0 ? rand() % 600 : -1;
+    flushes++;
+    try {
+      flushToSD();
+    } catch (const Reset&) {
+      resets++;
+      if (rand() % 10 == 0) {
+        // Stromausfall: RTC-RAM weg, gepufferte Werte verloren
+        powerFails++;
+        for (int i = 0; i < rtc.logCount; i++) powerLost.insert(rtc.log[i].boot);
+        for (int i = 0; i < rtc.eventCount; i++) powerLost.insert(rtc.events[i].boot);
+        rtc = Rtc();
+      }
+    }
+    writeBudget = -1;
+  }
+
+  // Letzter Flush ohne Störung
+  sdPresent = true;
+  flushToSD();
+
+  FileCheck csv, events;
+  uint32_t lastBoot = 0;
+  for (auto& f : sdFiles) {
+    if (f.first.rfind("/log_", 0) == 0) checkFile(f.second, true, csv, lastBoot);
+  }
+  uint32_t lastEvent = 0;
+  checkFile(sdFiles["/events.log"], false, events, lastEvent);
+
+  // Erwartet: genau einmal, außer verworfen (Puffer voll) oder beim Stromausfall verloren
+  auto verify = [&](const std::set<uint32_t>& expected, const std::set<uint32_t>& dropped,
+                    const FileCheck& c, int& missing, int& duplicates, int& unexpected) {
+    missing = duplicates = unexpected = 0;
+    for (uint32_t b : expected) {
+      auto it = c.seen.find(b);
+      int n = it == c.seen.end() ? 0 : it->second;
+      bool mayMiss = dropped.count(b) || powerLost.count(b);
+      if (n == 0 && !mayMiss) missing++;
+      if (n > 1) duplicates++;
+    }
+    for (auto& s : c.seen) if (!expected.count(s.first)) unexpected++;
+  };
+
+  int logMissing, logDup, logExtra, evMissing, evDup, evExtra;
+  verify(expectedLog, droppedLog, csv, logMissing, logDup, logExtra);
+  verify(expectedEvents, droppedEvents, events, evMissing, evDup, evExtra);
+
+  // Nach Stromausfall darf eine abgerissene Zeile stehen bleiben (wird mit \n abgeschlossen)
+  bool logOk = !logMissing && !logDup && !logExtra && csv.ordered && csv.badLines <= powerFails;
+  bool evOk = !evMissing && !evDup && !evExtra && events.ordered && events.badLines <= powerFails;
+
+  printf("%d Wakeups, %d Flushes: %d Resets im Schreiben, %d Stromausfälle, %d ohne SD-Karte\n",
+         wakes, flushes, resets, powerFails, missingCard);
+  printf("%s Messungen: %zu Zeilen, fehlend %d, doppelt %d, fremd %d, abgerissen %d, "
+         "verworfen %zu, Stromausfall %zu\n", logOk ? "✅" : "❌", csv.seen.size(), logMissing,
+         logDup, logExtra, csv.badLines, droppedLog.size(), powerLost.size());
+  printf("%s Ereignisse: %zu Zeilen, fehlend %d, doppelt %d, fremd %d, abgerissen %d\n",
+         evOk ? "✅" : "❌", events.seen.size(), evMissing, evDup, evExtra, events.badLines);
+  return rulesOk && logOk && evOk ? 0 : 1;
+}
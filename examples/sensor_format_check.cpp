@@ -0,0 +1,255 @@
+/*
+ * ForellenWächter - Prüfung der Feld-Writer JSON/CSV/Klartext (Host, Linux/macOS)
+ * Writer siehe src/sensor_format.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src sensor_format_check.cpp -o sensor_format_check
+ *   ./sensor_format_check
+ *
+ * Eine Feld-Tabelle wie SENSOR_FIELD_LIST in der Firmware (ein Sensor per
+ * Feature-Flag abgeschaltet) wird mit normalen Werten, NaN/±inf (Sensor
+ * liefert nichts), Extremwerten und zu kleinen Puffern ausgegeben. Geprüft:
+ * - JSON ist gültig (eigener Parser), fehlende Werte sind null
+ * - CSV: Kopf und Zeilen haben gleich viele Spalten, fehlende Werte leer
+ * - Klartext: Gruppenfilter, "--" ohne Einheit, Bool-Texte
+ * - abgeschaltete Felder fehlen überall, zu kleiner Puffer wird gemeldet
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include "sensor_format.h"
+
+struct Snapshot {
+  float waterTemp, airTemp, ph, tds, dissolvedOxygen, flowRate;
+  uint32_t pulses;
+  bool waterLevelOK, aerationActive;
+};
+
+#define HAS_DO false                 // wie ENABLE_DO_SENSOR = false
+
+constexpr FieldDef<Snapshot> FIELD_LIST[] = {
+  {"waterTemp", "Wasser", "💧", "°C", 2, FIELD_FLOAT, true, FMT_ALL, GROUP_TEMP,
+    [](const Snapshot& s) -> double { return s.waterTemp; }, nullptr, nullptr},
+  {"airTemp", "Luft", "🌡️", "°C", 2, FIELD_FLOAT, true, FMT_ALL, GROUP_TEMP,
+    [](const Snapshot& s) -> double { return s.airTemp; }, nullptr, nullptr},
+  {"ph", "pH", "🧪", "", 2, FIELD_FLOAT, true, FMT_ALL, GROUP_WATER,
+    [](const Snapshot& s) -> double { return s.ph; }, nullptr, nullptr},
+  {"tds", "TDS", "📊", "ppm", 0, FIELD_FLOAT, true, FMT_ALL, GROUP_WATER,
+    [](const Snapshot& s) -> double { return s.tds; }, nullptr, nullptr},
+  {"dissolvedOxygen", "O₂", "🫧", "mg/L", 2, FIELD_FLOAT, HAS_DO, FMT_ALL, GROUP_WATER,
+    [](const Snapshot& s) -> double { return s.dissolvedOxygen; }, nullptr, nullptr},
+  {"waterLevel", "Level", "🌊", "", 0, FIELD_BOOL, true, FMT_ALL, GROUP_WATER,
+    [](const Snapshot& s) -> double { return s.waterLevelOK; }, "OK", "NIEDRIG"},
+  {"flowRate", "Durchfluss", "⚡", "L/min", 2, FIELD_FLOAT, true, FMT_ALL, GROUP_POWER,
+    [](const Snapshot& s) -> double { return s.flowRate; }, nullptr, nullptr},
+  {"turbinePulseCount", "Pulse", "🔄", "", 0, FIELD_COUNT, true, FMT_JSON, GROUP_POWER,
+    [](const Snapshot& s) -> double { return s.pulses; }, nullptr, nullptr},
+  {"aeration", "Belüftung", "💨", "", 0, FIELD_BOOL, true, FMT_ALL, GROUP_STATE,
+    [](const Snapshot& s) -> double { return s.aerationActive; }, "AN", "AUS"},
+};
+
+constexpr auto FIELD_SET = selectEnabled<enabledCount(FIELD_LIST)>(FIELD_LIST);
+constexpr const auto& FIELDS = FIELD_SET.items;
+static_assert(FIELD_SET.size() == 8, "abgeschaltetes Feld muss herausfallen");
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// JSON-PARSER (nur Prüfung auf Gültigkeit)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class JsonCheck {
+public:
+  explicit JsonCheck(const char* text) : p(text) {}
+
+  bool valid() {
+    ws();
+    if (!value()) return false;
+    ws();
+    return *p == '\0';
+  }
+
+private:
+  const char* p;
+
+  void ws() { while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p++; }
+  bool lit(const char* s) {
+    size_t n = strlen(s);
+    if (strncmp(p, s, n) != 0) return false;
+    p += n;
+    return true;
+  }
+
+  bool value() {
+    ws();
+    if (*p == '{') return object();
+    if (*p == '[') return array();
+    if (*p == '"') return string();
+    if (lit("true") || lit("false") || lit("null")) return true;
+    return number();
+  }
+
+  bool object() {
+    p++;
+    ws();
+    if (*p == '}') { p++; return true; }
+    for (;;) {
+      ws();
+      if (!string()) return false;
+      ws();
+      if (*p++ != ':' || !value()) return false;
+      ws();
+      if (*p == ',') { p++; continue; }
+      return *p++ == '}';
+    }
+  }
+
+  bool array() {
+    p++;
+    ws();
+    if (*p == ']') { p++; return true; }
+    for (;;) {
+      if (!value()) return false;
+      ws();
+      if (*p == ',') { p++; continue; }
+      return *p++ == ']';
+    }
+  }
+
+  bool string() {
+    if (*p++ != '"') return false;
+    while (*p && *p != '"') {
+      if ((unsigned char)*p < 0x20) return false;
+      if (*p == '\\') {
+        p++;
+        if (*p == 'u') {
+          for (int i = 1; i <= 4; i++) if (!isxdigit((unsigned char)p[i])) return false;
+          p += 4;
+        } else if (!strchr("\"\\/bfnrt", *p)) {
+          return false;
+        }
+      }
+      p++;
+    }
+    return *p++ == '"';
+  }
+
+  bool number() {
+    const char* start = p;
+    if (*p == '-') p++;
+    if (*p == '0') p++;
+    else if (*p >= '1' && *p <= '9') while (isdigit((unsigned char)*p)) p++;
+    else return false;
+    if (*p == '.') { p++; if (!isdigit((unsigned char)*p)) return false; while (isdigit((unsigned char)*p)) p++; }
+    if (*p == 'e' || *p == 'E') {
+      p++;
+      if (*p == '+' || *p == '-') p++;
+      if (!isdigit((unsigned char)*p)) return false;
+      while (isdigit((unsigned char)*p)) p++;
+    }
+    return p > start;
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// PRÜFUNGEN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, const char* output = nullptr) {
+  printf("%s %s\n", ok ? "✅" : "❌", what);
+  if (!ok) {
+    if (output) printf("   %s\n", output);
+    failures++;
+  }
+}
+
+static int countColumns(const char* line) {
+  int n = 1;
+  for (; *line; line++) n += *line == ',';
+  return n;
+}
+
+static std::string json(const Snapshot& s) {
+  char buf[512];
+  TextBuffer out(buf, sizeof(buf));
+  out.append("{");
+  writeJsonFields(out, FIELDS, s);
+  out.append(",\"reason\":");
+  out.appendJsonString("Temp \"hoch\"\n\tpH\\");
+  out.append("}");
+  return buf;
+}
+
+static std::string csvRow(const Snapshot& s) {
+  char buf[256];
+  TextBuffer out(buf, sizeof(buf));
+  writeCsvRow(out, FIELDS, s);
+  return buf;
+}
+
+int main() {
+  const Snapshot normal = {11.52f, 18.24f, 7.24f, 185, 9.1f, 6.5f, 123456, true, false};
+  Snapshot missing = normal;
+  missing.waterTemp = NAN;           // DS18B20 abgezogen
+  missing.ph = INFINITY;
+  missing.flowRate = -INFINITY;
+  missing.pulses = 0;
+  Snapshot extreme = {-40.0f, 85.0f, 0.0f, 65535, 0, 999.99f, 4294967295u, false, true};
+
+  // JSON
+  std::string j = json(normal);
+  check(JsonCheck(j.c_str()).valid() && j.find("\"waterTemp\":11.52") != std::string::npos &&
+        j.find("\"waterLevel\":true") != std::string::npos &&
+        j.find("\"turbinePulseCount\":123456") != std::string::npos, "JSON: gültig, Werte und Bool", j.c_str());
+
+  j = json(missing);
+  check(JsonCheck(j.c_str()).valid() && j.find("\"waterTemp\":null") != std::string::npos &&
+        j.find("\"ph\":null") != std::string::npos && j.find("\"flowRate\":null") != std::string::npos &&
+        j.find("nan") == std::string::npos && j.find("inf") == std::string::npos,
+        "JSON: NaN/±inf als null, weiterhin gültig", j.c_str());
+
+  j = json(extreme);
+  check(JsonCheck(j.c_str()).valid() && j.find("\"turbinePulseCount\":4294967295") != std::string::npos,
+        "JSON: Extremwerte", j.c_str());
+
+  check(j.find("dissolvedOxygen") == std::string::npos, "JSON: abgeschalteter Sensor fehlt");
+
+  // CSV
+  char header[256];
+  TextBuffer h(header, sizeof(header));
+  writeCsvHeader(h, FIELDS);
+  int columns = countColumns(header);
+  std::string rowNormal = csvRow(normal), rowMissing = csvRow(missing), rowExtreme = csvRow(extreme);
+  check(columns == 7 && strstr(header, "turbinePulseCount") == nullptr && strstr(header, "dissolvedOxygen") == nullptr,
+        "CSV: Kopf ohne JSON-only- und abgeschaltete Spalten", header);
+  check(countColumns(rowNormal.c_str()) == columns && countColumns(rowMissing.c_str()) == columns &&
+        countColumns(rowExtreme.c_str()) == columns, "CSV: gleiche Spaltenzahl in allen Zeilen");
+  check(rowNormal == "11.52,18.24,7.24,185,1,6.50,0", "CSV: Werte mit Präzision", rowNormal.c_str());
+  check(rowMissing == ",18.24,,185,1,,0", "CSV: fehlende Werte als leere Felder", rowMissing.c_str());
+
+  // Klartext
+  char text[512];
+  TextBuffer t(text, sizeof(text));
+  writeTextFields(t, FIELDS, missing, GROUP_TEMP | GROUP_WATER, "- ");
+  check(strstr(text, "- 💧 Wasser: --\n") && strstr(text, "- 🌡️ Luft: 18.24 °C\n") &&
+        strstr(text, "- 🧪 pH: --\n") && strstr(text, "🌊 Level: OK\n") && !strstr(text, "Durchfluss") &&
+        !strstr(text, "nan") && !strstr(text, "inf"), "Klartext: Gruppen, -- ohne Einheit, Bool-Text", text);
+
+  t.clear();
+  writeTextFields(t, FIELDS, normal);
+  check(strstr(text, "⚡ Durchfluss: 6.50 L/min\n") && strstr(text, "💨 Belüftung: AUS\n") &&
+        !strstr(text, "Pulse"), "Klartext: alle Gruppen, JSON-only-Feld fehlt", text);
+
+  // Zu kleiner Puffer: abgeschnitten, terminiert, gemeldet
+  char small[24];
+  TextBuffer s(small, sizeof(small));
+  writeJsonFields(s, FIELDS, normal);
+  check(s.overflowed() && s.length() == sizeof(small) - 1 && strlen(small) == s.length(),
+        "Puffer zu klein: abgeschnitten und gemeldet", small);
+
+  printf("%s Writer-Prüfung: %d Fehler\n", failures ? "❌" : "✅", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+#!/bin/sh
+# ForellenWächter - Flash/RAM je Sensor-Konfiguration (arduino-cli)
+# Feature-Flags siehe src/ForellenWaechter_v1.6.1_LTE.ino (per -D überschreibbar)
+#
+# Voraussetzung: arduino-cli mit ESP32-Core 3.x und den Bibliotheken aus
+# docs/INSTALLATION.md
+#
+#   ./size_report.sh                       # ESP32 (Standard)
+#   ./size_report.sh esp32:esp32:esp32c3   # Satelliten-Knoten
+#
+# Jede Konfiguration wird einmal gebaut; ausgegeben werden Flash (Sketch) und
+# statischer RAM (globale Variablen) sowie die Differenz zur ersten Zeile.
+#
+# Stand: nur gegen eine nachgebaute arduino-cli-Ausgabe geprüft, noch nie mit
+# einem echten Build ausgeführt.
+
+set -e
+
+FQBN=${1:-esp32:esp32:esp32}
+SKETCH_NAME=ForellenWaechter_v1.6.1_LTE
+SRC=$(cd "$(dirname "$0")/../src" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# arduino-cli baut alle .ino eines Ordners zusammen → nur diesen Sketch kopieren
+mkdir -p "$WORK/$SKETCH_NAME"
+cp "$SRC/$SKETCH_NAME.ino" "$SRC"/*.h "$WORK/$SKETCH_NAME/"
+
+# Name|Flags
+CONFIGS="Standard (Turbine, Batterie)|
+Mit O2-Sensor|-DENABLE_DO_SENSOR=true
+Ohne Turbine|-DENABLE_TURBINE=false
+Nur Temperatur + pH/TDS|-DENABLE_TURBINE=false -DENABLE_BATTERY_MONITOR=false -DENABLE_DO_SENSOR=false
+Minimal (ohne LTE, E-Mail)|-DENABLE_TURBINE=false -DENABLE_BATTERY_MONITOR=false -DENABLE_LTE=false -DENABLE_EMAIL_ALERTS=false"
+
+printf '%-32s %10s %10s %10s %10s\n' "Konfiguration ($FQBN)" "Flash" "RAM" "ΔFlash" "ΔRAM"
+BASE_FLASH=
+BASE_RAM=
+echo "$CONFIGS" | while IFS='|' read -r NAME FLAGS; do
+  OUT=$(arduino-cli compile --fqbn "$FQBN" --build-path "$WORK/build" \
+        --build-property "compiler.cpp.extra_flags=$FLAGS" "$WORK/$SKETCH_NAME" 2>&1) || {
+    echo "❌ $NAME: Build fehlgeschlagen"
+    echo "$OUT" | grep -m 5 'error' >&2
+    continue
+  }
+  FLASH=$(echo "$OUT" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  RAM=$(echo "$OUT" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+  if [ -z "$BASE_FLASH" ]; then BASE_FLASH=$FLASH; BASE_RAM=$RAM; fi
+  printf '%-32s %10s %10s %+9d %+9d\n' "$NAME" "$FLASH" "$RAM" \
+    $((FLASH - BASE_FLASH)) $((RAM - BASE_RAM))
+done
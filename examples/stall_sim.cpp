@@ -0,0 +1,113 @@
+/*
+ * ForellenWächter - Stall-Profiler mit simuliertem Watchdog-Reset (Host)
+ * Marker siehe src/stall_profiler.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src stall_sim.cpp -o stall_sim
+ *   ./stall_sim [hängende Phase 1-9]
+ *
+ * Ablauf:
+ * 1. Power-On: RTC-Speicher enthält Zufallswerte → kein Vorlauf gemeldet
+ * 2. loop() mit Phasen wie in der Firmware (AT-Befehle, TLS, SD, NTP ...),
+ *    gelegentlich langsame Durchläufe über dem Budget
+ * 3. Eine Phase hängt länger als WATCHDOG_TIMEOUT → simulierter Reset
+ *    (RAM weg, RTC_NOINIT bleibt, Uptime beginnt bei 0)
+ * 4. Neustart: Bericht wie logEvent("RESET", ...) und /api/status
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "stall_profiler.h"
+
+// Wie LoopPhase in der Firmware
+enum LoopPhase : uint8_t {
+  PHASE_IDLE, PHASE_SENSORS, PHASE_WEB, PHASE_OTA, PHASE_LTE_AT, PHASE_HTTPS,
+  PHASE_SD, PHASE_TIME, PHASE_SETTINGS, PHASE_TELEGRAM, PHASE_COUNT
+};
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+  "IDLE", "SENSORS", "WEB", "OTA", "LTE_AT", "HTTPS", "SD", "TIME", "SETTINGS", "TELEGRAM"
+};
+
+const uint32_t WATCHDOG_MS = 120000;
+const uint32_t LOOP_BUDGET_MS = 200;
+
+StallRecord rtcNoInit;               // Überlebt den simulierten Reset
+uint32_t uptimeMs = 0;
+uint32_t clockMs() { return uptimeMs; }
+
+void spend(StallProfiler& profiler, uint8_t phase, uint32_t ms) {
+  StallScope scope(profiler, phase);
+  uptimeMs += ms;
+}
+
+// Ein Lauf bis zum Watchdog; hangPhase hängt im Durchlauf hangAt
+void runUntilWatchdog(StallProfiler& profiler, uint8_t hangPhase, int hangAt) {
+  for (int i = 0;; i++) {
+    profiler.loopStart();
+    spend(profiler, PHASE_WEB, 1 + rand() % 3);
+    spend(profiler, PHASE_SENSORS, 5 + rand() % 20);
+    if (i % 50 == 0) spend(profiler, PHASE_SD, 20 + rand() % 300);
+    if (i % 120 == 0) {
+      // Telemetrie über LTE: HTTP-AT-Befehle verschachtelt
+      StallScope https(profiler, PHASE_HTTPS);
+      spend(profiler, PHASE_LTE_AT, 800 + rand() % 1500);
+    }
+    if (i % 300 == 0) spend(profiler, PHASE_TIME, 1000);
+
+    if (i == hangAt) {
+      // Phase betreten und nicht mehr verlassen; Watchdog greift nach WATCHDOG_MS
+      profiler.enter(hangPhase);
+      uptimeMs += WATCHDOG_MS;
+      return;                        // Reset: Stack und RAM sind weg
+    }
+    profiler.loopEnd(LOOP_BUDGET_MS);
+    uptimeMs += 10;
+  }
+}
+
+int main(int argc, char** argv) {
+  uint8_t hangPhase = argc > 1 ? atoi(argv[1]) : PHASE_LTE_AT;
+  if (hangPhase == 0 || hangPhase >= PHASE_COUNT) hangPhase = PHASE_LTE_AT;
+  srand(3);
+
+  // 1. Power-On: Zufallsinhalt im RTC-Speicher
+  for (size_t i = 0; i < sizeof(rtcNoInit); i++) ((uint8_t*)&rtcNoInit)[i] = rand();
+  {
+    StallProfiler profiler(rtcNoInit, clockMs);
+    bool previous = profiler.boot();
+    printf("Power-On: Vorlauf %s\n", previous ? "❌ fälschlich gültig" : "✅ verworfen");
+
+    // 2./3. Betrieb bis zum Hänger
+    runUntilWatchdog(profiler, hangPhase, 1500);
+    printf("Lauf 1: %lu Durchläufe, Watchdog nach %lu s in %s\n",
+           (unsigned long)rtcNoInit.loops, (unsigned long)(uptimeMs / 1000), PHASE_NAMES[hangPhase]);
+  }
+
+  // 4. Neustart nach Watchdog-Reset
+  uptimeMs = 0;
+  StallProfiler profiler(rtcNoInit, clockMs);
+  if (!profiler.boot()) {
+    printf("❌ Vorlauf nach Reset nicht erkannt\n");
+    return 1;
+  }
+
+  const StallRecord& last = profiler.previous();
+  printf("\nBericht nach Neustart (Reset Nr. %lu):\n", (unsigned long)profiler.current().boots);
+  printf("  Phase beim Reset: %s (seit Uptime %lu s, letztes Lebenszeichen %lu s)\n",
+         PHASE_NAMES[last.phase], (unsigned long)(last.phaseEnterMs / 1000),
+         (unsigned long)(last.lastMarkMs / 1000));
+  printf("  loop(): %lu Durchläufe, %lu über %lu ms Budget, max %lu ms\n",
+         (unsigned long)last.loops, (unsigned long)last.loopsOverBudget,
+         (unsigned long)LOOP_BUDGET_MS, (unsigned long)last.maxLoopMs);
+
+  uint8_t slow[3];
+  uint8_t n = StallProfiler::slowest(last, slow, 3);
+  printf("  Längste Phasen:");
+  for (uint8_t i = 0; i < n; i++) printf(" %s %lu ms", PHASE_NAMES[slow[i]], (unsigned long)last.maxPhaseMs[slow[i]]);
+  printf("\n\n");
+
+  bool ok = last.phase == hangPhase && last.loopsOverBudget > 0 && n > 0 &&
+            profiler.current().loops == 0 && profiler.current().boots == 1;
+  printf("%s Hängende Phase korrekt erkannt\n", ok ? "✅" : "❌");
+  return ok ? 0 : 1;
+}
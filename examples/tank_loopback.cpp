@@ -0,0 +1,268 @@
+/*
+ * ForellenWächter - Multi-Becken über UDP-Loopback (Host, Linux/macOS)
+ * Frame-Format und Sequenz-Auswertung siehe src/tank_link.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src tank_loopback.cpp -o tank_loopback
+ *   ./tank_loopback [Becken] [Runden]
+ *
+ * Viele simulierte Satelliten senden pro Runde je einen TankFrame an einen
+ * Master-Socket auf 127.0.0.1 (TankTransport über POSIX-UDP). Dabei:
+ * - zufällig verlorene Frames (Sequenz läuft weiter, Frame wird nicht gesendet)
+ * - doppelt gesendete Frames
+ * - Neustart jedes Satelliten in der Mitte (Sequenz beginnt wieder bei 0)
+ * - Sequenz-Überlauf 65535 → 0 bei einigen Becken
+ * - fremde Pakete und Frames mit falscher CRC
+ * Der Master zählt wie processTankFrame() in der Firmware; am Ende müssen
+ * empfangen/verloren/Neustarts je Becken exakt mit dem Sender übereinstimmen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "tank_link.h"
+
+// UDP-Transport wie UdpTankTransport, aber mit POSIX-Sockets
+class PosixUdpTankTransport : public TankTransport {
+public:
+  explicit PosixUdpTankTransport(uint16_t port) : port(port) {}
+  ~PosixUdpTankTransport() override { if (fd >= 0) close(fd); }
+
+  // Master: auf 127.0.0.1:port lauschen
+  bool begin() override {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+    int rcvbuf = 1 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in addr = target();
+    return bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+  }
+
+  // Satellit: eigener Socket, sendet an den Master
+  bool beginSender() {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    return fd >= 0;
+  }
+
+  bool send(const TankFrame& frame) override {
+    return sendRaw((const uint8_t*)&frame, sizeof(frame));
+  }
+
+  bool sendRaw(const uint8_t* data, size_t len) {
+    sockaddr_in addr = target();
+    return sendto(fd, data, len, 0, (sockaddr*)&addr, sizeof(addr)) == (ssize_t)len;
+  }
+
+  int poll(TankFrame* out, int maxFrames) override {
+    int n = 0;
+    uint8_t buffer[64];
+    while (n < maxFrames) {
+      ssize_t size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+      if (size < 0) break;
+      packets++;
+      if (decodeTankFrame(buffer, size, out[n])) n++;
+      else rejected++;
+    }
+    return n;
+  }
+
+  // Wartet bis zu timeoutMs auf das nächste Paket
+  bool wait(int timeoutMs) {
+    pollfd p = {fd, POLLIN, 0};
+    return ::poll(&p, 1, timeoutMs) > 0;
+  }
+
+  uint32_t packets = 0;
+  uint32_t rejected = 0;
+
+private:
+  sockaddr_in target() const {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+  }
+
+  int fd = -1;
+  uint16_t port;
+};
+
+// Master-Seite: Zählung wie processTankFrame()
+struct MasterTank {
+  bool active = false;
+  uint16_t lastSeq = 0;
+  uint32_t received = 0;
+  uint32_t lost = 0;
+  uint16_t restarts = 0;
+  int16_t waterTemp = 0;
+};
+
+// Satelliten-Seite: Wahrheit zum Vergleich
+struct Satellite {
+  uint16_t seq;
+  uint32_t delivered = 0;            // Verschiedene Frames, die angekommen sein müssen
+  uint32_t dropped = 0;              // Sequenznummern, die nie gesendet wurden
+  uint16_t restarts = 0;
+  bool sentOnce = false;
+};
+
+void processFrame(std::vector<MasterTank>& tanks, const TankFrame& frame) {
+  if (frame.tankId < 1 || frame.tankId > tanks.size()) return;
+  MasterTank& tank = tanks[frame.tankId - 1];
+
+  if (tank.active) {
+    uint16_t lost;
+    TankSeqStatus status = tankSequenceCheck(tank.lastSeq, frame.sequence, lost);
+    if (status == TANK_SEQ_DUPLICATE) return;
+    if (status == TANK_SEQ_RESET) tank.restarts++;
+    tank.lost += lost;
+  }
+  tank.active = true;
+  tank.lastSeq = frame.sequence;
+  tank.received++;
+  tank.waterTemp = frame.waterTemp;
+}
+
+TankFrame makeFrame(int id, uint16_t seq) {
+  TankFrame f = {};
+  f.tankId = id;
+  f.flags = TANK_FLAG_LEVEL_OK;
+  f.sequence = seq;
+  f.waterTemp = tankQuantize100(10.0f + id * 0.1f);
+  f.airTemp = tankQuantize100(18.0f);
+  f.ph = tankQuantizeU100(7.2f);
+  f.tds = 180;
+  f.dissolvedOxygen = tankQuantizeU100(9.0f);
+  f.flowRate = tankQuantizeU100(6.0f);
+  f.batteryMilliVolt = 12600;
+  sealTankFrame(f);
+  return f;
+}
+
+int main(int argc, char** argv) {
+  int tankCount = argc > 1 ? atoi(argv[1]) : 48;
+  int rounds = argc > 2 ? atoi(argv[2]) : 400;
+  if (tankCount < 1 || tankCount > 250) tankCount = 48;
+
+  // Sequenz-Regeln ohne Netz
+  uint16_t lost;
+  bool seqOk = tankSequenceCheck(10, 11, lost) == TANK_SEQ_NEXT && lost == 0 &&
+               tankSequenceCheck(10, 14, lost) == TANK_SEQ_NEXT && lost == 3 &&
+               tankSequenceCheck(65534, 1, lost) == TANK_SEQ_NEXT && lost == 2 &&
+               tankSequenceCheck(10, 10, lost) == TANK_SEQ_DUPLICATE &&
+               tankSequenceCheck(5000, 0, lost) == TANK_SEQ_RESET && lost == 0;
+  printf("%s Sequenz: Lücke, Überlauf, Duplikat, Neustart\n", seqOk ? "✅" : "❌");
+
+  const uint16_t port = 42100 + getpid() % 1000;
+  PosixUdpTankTransport master(port);
+  if (!master.begin()) { perror("bind"); return 1; }
+
+  std::vector<PosixUdpTankTransport*> links;
+  std::vector<Satellite> sats(tankCount);
+  std::vector<MasterTank> tanks(tankCount);
+  for (int i = 0; i < tankCount; i++) {
+    links.push_back(new PosixUdpTankTransport(port));
+    if (!links.back()->beginSender()) { perror("socket"); return 1; }
+    // Jedes 8. Becken läuft kurz vor dem Überlauf los
+    sats[i].seq = i % 8 == 0 ? 65535 - rounds / 4 : rand() % 1000;
+  }
+
+  srand(11);
+  uint32_t sentPackets = 0, junkPackets = 0, processed = 0;
+  double processUs = 0;
+  TankFrame frames[8];
+
+  for (int round = 0; round < rounds; round++) {
+    uint32_t expected = 0;
+    for (int i = 0; i < tankCount; i++) {
+      Satellite& s = sats[i];
+      int id = i + 1;
+
+      // Neustart in der Mitte: Zähler beginnt wieder bei 0
+      if (round == rounds / 2 + i % 5) {
+        s.seq = 0;
+        s.restarts++;
+      }
+
+      // Verlust (nicht am Start, am Ende oder um den Neustart herum - dort
+      // folgt kein Frame, an dem der Master die Lücke sehen könnte)
+      bool nearRestart = round >= rounds / 2 - 1 && round <= rounds / 2 + 5;
+      if (s.sentOnce && !nearRestart && round < rounds - 1 && rand() % 100 < 3) {
+        s.seq++;
+        s.dropped++;
+        continue;
+      }
+
+      TankFrame f = makeFrame(id, s.seq++);
+      links[i]->send(f);
+      sentPackets++;
+      expected++;
+      s.delivered++;
+      s.sentOnce = true;
+
+      if (rand() % 100 < 2) {                // Duplikat
+        links[i]->send(f);
+        sentPackets++;
+        expected++;
+      }
+      if (rand() % 200 == 0) {               // Bitfehler → CRC
+        TankFrame bad = f;
+        bad.waterTemp ^= 0x40;
+        links[i]->sendRaw((const uint8_t*)&bad, sizeof(bad));
+        junkPackets++;
+        expected++;
+      }
+      if (rand() % 300 == 0) {               // Fremdes Paket auf dem Port
+        links[i]->sendRaw((const uint8_t*)"hello", 5);
+        junkPackets++;
+        expected++;
+      }
+    }
+
+    // Master holt ab wie handleTankFrames(): je Aufruf max. 8 Frames
+    uint32_t target = master.packets + expected;
+    while (master.packets < target) {
+      if (!master.wait(200)) break;
+      int count = master.poll(frames, 8);
+      auto t0 = std::chrono::steady_clock::now();
+      for (int k = 0; k < count; k++) processFrame(tanks, frames[k]);
+      processUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+      processed += count;
+    }
+  }
+
+  int mismatches = 0;
+  for (int i = 0; i < tankCount; i++) {
+    const Satellite& s = sats[i];
+    const MasterTank& t = tanks[i];
+    if (t.received != s.delivered || t.lost != s.dropped || t.restarts != s.restarts) {
+      if (mismatches < 5) {
+        printf("❌ Becken %d: empfangen %u/%u, verloren %u/%u, Neustarts %u/%u\n", i + 1,
+               t.received, s.delivered, t.lost, s.dropped, t.restarts, s.restarts);
+      }
+      mismatches++;
+    }
+  }
+
+  uint32_t totalLost = 0, totalDelivered = 0;
+  for (int i = 0; i < tankCount; i++) {
+    totalLost += tanks[i].lost;
+    totalDelivered += tanks[i].received;
+  }
+  printf("%s %d Becken × %d Runden: %u Pakete (%u fremd/defekt), %u Frames ausgewertet, "
+         "%u verloren erkannt\n", mismatches ? "❌" : "✅", tankCount, rounds,
+         sentPackets + junkPackets, junkPackets, totalDelivered, totalLost);
+  bool junkOk = master.rejected == junkPackets;
+  printf("%s Verworfen: %u von %u fremden/defekten Paketen\n", junkOk ? "✅" : "❌",
+         master.rejected, junkPackets);
+  printf("   Auswertung: %.0f ns pro Frame\n", processed ? processUs * 1000 / processed : 0.0);
+
+  for (auto* l : links) delete l;
+  return seqOk && !mismatches && junkOk ? 0 : 1;
+}
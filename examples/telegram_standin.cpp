@@ -0,0 +1,721 @@
+/*
+ * ForellenWächter - Lokaler Telegram Bot API Stand-in (Host, Linux/macOS)
+ * Gegenstück zu telegramPollTask()/telegramSendTask() in der Firmware
+ * Schleifen der Tasks siehe src/telegram_tasks.h
+ *
+ * Kompilieren & starten (PC):
+ *   g++ -std=c++17 -O2 -pthread -I../src telegram_standin.cpp -o telegram_standin
+ *   ./telegram_standin --selftest          Firmware-Tasks auf dem PC nachgebildet
+ *   ./telegram_standin [Port] [Chat-ID]    Echter ESP32 im LAN (Standard 8081, 123456789)
+ *
+ * Für den ESP32 den Bot auf den PC umlenken (Klartext-HTTP, kein TLS):
+ *   -DTELEGRAM_API_HOST='"192.168.1.10"' -DTELEGRAM_API_PORT=8081 -DTELEGRAM_API_TLS=false
+ *   TELEGRAM_CHAT_ID = "123456789"  (bzw. die hier angegebene Chat-ID)
+ *
+ * Der Stand-in beantwortet getUpdates (Long Polling mit timeout/offset) und
+ * sendMessage wie api.telegram.org - inkl. 429 bei mehr als 1 Nachricht/s pro
+ * Chat und einem einmaligen 500er zum Testen der Wiederholung. Ein Skript
+ * schickt Befehle (/start, /status, /relay2, fremder Chat, Befehls-Burst).
+ * Am Ende wird geprüft:
+ * - jedes Update genau einmal ausgeliefert (offset wird bestätigt)
+ * - jede Antwort im richtigen Chat, fremder Chat nur "Nicht autorisiert"
+ * - kein 429, d.h. der Versand hält das Rate-Limit ein
+ * - wenige getUpdates-Anfragen (Long Polling statt Abfrage alle 2 s)
+ * - Keep-Alive: wenige TCP-Verbindungen für alle Anfragen
+ * - Pool-Plätze (reserve/release) am Ende alle zurückgegeben
+ * - Backoff: gegen einen Port ohne Server nur wenige getUpdates-Versuche
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+static const char* TOKEN = "123456:TEST";
+static std::string authorizedChat = "123456789";
+static const char* FOREIGN_CHAT = "555";
+
+static double now() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return duration<double>(steady_clock::now() - start).count();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// HTTP (minimal, Keep-Alive mit Content-Length)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct HttpMessage {
+  std::string start;                   // Request- bzw. Status-Zeile
+  std::string body;
+};
+
+// Liest eine Nachricht von fd; buffer behält Bytes der nächsten Nachricht
+static bool readHttp(int fd, std::string& buffer, HttpMessage& msg) {
+  char chunk[2048];
+  for (;;) {
+    size_t headerEnd = buffer.find("\r\n\r\n");
+    if (headerEnd != std::string::npos) {
+      size_t length = 0;
+      size_t cl = buffer.find("Content-Length:");
+      if (cl == std::string::npos) cl = buffer.find("content-length:");
+      if (cl != std::string::npos && cl < headerEnd) length = strtoul(buffer.c_str() + cl + 15, nullptr, 10);
+      if (buffer.size() >= headerEnd + 4 + length) {
+        msg.start = buffer.substr(0, buffer.find("\r\n"));
+        msg.body = buffer.substr(headerEnd + 4, length);
+        buffer.erase(0, headerEnd + 4 + length);
+        return true;
+      }
+    }
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) return false;
+    buffer.append(chunk, n);
+  }
+}
+
+static bool writeAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+static std::string jsonEscape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') { out += '\\'; out += c; }
+    else if (c == '\n') out += "\\n";
+    else out += c;
+  }
+  return out;
+}
+
+// Wert eines Felds aus flachem JSON (String oder Zahl), reicht für Bot-API-Bodies
+static std::string jsonField(const std::string& json, const char* key) {
+  std::string pattern = std::string("\"") + key + "\":";
+  size_t p = json.find(pattern);
+  if (p == std::string::npos) return "";
+  p += pattern.size();
+  while (p < json.size() && json[p] == ' ') p++;
+  std::string out;
+  if (json[p] != '"') {
+    while (p < json.size() && json[p] != ',' && json[p] != '}') out += json[p++];
+    return out;
+  }
+  for (p++; p < json.size() && json[p] != '"'; p++) {
+    if (json[p] == '\\' && p + 1 < json.size()) {
+      p++;
+      out += json[p] == 'n' ? '\n' : json[p];
+    } else {
+      out += json[p];
+    }
+  }
+  return out;
+}
+
+static long queryParam(const std::string& target, const char* name, long fallback) {
+  std::string pattern = std::string(name) + "=";
+  size_t p = target.find(pattern);
+  return p == std::string::npos ? fallback : strtol(target.c_str() + p + pattern.size(), nullptr, 10);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// BOT API STAND-IN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct Update {
+  long id;
+  std::string chat;
+  std::string text;
+  double releaseAt;                    // Sekunden nach Start
+  int deliveries = 0;
+};
+
+struct Reply {
+  std::string chat;
+  std::string text;
+  double at;
+};
+
+class BotApiStandIn {
+public:
+  std::vector<Update> updates;
+  std::vector<Reply> replies;
+  int getUpdatesCalls = 0;
+  int emptyPolls = 0;
+  int sendCalls = 0;
+  int tooManyRequests = 0;
+  int injectedErrors = 0;
+  int connections = 0;
+  int failSendNumber = 3;              // Dieser sendMessage-Aufruf bekommt einmal 500
+
+  bool start(uint16_t port) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 8) != 0) return false;
+    acceptThread = std::thread([this] { acceptLoop(); });
+    ticker = std::thread([this] {       // Geplante Updates freigeben
+      while (!stopping) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cv.notify_all();
+      }
+    });
+    return true;
+  }
+
+  void stop() {
+    stopping = true;
+    shutdown(listenFd, SHUT_RDWR);
+    close(listenFd);
+    {
+      std::lock_guard<std::mutex> lock(m);
+      for (int fd : clients) shutdown(fd, SHUT_RDWR);
+    }
+    cv.notify_all();
+    acceptThread.join();
+    ticker.join();
+  }
+
+  void schedule(double at, const std::string& chat, const std::string& text) {
+    Update u;
+    u.id = 1000 + updates.size();
+    u.chat = chat;
+    u.text = text;
+    u.releaseAt = at;
+    updates.push_back(u);
+  }
+
+  size_t replyCount() {
+    std::lock_guard<std::mutex> lock(m);
+    return replies.size();
+  }
+
+  std::mutex m;
+
+private:
+  int listenFd = -1;
+  std::atomic<bool> stopping{false};
+  std::thread acceptThread, ticker;
+  std::condition_variable cv;
+  std::vector<int> clients;
+  std::map<std::string, double> lastSend;
+
+  void acceptLoop() {
+    std::vector<std::thread> workers;
+    for (;;) {
+      int fd = accept(listenFd, nullptr, nullptr);
+      if (fd < 0) break;
+      {
+        std::lock_guard<std::mutex> lock(m);
+        connections++;
+        clients.push_back(fd);
+      }
+      workers.emplace_back([this, fd] { serve(fd); });
+    }
+    for (auto& w : workers) w.join();
+  }
+
+  void serve(int fd) {
+    std::string buffer;
+    HttpMessage req;
+    while (!stopping && readHttp(fd, buffer, req)) {
+      size_t sp = req.start.find(' ');
+      std::string method = req.start.substr(0, sp);
+      std::string target = req.start.substr(sp + 1, req.start.find(' ', sp + 1) - sp - 1);
+      int status = 200;
+      std::string body;
+
+      if (target.find(std::string("/bot") + TOKEN + "/") != 0) {
+        status = 401;
+        body = "{\"ok\":false,\"error_code\":401,\"description\":\"Unauthorized\"}";
+      } else if (target.find("/getUpdates") != std::string::npos) {
+        body = getUpdates(queryParam(target, "offset", 0), queryParam(target, "limit", 100),
+                          queryParam(target, "timeout", 0));
+      } else if (target.find("/sendMessage") != std::string::npos && method == "POST") {
+        body = sendMessage(req.body, status);
+      } else {
+        status = 404;
+        body = "{\"ok\":false,\"error_code\":404,\"description\":\"Not Found\"}";
+      }
+
+      const char* reason = status == 200 ? "OK" : status == 429 ? "Too Many Requests" : "Error";
+      char head[160];
+      snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n"
+               "Content-Length: %zu\r\nConnection: keep-alive\r\n\r\n", status, reason, body.size());
+      if (!writeAll(fd, head + body)) break;
+    }
+    close(fd);
+  }
+
+  // Long Polling: bis zu timeout Sekunden auf ein Update ≥ offset warten
+  std::string getUpdates(long offset, long limit, long timeout) {
+    std::unique_lock<std::mutex> lock(m);
+    getUpdatesCalls++;
+    double deadline = now() + timeout;
+    std::string result;
+    for (;;) {
+      long count = 0;
+      for (Update& u : updates) {
+        if (u.id < offset || u.releaseAt > now() || count >= limit) continue;
+        count++;
+        if (!result.empty()) result += ",";
+        char item[512];
+        snprintf(item, sizeof(item),
+                 "{\"update_id\":%ld,\"message\":{\"message_id\":%ld,\"from\":{\"id\":%s,"
+                 "\"is_bot\":false,\"first_name\":\"Test\"},\"chat\":{\"id\":%s,\"type\":\"private\"},"
+                 "\"date\":1784000000,\"text\":\"%s\"}}", u.id, u.id, u.chat.c_str(), u.chat.c_str(),
+                 jsonEscape(u.text).c_str());
+        result += item;
+        u.deliveries++;
+      }
+      if (!result.empty() || stopping || now() >= deadline) break;
+      cv.wait(lock);
+    }
+    if (result.empty()) emptyPolls++;
+    return "{\"ok\":true,\"result\":[" + result + "]}";
+  }
+
+  std::string sendMessage(const std::string& json, int& status) {
+    std::lock_guard<std::mutex> lock(m);
+    sendCalls++;
+    std::string chat = jsonField(json, "chat_id");
+    double t = now();
+
+    auto last = lastSend.find(chat);
+    if (last != lastSend.end() && t - last->second < 1.0) {
+      tooManyRequests++;
+      status = 429;
+      return "{\"ok\":false,\"error_code\":429,\"description\":\"Too Many Requests: retry after 1\","
+             "\"parameters\":{\"retry_after\":1}}";
+    }
+    lastSend[chat] = t;
+    if (sendCalls == failSendNumber) {
+      injectedErrors++;
+      status = 500;
+      return "{\"ok\":false,\"error_code\":500,\"description\":\"Internal Server Error\"}";
+    }
+
+    replies.push_back({chat, jsonField(json, "text"), t});
+    char body[96];
+    snprintf(body, sizeof(body), "{\"ok\":true,\"result\":{\"message_id\":%d}}", 5000 + sendCalls);
+    return body;
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SELBSTTEST: Firmware-Tasks auf dem PC (telegramPollStep/telegramSendStep)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#define TELEGRAM_LONG_POLL_SEC 2      // Firmware: 25 s, hier kurz für eine schnelle Runde
+#define TELEGRAM_QUEUE_SIZE 8
+#include "telegram_tasks.h"
+
+static uint32_t hostMillis() { return (uint32_t)(now() * 1000); }
+
+// Keep-Alive-Verbindung wie WiFiClientSecure in UniversalTelegramBot
+class ApiConnection {
+public:
+  explicit ApiConnection(uint16_t port) : port(port) {}
+  ~ApiConnection() { disconnect(); }
+
+  bool request(const std::string& method, const std::string& command, const std::string& json,
+               HttpMessage& response) {
+    for (int attempt = 0; attempt < 2; attempt++) {     // Server hat Keep-Alive beendet → neu
+      if (fd < 0 && !connectServer()) return false;
+      std::string req = method + " /bot" + TOKEN + "/" + command + " HTTP/1.1\r\nHost: api.telegram.org\r\n";
+      if (method == "POST") {
+        req += "Content-Type: application/json\r\nContent-Length: " + std::to_string(json.size()) + "\r\n";
+      }
+      req += "\r\n" + json;
+      if (writeAll(fd, req) && readHttp(fd, buffer, response)) return true;
+      disconnect();
+    }
+    return false;
+  }
+
+  void disconnect() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    buffer.clear();
+  }
+
+private:
+  int fd = -1;
+  uint16_t port;
+  std::string buffer;
+
+  bool connectServer() {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+      disconnect();
+      return false;
+    }
+    return true;
+  }
+};
+
+struct OutMessage {
+  std::string chat;
+  std::string text;
+  bool markdown;
+};
+
+// HTTPS-Pool: nur die externen Plätze zählen
+static std::atomic<int> poolLeases{0};
+
+// Empfang wie TelegramPollLink in der Firmware
+struct HostPollLink {
+  ApiConnection conn;
+  std::function<void(const std::string&, const std::string&)> onCommand;
+  std::vector<std::pair<std::string, std::string>> batch;   // Chat, Text
+  long lastUpdate = 0;
+  int requests = 0;
+
+  explicit HostPollLink(uint16_t port) : conn(port) {}
+
+  bool connected() { return true; }
+  bool reserve() { poolLeases++; return true; }
+  void release() { conn.disconnect(); poolLeases--; }
+  uint32_t millis() { return hostMillis(); }
+
+  int getUpdates() {
+    requests++;
+    batch.clear();
+    HttpMessage res;
+    std::string command = "getUpdates?offset=" + std::to_string(lastUpdate + 1) +
+                          "&limit=1&timeout=" + std::to_string(TELEGRAM_LONG_POLL_SEC);
+    if (!conn.request("GET", command, "", res)) return 0;   // Wie UniversalTelegramBot: Fehler = 0
+    size_t p = 0;
+    while ((p = res.body.find("\"update_id\":", p)) != std::string::npos) {
+      std::string item = res.body.substr(p, res.body.find("}}", p) - p + 2);
+      lastUpdate = atol(jsonField(item, "update_id").c_str());
+      std::string chatObj = item.substr(item.find("\"chat\":"));
+      batch.push_back({jsonField(chatObj, "id"), jsonField(item, "text")});
+      p++;
+    }
+    return (int)batch.size();
+  }
+
+  void handle(int i) { onCommand(batch[i].first, batch[i].second); }
+};
+
+class FirmwareBot;
+
+// Versand wie TelegramSendLink in der Firmware
+struct HostSendLink {
+  FirmwareBot& bot;
+  ApiConnection conn;
+
+  HostSendLink(FirmwareBot& bot, uint16_t port) : bot(bot), conn(port) {}
+
+  bool connected() { return true; }
+  bool reserve() { poolLeases++; return true; }
+  void release() { conn.disconnect(); poolLeases--; }
+  uint32_t millis() { return hostMillis(); }
+  void sleep(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+  bool receive(OutMessage& msg, uint32_t waitMs);
+
+  bool send(const OutMessage& msg) {
+    std::string json = "{\"chat_id\":\"" + msg.chat + "\",\"text\":\"" + jsonEscape(msg.text) +
+                       "\",\"parse_mode\":\"" + (msg.markdown ? "Markdown" : "") + "\"}";
+    HttpMessage res;
+    return conn.request("POST", "sendMessage", json, res) &&
+           res.body.find("\"ok\":true") != std::string::npos;
+  }
+};
+
+class FirmwareBot {
+public:
+  std::atomic<uint32_t> sent{0};
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<bool> running{true};
+
+  explicit FirmwareBot(uint16_t port) : pollLink(port), sendLink(*this, port) {
+    pollLink.onCommand = [this](const std::string& chat, const std::string& text) { handleCommand(chat, text); };
+  }
+
+  void start() {
+    pollThread = std::thread([this] { pollTask(); });
+    sendThread = std::thread([this] { sendTask(); });
+    loopThread = std::thread([this] { mainLoop(); });
+  }
+
+  void stop() {
+    running = false;
+    outboxCv.notify_all();
+    relayCv.notify_all();
+    pollThread.join();
+    sendThread.join();
+    loopThread.join();
+  }
+
+  // xQueueReceive() auf die Outbox; beim Beenden sofort false
+  bool receive(OutMessage& msg, uint32_t waitMs) {
+    std::unique_lock<std::mutex> lock(outboxMutex);
+    auto ready = [this] { return !outbox.empty() || !running; };
+    if (waitMs == TELEGRAM_WAIT_FOREVER) outboxCv.wait(lock, ready);
+    else outboxCv.wait_for(lock, std::chrono::milliseconds(waitMs), ready);
+    if (outbox.empty()) return false;
+    msg = outbox.front();
+    outbox.pop_front();
+    return true;
+  }
+
+private:
+  HostPollLink pollLink;
+  HostSendLink sendLink;
+  std::thread pollThread, sendThread, loopThread;
+
+  std::mutex outboxMutex;
+  std::condition_variable outboxCv;
+  std::deque<OutMessage> outbox;
+
+  std::mutex relayMutex;
+  std::condition_variable relayCv;
+  std::deque<int> relayQueue;
+  int relayModes[4] = {0, 0, 0, 0};
+
+  // queueTelegramMessage(): blockiert nie, volle Queue → verwerfen
+  void queueMessage(const std::string& chat, const std::string& text, bool markdown) {
+    std::lock_guard<std::mutex> lock(outboxMutex);
+    if (outbox.size() >= TELEGRAM_QUEUE_SIZE) {
+      dropped++;
+      return;
+    }
+    outbox.push_back({chat, text, markdown});
+    outboxCv.notify_one();
+  }
+
+  void handleCommand(const std::string& chat, const std::string& text) {
+    if (chat != authorizedChat) {
+      queueMessage(chat, "⛔ Nicht autorisiert!", false);
+      return;
+    }
+    if (text == "/start") queueMessage(chat, "🐟 ForellenWächter Bot aktiv!", false);
+    else if (text == "/status") queueMessage(chat, "📊 *ForellenWächter Status*", true);
+    else if (text == "/temp") queueMessage(chat, "🌡️ *Temperaturen*", true);
+    else if (text == "/water") queueMessage(chat, "💧 *Wasserqualität*", true);
+    else if (text == "/power") queueMessage(chat, "⚡ *Turbine & Batterie*", true);
+    else if (text == "/alarm") queueMessage(chat, "🚨 *Alarm-Status*", true);
+    else if (text.compare(0, 6, "/relay") == 0) {
+      int relay = atoi(text.c_str() + 6) - 1;
+      if (relay >= 0 && relay < 4) {
+        std::lock_guard<std::mutex> lock(relayMutex);
+        relayQueue.push_back(relay);
+        relayCv.notify_one();
+      }
+    }
+    else queueMessage(chat, "❓ Unbekannter Befehl. Sende /start für Hilfe.", false);
+  }
+
+  // telegramPollTask(): Wartezeiten in 50-ms-Schritten, damit stop() nicht hängt
+  void pollTask() {
+    TelegramPollState state;
+    while (running) {
+      uint32_t wait = telegramPollStep(pollLink, state);
+      for (uint32_t waited = 0; waited < wait && running; waited += 50) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+    }
+    if (state.leased) pollLink.release();
+  }
+
+  // telegramSendTask()
+  void sendTask() {
+    TelegramSendState state;
+    OutMessage msg;
+    while (running) {
+      TelegramSendResult result = telegramSendStep(sendLink, state, msg);
+      if (result == TELEGRAM_SENT) sent++;
+      else if (result == TELEGRAM_DROPPED) dropped++;
+    }
+    if (state.leased) sendLink.release();
+  }
+
+  // handleTelegramRelayCommands() in loop()
+  void mainLoop() {
+    static const char* modeNames[3] = {"Auto", "An", "Aus"};
+    while (running) {
+      std::unique_lock<std::mutex> lock(relayMutex);
+      relayCv.wait_for(lock, std::chrono::milliseconds(200), [this] { return !relayQueue.empty() || !running; });
+      while (!relayQueue.empty()) {
+        int relay = relayQueue.front();
+        relayQueue.pop_front();
+        relayModes[relay] = (relayModes[relay] + 1) % 3;
+        queueMessage(authorizedChat, "Relais " + std::to_string(relay + 1) + ": " + modeNames[relayModes[relay]], false);
+      }
+    }
+  }
+};
+
+bool HostSendLink::receive(OutMessage& msg, uint32_t waitMs) { return bot.receive(msg, waitMs); }
+
+// Empfang gegen einen Port ohne Server: jeder getUpdates-Versuch scheitert sofort
+static int pollAgainstDeadPort(uint16_t port, double seconds) {
+  HostPollLink link(port);
+  link.onCommand = [](const std::string&, const std::string&) {};
+  TelegramPollState state;
+  double end = now() + seconds;
+  while (now() < end) {
+    uint32_t wait = telegramPollStep(link, state);
+    for (uint32_t waited = 0; waited < wait && now() < end; waited += 50) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  }
+  if (state.leased) link.release();
+  return link.requests;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SKRIPT & AUSWERTUNG
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct Expectation {
+  std::string chat;
+  std::string contains;
+};
+
+int main(int argc, char** argv) {
+  bool selftest = argc > 1 && strcmp(argv[1], "--selftest") == 0;
+  uint16_t port = selftest ? 42800 + getpid() % 1000 : (argc > 1 ? atoi(argv[1]) : 8081);
+  if (!selftest && argc > 2) authorizedChat = argv[2];
+
+  BotApiStandIn api;
+  const std::string& me = authorizedChat;
+  std::vector<Expectation> expected;
+
+  api.schedule(1.0, me, "/start");              expected.push_back({me, "Bot aktiv"});
+  api.schedule(2.5, me, "/status");             expected.push_back({me, "Status"});
+  api.schedule(3.0, FOREIGN_CHAT, "/status");   expected.push_back({FOREIGN_CHAT, "Nicht autorisiert"});
+  api.schedule(4.0, me, "/relay2");             expected.push_back({me, "Relais 2: An"});
+  // Burst: fünf Befehle in einer Sekunde, Antworten müssen sich ans Rate-Limit halten
+  const char* burst[] = {"/temp", "/water", "/power", "/alarm", "/gibtsnicht"};
+  const char* burstReply[] = {"Temperaturen", "Wasserqualität", "Turbine", "Alarm-Status", "Unbekannter Befehl"};
+  for (int i = 0; i < 5; i++) {
+    api.schedule(6.0 + i * 0.2, me, burst[i]);
+    expected.push_back({me, burstReply[i]});
+  }
+
+  if (!api.start(port)) { perror("bind"); return 1; }
+  printf("🤖 Bot API Stand-in auf Port %u, Token %s, Chat-ID %s\n", port, TOKEN, me.c_str());
+
+  FirmwareBot* bot = nullptr;
+  std::thread deadPoll;
+  int deadRequests = 0;
+  const double DEAD_SECONDS = 7;
+  if (selftest) {
+    bot = new FirmwareBot(port);
+    bot->start();
+    deadPoll = std::thread([&] { deadRequests = pollAgainstDeadPort(port + 1, DEAD_SECONDS); });
+  } else {
+    printf("   Warte auf den ESP32 (TELEGRAM_API_HOST → diese Maschine, Port %u) ...\n", port);
+  }
+
+  double timeout = selftest ? 60 : 300;
+  while (api.replyCount() < expected.size() && now() < timeout) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));   // Keine zusätzlichen Antworten?
+  double duration = now();
+
+  if (bot) bot->stop();
+  if (deadPoll.joinable()) deadPoll.join();
+  api.stop();
+
+  std::lock_guard<std::mutex> lock(api.m);
+  int failures = 0;
+  auto check = [&failures](bool ok, const char* what) {
+    printf("%s %s\n", ok ? "✅" : "❌", what);
+    if (!ok) failures++;
+  };
+
+  bool onceEach = true;
+  for (const Update& u : api.updates) {
+    if (u.deliveries != 1) {
+      printf("   Update %ld (%s) %d× ausgeliefert\n", u.id, u.text.c_str(), u.deliveries);
+      onceEach = false;
+    }
+  }
+  check(onceEach, "Jedes Update genau einmal ausgeliefert (offset bestätigt)");
+
+  bool allReplies = api.replies.size() == expected.size();
+  std::vector<bool> used(api.replies.size(), false);
+  for (const Expectation& e : expected) {
+    bool found = false;
+    for (size_t i = 0; i < api.replies.size() && !found; i++) {
+      if (!used[i] && api.replies[i].chat == e.chat && api.replies[i].text.find(e.contains) != std::string::npos) {
+        used[i] = found = true;
+      }
+    }
+    if (!found) {
+      printf("   Fehlt: \"%s\" an Chat %s\n", e.contains.c_str(), e.chat.c_str());
+      allReplies = false;
+    }
+  }
+  char line[160];
+  snprintf(line, sizeof(line), "Antworten: %zu von %zu, jeweils im richtigen Chat", api.replies.size(), expected.size());
+  check(allReplies, line);
+
+  double minGap = 1e9;
+  for (size_t i = 1; i < api.replies.size(); i++) {
+    if (api.replies[i].chat == api.replies[i - 1].chat) {
+      minGap = std::min(minGap, api.replies[i].at - api.replies[i - 1].at);
+    }
+  }
+  snprintf(line, sizeof(line), "Rate-Limit: %d× 429, kleinster Abstand %.2f s", api.tooManyRequests,
+           minGap < 1e9 ? minGap : 0.0);
+  check(api.tooManyRequests == 0, line);
+
+  snprintf(line, sizeof(line), "Wiederholung: %d× 500 eingestreut, trotzdem zugestellt", api.injectedErrors);
+  check(api.injectedErrors == 0 || allReplies, line);
+
+  // Long Polling: pro Update-Lieferung eine Anfrage plus eine je abgelaufenem Timeout
+  int longPoll = selftest ? TELEGRAM_LONG_POLL_SEC : 25;
+  int maxPolls = (int)api.updates.size() + (int)(duration / longPoll) + 2;
+  snprintf(line, sizeof(line), "Long Polling: %d getUpdates in %.0f s (%d leer, max. %d)",
+           api.getUpdatesCalls, duration, api.emptyPolls, maxPolls);
+  check(api.getUpdatesCalls <= maxPolls, line);
+
+  snprintf(line, sizeof(line), "Keep-Alive: %d TCP-Verbindungen für %d Anfragen", api.connections,
+           api.getUpdatesCalls + api.sendCalls);
+  check(api.connections <= 4, line);
+
+  if (bot) {
+    snprintf(line, sizeof(line), "Firmware-Zähler: %u gesendet, %u verworfen", bot->sent.load(), bot->dropped.load());
+    check(bot->sent == expected.size() && bot->dropped == 0, line);
+    delete bot;
+
+    snprintf(line, sizeof(line), "Pool-Plätze: %d nach dem Beenden noch belegt", poolLeases.load());
+    check(poolLeases == 0, line);
+
+    // 0 s, 2 s, 6 s (Backoff 2, 4, 8 s) statt alle 100 ms
+    snprintf(line, sizeof(line), "Backoff: %d getUpdates in %.0f s ohne Server (max. 4)", deadRequests, DEAD_SECONDS);
+    check(deadRequests <= 4, line);
+  }
+  return failures ? 1 : 0;
+}
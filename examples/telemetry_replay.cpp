@@ -0,0 +1,601 @@
+/*
+ * ForellenWächter - Telemetrie: Dekoder und Spool-Nachlieferung (Host, Linux/macOS)
+ * Format siehe src/telemetry.h, Spool siehe uploadTelemetry() in der Firmware
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -pthread -I../src telemetry_replay.cpp -o telemetry_replay
+ *   ./telemetry_replay [Tage]        Simulation mit HTTP-Empfänger auf 127.0.0.1
+ *   ./telemetry_replay /mnt/sd/spool Spool-Dateien einer SD-Karte dekodieren (CSV)
+ *
+ * Simulation: alle SENSOR_INTERVAL (5 s) eine Messung, alle 15 min Upload wie
+ * uploadTelemetry() - älteste Spool-Datei zuerst, max. TELEMETRY_CATCHUP_PER_UPLOAD.
+ * Der Empfänger ist ein kleiner HTTP-Server (Stand-in für den Telemetrie-Server
+ * bzw. eine MQTT-Bridge), der jeden Batch dekodiert. Dazwischen:
+ * - Offline-Phasen (kein Internet) von Minuten bis > 3 Tage (Spool läuft über)
+ * - Server antwortet 503 (Batch bleibt im Spool)
+ * - Neustarts: Spool wird wie initTelemetry() aus den Dateien bestimmt,
+ *   der Batch im RAM ist verloren
+ * - Sprünge in den Messwerten (alle MessagePack-Integer-Breiten)
+ * Geprüft: jede angekommene Messung exakt (Zeit, Werte, Flags), keine doppelt,
+ * Reihenfolge erhalten, und jede fehlende ist als verworfen/RAM-Verlust erklärt.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "telemetry.h"
+
+#define SENSOR_INTERVAL_S 5
+#define TELEMETRY_UPLOAD_INTERVAL_S 900
+#define TELEMETRY_SPOOL_MAX 288
+#define TELEMETRY_CATCHUP_PER_UPLOAD 4
+
+static const char* FIELD_NAMES[TELEMETRY_FIELDS] = {
+  "waterTemp", "airTemp", "ph", "tds", "dissolvedOxygen", "flowRate", "battery"
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DEKODER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct TelemetryBatch {
+  int version = 0;
+  std::string deviceId;
+  uint32_t t0 = 0;
+  std::vector<TelemetrySample> samples;
+};
+
+class TelemetryDecoder {
+public:
+  // false = kein gültiger Batch; error beschreibt die Stelle
+  bool decode(const uint8_t* data, size_t size, TelemetryBatch& batch) {
+    p = data;
+    end = data + size;
+    error = nullptr;
+    batch = TelemetryBatch();
+
+    uint32_t n;
+    int64_t v;
+    if (!readArray(n) || n != 4) return fail("Kopf: kein Array(4)");
+    if (!readInt(v) || v != TELEMETRY_FORMAT_VERSION) return fail("Version");
+    batch.version = (int)v;
+    if (!readStr(batch.deviceId)) return fail("Geräte-ID");
+    if (!readInt(v) || v < 0 || v > 0xFFFFFFFFLL) return fail("t0");
+    batch.t0 = (uint32_t)v;
+    uint32_t count;
+    if (!readArray(count)) return fail("Datensatz-Array");
+
+    int32_t prev[TELEMETRY_FIELDS] = {0};
+    uint32_t time = batch.t0;
+    for (uint32_t r = 0; r < count; r++) {
+      if (!readArray(n) || n != TELEMETRY_FIELDS + 2) return fail("Datensatz: kein Array(9)");
+      TelemetrySample s;
+      if (!readInt(v)) return fail("dt");
+      time += (int32_t)v;
+      s.time = time;
+      for (int i = 0; i < TELEMETRY_FIELDS; i++) {
+        if (!readInt(v)) return fail("Delta");
+        prev[i] += (int32_t)v;
+        s.values[i] = prev[i];
+      }
+      if (!readInt(v) || v < 0 || v > 0xFF) return fail("Flags");
+      s.flags = (uint8_t)v;
+      batch.samples.push_back(s);
+    }
+    if (p != end) return fail("Daten hinter dem Batch");
+    return true;
+  }
+
+  const char* error = nullptr;
+
+private:
+  const uint8_t* p = nullptr;
+  const uint8_t* end = nullptr;
+
+  bool fail(const char* what) {
+    error = what;
+    return false;
+  }
+
+  bool take(uint8_t& b) {
+    if (p >= end) return false;
+    b = *p++;
+    return true;
+  }
+
+  bool readBE(int bytes, uint32_t& out) {
+    out = 0;
+    for (int i = 0; i < bytes; i++) {
+      uint8_t b;
+      if (!take(b)) return false;
+      out = (out << 8) | b;
+    }
+    return true;
+  }
+
+  bool readInt(int64_t& out) {
+    uint8_t b;
+    uint32_t raw;
+    if (!take(b)) return false;
+    if (b < 0x80) { out = b; return true; }
+    if (b >= 0xe0) { out = (int8_t)b; return true; }
+    switch (b) {
+      case 0xcc: if (!readBE(1, raw)) return false; out = raw; return true;
+      case 0xcd: if (!readBE(2, raw)) return false; out = raw; return true;
+      case 0xce: if (!readBE(4, raw)) return false; out = raw; return true;
+      case 0xd0: if (!readBE(1, raw)) return false; out = (int8_t)raw; return true;
+      case 0xd1: if (!readBE(2, raw)) return false; out = (int16_t)raw; return true;
+      case 0xd2: if (!readBE(4, raw)) return false; out = (int32_t)raw; return true;
+    }
+    return false;
+  }
+
+  bool readArray(uint32_t& n) {
+    uint8_t b;
+    if (!take(b)) return false;
+    if ((b & 0xf0) == 0x90) { n = b & 0x0f; return true; }
+    if (b == 0xdc) return readBE(2, n);
+    if (b == 0xdd) return readBE(4, n);
+    return false;
+  }
+
+  bool readStr(std::string& s) {
+    uint8_t b;
+    if (!take(b) || (b & 0xe0) != 0xa0) return false;
+    size_t n = b & 0x1f;
+    if ((size_t)(end - p) < n) return false;
+    s.assign((const char*)p, n);
+    p += n;
+    return true;
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// HTTP-EMPFÄNGER (Stand-in für TELEMETRY_URL)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class TelemetryServer {
+public:
+  std::vector<TelemetrySample> received;
+  uint32_t batches = 0;
+  uint32_t badBatches = 0;
+  uint64_t bytes = 0;
+  std::atomic<bool> unavailable{false};  // true: 503 wie ein Server-Ausfall
+  uint16_t port = 0;
+
+  bool start() {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 4) != 0) return false;
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    thread = std::thread([this] { run(); });
+    return true;
+  }
+
+  void stop() {
+    shutdown(listenFd, SHUT_RDWR);
+    close(listenFd);
+    thread.join();
+  }
+
+  std::mutex m;
+
+private:
+  int listenFd = -1;
+  std::thread thread;
+
+  void run() {
+    for (;;) {
+      int fd = accept(listenFd, nullptr, nullptr);
+      if (fd < 0) break;
+      std::string request;
+      char chunk[4096];
+      size_t need = std::string::npos;
+      for (;;) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        request.append(chunk, n);
+        size_t headerEnd = request.find("\r\n\r\n");
+        if (headerEnd != std::string::npos && need == std::string::npos) {
+          size_t cl = request.find("Content-Length: ");
+          need = headerEnd + 4 + (cl < headerEnd ? strtoul(request.c_str() + cl + 16, nullptr, 10) : 0);
+        }
+        if (request.size() >= need) break;
+      }
+
+      int status = 200;
+      size_t headerEnd = request.find("\r\n\r\n");
+      if (unavailable) {
+        status = 503;
+      } else if (headerEnd == std::string::npos ||
+                 request.find("Content-Type: application/msgpack") == std::string::npos) {
+        status = 415;
+      } else {
+        TelemetryBatch batch;
+        TelemetryDecoder decoder;
+        const uint8_t* body = (const uint8_t*)request.data() + headerEnd + 4;
+        std::lock_guard<std::mutex> lock(m);
+        if (decoder.decode(body, request.size() - headerEnd - 4, batch)) {
+          received.insert(received.end(), batch.samples.begin(), batch.samples.end());
+          batches++;
+          bytes += request.size() - headerEnd - 4;
+        } else {
+          badBatches++;
+          status = 400;
+        }
+      }
+      char response[96];
+      int len = snprintf(response, sizeof(response), "HTTP/1.1 %d X\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+      send(fd, response, len, MSG_NOSIGNAL);
+      close(fd);
+    }
+  }
+};
+
+// sendHTTPPost(url, data, len, "application/msgpack")
+static bool httpPost(uint16_t port, const uint8_t* data, size_t len) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); return false; }
+  char head[160];
+  int n = snprintf(head, sizeof(head), "POST /api/telemetry HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                   "Content-Type: application/msgpack\r\nContent-Length: %zu\r\n\r\n", len);
+  bool ok = send(fd, head, n, MSG_NOSIGNAL) == n && send(fd, data, len, MSG_NOSIGNAL) == (ssize_t)len;
+  char response[64] = "";
+  if (ok) ok = recv(fd, response, sizeof(response) - 1, 0) > 12;
+  close(fd);
+  int status = ok ? atoi(response + 9) : 0;
+  return status >= 200 && status < 300;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// GERÄT: Batch, SD-Spool und Upload wie in der Firmware
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class Device {
+public:
+  Device(const std::string& spoolDir, uint16_t port) : dir(spoolDir), port(port) {}
+
+  TelemetryEncoder batch;
+  uint32_t spoolHead = 0, spoolTail = 0;
+  uint32_t batchesSent = 0, batchesDropped = 0;
+  uint64_t droppedSamples = 0;         // Nur zur Auswertung (Firmware zählt Batches)
+  bool online = true;
+
+  // initTelemetry(): Spool-Bereich aus den Dateien bestimmen
+  void boot(uint32_t now) {
+    batch.begin("forellenwaechter", now);
+    spoolHead = spoolTail = 0;
+    bool found = false;
+    DIR* d = opendir(dir.c_str());
+    for (dirent* e; d && (e = readdir(d));) {
+      if (e->d_name[0] == '.') continue;
+      uint32_t seq = strtoul(e->d_name, nullptr, 10);
+      if (!found || seq < spoolHead) spoolHead = seq;
+      if (!found || seq + 1 > spoolTail) spoolTail = seq + 1;
+      found = true;
+    }
+    if (d) closedir(d);
+  }
+
+  // sampleTelemetry()
+  void sample(const TelemetrySample& s) {
+    if (!batch.add(s)) {
+      size_t len;
+      const uint8_t* data = batch.finish(len);
+      spool(data, len);
+      batch.begin("forellenwaechter", s.time);
+      batch.add(s);
+    }
+  }
+
+  // uploadTelemetry()
+  void upload(uint32_t now) {
+    size_t len;
+    const uint8_t* data;
+
+    if (!online) {
+      if (batch.records() > 0) {
+        data = batch.finish(len);
+        spool(data, len);
+        batch.begin("forellenwaechter", now);
+      }
+      return;
+    }
+
+    bool up = true;
+    for (int i = 0; i < TELEMETRY_CATCHUP_PER_UPLOAD && spoolHead < spoolTail; i++) {
+      std::string file = filename(spoolHead);
+      FILE* f = fopen(file.c_str(), "rb");
+      if (f) {
+        size_t size = fread(readBuffer, 1, sizeof(readBuffer), f);
+        fclose(f);
+        if (!post(readBuffer, size)) {
+          up = false;
+          break;
+        }
+        unlink(file.c_str());
+      }
+      spoolHead++;
+    }
+
+    if (batch.records() == 0) return;
+
+    data = batch.finish(len);
+    if (!up || spoolHead < spoolTail || !post(data, len)) {
+      spool(data, len);
+    }
+    batch.begin("forellenwaechter", now);
+  }
+
+  size_t ramRecords() const { return batch.records(); }
+
+private:
+  std::string dir;
+  uint16_t port;
+  uint8_t readBuffer[TELEMETRY_BATCH_BYTES];
+
+  std::string filename(uint32_t seq) {
+    char name[24];
+    snprintf(name, sizeof(name), "/%08lu.mpk", (unsigned long)seq);
+    return dir + name;
+  }
+
+  bool post(const uint8_t* data, size_t len) {
+    if (!httpPost(port, data, len)) return false;
+    batchesSent++;
+    return true;
+  }
+
+  // spoolTelemetryBatch()
+  void spool(const uint8_t* data, size_t len) {
+    if (spoolTail - spoolHead >= TELEMETRY_SPOOL_MAX) {
+      std::string oldest = filename(spoolHead++);
+      droppedSamples += recordsIn(oldest);
+      unlink(oldest.c_str());
+      batchesDropped++;
+    }
+    FILE* f = fopen(filename(spoolTail).c_str(), "wb");
+    if (!f) {
+      batchesDropped++;
+      return;
+    }
+    bool ok = fwrite(data, 1, len, f) == len;
+    fclose(f);
+    if (ok) spoolTail++;
+    else batchesDropped++;
+  }
+
+  size_t recordsIn(const std::string& file) {
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f) return 0;
+    size_t size = fread(readBuffer, 1, sizeof(readBuffer), f);
+    fclose(f);
+    TelemetryBatch b;
+    TelemetryDecoder decoder;
+    return decoder.decode(readBuffer, size, b) ? b.samples.size() : 0;
+  }
+};
+
+// Messwerte als Funktion der Zeit, mit gelegentlichen großen Sprüngen
+static TelemetrySample makeSample(uint32_t t, uint32_t step) {
+  TelemetrySample s;
+  s.time = t;
+  s.values[0] = lroundf((12.0f + 3 * sinf(step * 0.0007f)) * 100);
+  s.values[1] = lroundf((15.0f + 12 * sinf(step * 0.0004f)) * 100);
+  s.values[2] = 720 + step % 5;
+  s.values[3] = 180 + (step / 50) % 30;
+  s.values[4] = 950 - (step % 13);
+  s.values[5] = 600 + (step % 7) * 3;
+  s.values[6] = 12600 - (step % 1000);
+  if (step % 4001 == 0) s.values[1] = -4000;          // Frost: -40 °C (Delta ~ -5500)
+  if (step % 7919 == 0) s.values[5] = 150000;         // Durchfluss-Spitze (Delta > 65535)
+  if (step % 9973 == 0) s.values[3] = 0;              // TDS-Sensor fehlt kurz
+  s.flags = TELEMETRY_FLAG_LEVEL_OK | (step % 600 < 120 ? TELEMETRY_FLAG_AERATION : 0);
+  return s;
+}
+
+static bool sameSample(const TelemetrySample& a, const TelemetrySample& b) {
+  return a.time == b.time && a.flags == b.flags && memcmp(a.values, b.values, sizeof(a.values)) == 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SD-SPOOL DEKODIEREN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static int decodeSpoolDir(const char* path) {
+  std::vector<std::string> files;
+  DIR* d = opendir(path);
+  if (!d) { perror(path); return 1; }
+  for (dirent* e; (e = readdir(d));) {
+    if (strstr(e->d_name, ".mpk")) files.push_back(e->d_name);
+  }
+  closedir(d);
+  std::sort(files.begin(), files.end());       // %08lu: Name = Reihenfolge
+
+  printf("file,time");
+  for (const char* name : FIELD_NAMES) printf(",%s", name);
+  printf(",flags\n");
+
+  int bad = 0;
+  uint32_t lastTime = 0;
+  std::vector<uint8_t> buffer(TELEMETRY_BATCH_BYTES);
+  for (const std::string& name : files) {
+    std::string full = std::string(path) + "/" + name;
+    FILE* f = fopen(full.c_str(), "rb");
+    size_t size = f ? fread(buffer.data(), 1, buffer.size(), f) : 0;
+    if (f) fclose(f);
+    TelemetryBatch batch;
+    TelemetryDecoder decoder;
+    if (!decoder.decode(buffer.data(), size, batch)) {
+      fprintf(stderr, "❌ %s: %s\n", name.c_str(), decoder.error);
+      bad++;
+      continue;
+    }
+    for (const TelemetrySample& s : batch.samples) {
+      if (s.time < lastTime && !(s.flags & TELEMETRY_FLAG_NO_TIME)) {
+        fprintf(stderr, "⚠️  %s: Zeit springt zurück (%u < %u)\n", name.c_str(), s.time, lastTime);
+      }
+      lastTime = s.time;
+      printf("%s,%u", name.c_str(), s.time);
+      for (int i = 0; i < TELEMETRY_FIELDS; i++) printf(",%d", s.values[i]);
+      printf(",%u\n", s.flags);
+    }
+  }
+  fprintf(stderr, "%s %zu Spool-Dateien, %d ungültig\n", bad ? "❌" : "✅", files.size(), bad);
+  return bad ? 1 : 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SIMULATION
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+  if (argc > 1 && !isdigit((unsigned char)argv[1][0])) return decodeSpoolDir(argv[1]);
+  int days = argc > 1 ? atoi(argv[1]) : 8;
+
+  // Encoder ↔ Dekoder ohne Netz: alle Integer-Breiten, beide Richtungen
+  {
+    static TelemetryEncoder enc;
+    enc.begin("roundtrip", 1784000000);
+    std::vector<TelemetrySample> in;
+    const int32_t edges[] = {0, 1, 31, -1, -32, -33, 127, 128, -128, -129, 255, 256, 32767, -32768,
+                             -32769, 65535, 65536, 2000000000, -2000000000, 0};
+    uint32_t t = 1784000000;
+    for (int32_t e : edges) {
+      TelemetrySample s = {};
+      s.time = t += 5;
+      for (int i = 0; i < TELEMETRY_FIELDS; i++) s.values[i] = i % 2 ? e : -e / 2;
+      s.flags = 0x0F;
+      enc.add(s);
+      in.push_back(s);
+    }
+    size_t len;
+    const uint8_t* data = enc.finish(len);
+    TelemetryBatch batch;
+    TelemetryDecoder decoder;
+    bool ok = decoder.decode(data, len, batch) && batch.deviceId == "roundtrip" && batch.samples.size() == in.size();
+    for (size_t i = 0; ok && i < in.size(); i++) ok = sameSample(in[i], batch.samples[i]);
+    bool truncatedRejected = !decoder.decode(data, len - 1, batch);
+    printf("%s Roundtrip: %zu Datensätze mit allen Integer-Breiten, %zu Byte; abgeschnitten → %s\n",
+           ok && truncatedRejected ? "✅" : "❌", in.size(), len, truncatedRejected ? "abgelehnt" : "angenommen");
+    if (!ok || !truncatedRejected) return 1;
+  }
+
+  TelemetryServer server;
+  if (!server.start()) { perror("bind"); return 1; }
+
+  char dir[64];
+  snprintf(dir, sizeof(dir), "/tmp/telemetry_spool_%d", getpid());
+  mkdir(dir, 0755);
+  static Device device(dir, server.port);
+
+  const uint32_t start = 1784000000;
+  const uint32_t steps = days * 86400 / SENSOR_INTERVAL_S;
+  const uint32_t perUpload = TELEMETRY_UPLOAD_INTERVAL_S / SENSOR_INTERVAL_S;
+
+  // Offline-Phasen (in Schritten): kurz, mehrere Stunden, einmal 4 Tage (Spool voll)
+  struct Window { uint32_t from, to; };
+  std::vector<Window> offline = {
+    {steps / 20, steps / 20 + 500}, {steps / 8, steps / 8 + 7000},
+    {steps / 4, steps / 4 + 4 * 86400 / SENSOR_INTERVAL_S}
+  };
+  std::vector<Window> serverDown = {{steps * 7 / 10, steps * 7 / 10 + 3000}};
+  std::vector<uint32_t> reboots = {steps / 6 + 77, steps / 3 + 5, steps * 3 / 4 + 1234};
+  auto inside = [](const std::vector<Window>& w, uint32_t s) {
+    for (const Window& x : w) if (s >= x.from && s < x.to) return true;
+    return false;
+  };
+
+  std::vector<TelemetrySample> truth;
+  truth.reserve(steps);
+  uint64_t lostAtReboot = 0;
+  uint32_t maxSpool = 0;
+  device.boot(start);
+
+  for (uint32_t step = 0; step < steps; step++) {
+    uint32_t now = start + step * SENSOR_INTERVAL_S;
+    if (std::find(reboots.begin(), reboots.end(), step) != reboots.end()) {
+      lostAtReboot += device.ramRecords();
+      device.boot(now);
+    }
+    TelemetrySample s = makeSample(now, step);
+    truth.push_back(s);
+    device.sample(s);
+
+    if ((step + 1) % perUpload == 0) {
+      device.online = !inside(offline, step);
+      server.unavailable = inside(serverDown, step);
+      device.upload(now);
+      maxSpool = std::max(maxSpool, device.spoolTail - device.spoolHead);
+    }
+  }
+  // Danach dauerhaft online, bis der Spool leer ist
+  server.unavailable = false;
+  device.online = true;
+  uint32_t drainUploads = 0;
+  for (uint32_t now = start + steps * SENSOR_INTERVAL_S; device.spoolHead < device.spoolTail || device.ramRecords();
+       now += TELEMETRY_UPLOAD_INTERVAL_S) {
+    device.upload(now);
+    drainUploads++;
+  }
+  server.stop();
+
+  // Auswertung: angekommene Messungen = geordnete Teilfolge der Wahrheit
+  std::map<uint32_t, size_t> index;
+  for (size_t i = 0; i < truth.size(); i++) index[truth[i].time] = i;
+  size_t duplicates = 0, wrong = 0, outOfOrder = 0;
+  std::vector<bool> seen(truth.size(), false);
+  long lastIndex = -1;
+  for (const TelemetrySample& s : server.received) {
+    auto it = index.find(s.time);
+    if (it == index.end() || !sameSample(s, truth[it->second])) { wrong++; continue; }
+    if (seen[it->second]) duplicates++;
+    seen[it->second] = true;
+    if ((long)it->second < lastIndex) outOfOrder++;
+    lastIndex = it->second;
+  }
+  size_t missing = 0;
+  for (bool b : seen) missing += !b;
+  uint64_t explained = device.droppedSamples + lostAtReboot;
+
+  printf("%s %d Tage, %zu Messungen: %zu angekommen, %zu falsch, %zu doppelt, %zu nicht in Reihenfolge\n",
+         wrong || duplicates || outOfOrder ? "❌" : "✅", days, truth.size(), server.received.size(),
+         wrong, duplicates, outOfOrder);
+  printf("%s Fehlend: %zu = %llu aus verworfenen Spool-Batches (%u) + %llu RAM-Batch bei Neustart\n",
+         missing == explained ? "✅" : "❌", missing, (unsigned long long)device.droppedSamples,
+         device.batchesDropped, (unsigned long long)lostAtReboot);
+  printf("%s Spool: max. %u Batches (Grenze %d), nach %u Uploads leer, %u fehlerhafte Batches am Server\n",
+         maxSpool <= TELEMETRY_SPOOL_MAX && server.badBatches == 0 ? "✅" : "❌", maxSpool,
+         TELEMETRY_SPOOL_MAX, drainUploads, server.badBatches);
+  printf("   %u Batches, %.1f Byte pro Messung (Binär ohne Delta: %zu Byte)\n", server.batches,
+         server.received.empty() ? 0.0 : (double)server.bytes / server.received.size(),
+         sizeof(uint32_t) + TELEMETRY_FIELDS * sizeof(int32_t) + 1);
+
+  rmdir(dir);
+  bool ok = !wrong && !duplicates && !outOfOrder && missing == explained &&
+            maxSpool <= TELEMETRY_SPOOL_MAX && server.badBatches == 0 && device.batchesDropped > 0;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/*
+ * ForellenWächter - Wetter-Parser gegen eine aufgezeichnete Antwort (Host)
+ * Parser siehe src/weather.h, src/json_stream.h
+ *
+ * Kompilieren & starten (PC, kein ESP32 nötig):
+ *   g++ -std=c++17 -O2 -I../src weather_parse.cpp -o weather_parse
+ *   curl -o 10115.json "https://wttr.in/10115?format=j1&lang=de"
+ *   ./weather_parse 10115.json [JJJJMMTT HH]
+ *
+ * Ohne Datei wird ein j1-förmiges Dokument (3 Tage, mit Füllfeldern wie
+ * astronomy, nearest_area, Escapes) erzeugt. Geprüft wird:
+ * 1. Einmal am Stück parsen (Referenz)
+ * 2. In zufällig geschnittenen Stücken (1..1500 Byte, wie AT+HTTPREAD/WiFi)
+ *    → identisches Ergebnis
+ * 3. Abgeschnittene Antwort → kein gültiges Ergebnis
+ *
+ * Dieselbe Datei dient als Ersatz-Server für die Firmware:
+ *   python3 -m http.server 8080
+ *   #define WEATHER_URL "http://<PC-IP>:8080/%s.json"
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "weather.h"
+
+static std::string synthesize(uint32_t firstDay) {
+  std::string s = "{\"current_condition\":[{\"FeelsLikeC\":\"27\",\"cloudcover\":\"25\",\"humidity\":\"41\","
+                  "\"lang_de\":[{\"value\":\"Teilweise bew\\u00f6lkt\"}],\"temp_C\":\"29\","
+                  "\"weatherCode\":\"116\",\"weatherDesc\":[{\"value\":\"Partly cloudy\"}],"
+                  "\"weatherIconUrl\":[{\"value\":\"\"}],\"winddir16Point\":\"SW\",\"windspeedKmph\":\"11\"}],"
+                  "\"nearest_area\":[{\"areaName\":[{\"value\":\"Berlin \\\"Mitte\\\"\"}],\"latitude\":\"52.5\"}],"
+                  "\"request\":[{\"query\":\"10115\",\"type\":\"Zipcode\"}],\"weather\":[";
+  char tmp[512];
+  int32_t dayNum = statsDayNumber(firstDay);
+  for (int d = 0; d < WEATHER_DAYS; d++) {
+    uint32_t date = statsDate(dayNum + d);
+    snprintf(tmp, sizeof(tmp),
+             "%s{\"astronomy\":[{\"moon_illumination\":\"40\",\"sunrise\":\"04:52 AM\",\"sunset\":\"09:21 PM\"}],"
+             "\"avgtempC\":\"24\",\"date\":\"%04u-%02u-%02u\",\"hourly\":[",
+             d ? "," : "", date / 10000, (date / 100) % 100, date % 100);
+    s += tmp;
+    for (int h = 0; h < WEATHER_HOURLY; h++) {
+      int temp = 16 + d * 3 + (h >= 4 ? 8 - (h - 4) * 2 : h * 2);   // Hitzewelle ab Tag 2
+      snprintf(tmp, sizeof(tmp),
+               "%s{\"DewPointC\":\"12\",\"chanceofrain\":\"%d\",\"chanceofsunshine\":\"80\","
+               "\"lang_de\":[{\"value\":\"Sonnig\"}],\"tempC\":\"%d\",\"time\":\"%d\",\"uvIndex\":\"6\","
+               "\"weatherCode\":\"%d\",\"weatherDesc\":[{\"value\":\"Sunny\"}],\"winddirDegree\":\"220\"}",
+               h ? "," : "", (h * 13) % 100, temp, h * 300, h < 4 ? 113 : 176);
+      s += tmp;
+      for (int pad = 0; pad < 12; pad++) s += "   ";    // Einrückung wie im Original
+    }
+    s += "],\"maxtempC\":\"30\",\"mintempC\":\"14\"}";
+  }
+  s += "]}\n";
+  return s;
+}
+
+static bool sameForecast(const WeatherForecast& a, const WeatherForecast& b) {
+  if (a.valid != b.valid || a.count != b.count) return false;
+  if (memcmp(&a.current, &b.current, sizeof(a.current)) != 0) return false;
+  return memcmp(a.slots, b.slots, a.count * sizeof(WeatherSlot)) == 0;
+}
+
+static bool parse(const std::string& doc, size_t maxChunk, size_t limit, int32_t nowHour, WeatherForecast& f) {
+  WeatherParser parser;
+  parser.begin(f);
+  size_t pos = 0;
+  while (pos < limit) {
+    size_t n = maxChunk ? 1 + rand() % maxChunk : limit;
+    if (n > limit - pos) n = limit - pos;
+    if (!parser.feed(doc.data() + pos, n)) return false;
+    pos += n;
+  }
+  return parser.finish(nowHour);
+}
+
+int main(int argc, char** argv) {
+  std::string doc;
+  uint32_t today = 20260715;
+  int hour = 14;
+
+  if (argc > 1) {
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) { perror(argv[1]); return 1; }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) doc.append(buf, n);
+    fclose(f);
+    if (argc > 3) { today = strtoul(argv[2], nullptr, 10); hour = atoi(argv[3]); }
+  } else {
+    doc = synthesize(today);
+  }
+
+  // Ohne Angabe: erster Tag der Datei, 14 Uhr
+  if (argc == 2) {
+    size_t at = doc.find("\"date\"");
+    int y, m, d;
+    if (at != std::string::npos && sscanf(doc.c_str() + at, "\"date\": \"%d-%d-%d", &y, &m, &d) == 3)
+      today = y * 10000 + m * 100 + d;
+  }
+  int32_t nowHour = statsDayNumber(today) * 24 + hour;
+
+  printf("Dokument: %zu Byte, Parser: %zu Byte, Ergebnis: %zu Byte\n",
+         doc.size(), sizeof(WeatherParser), sizeof(WeatherForecast));
+
+  WeatherForecast ref;
+  if (!parse(doc, 0, doc.size(), nowHour, ref)) {
+    printf("❌ Referenz ungültig\n");
+    return 1;
+  }
+
+  printf("Aktuell: %d°C, %u%%, %u km/h, Code %u, \"%s\"\n", ref.current.tempC, ref.current.humidity,
+         ref.current.windKmh, ref.current.code, ref.current.text);
+  for (uint8_t i = 0; i < ref.count; i++) {
+    const WeatherSlot& s = ref.slots[i];
+    uint32_t date = statsDate(s.hour / 24);
+    printf("  %02u.%02u. %02d:00  %3d°C  Regen %3u%%  Code %u\n",
+           date % 100, (date / 100) % 100, s.hour % 24, s.tempC, s.rainChance, s.code);
+  }
+  printf("Max. nächste 24 h: %.0f°C, 48 h: %.0f°C\n",
+         weatherMaxTemp(ref, nowHour, 24), weatherMaxTemp(ref, nowHour, 48));
+
+  srand(42);
+  int mismatches = 0;
+  for (int run = 0; run < 200; run++) {
+    WeatherForecast f;
+    size_t maxChunk = run < 20 ? 1 + run : 1500;
+    if (!parse(doc, maxChunk, doc.size(), nowHour, f) || !sameForecast(f, ref)) mismatches++;
+  }
+  printf("%s 200 Läufe mit zufälligen Stückgrößen: %d Abweichungen\n", mismatches ? "❌" : "✅", mismatches);
+
+  WeatherForecast cut;
+  bool cutValid = parse(doc, 512, doc.size() * 2 / 3, nowHour, cut);
+  printf("%s Abgeschnittene Antwort %s\n", cutValid ? "❌" : "✅", cutValid ? "als gültig angenommen" : "verworfen");
+
+  return mismatches || cutValid ? 1 : 0;
+}
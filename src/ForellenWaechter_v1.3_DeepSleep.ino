@@ -10,7 +10,7 @@
  * 
  * Features:
  * - Deep Sleep Mode (ESP32 schläft zwischen Messungen)
- * - SD-Karten Datenlogging
+ * - SD-Karten Datenlogging (RTC-gepuffert, SD nur alle N Wakeups aktiv)
  * - Battery Monitoring mit Spannungsteiler
  * - Software Watchdog
  * - Alarm per Summer/Buzzer
@@ -20,7 +20,7 @@
  * - Live-Charts
  * 
  * Stromverbrauch:
- * - Aktiv: ~80mA für 30 Sekunden
+ * - Aktiv: ~80mA für 30 Sekunden (SD-Zugriff nur bei jedem 12. Wakeup)
  * - Deep Sleep: ~10µA
  * - Durchschnitt bei 10 Min Intervall: ~0.4mA
  * 
@@ -40,6 +40,8 @@
 #include <esp_sleep.h>
 #include <esp_task_wdt.h>
 #include <driver/rtc_io.h>
+#include <unistd.h>                   // truncate() auf der SD (VFS unter /sd)
+#include "sd_batch.h"
 
 // ═══════════════════════════════════════════════════════════════════════════
 // KONFIGURATION
@@ -51,6 +53,11 @@
 #define MEASUREMENT_TIME_SEC 30       // Zeit für Messung (30 Sek)
 #define WATCHDOG_TIMEOUT_SEC 60       // Watchdog Timeout
 
+// --- SD-Logging (gepuffert im RTC-RAM) ---
+#define RTC_LOG_CAPACITY 48           // Messungen im RTC-Puffer (16 Byte/Stück)
+#define RTC_EVENT_CAPACITY 8          // Events im RTC-Puffer (32 Byte/Stück)
+#define SD_FLUSH_EVERY_N_WAKES 12     // SD nur alle N Wakeups (12 × 10 min = 2h)
+
 // --- Betriebsmodus ---
 #define TEST_MODE false               // true = Fake-Werte
 #define DEBUG_SERIAL true             // Serial-Ausgabe (verbraucht Strom!)
@@ -94,6 +101,39 @@ RTC_DATA_ATTR float lastWaterTemp = 0;
 RTC_DATA_ATTR float lastBatteryVolt = 12.0;
 RTC_DATA_ATTR bool lowBatteryMode = false;
 
+// Kompakter Messwert (quantisiert, 16 Byte statt ~60 Byte CSV-Zeile)
+struct RtcLogRecord {
+  uint32_t boot;                      // bootCount der Messung
+  int16_t waterTemp;                  // °C × 100
+  int16_t airTemp;                    // °C × 100
+  uint16_t ph;                        // pH × 100
+  uint16_t tds;                       // ppm
+  uint16_t batteryMilliVolt;          // mV
+  uint8_t batteryPercent;             // %
+  uint8_t flags;                      // Bit 0: Level OK, Bit 1: Alarm
+};
+
+struct RtcEventRecord {
+  uint32_t boot;
+  char type[12];
+  char value[16];
+};
+
+#define LOG_FLAG_LEVEL_OK 0x01
+#define LOG_FLAG_ALARM    0x02
+
+// Ringpuffer im RTC-RAM - SD-Karte wird nur beim Flush eingeschaltet
+RTC_DATA_ATTR RtcLogRecord rtcLog[RTC_LOG_CAPACITY];
+RTC_DATA_ATTR uint8_t rtcLogCount = 0;
+RTC_DATA_ATTR RtcEventRecord rtcEvents[RTC_EVENT_CAPACITY];
+RTC_DATA_ATTR uint8_t rtcEventCount = 0;
+RTC_DATA_ATTR int wakesSinceFlush = 0;
+
+// Offene Batches (siehe sd_batch.h): wird ein Flush durch Reset unterbrochen,
+// kürzt der nächste die Datei auf den Stand davor und schreibt neu
+RTC_DATA_ATTR SdPendingBatch pendingLog = {};
+RTC_DATA_ATTR SdPendingBatch pendingEvents = {};
+
 // ═══════════════════════════════════════════════════════════════════════════
 // GLOBALE OBJEKTE
 // ═══════════════════════════════════════════════════════════════════════════
@@ -156,8 +196,12 @@ void setup() {
   // Alarme prüfen
   checkAlarms();
   
-  // Daten loggen
+  // Daten im RTC-Puffer ablegen, SD nur bei Bedarf
   logToSD();
+  wakesSinceFlush++;
+  if (shouldFlushSD()) {
+    flushToSD();
+  }
   
   // Status ausgeben
   if (DEBUG_SERIAL) {
@@ -196,6 +240,10 @@ void loop() {
     esp_task_wdt_reset();
     readAllSensors();
     checkAlarms();
+    logToSD();
+    if (shouldFlushSD()) {
+      flushToSD();
+    }
     printStatus();
     lastRead = millis();
   }
@@ -392,62 +440,164 @@ void soundAlarm() {
 // SD-KARTE LOGGING
 // ═══════════════════════════════════════════════════════════════════════════
 
+// Messung quantisiert im RTC-Puffer ablegen (kein SD-Zugriff!)
 void logToSD() {
-  if (!SD.begin(SD_CS)) {
-    if (DEBUG_SERIAL) Serial.println("SD-Karte nicht gefunden");
-    return;
-  }
-  
-  // Dateiname basierend auf Boot-Count
-  int fileNum = bootCount / 288;  // Neue Datei alle 24h (bei 5min Intervall)
-  char filename[24];
-  snprintf(filename, sizeof(filename), "/log_%04d.csv", fileNum);
-  
-  bool newFile = !SD.exists(filename);
-  File file = SD.open(filename, FILE_APPEND);
-  
-  if (!file) {
-    if (DEBUG_SERIAL) Serial.println("Kann Datei nicht öffnen");
-    return;
-  }
-  
-  // Header für neue Datei
-  if (newFile) {
-    file.println("Boot,WaterTemp,AirTemp,pH,TDS,Level,Battery,BattV,Alarm");
+  if (rtcLogCount >= RTC_LOG_CAPACITY) {
+    // Puffer voll und SD nicht verfügbar: älteste Messung verwerfen
+    memmove(&rtcLog[0], &rtcLog[1], sizeof(RtcLogRecord) * (RTC_LOG_CAPACITY - 1));
+    rtcLogCount = RTC_LOG_CAPACITY - 1;
   }
-  
-  // Daten schreiben
-  file.printf("%d,%.2f,%.2f,%.2f,%.0f,%d,%d,%.2f,%d\n",
-    bootCount,
-    waterTemp,
-    airTemp,
-    phValue,
-    tdsValue,
-    waterLevelOK ? 1 : 0,
-    batteryPercent,
-    batteryVoltage,
-    alarmActive ? 1 : 0
-  );
-  
-  file.close();
-  SD.end();  // SD ausschalten für Stromsparen
+
+  RtcLogRecord& rec = rtcLog[rtcLogCount++];
+  rec.boot = bootCount;
+  rec.waterTemp = (int16_t)lroundf(waterTemp * 100.0f);
+  rec.airTemp = (int16_t)lroundf(airTemp * 100.0f);
+  rec.ph = (uint16_t)lroundf(phValue * 100.0f);
+  rec.tds = (uint16_t)lroundf(tdsValue);
+  rec.batteryMilliVolt = (uint16_t)lroundf(batteryVoltage * 1000.0f);
+  rec.batteryPercent = (uint8_t)batteryPercent;
+  rec.flags = (waterLevelOK ? LOG_FLAG_LEVEL_OK : 0) | (alarmActive ? LOG_FLAG_ALARM : 0);
 }
 
 void logEvent(String eventType, String value) {
-  if (!SD.begin(SD_CS)) return;
-  
-  File file = SD.open("/events.log", FILE_APPEND);
-  if (file) {
-    file.printf("%d,%s,%s\n", bootCount, eventType.c_str(), value.c_str());
-    file.close();
+  if (rtcEventCount >= RTC_EVENT_CAPACITY) {
+    memmove(&rtcEvents[0], &rtcEvents[1], sizeof(RtcEventRecord) * (RTC_EVENT_CAPACITY - 1));
+    rtcEventCount = RTC_EVENT_CAPACITY - 1;
   }
-  SD.end();
+
+  RtcEventRecord& ev = rtcEvents[rtcEventCount++];
+  ev.boot = bootCount;
+  strlcpy(ev.type, eventType.c_str(), sizeof(ev.type));
+  strlcpy(ev.value, value.c_str(), sizeof(ev.value));
 }
 
 void logEvent(String eventType, float value) {
   logEvent(eventType, String(value, 2));
 }
 
+bool shouldFlushSD() {
+  if (rtcLogCount == 0 && rtcEventCount == 0) return false;
+  if (pendingLog.active || pendingEvents.active) return true;  // Unterbrochener Flush
+  if (alarmActive) return true;                           // Alarm sofort sichern
+  if (rtcLogCount >= RTC_LOG_CAPACITY) return true;       // Puffer voll
+  if (rtcEventCount >= RTC_EVENT_CAPACITY) return true;
+  return wakesSinceFlush >= SD_FLUSH_EVERY_N_WAKES;
+}
+
+// Neue Datei alle 24h (bei 5min Intervall)
+uint32_t getLogDay(uint32_t boot) {
+  return boot / 288;
+}
+
+void getLogFilename(uint32_t boot, char* filename, size_t len) {
+  snprintf(filename, len, "/log_%04lu.csv", (unsigned long)getLogDay(boot));
+}
+
+// Öffnet "path" zum Anhängen eines Batches; kürzt vorher einen unterbrochenen
+// Batch derselben Datei weg (sdBatchBegin). false = SD-Fehler.
+bool beginBatchFile(File& file, const char* path, uint32_t fileId, SdPendingBatch& pending,
+                   const char* header) {
+  File probe = SD.open(path, FILE_READ);
+  uint32_t size = probe ? probe.size() : 0;
+  int last = '\n';
+  if (probe && size > 0) {
+    probe.seek(size - 1);
+    last = probe.read();
+  }
+  if (probe) probe.close();
+
+  // Abgerissene Zeile ohne offenen Batch (Stromausfall, RTC-RAM verloren) abschließen
+  if (!sdBatchPending(pending, fileId) && last != '\n') {
+    File fix = SD.open(path, FILE_APPEND);
+    if (!fix) return false;
+    fix.print('\n');
+    fix.close();
+    size++;
+  }
+
+  if (sdBatchBegin(pending, fileId, size)) {
+    char vfsPath[32];
+    snprintf(vfsPath, sizeof(vfsPath), "/sd%s", path);
+    if (truncate(vfsPath, pending.offset) != 0) return false;
+    size = pending.offset;
+  }
+
+  file = SD.open(path, FILE_APPEND);
+  if (!file) return false;
+  if (size == 0 && header) {
+    file.println(header);
+  }
+  return true;
+}
+
+// Schreibt den RTC-Puffer auf die SD-Karte: je Datei ein Batch, der erst nach
+// dem Schließen aus dem Puffer genommen wird
+void flushToSD() {
+  if (!SD.begin(SD_CS)) {
+    if (DEBUG_SERIAL) Serial.println("SD-Karte nicht gefunden");
+    return;  // Daten bleiben im RTC-Puffer
+  }
+
+  while (rtcLogCount > 0) {
+    char filename[24];
+    getLogFilename(rtcLog[0].boot, filename, sizeof(filename));
+
+    // Führende Datensätze, die in dieselbe Tagesdatei gehören
+    uint32_t day = getLogDay(rtcLog[0].boot);
+    int count = 1;
+    while (count < rtcLogCount && getLogDay(rtcLog[count].boot) == day) count++;
+
+    File file;
+    if (!beginBatchFile(file, filename, day, pendingLog,
+                        "Boot,WaterTemp,AirTemp,pH,TDS,Level,Battery,BattV,Alarm")) {
+      if (DEBUG_SERIAL) Serial.println("Kann Datei nicht öffnen");
+      SD.end();
+      return;  // pendingLog bleibt offen → nächster Wake schreibt den Batch neu
+    }
+
+    for (int i = 0; i < count; i++) {
+      const RtcLogRecord& rec = rtcLog[i];
+      file.printf("%lu,%.2f,%.2f,%.2f,%u,%d,%u,%.2f,%d\n",
+        (unsigned long)rec.boot,
+        rec.waterTemp / 100.0,
+        rec.airTemp / 100.0,
+        rec.ph / 100.0,
+        rec.tds,
+        (rec.flags & LOG_FLAG_LEVEL_OK) ? 1 : 0,
+        rec.batteryPercent,
+        rec.batteryMilliVolt / 1000.0,
+        (rec.flags & LOG_FLAG_ALARM) ? 1 : 0
+      );
+    }
+    file.close();
+
+    // Batch liegt auf der SD: sofort abschließen und aus dem Puffer nehmen
+    sdBatchDone(pendingLog);
+    memmove(&rtcLog[0], &rtcLog[count], sizeof(RtcLogRecord) * (rtcLogCount - count));
+    rtcLogCount -= count;
+  }
+
+  if (rtcEventCount > 0) {
+    File file;
+    if (beginBatchFile(file, "/events.log", 0, pendingEvents, nullptr)) {
+      int count = rtcEventCount;
+      for (int i = 0; i < count; i++) {
+        file.printf("%lu,%s,%s\n", (unsigned long)rtcEvents[i].boot,
+                    rtcEvents[i].type, rtcEvents[i].value);
+      }
+      file.close();
+      sdBatchDone(pendingEvents);
+      memmove(&rtcEvents[0], &rtcEvents[count], sizeof(RtcEventRecord) * (rtcEventCount - count));
+      rtcEventCount -= count;
+    }
+  }
+
+  wakesSinceFlush = 0;
+  SD.end();  // SD ausschalten für Stromsparen
+
+  if (DEBUG_SERIAL) Serial.println("💾 RTC-Puffer auf SD geschrieben");
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 // DEEP SLEEP
 // ═══════════════════════════════════════════════════════════════════════════
@@ -485,6 +635,7 @@ void emergencySleep() {
   }
   
   logEvent("EMERGENCY", "BATTERY_CRITICAL");
+  flushToSD();  // Puffer sichern, nächster Wake erst in 1h
   
   // 1 Stunde schlafen
   esp_sleep_enable_timer_wakeup(3600ULL * 1000000ULL);
@@ -533,5 +684,7 @@ void printStatus() {
   }
   
   Serial.printf("📈 Alarme gesamt: %d\n", alarmCount);
+  Serial.printf("💾 RTC-Puffer: %d/%d (Flush in %d Wakes)\n",
+    rtcLogCount, RTC_LOG_CAPACITY, SD_FLUSH_EVERY_N_WAKES - wakesSinceFlush);
   Serial.println("────────────────────────────────────────");
 }
@@ -63,14 +63,52 @@
 #include <SD.h>
 #include <SPI.h>
 #include <EEPROM.h>
+#include <Preferences.h>
+#include <esp_rom_crc.h>
 #include <esp_task_wdt.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <time.h>
+#include <atomic>
 
 // Telegram Bot (v1.6.1) - Install via Library Manager: "UniversalTelegramBot" by Brian Lough
 #include <WiFiClientSecure.h>
 #include <UniversalTelegramBot.h>
+#include "telegram_tasks.h"        // Empfangs-/Versand-Schleife (auch im Host-Test)
+
+// Multi-Becken Frames & Transport
+#include "tank_link.h"
+
+// Keep-Alive Pool für ausgehende HTTPS-Requests
+#include "https_pool.h"
+
+// Kompakte Telemetrie-Batches (MessagePack)
+#include "telemetry.h"
+#include "sensor_format.h"
+#include "aeration.h"
+#include "adc_lut.h"
+#include "sampling.h"
+#include "downsample.h"
+
+// Delta-Firmware über LTE (streamender Patch in die OTA-Partition)
+#include <esp_ota_ops.h>
+#include "delta_patch.h"
+
+// Hänger-Analyse: Phasen-Marker im RTC-Speicher (überleben Watchdog-Resets)
+#include <esp_system.h>
+#include "stall_profiler.h"
+
+// Ereignis-Journal im RAM (gebündelt auf SD, abrufbar über /api/events)
+#include "event_journal.h"
+
+// Tagesstatistik (laufend aggregiert, 365 Tage auf SD, /api/stats)
+#include "daily_stats.h"
+
+// Wettervorhersage am Gerät (gefiltert beim Empfang, /api/weather)
+#include "weather.h"
+
+// Chart-Historie neustartfest (Ring auf SD, ein Datensatz pro Punkt)
+#include "history_log.h"
 
 // ═══════════════════════════════════════════════════════════════════════════════════
 // KONFIGURATION
@@ -81,18 +119,48 @@
 #define TEST_MODE false              // Fake-Werte für Tests
 #define DEBUG_MODE true              // Serial-Ausgabe
 #define WATCHDOG_TIMEOUT 120         // Sekunden
+#define LOOP_BUDGET_MS 200           // loop()-Durchläufe darüber zählen als "über Budget"
 
-// --- Feature Toggles ---
+// --- Feature Toggles (per -D überschreibbar, siehe examples/size_report.sh) ---
+#ifndef ENABLE_LTE
 #define ENABLE_LTE true              // LTE Mobilfunk
+#endif
+#ifndef ENABLE_WIFI
 #define ENABLE_WIFI true             // WiFi (parallel zu LTE)
+#endif
+#ifndef ENABLE_EMAIL_ALERTS
 #define ENABLE_EMAIL_ALERTS true     // E-Mail Benachrichtigungen
+#endif
+#ifndef ENABLE_DO_SENSOR
 #define ENABLE_DO_SENSOR false       // Dissolved Oxygen Sensor
+#endif
+#ifndef ENABLE_SD_LOGGING
 #define ENABLE_SD_LOGGING true       // SD-Karten Logging
+#endif
+#ifndef ENABLE_OTA
 #define ENABLE_OTA true              // Over-The-Air Updates
+#endif
+#ifndef ENABLE_TURBINE
 #define ENABLE_TURBINE true          // Wasserturbine (Flow + Power Monitoring)
+#endif
+#ifndef ENABLE_BATTERY_MONITOR
 #define ENABLE_BATTERY_MONITOR true  // Batterie-Überwachung (Spannung + %)
+#endif
+#ifndef ENABLE_TELEGRAM
 #define ENABLE_TELEGRAM false        // Telegram Bot (v1.6.1) - optional
+#endif
+#ifndef ENABLE_DYNDNS
 #define ENABLE_DYNDNS false          // DynDNS Auto-Update (v1.6.1) - optional
+#endif
+#ifndef ENABLE_MULTI_TANK
+#define ENABLE_MULTI_TANK false      // Satelliten-Becken via ESP-NOW/UDP - optional
+#endif
+#ifndef ENABLE_TELEMETRY
+#define ENABLE_TELEMETRY false       // Gebündelter Telemetrie-Upload - optional
+#endif
+#ifndef ENABLE_DELTA_OTA
+#define ENABLE_DELTA_OTA false       // Delta-Firmware-Updates über LTE - optional
+#endif
 
 // --- WiFi (lokaler Zugriff) ---
 const char* AP_SSID = "ForellenWaechter";
@@ -106,6 +174,7 @@ const char* OTA_PASSWORD = "forellenadmin123";  // ÄNDERN! OTA Update Passwort
 #define LTE_APN "internet"           // APN deines Providers (z.B. "internet.t-mobile")
 #define LTE_USER ""                  // APN Username (meist leer)
 #define LTE_PASS ""                  // APN Passwort (meist leer)
+#define LTE_HTTP_READ_SIZE 1024      // Bytes pro AT+HTTPREAD (Delta-Update, Wetter)
 
 // --- E-Mail Konfiguration (über HTTP Webhook) ---
 // Nutze einen kostenlosen Service wie EmailJS, Mailgun, oder eigenen Server
@@ -120,7 +189,21 @@ const char* EMAIL_RECIPIENT = "your-email@example.com";  // ÄNDERN!
 // 4. Hole deine Chat-ID von @userinfobot
 const char* TELEGRAM_BOT_TOKEN = "YOUR_BOT_TOKEN";  // ÄNDERN!
 const char* TELEGRAM_CHAT_ID = "YOUR_CHAT_ID";      // ÄNDERN!
-#define TELEGRAM_CHECK_INTERVAL 2000  // Check für neue Nachrichten (ms)
+#define TELEGRAM_QUEUE_SIZE 8         // Ausgehende Nachrichten-Queue
+#define TELEGRAM_TASK_CORE 0          // loop() läuft auf Core 1
+// Long Polling, Rate-Limit, Wiederholungen und Backoff: src/telegram_tasks.h (per -D änderbar)
+// Bot-API-Server: für Tests auf einen lokalen Stand-in umbiegen, z.B.
+// -DTELEGRAM_API_HOST='"192.168.1.10"' -DTELEGRAM_API_PORT=8081 -DTELEGRAM_API_TLS=false
+// (siehe examples/telegram_standin.cpp)
+#ifndef TELEGRAM_API_HOST
+#define TELEGRAM_API_HOST "api.telegram.org"
+#endif
+#ifndef TELEGRAM_API_PORT
+#define TELEGRAM_API_PORT 443
+#endif
+#ifndef TELEGRAM_API_TLS
+#define TELEGRAM_API_TLS true
+#endif
 
 // --- DynDNS Konfiguration (v1.6.1) ---
 // DuckDNS: https://www.duckdns.org (kostenlos, keine Registrierung nötig)
@@ -131,6 +214,57 @@ const char* DYNDNS_DOMAIN = "forellenwaechter.duckdns.org";  // ÄNDERN!
 const char* DYNDNS_TOKEN = "YOUR_DUCKDNS_TOKEN";             // ÄNDERN!
 #define DYNDNS_UPDATE_INTERVAL 300000  // Update alle 5 Minuten
 
+// --- Multi-Becken Konfiguration ---
+// Jeder Satellit sendet alle SENSOR_INTERVAL einen TankFrame (siehe tank_link.h)
+#define MAX_TANKS 16                 // Max. Anzahl Satelliten-Becken
+#define TANK_TRANSPORT_ESPNOW true   // true = ESP-NOW, false = UDP (Port 4210)
+#define TANK_TIMEOUT 120000          // Becken offline nach 2 min ohne Frame
+#define TANK_HISTORY_SIZE 48         // 4h bei 5min Intervall (6 Byte/Punkt)
+
+// --- Telemetrie-Upload ---
+// Messungen werden jede SENSOR_INTERVAL delta-kodiert gesammelt und gebündelt
+// hochgeladen. Offline landen Batches im SD-Spool (/spool) und werden später
+// in Reihenfolge nachgeliefert.
+const char* TELEMETRY_URL = "https://example.com/api/telemetry";  // ÄNDERN!
+#define TELEMETRY_UPLOAD_INTERVAL 900000  // Upload alle 15 Minuten
+#define TELEMETRY_SPOOL_MAX 288           // Max. Batches im Spool (3 Tage)
+#define TELEMETRY_CATCHUP_PER_UPLOAD 4    // Nachzuliefernde Batches pro Upload
+
+// --- Daten-Export (/api/export) ---
+#define EXPORT_CHUNK_SIZE 2048       // Bytes pro SD-Lesezugriff / HTTP-Chunk
+#define EXPORT_MAX_DAYS 366          // Max. Zeitraum pro Export
+
+// --- Ereignis-Journal (/api/events, /logs/events.log) ---
+#define EVENT_FLUSH_INTERVAL 60000   // Offene Ereignisse spätestens nach 1 min auf SD
+#define EVENT_FLUSH_BATCH 16         // ... oder sobald so viele offen sind
+#define EVENT_API_LIMIT 50           // Max. Ereignisse pro /api/events-Antwort
+
+// --- Tagesstatistik (/api/stats) ---
+#define STATS_FILE "/data/daily_stats.bin"  // 365 Slots à 56 Byte
+#define STATS_API_DEFAULT_DAYS 30
+
+// --- Chart-Historie auf SD (übersteht Reset, OTA, Brownout) ---
+#define HISTORY_LOG_FILE "/data/history.bin"  // 304 Slots à 26 Byte
+
+// --- Wettervorhersage (/api/weather) ---
+// Ort (PLZ oder Name) in den Einstellungen; %s = Ort. Für Tests ohne Internet eine
+// aufgezeichnete Antwort lokal ausliefern (siehe examples/weather_parse.cpp):
+//   #define WEATHER_URL "http://192.168.4.2:8080/%s.json"
+#define WEATHER_URL "https://wttr.in/%s?format=j1&lang=de"
+#define WEATHER_FIRST_DELAY 120000        // Erster Abruf 2 min nach dem Start
+#define WEATHER_RETRY_INTERVAL 1800000    // Nach Fehlschlag in 30 min erneut
+#define WEATHER_MAX_AGE 129600            // Vorhersage nach 36h verwerfen (s)
+#define WEATHER_HEAT_LEAD_HOURS 24        // Hitze so weit im Voraus berücksichtigen
+#define WEATHER_READ_SIZE 512             // Bytes pro Lesezugriff (WiFi/AT+HTTPREAD)
+
+// --- Delta-Updates über LTE ---
+// Der Server legt pro Ausgangsversion einen Patch ab: <DELTA_OTA_URL><FIRMWARE_VERSION>.fwd
+// (erzeugt mit examples/fw_delta.cpp). 404 = kein Update verfügbar.
+const char* DELTA_OTA_URL = "https://example.com/forellenwaechter/delta/";  // ÄNDERN!
+#define DELTA_OTA_CHECK_INTERVAL 21600000  // Alle 6h nach einem Patch fragen
+#define DELTA_OTA_RANGE_SIZE 16384         // Bytes pro HTTP-Range-Request
+#define DELTA_OTA_CONFIRM_MS 120000        // Neue Firmware nach 2 min stabilem Betrieb bestätigen
+
 // --- Sensor Grenzwerte (Regenbogenforelle) ---
 struct TroutParameters {
   float tempMin = 8.0;
@@ -149,6 +283,12 @@ struct TroutParameters {
 #define TURBINE_MAX_POWER 10.0        // Max. Leistung (W)
 #define FLOW_MIN_ALARM 5.0            // Min. Durchfluss L/min (Alarm wenn unterschritten)
 
+// --- Persistente Einstellungen (NVS) ---
+#define SETTINGS_NAMESPACE "fw-settings"
+#define SETTINGS_SCHEMA_VERSION 3     // v1 = EEPROM, v2 = NVS, v3 = + Becken-Grenzwerte (eigener Blob "tanks"), Belüftung/Zeitpläne, Wetter
+#define SETTINGS_COMMIT_DELAY 5000    // Ruhezeit (ms) bevor ins Flash geschrieben wird
+#define SETTINGS_COMMIT_MAX_DELAY 30000  // Spätestens nach 30s schreiben
+
 // --- Batterie-Konfiguration (Blei/Gel) ---
 #define BATTERY_PIN 36                // ADC für Batterie-Spannung
 #define BATTERY_R1 10000.0            // Oberer Widerstand (Ohm) im Spannungsteiler
@@ -157,8 +297,19 @@ struct TroutParameters {
 #define BATTERY_EMPTY 10.5            // 0% Spannung (Tiefentladung)
 #define BATTERY_WARNING 11.5          // Warnschwelle (niedrige Batterie)
 
+// --- Regel-Task (Messen, Alarm, Relais) ---
+// Läuft unabhängig von loop(): AT-Befehle, TLS-Handshakes oder SD-Zugriffe
+// verzögern die Belüftung nicht. Kein Netzwerk, keine SD im Task.
+#define CONTROL_TASK_CORE ARDUINO_RUNNING_CORE  // Core von loop() (1, ESP32-C3: 0), höhere Priorität verdrängt loop() sofort
+#define CONTROL_TASK_PRIORITY 5       // loop() und Telegram laufen mit 1
+#define CONTROL_TASK_STACK 6144
+#define CONTROL_TICK_MS 50            // Aufwachraster (Summer-Muster); Relais-Befehle wecken sofort
+#define ALARM_QUEUE_SIZE 4            // Alarm-Meldungen an loop() (E-Mail, Telegram)
+#define CONTROL_QUEUE_SIZE 8          // Befehle aus loop() an den Regel-Task (Relais, Zähler)
+
 // --- Zeitintervalle (ms) ---
-#define SENSOR_INTERVAL 5000         // Sensor-Abfrage
+#define SENSOR_INTERVAL 5000         // Auswerte-Raster (Telemetrie, Debug-Ausgabe)
+#define SAMPLE_TICK 1000             // Kleinste Abtastperiode (Raten je Kanal: SAMPLE_CHANNELS)
 #define LOG_INTERVAL 300000          // SD-Logging (5 min)
 #define LTE_CHECK_INTERVAL 60000     // LTE Status (1 min)
 #define HISTORY_INTERVAL 300000      // Chart-History (5 min)
@@ -209,11 +360,66 @@ OneWire oneWire(ONE_WIRE_BUS);
 DallasTemperature tempSensors(&oneWire);
 WebServer server(80);
 HardwareSerial LTESerial(1);
-
-// Telegram Bot (v1.6.1)
+bool lteHttpHeld = false;            // HTTP-Sitzung im Modem offen (Delta-Update, Server ohne Range)
+HttpsPool httpsPool;
+
+// ADC-Kennlinie (raw → mV) und TDS-Kurve (mV → ppm × 10), in initADC() gefüllt
+Lut12 adcLut;
+Lut12 tdsLut;
+AdcCalSource adcCalSource = ADC_CAL_LINEAR;
+constexpr int32_t BATTERY_DIVIDER_Q10 = dividerQ10(BATTERY_R1, BATTERY_R2);
+
+// Adaptive Abtastung: Basis-/Schnellrate je Messkanal (siehe sampling.h)
+enum SensorChannel : uint8_t {
+  CH_TEMPERATURE, CH_PH, CH_TDS, CH_DO, CH_LEVEL, CH_FLOW, CH_BATTERY, CH_COUNT
+};
+
+struct SampleChannel {
+  const char* name;
+  bool enabled;
+  SamplePolicy policy;
+};
+
+const SampleChannel SAMPLE_CHANNELS[CH_COUNT] = {
+  // name          enabled                 base    fast   hold     Δ/min  Streuung
+  {"temperature", true,                   {60000,  5000, 300000,  0.2,   0.1}},
+  {"ph",          true,                   {30000,  5000, 300000,  0.1,   0.05}},
+  {"tds",         true,                   {60000, 10000, 300000,  20,    10}},
+  {"do",          ENABLE_DO_SENSOR,       {30000,  5000, 300000,  0.3,   0.2}},
+  {"level",       true,                   { 5000,  1000, 120000,  0.5,   0.3}},
+  {"flow",        ENABLE_TURBINE,         { 5000,  1000, 120000,  1.0,   0.5}},
+  {"battery",     ENABLE_BATTERY_MONITOR, {60000, 10000, 300000,  0.2,   0.05}},
+};
+
+AdaptiveSampler samplers[CH_COUNT];
+
+// Telegram Bot (v1.6.1) - eigene Tasks mit je einer TLS-Verbindung. Beide zählen
+// als externe Verbindungen gegen HTTPS_POOL_SIZE (httpsPool.reserveExternal()).
 #if ENABLE_TELEGRAM
-WiFiClientSecure telegramClient;
-UniversalTelegramBot *bot = nullptr;
+// UniversalTelegramBot verbindet fest mit api.telegram.org:443 - hier umlenkbar
+class TelegramApiClient : public WiFiClientSecure {
+public:
+  using WiFiClientSecure::connect;
+  int connect(const char* host, uint16_t port) override {
+    return WiFiClientSecure::connect(TELEGRAM_API_HOST, TELEGRAM_API_PORT);
+  }
+};
+
+TelegramApiClient telegramPollClient;
+TelegramApiClient telegramSendClient;
+UniversalTelegramBot *bot = nullptr;       // Empfang (Long Polling)
+UniversalTelegramBot *botSender = nullptr; // Versand (Outbox-Queue)
+
+struct TelegramMessage {
+  char chatId[24];
+  char text[480];
+  bool markdown;
+};
+
+QueueHandle_t telegramOutbox = nullptr;
+QueueHandle_t telegramRelayQueue = nullptr;  // Relais-Befehle → loop()
+std::atomic<uint32_t> telegramSent{0};      // Send-Task
+std::atomic<uint32_t> telegramDropped{0};   // Send-Task und queueTelegramMessage() aus allen Tasks
 #endif
 
 DeviceAddress waterTempAddr, airTempAddr;
@@ -233,7 +439,8 @@ String getJS();
 // DATENSTRUKTUREN
 // ═══════════════════════════════════════════════════════════════════════════════════
 
-// Aktuelle Sensordaten
+// Aktuelle Sensordaten. Schreibt nur der Regel-Task; andere Tasks lesen einzelne
+// Werte (32 Bit, atomar) oder eine zusammenhängende Kopie über readSensorSnapshot().
 struct SensorData {
   float waterTemp = 0;
   float airTemp = 0;
@@ -243,7 +450,7 @@ struct SensorData {
   bool waterLevelOK = true;
   bool aerationActive = false;
   bool alarmActive = false;
-  String alarmReason = "";
+  char alarmReason[160] = "";
 
   // Turbinen-Daten (v1.6)
   float flowRate = 0;                // L/min
@@ -258,6 +465,133 @@ struct SensorData {
   unsigned long timestamp = 0;
 } sensors;
 
+// Thread-sichere Kopie der Sensordaten für Hintergrund-Tasks (ohne String)
+struct SensorSnapshot {
+  float waterTemp;
+  float airTemp;
+  float ph;
+  float tds;
+  float dissolvedOxygen;
+  float flowRate;
+  float turbinePower;
+  unsigned long turbinePulseCount;
+  float batteryVoltage;
+  float batteryPercent;
+  bool waterLevelOK;
+  bool aerationActive;
+  bool alarmActive;
+  bool batteryLow;
+  bool aerationRelay;                // Tatsächlicher Zustand RELAY_4
+  ActuatorStats aeration;            // Belüftung seit Mitternacht
+  char alarmReason[160];
+  unsigned long timestamp;
+};
+
+SensorSnapshot sensorSnapshot = {};
+portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Regel-Task → loop(): neuer Alarm, Versand (E-Mail, Telegram) braucht Netzwerk
+struct AlarmNotice {
+  uint32_t detectedMs;
+  char reason[160];
+};
+
+// Laufzeit des Regel-Tasks (/api/status "control")
+struct ControlStats {
+  uint32_t cycles;
+  uint32_t lastCycleUs;              // Messbeginn → Relais geschrieben
+  uint32_t avgCycleUs;               // Gleitender Mittelwert (1/16)
+  uint32_t maxCycleUs;
+  uint32_t maxLateMs;                // Verspätung gegenüber dem Messraster
+  uint32_t aerationStarts;           // Belüftungsbedarf → RELAY_4 geschrieben
+  uint32_t lastAerationUs;
+  uint32_t maxAerationUs;
+  uint32_t deadlineMisses;           // RELAY_4 später als eine Messperiode nach dem Bedarf
+  uint32_t noticesDropped;           // Queue voll
+};
+
+// loop() → Regel-Task. Zähler in sysStatus schreibt nur der Task.
+enum ControlCommandType : uint8_t {
+  CTL_RELAYS = 0,                    // Relais-Modus geändert: sofort schalten
+  CTL_COUNT_ALARM,                   // Alarm außerhalb des Tasks (Multi-Becken) zählen
+  CTL_RESET_DAILY,                   // Tageswechsel
+  CTL_RESTORE_DAILY,                 // Tageszähler nach Neustart von SD (value)
+  CTL_SAMPLE_ADC                     // Rohwert für die Kalibrierung messen (value = Pin)
+};
+
+struct ControlCommand {
+  uint8_t type;
+  uint16_t value;
+};
+
+TaskHandle_t controlTask = nullptr;
+QueueHandle_t alarmQueue = nullptr;
+QueueHandle_t controlQueue = nullptr;
+QueueHandle_t adcSampleQueue = nullptr;  // Antwort auf CTL_SAMPLE_ADC (1 Eintrag)
+ControlStats controlStats = {};
+volatile bool weatherHeat = false;     // Von loop() gesetzt, Regel-Task liest
+
+// Binär-Log (/logs/JJJJ-MM-TT.bin): ein Datensatz pro LOG_INTERVAL, Little Endian.
+// Feste Größe → Export-Offsets ohne Parsen (Format in docs/API.md)
+#define LOG_RECORD_VERSION 1
+#define LOG_FLAG_LEVEL_OK    0x01
+#define LOG_FLAG_AERATION    0x02
+#define LOG_FLAG_ALARM       0x04
+#define LOG_FLAG_BATTERY_LOW 0x08
+
+struct __attribute__((packed)) LogRecord {
+  uint32_t time;                     // Unix-Zeit, 0 = keine NTP-Zeit
+  int16_t waterTemp;                 // °C × 100
+  int16_t airTemp;                   // °C × 100
+  uint16_t ph;                       // pH × 100
+  uint16_t tds;                      // ppm
+  uint16_t dissolvedOxygen;          // mg/L × 100
+  uint16_t flowRate;                 // L/min × 100
+  uint16_t turbinePower;             // W × 100
+  uint16_t batteryMilliVolt;
+  uint8_t flags;                     // LOG_FLAG_*
+  uint8_t version;                   // LOG_RECORD_VERSION
+};
+static_assert(sizeof(LogRecord) == 22, "LogRecord muss 22 Bytes haben");
+
+// Feld-Tabelle: einzige Quelle für API-JSON, SD-CSV, E-Mail, Telegram und Serial
+// (Reihenfolge = CSV-Spaltenreihenfolge; neue Felder nur hinten anfügen)
+constexpr FieldDef<SensorSnapshot> SENSOR_FIELD_LIST[] = {
+  // key                label          icon    unit     prec kind         enabled                 formats   group
+  {"waterTemp",         "Wasser",      "💧",   "°C",    2,   FIELD_FLOAT, true,                   FMT_ALL,  GROUP_TEMP,
+    [](const SensorSnapshot& s) -> double { return s.waterTemp; }, nullptr, nullptr},
+  {"airTemp",           "Luft",        "🌡️",   "°C",    2,   FIELD_FLOAT, true,                   FMT_ALL,  GROUP_TEMP,
+    [](const SensorSnapshot& s) -> double { return s.airTemp; }, nullptr, nullptr},
+  {"ph",                "pH",          "🧪",   "",      2,   FIELD_FLOAT, true,                   FMT_ALL,  GROUP_WATER,
+    [](const SensorSnapshot& s) -> double { return s.ph; }, nullptr, nullptr},
+  {"tds",               "TDS",         "📊",   "ppm",   0,   FIELD_FLOAT, true,                   FMT_ALL,  GROUP_WATER,
+    [](const SensorSnapshot& s) -> double { return s.tds; }, nullptr, nullptr},
+  {"dissolvedOxygen",   "O₂",          "🫧",   "mg/L",  2,   FIELD_FLOAT, ENABLE_DO_SENSOR,       FMT_ALL,  GROUP_WATER,
+    [](const SensorSnapshot& s) -> double { return s.dissolvedOxygen; }, nullptr, nullptr},
+  {"waterLevel",        "Level",       "🌊",   "",      0,   FIELD_BOOL,  true,                   FMT_ALL,  GROUP_WATER,
+    [](const SensorSnapshot& s) -> double { return s.waterLevelOK; }, "OK", "NIEDRIG"},
+  {"flowRate",          "Durchfluss",  "⚡",   "L/min", 2,   FIELD_FLOAT, ENABLE_TURBINE,         FMT_ALL,  GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.flowRate; }, nullptr, nullptr},
+  {"turbinePower",      "Leistung",    "🔌",   "W",     1,   FIELD_FLOAT, ENABLE_TURBINE,         FMT_ALL,  GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.turbinePower; }, nullptr, nullptr},
+  {"turbinePulseCount", "Pulse",       "🔄",   "",      0,   FIELD_COUNT, ENABLE_TURBINE,         FMT_JSON, GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.turbinePulseCount; }, nullptr, nullptr},
+  {"batteryVoltage",    "Batterie",    "🔋",   "V",     2,   FIELD_FLOAT, ENABLE_BATTERY_MONITOR, FMT_ALL,  GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.batteryVoltage; }, nullptr, nullptr},
+  {"batteryPercent",    "Ladung",      "📊",   "%",     0,   FIELD_FLOAT, ENABLE_BATTERY_MONITOR, FMT_ALL,  GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.batteryPercent; }, nullptr, nullptr},
+  {"batteryLow",        "Batteriestatus", "⚠️", "",     0,   FIELD_BOOL,  ENABLE_BATTERY_MONITOR, FMT_ALL,  GROUP_POWER,
+    [](const SensorSnapshot& s) -> double { return s.batteryLow; }, "NIEDRIG", "OK"},
+  {"aeration",          "Belüftung",   "💨",   "",      0,   FIELD_BOOL,  true,                   FMT_ALL,  GROUP_STATE,
+    [](const SensorSnapshot& s) -> double { return s.aerationActive; }, "AN", "AUS"},
+  {"alarm",             "Alarm",       "🚨",   "",      0,   FIELD_BOOL,  true,                   FMT_ALL,  GROUP_STATE,
+    [](const SensorSnapshot& s) -> double { return s.alarmActive; }, "AKTIV", "Kein Alarm"},
+};
+
+// Abgeschaltete Sensoren (enabled = false) fallen zur Compile-Zeit heraus
+constexpr auto SENSOR_FIELD_SET = selectEnabled<enabledCount(SENSOR_FIELD_LIST)>(SENSOR_FIELD_LIST);
+constexpr const auto& SENSOR_FIELDS = SENSOR_FIELD_SET.items;
+
 // Systemstatus
 struct SystemStatus {
   bool wifiConnected = false;
@@ -280,17 +614,18 @@ struct SystemStatus {
 struct CalibrationData {
   uint16_t magic = EEPROM_MAGIC;
 
-  // pH Kalibrierung (2-Punkt)
-  float ph_slope = 3.5;              // Standard-Steigung
-  float ph_offset = 0.0;             // Standard-Offset
+  // pH Kalibrierung (2-Punkt). Die Gerade rechnet readPH() aus den Pufferpunkten
+  // in mV (phLineVolts()); die beiden Felder davor halten nur das Speicher-Layout.
+  float reserved_ph_slope = 3.5;     // Früher Steigung pro ADC-Schritt, unbenutzt
+  float reserved_ph_offset = 0.0;    // Unbenutzt
   bool ph_calibrated = false;
   int ph_buffer1_adc = 0;            // pH 4.0 Pufferlösung ADC-Wert
   int ph_buffer2_adc = 0;            // pH 7.0 Pufferlösung ADC-Wert
   float ph_buffer1_value = 4.0;
   float ph_buffer2_value = 7.0;
 
-  // TDS Kalibrierung
-  float tds_factor = 0.5;            // Standard-Faktor
+  // TDS Kalibrierung (Faktor in mV: tdsFactorPerMv())
+  float reserved_tds_factor = 0.5;   // Früher ppm pro ADC-Schritt, unbenutzt
   bool tds_calibrated = false;
   int tds_reference_adc = 0;         // z.B. 1413 µS/cm Lösung
   float tds_reference_value = 1413.0;
@@ -304,30 +639,230 @@ struct CalibrationData {
   uint8_t checksum = 0;
 } calibration;
 
+// Alarm-Regeln (über /api/settings änderbar)
+struct AlarmRules {
+  float flowMin = FLOW_MIN_ALARM;            // L/min
+  float batteryWarning = BATTERY_WARNING;    // V
+  uint16_t emailCooldownMin = EMAIL_COOLDOWN_MIN;
+} alarmRules;
+
+// Wettervorhersage und vorausschauende Belüftung (über /api/settings änderbar)
+struct WeatherConfig {
+  char location[24] = "";                    // PLZ oder Ort, leer = kein Abruf
+  float heatAirTemp = 28.0;                  // °C Lufttemperatur = Hitzeperiode
+  float doBoost = 1.0;                       // mg/L mehr Sauerstoff anstreben (mit DO-Sensor)
+  float tempShift = 1.0;                     // °C früher belüften (ohne DO-Sensor)
+} weatherConfig;
+
+// Persistierter Einstellungs-Block (NVS)
+// WICHTIG: Neue Felder nur am Ende anhängen und SETTINGS_SCHEMA_VERSION erhöhen!
+struct SettingsHeader {
+  uint16_t magic;
+  uint16_t version;
+  uint16_t length;                   // Länge des Payloads in Bytes
+  uint32_t crc;                      // CRC32 über den Payload
+};
+
+struct PersistedSettings {
+  TroutParameters trout;
+  CalibrationData calibration;
+  uint8_t relayModes[4];
+  AlarmRules alarms;
+  AerationConfig aeration;                // Schema v3
+  RelaySchedule schedules[3];             // Schema v3 (Relais 1-3)
+  WeatherConfig weather;                  // Schema v3
+};
+
+// Satelliten-Becken: letzter Frame + kompakte Historie
+struct TankHistoryPoint {
+  int16_t waterTemp;                 // °C × 100
+  uint16_t ph;                       // pH × 100
+  uint16_t dissolvedOxygen;          // mg/L × 100
+};
+
+struct TankState {
+  bool active = false;
+  TankFrame latest;
+  unsigned long lastSeen = 0;
+  uint32_t framesReceived = 0;
+  uint32_t framesLost = 0;
+  uint16_t restarts = 0;             // Sequenz sprang zurück (Satellit neu gestartet)
+  uint16_t alarmMask = 0;            // Auswertung durch Master
+  uint16_t notifiedMask = 0;         // Bereits gemeldete Alarm-Bits
+  TankHistoryPoint history[TANK_HISTORY_SIZE];
+  uint8_t historyIndex = 0;
+  bool historyFull = false;
+  unsigned long lastHistory = 0;
+};
+
+#if ENABLE_TELEMETRY
+TelemetryEncoder telemetryBatch;
+uint8_t telemetrySpoolBuffer[TELEMETRY_BATCH_BYTES];  // Lesepuffer für Nachlieferung
+uint32_t spoolHead = 0;              // Ältester Batch im Spool
+uint32_t spoolTail = 0;              // Nächste freie Nummer
+struct TelemetryStats {
+  uint32_t batchesSent = 0;
+  uint32_t bytesSent = 0;
+  uint32_t batchesDropped = 0;
+} telemetryStats;
+#endif
+
+#if ENABLE_DELTA_OTA
+struct DeltaOtaStatus {
+  bool requested = false;            // Über /api/ota/delta angestoßen
+  bool pendingVerify = false;        // Neue Firmware läuft, noch nicht bestätigt
+  bool rolledBack = false;           // Bootloader ist auf die alte Firmware zurück
+  uint32_t patchBytes = 0;           // Geladene Patch-Bytes (letzter Versuch)
+  uint32_t imageBytes = 0;           // Größe der neuen Firmware
+  char lastResult[32] = "-";
+} deltaOta;
+
+struct DeltaOtaTarget {
+  const esp_partition_t* running;
+  const esp_partition_t* update;
+  esp_ota_handle_t handle;
+  bool begun;
+};
+
+// Laufendes Delta-Update: ein Range-Block pro loop()-Durchlauf
+struct DeltaOtaJob {
+  bool active = false;
+  DeltaOtaTarget target = {nullptr, nullptr, 0, false};
+  uint32_t offset = 0;               // Nächstes Patch-Byte
+  DeltaStatus status = DELTA_OK;
+  bool wholeBody = false;            // Server ignoriert Range: ganzer Patch im Modem (lteHttpHeld)
+  uint32_t bodyLen = 0;
+} deltaJob;
+
+DeltaPatcher deltaPatcher;           // ~1.1 KB, unabhängig von der Image-Größe
+#endif
+
+#if ENABLE_MULTI_TANK
+TankState tanks[MAX_TANKS];
+TankTransport* tankTransport = nullptr;
+TroutParameters tankParams[MAX_TANKS];     // Grenzwerte je Becken (Index = Tank-ID - 1)
+#endif
+
+struct ExportStats {
+  uint32_t count = 0;                // Exporte seit Boot
+  uint32_t lastBytes = 0;
+  uint32_t lastMs = 0;
+} exportStats;
+
+// Ein Tag des Exports: Datei ab Byte skip, len Bytes
+struct ExportPart {
+  char path[24];
+  uint32_t skip;
+  uint32_t len;
+};
+
+// Hänger-Analyse: in welcher Phase steckt loop() gerade?
+enum LoopPhase : uint8_t {
+  PHASE_IDLE, PHASE_SENSORS, PHASE_WEB, PHASE_OTA, PHASE_LTE_AT, PHASE_HTTPS, PHASE_SD,
+  PHASE_TIME, PHASE_SETTINGS, PHASE_TELEMETRY, PHASE_DYNDNS, PHASE_EXPORT, PHASE_DELTA_OTA,
+  PHASE_WEATHER,
+  PHASE_COUNT
+};
+const char* const LOOP_PHASE_NAMES[PHASE_COUNT] = {
+  "IDLE", "SENSORS", "WEB", "OTA", "LTE_AT", "HTTPS", "SD",
+  "TIME", "SETTINGS", "TELEMETRY", "DYNDNS", "EXPORT", "DELTA_OTA",
+  "WEATHER"
+};
+
+RTC_NOINIT_ATTR StallRecord stallRecord;   // Bleibt bei Watchdog/Panic/Software-Reset erhalten
+StallProfiler stallProfiler(stallRecord, []() -> uint32_t { return millis(); });
+esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+
+// Ereignis-Journal: Typen (Namen wie bisher in events.log)
+enum EventCode : uint8_t {
+  EVT_RESET, EVT_ALARM, EVT_TANK_ALARM, EVT_EMAIL_SENT, EVT_RELAY, EVT_AERATION_DAILY,
+  EVT_DAILY_RESET, EVT_LOW_MEMORY, EVT_EXPORT, EVT_OTA_CONFIRMED, EVT_OTA_ROLLBACK,
+  EVT_OTA_DELTA, EVT_OTA_DELTA_FAIL, EVT_HEAT_FORECAST,
+  EVT_COUNT
+};
+const char* const EVENT_NAMES[EVT_COUNT] = {
+  "RESET", "ALARM", "TANK_ALARM", "EMAIL_SENT", "RELAY", "AERATION_DAILY",
+  "DAILY_RESET", "LOW_MEMORY", "EXPORT", "OTA_CONFIRMED", "OTA_ROLLBACK",
+  "OTA_DELTA", "OTA_DELTA_FAIL", "HEAT_FORECAST"
+};
+
+// Tagesstatistik (Schlüssel und Nachkommastellen wie /api/history)
+const char* const STATS_KEYS[STAT_METRICS] = {"waterTemp", "airTemp", "ph", "tds", "do"};
+const uint8_t STATS_PRECISION[STAT_METRICS] = {1, 1, 2, 0, 1};
+DailyStats dailyStats;                   // Heute; day() == 0 bis zur ersten NTP-Zeit
+unsigned long lastStatsSample = 0;
+
+// Wettervorhersage: letzte gültige bleibt bei Fehlschlägen erhalten
+WeatherForecast weather;
+time_t weatherFetchedAt = 0;             // Unix-Zeit des letzten gültigen Abrufs
+unsigned long weatherInterval = WEATHER_FIRST_DELAY;  // Bis zum nächsten Abruf
+uint16_t weatherFailures = 0;            // Fehlschläge in Folge
+const char* weatherError = "";
+bool weatherRequested = false;           // POST /api/weather/refresh, Ort geändert
+bool weatherHeatLogged = false;
+
+EventJournal journal;
+portMUX_TYPE journalMux = portMUX_INITIALIZER_UNLOCKED;  // logEvent() auch aus anderen Tasks
+uint32_t eventsLost = 0;                 // Vor dem SD-Flush überschrieben
+uint32_t eventBootId = 0;                // Zufällig pro Start: Client erkennt Neustart am Cursor
+unsigned long lastEventFlush = 0;
+
+bool settingsDirty = false;
+unsigned long settingsFirstChange = 0;
+unsigned long settingsLastChange = 0;
+
+// Reihen für /api/history (Schlüssel wie im Dashboard). Speicher gibt es nur für
+// aktivierte Reihen: ohne O₂-Sensor und Turbine 3 Reihen × 1152 Byte (288 × float) weniger.
+struct HistoryChannel {
+  const char* key;
+  uint8_t precision;
+  bool enabled;                      // Feature-Flag (zur Compile-Zeit bekannt)
+  uint8_t logChannel;                // Spalte im SD-Ring (HistoryLogChannel)
+  float (*get)(const SensorSnapshot&);
+};
+
+constexpr HistoryChannel HISTORY_CHANNEL_LIST[] = {
+  {"waterTemp",    1, true,             HLOG_WATER_TEMP, [](const SensorSnapshot& s) { return s.waterTemp; }},
+  {"airTemp",      1, true,             HLOG_AIR_TEMP,   [](const SensorSnapshot& s) { return s.airTemp; }},
+  {"ph",           2, true,             HLOG_PH,         [](const SensorSnapshot& s) { return s.ph; }},
+  {"tds",          0, true,             HLOG_TDS,        [](const SensorSnapshot& s) { return s.tds; }},
+  {"do",           1, ENABLE_DO_SENSOR, HLOG_DO,         [](const SensorSnapshot& s) { return s.dissolvedOxygen; }},
+  {"flowRate",     1, ENABLE_TURBINE,   HLOG_FLOW,       [](const SensorSnapshot& s) { return s.flowRate; }},
+  {"turbinePower", 1, ENABLE_TURBINE,   HLOG_POWER,      [](const SensorSnapshot& s) { return s.turbinePower; }},
+};
+
+constexpr auto HISTORY_SERIES = selectEnabled<enabledCount(HISTORY_CHANNEL_LIST)>(HISTORY_CHANNEL_LIST);
+
 // Historie für Charts
-#define HISTORY_SIZE 288             // 24h bei 5min Intervall
+#define HISTORY_SIZE HISTORY_LOG_POINTS  // 24h bei 5min Intervall (288)
 struct HistoryBuffer {
-  float waterTemp[HISTORY_SIZE];
-  float airTemp[HISTORY_SIZE];
-  float ph[HISTORY_SIZE];
-  float tds[HISTORY_SIZE];
-  float dissolvedOxygen[HISTORY_SIZE];
-  float flowRate[HISTORY_SIZE];      // v1.6 Turbine
-  float turbinePower[HISTORY_SIZE];  // v1.6 Turbine
+  float values[HISTORY_SERIES.size()][HISTORY_SIZE];  // Reihenfolge wie HISTORY_SERIES
   unsigned long timestamp[HISTORY_SIZE];
+  uint32_t unixTime[HISTORY_SIZE];   // 0 = ohne NTP-Zeit aufgezeichnet
   int index = 0;
   bool full = false;
+  uint32_t nextSeq = 1;              // seq des nächsten Punkts (SD-Ring)
 } history;
 
+uint32_t historyRestored = 0;        // Beim Boot von SD übernommene Punkte
+uint32_t historyRestoreMs = 0;
+uint32_t historyWriteErrors = 0;
+bool historyRealign = false;         // Übernommene Punkte nach NTP-Sync zeitlich einordnen
+
+#define HISTORY_POINTS 96            // Standard-Punktzahl für /api/history (vorher jeder 3. Wert)
+
 // Timing
 unsigned long lastSensorRead = 0;
+unsigned long lastSensorCycle = 0;
 unsigned long lastLogWrite = 0;
 unsigned long lastLTECheck = 0;
 unsigned long lastHistoryUpdate = 0;
 unsigned long lastNTPSync = 0;
 unsigned long lastWeatherUpdate = 0;
-unsigned long lastTelegramCheck = 0;     // v1.6.1
 unsigned long lastDynDNSUpdate = 0;      // v1.6.1
+unsigned long lastTankCheck = 0;
+unsigned long lastTelemetryUpload = 0;
+unsigned long lastDeltaOtaCheck = 0;
 unsigned long startTime = 0;
 
 // Turbinen Flow-Messung (v1.6)
@@ -337,7 +872,34 @@ unsigned long lastTurbinePulseCount = 0;
 
 // Relay Modi: 0=Auto, 1=An, 2=Aus
 uint8_t relayModes[4] = {2, 2, 2, 0};  // 1-3: Aus, 4: Auto (Belüftung)
-bool relayStates[4] = {false, false, false, false};
+bool relayStates[4] = {false, false, false, false};  // Entspricht dem GPIO-Pegel (initPins: LOW)
+
+// Belüftungsregler (Relais 4 Auto) und Zeitpläne (Relais 1-3 Auto)
+AerationConfig aerationConfig;
+AerationController aerator;
+ActuatorStats aerationStats;               // Laufzeit Relais 4 seit Mitternacht (nur Regel-Task, sonst Snapshot)
+RelaySchedule relaySchedules[3];
+
+// Konfiguration des Regel-Tasks. Web und Telegram ändern die globalen Structs
+// feldweise in loop(); der Task liest nur seine Kopie, die markSettingsDirty()
+// unter configMux übergibt (nie ein halb geänderter Grenzwert-Satz).
+struct ControlConfig {
+  TroutParameters trout;
+  AlarmRules alarms;
+  AerationConfig aeration;
+  WeatherConfig weather;
+  RelaySchedule schedules[3];
+  CalibrationData calibration;
+};
+
+ControlConfig controlConfig;               // Nur Regel-Task (und setup() vor dem Start)
+ControlConfig pendingControlConfig;        // loop() → Task, unter configMux
+bool controlConfigChanged = false;
+portMUX_TYPE configMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Belüftungsbedarf, der noch nicht an RELAY_4 angekommen ist (Latenz-Messung)
+bool aerationDemandPending = false;
+uint32_t aerationDemandUs = 0;             // Fälligkeit der Messung, die den Bedarf zeigte
 
 // ═══════════════════════════════════════════════════════════════════════════════════
 // FORWARD DECLARATIONS
@@ -356,15 +918,23 @@ void setup() {
 
   printBanner();
   startTime = millis();
+  eventBootId = esp_random() | 1;        // 0 = Client kennt noch keinen Start
+
+  // Hänger-Analyse: vorigen Lauf aus dem RTC-Speicher übernehmen (Bericht nach initSDCard)
+  resetReason = esp_reset_reason();
+  stallProfiler.boot();
 
   initWatchdog();
   esp_task_wdt_reset();  // Watchdog zurücksetzen nach Init
 
+  loadSettings();
+  publishControlConfig();
+  takeControlConfig();                   // Erste Messung in setup() nutzt schon die Kopie
   initPins();
-  initEEPROM();
-  loadCalibration();
   initSensors();
   initSDCard();
+  reportLastReset();
+  restoreHistory();
   esp_task_wdt_reset();  // Watchdog zurücksetzen nach Sensor-Init
 
   if (ENABLE_WIFI) {
@@ -385,12 +955,15 @@ void setup() {
   esp_task_wdt_reset();  // Watchdog zurücksetzen nach WebServer-Init
 
   // Telegram Bot initialisieren (v1.6.1)
+  // Nur mit WLAN: der Bot braucht WiFiClientSecure, über LTE gibt es nur AT-HTTP
+  // (sendHTTPPost) ohne Long Polling. Früher stand hier ENABLE_WIFI || ENABLE_LTE;
+  // ohne WLAN scheiterte dann jeder getUpdates()-Verbindungsaufbau.
   #if ENABLE_TELEGRAM
-  if (ENABLE_WIFI || ENABLE_LTE) {
-    telegramClient.setInsecure();  // Für ESP32 (keine Zertifikatsprüfung)
-    bot = new UniversalTelegramBot(TELEGRAM_BOT_TOKEN, telegramClient);
-    Serial.println("✅ Telegram Bot initialisiert");
+  if (ENABLE_WIFI) {
+    initTelegram();
     esp_task_wdt_reset();
+  } else {
+    Serial.println("⚠️ Telegram braucht WLAN (ENABLE_WIFI) - Bot deaktiviert");
   }
   #endif
 
@@ -402,13 +975,29 @@ void setup() {
   }
   #endif
 
-  // Erste Messung
+  // Satelliten-Empfang starten
+  #if ENABLE_MULTI_TANK
+  initTanks();
+  esp_task_wdt_reset();
+  #endif
+
+  // Erste Messung, danach übernimmt der Regel-Task
   readAllSensors();
+  startControlTask();
   esp_task_wdt_reset();  // Watchdog zurücksetzen nach Sensor-Read
 
+  #if ENABLE_TELEMETRY
+  initTelemetry();
+  #endif
+
   // NTP-Sync wird später in loop() durchgeführt (nicht in setup(), um Watchdog zu vermeiden)
   lastNTPSync = millis() - NTP_SYNC_INTERVAL + 30000; // Erstes Sync nach 30 Sekunden
 
+  #if ENABLE_DELTA_OTA
+  checkFirmwareRollback();
+  lastDeltaOtaCheck = millis() - DELTA_OTA_CHECK_INTERVAL + 600000;  // Erste Prüfung nach 10 Minuten
+  #endif
+
   Serial.println("\n✅ ForellenWächter v" + String(FIRMWARE_VERSION) + " bereit!");
   Serial.println("══════════════════════════════════════════════\n");
   
@@ -430,6 +1019,49 @@ void printBanner() {
     ENABLE_WIFI, ENABLE_LTE, ENABLE_EMAIL_ALERTS, ENABLE_DO_SENSOR, ENABLE_SD_LOGGING);
 }
 
+const char* resetReasonName(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON:   return "POWERON";
+    case ESP_RST_EXT:       return "EXT";
+    case ESP_RST_SW:        return "SW";
+    case ESP_RST_PANIC:     return "PANIC";
+    case ESP_RST_INT_WDT:   return "INT_WDT";
+    case ESP_RST_TASK_WDT:  return "TASK_WDT";
+    case ESP_RST_WDT:       return "WDT";
+    case ESP_RST_DEEPSLEEP: return "DEEPSLEEP";
+    case ESP_RST_BROWNOUT:  return "BROWNOUT";
+    case ESP_RST_SDIO:      return "SDIO";
+    default:                return "UNKNOWN";
+  }
+}
+
+// Wo hing der vorige Lauf? Serial + Ereignis-Journal (Power-On: RTC-Speicher ungültig)
+void reportLastReset() {
+  if (!stallProfiler.hasPrevious()) {
+    Serial.printf("🩺 Reset: %s (keine Phasen-Daten)\n", resetReasonName(resetReason));
+    logEvent(EVT_RESET, resetReasonName(resetReason));
+    return;
+  }
+
+  const StallRecord& last = stallProfiler.previous();
+  char msg[200];
+  TextBuffer out(msg, sizeof(msg));
+  out.appendf("%s in %s seit %lus, %lu/%lu Durchläufe > %dms, max %lums, längste:",
+              resetReasonName(resetReason), LOOP_PHASE_NAMES[last.phase < PHASE_COUNT ? last.phase : PHASE_IDLE],
+              (unsigned long)(last.phaseEnterMs / 1000), (unsigned long)last.loopsOverBudget,
+              (unsigned long)last.loops, LOOP_BUDGET_MS, (unsigned long)last.maxLoopMs);
+
+  uint8_t slow[3];
+  uint8_t n = StallProfiler::slowest(last, slow, 3);
+  for (uint8_t i = 0; i < n; i++) {
+    out.appendf(" %s %lums", slow[i] < PHASE_COUNT ? LOOP_PHASE_NAMES[slow[i]] : "?",
+                (unsigned long)last.maxPhaseMs[slow[i]]);
+  }
+
+  Serial.printf("🩺 Reset: %s\n", msg);
+  logEvent(EVT_RESET, msg);
+}
+
 void initWatchdog() {
   esp_task_wdt_config_t wdtConfig = {
     .timeout_ms = WATCHDOG_TIMEOUT * 1000,
@@ -496,6 +1128,8 @@ void initSensors() {
   
   tempSensors.setResolution(12);
   tempSensors.setWaitForConversion(false);
+
+  initADC();
   
   // DO Sensor Initialisierung (falls aktiviert)
   if (ENABLE_DO_SENSOR) {
@@ -504,6 +1138,36 @@ void initSensors() {
   }
 }
 
+void initADC() {
+  analogReadResolution(12);
+  analogSetAttenuation(ADC_11db);
+
+  adcCalSource = buildAdcLut(adcLut);
+  buildTdsLut(tdsLut);
+
+  Serial.printf("✅ ADC-Kennlinie: %s (2048 → %u mV)\n", getAdcCalName(), adcLut.lookup(2048));
+}
+
+const char* getAdcCalName() {
+  static const char* sources[] = {"linear", "Standard-Vref", "eFuse Vref", "eFuse Two-Point"};
+  return sources[adcCalSource];
+}
+
+// Mittelwert aus 10 Messungen (Rohwert, so speichert ihn auch die Kalibrierung)
+int readAdcRaw(int pin) {
+  uint32_t sum = 0;
+  for (int i = 0; i < 10; i++) {
+    sum += analogRead(pin);
+    delay(10);
+  }
+  return (sum + 5) / 10;
+}
+
+// Mittelwert über Kennlinie in mV
+int32_t readAdcMilliVolts(int pin) {
+  return adcLut.lookup(readAdcRaw(pin));
+}
+
 void initSDCard() {
   if (!ENABLE_SD_LOGGING) return;
   
@@ -563,6 +1227,12 @@ void initOTA() {
     String type = (ArduinoOTA.getCommand() == U_FLASH) ? "Sketch" : "Filesystem";
     Serial.println("\n🔄 OTA Update gestartet: " + type);
 
+    // Ausstehende Einstellungen und Ereignisse sichern
+    if (settingsDirty) {
+      saveSettings();
+    }
+    flushEvents();
+
     // SD-Karte sicher beenden
     if (sysStatus.sdCardOK) {
       SD.end();
@@ -596,17 +1266,9 @@ void initOTA() {
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
-// EEPROM & KALIBRIERUNG
+// EINSTELLUNGEN & KALIBRIERUNG (NVS)
 // ═══════════════════════════════════════════════════════════════════════════════════
 
-void initEEPROM() {
-  if (!EEPROM.begin(EEPROM_SIZE)) {
-    Serial.println("⚠️  EEPROM Init fehlgeschlagen!");
-    return;
-  }
-  Serial.println("✅ EEPROM initialisiert");
-}
-
 uint8_t calculateChecksum(const CalibrationData& data) {
   uint8_t checksum = 0;
   const uint8_t* ptr = (const uint8_t*)&data;
@@ -616,25 +1278,94 @@ uint8_t calculateChecksum(const CalibrationData& data) {
   return checksum;
 }
 
-void loadCalibration() {
-  Serial.println("📂 Lade Kalibrierungsdaten...");
+uint32_t calculateCRC32(const uint8_t* data, size_t len) {
+  return esp_rom_crc32_le(0, data, len);
+}
 
-  EEPROM.get(0, calibration);
+// Schema v1: Kalibrierung lag im emulierten EEPROM (XOR-Checksumme)
+bool migrateLegacyEEPROM() {
+  if (!EEPROM.begin(EEPROM_SIZE)) return false;
 
-  if (calibration.magic != EEPROM_MAGIC) {
-    Serial.println("   Keine gültigen Daten, verwende Standardwerte");
-    calibration.magic = EEPROM_MAGIC;
-    saveCalibration();
-    return;
+  CalibrationData legacy;
+  EEPROM.get(0, legacy);
+  EEPROM.end();
+
+  if (legacy.magic != EEPROM_MAGIC || calculateChecksum(legacy) != legacy.checksum) {
+    return false;
+  }
+
+  calibration = legacy;
+  Serial.println("   Kalibrierung aus EEPROM (Schema v1) übernommen");
+  return true;
+}
+
+void applySettings(const PersistedSettings& cfg) {
+  troutParams = cfg.trout;
+  calibration = cfg.calibration;
+  memcpy(relayModes, cfg.relayModes, sizeof(relayModes));
+  alarmRules = cfg.alarms;
+  aerationConfig = cfg.aeration;
+  memcpy(relaySchedules, cfg.schedules, sizeof(relaySchedules));
+  weatherConfig = cfg.weather;
+  weatherConfig.location[sizeof(weatherConfig.location) - 1] = '\0';
+}
+
+void collectSettings(PersistedSettings& cfg) {
+  cfg.trout = troutParams;
+  cfg.calibration = calibration;
+  memcpy(cfg.relayModes, relayModes, sizeof(relayModes));
+  cfg.alarms = alarmRules;
+  cfg.aeration = aerationConfig;
+  memcpy(cfg.schedules, relaySchedules, sizeof(relaySchedules));
+  cfg.weather = weatherConfig;
+}
+
+void loadSettings() {
+  Serial.println("📂 Lade Einstellungen...");
+
+  Preferences prefs;
+  prefs.begin(SETTINGS_NAMESPACE, true);
+
+  uint8_t buffer[sizeof(SettingsHeader) + sizeof(PersistedSettings)];
+  size_t len = prefs.getBytes("cfg", buffer, sizeof(buffer));
+  prefs.end();
+
+  SettingsHeader header;
+  bool valid = len >= sizeof(SettingsHeader);
+  if (valid) {
+    memcpy(&header, buffer, sizeof(header));
+    valid = header.magic == EEPROM_MAGIC &&
+            header.length <= len - sizeof(SettingsHeader) &&
+            calculateCRC32(buffer + sizeof(SettingsHeader), header.length) == header.crc;
   }
 
-  uint8_t checksum = calculateChecksum(calibration);
-  if (checksum != calibration.checksum) {
-    Serial.println("⚠️  Checksumme ungültig, verwende Standardwerte");
+  if (!valid) {
+    if (len > 0) {
+      Serial.println("⚠️  Einstellungen ungültig (CRC), verwende Standardwerte");
+    } else if (!migrateLegacyEEPROM()) {
+      Serial.println("   Keine gespeicherten Daten, verwende Standardwerte");
+    }
+    saveSettings();
     return;
   }
 
-  Serial.println("✅ Kalibrierungsdaten geladen");
+  // Ältere Schemata sind Präfixe des aktuellen (Felder werden nur angehängt):
+  // fehlende Felder behalten ihre Standardwerte
+  PersistedSettings cfg;
+  collectSettings(cfg);
+  memcpy(&cfg, buffer + sizeof(SettingsHeader), min((size_t)header.length, sizeof(cfg)));
+  applySettings(cfg);
+
+  #if ENABLE_MULTI_TANK
+  loadTankSettings();                // Eigener Blob, fehlt bis Schema v2
+  #endif
+
+  if (header.version != SETTINGS_SCHEMA_VERSION) {
+    Serial.printf("   Schema v%u → v%u migriert\n", header.version, SETTINGS_SCHEMA_VERSION);
+    saveSettings();
+  }
+
+  Serial.println("✅ Einstellungen geladen");
   if (calibration.ph_calibrated) {
     Serial.println("   pH: kalibriert ✓");
   }
@@ -646,11 +1377,98 @@ void loadCalibration() {
   }
 }
 
+// Schreibt alle Einstellungen als ein Blob (ein einziger NVS-Commit)
+void saveSettings() {
+  uint8_t buffer[sizeof(SettingsHeader) + sizeof(PersistedSettings)];
+
+  PersistedSettings cfg;
+  collectSettings(cfg);
+  cfg.calibration.checksum = calculateChecksum(calibration);
+
+  SettingsHeader header;
+  header.magic = EEPROM_MAGIC;
+  header.version = SETTINGS_SCHEMA_VERSION;
+  header.length = sizeof(PersistedSettings);
+  header.crc = calculateCRC32((const uint8_t*)&cfg, sizeof(cfg));
+
+  memcpy(buffer, &header, sizeof(header));
+  memcpy(buffer + sizeof(header), &cfg, sizeof(cfg));
+
+  Preferences prefs;
+  prefs.begin(SETTINGS_NAMESPACE, false);
+  prefs.putBytes("cfg", buffer, sizeof(buffer));
+  prefs.end();
+
+  #if ENABLE_MULTI_TANK
+  saveTankSettings();
+  #endif
+
+  settingsDirty = false;
+  Serial.println("💾 Einstellungen gespeichert");
+}
+
+#if ENABLE_MULTI_TANK
+// Becken-Grenzwerte: eigener Blob "tanks" (Header + CRC wie "cfg"), Größe je nach MAX_TANKS
+void loadTankSettings() {
+  uint8_t buffer[sizeof(SettingsHeader) + sizeof(tankParams)];
+  Preferences prefs;
+  prefs.begin(SETTINGS_NAMESPACE, true);
+  size_t len = prefs.getBytes("tanks", buffer, sizeof(buffer));
+  prefs.end();
+
+  SettingsHeader header;
+  if (len < sizeof(header)) return;
+  memcpy(&header, buffer, sizeof(header));
+  if (header.magic != EEPROM_MAGIC || header.length > len - sizeof(header) ||
+      calculateCRC32(buffer + sizeof(header), header.length) != header.crc) {
+    Serial.println("⚠️  Becken-Grenzwerte ungültig (CRC), verwende Standardwerte");
+    return;
+  }
+  // Weniger Becken gespeichert als MAX_TANKS → Rest behält Standardwerte
+  memcpy(tankParams, buffer + sizeof(header), min((size_t)header.length, sizeof(tankParams)));
+}
+
+void saveTankSettings() {
+  uint8_t buffer[sizeof(SettingsHeader) + sizeof(tankParams)];
+  SettingsHeader header;
+  header.magic = EEPROM_MAGIC;
+  header.version = SETTINGS_SCHEMA_VERSION;
+  header.length = sizeof(tankParams);
+  header.crc = calculateCRC32((const uint8_t*)tankParams, sizeof(tankParams));
+  memcpy(buffer, &header, sizeof(header));
+  memcpy(buffer + sizeof(header), tankParams, sizeof(tankParams));
+
+  Preferences prefs;
+  prefs.begin(SETTINGS_NAMESPACE, false);
+  prefs.putBytes("tanks", buffer, sizeof(buffer));
+  prefs.end();
+}
+#endif
+
+// Änderung vormerken - mehrere UI-Änderungen werden zu einem Commit zusammengefasst
+void markSettingsDirty() {
+  unsigned long now = millis();
+  if (!settingsDirty) {
+    settingsFirstChange = now;
+  }
+  settingsDirty = true;
+  settingsLastChange = now;
+  publishControlConfig();  // Jede Einstellungsänderung endet hier: Kopie an den Regel-Task
+}
+
+void handleSettingsCommit() {
+  if (!settingsDirty) return;
+
+  unsigned long now = millis();
+  if (now - settingsLastChange >= SETTINGS_COMMIT_DELAY ||
+      now - settingsFirstChange >= SETTINGS_COMMIT_MAX_DELAY) {
+    StallScope phase(stallProfiler, PHASE_SETTINGS);
+    saveSettings();
+  }
+}
+
 void saveCalibration() {
-  calibration.checksum = calculateChecksum(calibration);
-  EEPROM.put(0, calibration);
-  EEPROM.commit();
-  Serial.println("💾 Kalibrierungsdaten gespeichert");
+  markSettingsDirty();
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -660,6 +1478,7 @@ void saveCalibration() {
 void initLTE() {
   Serial.println("📡 LTE wird initialisiert...");
 
+  LTESerial.setRxBufferSize(LTE_HTTP_READ_SIZE + 256);  // Ganzer AT+HTTPREAD-Block passt in den Puffer
   LTESerial.begin(115200, SERIAL_8N1, LTE_RX, LTE_TX);
   delay(1000);
 
@@ -708,6 +1527,7 @@ void initLTE() {
 }
 
 String sendATCommand(const char* cmd, int timeout) {
+  StallScope phase(stallProfiler, PHASE_LTE_AT);
   LTESerial.println(cmd);
 
   String response = "";
@@ -768,6 +1588,14 @@ void checkLTEConnection() {
 }
 
 bool sendHTTPRequest(const char* url, const char* payload) {
+  return sendHTTPPost(url, (const uint8_t*)payload, strlen(payload), "application/json");
+}
+
+bool isInternetAvailable() {
+  return sysStatus.lteConnected || WiFi.status() == WL_CONNECTED;
+}
+
+bool sendHTTPPost(const char* url, const uint8_t* data, size_t len, const char* contentType) {
   // WiFi STA verbunden? (AP reicht nicht für externe URLs)
   bool wifiStaConnected = (WiFi.status() == WL_CONNECTED);
   
@@ -777,20 +1605,47 @@ bool sendHTTPRequest(const char* url, const char* payload) {
   }
   
   // Versuche erst WiFi STA, dann LTE
+  WiFiClientSecure* client = nullptr;
+  if (wifiStaConnected && HttpsPool::isHttps(url)) {
+    // HTTPS über Keep-Alive Pool (kein Handshake pro Request)
+    StallScope phase(stallProfiler, PHASE_HTTPS);
+    client = httpsPool.acquire(url);
+    if (!client) {
+      // Kein TLS-Platz frei oder Handshake fehlgeschlagen: nicht ungesichert am
+      // Pool vorbei verbinden. Über LTE versuchen, sonst meldet der Aufrufer den
+      // Fehler (Telemetrie bleibt dann z.B. im SD-Spool)
+      if (DEBUG_MODE) Serial.println("⚠️  WiFi HTTPS: keine TLS-Verbindung aus dem Pool");
+      if (!sysStatus.lteConnected) return false;
+      wifiStaConnected = false;
+    }
+  }
+
   if (wifiStaConnected) {
+    StallScope phase(stallProfiler, PHASE_HTTPS);
     HTTPClient http;
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
+    http.setReuse(true);
+    if (client) {
+      http.begin(*client, url);
+    } else {
+      http.begin(url);  // Nur http://
+    }
+    http.addHeader("Content-Type", contentType);
     http.setTimeout(10000);  // 10 Sekunden Timeout
     
-    int httpCode = http.POST(payload);
+    int httpCode = http.POST((uint8_t*)data, len);
     http.end();
+    if (client) httpsPool.release(client, httpCode > 0);
     
     if (DEBUG_MODE) Serial.printf("📡 WiFi HTTP: %d\n", httpCode);
     return httpCode >= 200 && httpCode < 300;
   }
   
-  // LTE HTTP Request über AT-Befehle (SIM7600)
+  // LTE HTTP Request über AT-Befehle (SIM7600). Hält ein Delta-Update die HTTP-Sitzung,
+  // würde HTTPINIT/HTTPTERM sie beenden - dann später erneut (Telemetrie bleibt im Spool)
+  if (sysStatus.lteConnected && lteHttpHeld) {
+    if (DEBUG_MODE) Serial.println("📡 LTE HTTP: Modem belegt (Delta-Update)");
+    return false;
+  }
   if (sysStatus.lteConnected) {
     if (DEBUG_MODE) Serial.println("📡 LTE HTTP Request...");
 
@@ -804,16 +1659,17 @@ bool sendHTTPRequest(const char* url, const char* payload) {
     sendATCommand(urlCmd.c_str(), 1000);
 
     // Content-Type setzen
-    sendATCommand("AT+HTTPPARA=\"CONTENT\",\"application/json\"", 500);
+    String contentCmd = "AT+HTTPPARA=\"CONTENT\",\"" + String(contentType) + "\"";
+    sendATCommand(contentCmd.c_str(), 500);
 
     // Datenlänge angeben und Daten senden
-    String dataCmd = "AT+HTTPDATA=" + String(strlen(payload)) + ",10000";
+    String dataCmd = "AT+HTTPDATA=" + String(len) + ",10000";
     String dataResponse = sendATCommand(dataCmd.c_str(), 2000);
     esp_task_wdt_reset();
 
     // Warten auf DOWNLOAD prompt
     if (dataResponse.indexOf("DOWNLOAD") != -1) {
-      LTESerial.print(payload);
+      LTESerial.write(data, len);
       delay(1000);
     }
 
@@ -833,90 +1689,215 @@ bool sendHTTPRequest(const char* url, const char* payload) {
   return false;
 }
 
+// Liest eine Antwortzeile des Modems (ohne \r\n); false bei Timeout
+bool readModemLine(char* line, size_t size, uint32_t timeoutMs) {
+  size_t len = 0;
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    while (LTESerial.available()) {
+      char c = LTESerial.read();
+      if (c == '\n') {
+        if (len == 0) continue;      // Leerzeilen überspringen
+        line[len] = '\0';
+        return true;
+      }
+      if (c != '\r' && len < size - 1) line[len++] = c;
+    }
+    esp_task_wdt_reset();
+    delay(1);
+  }
+  line[len] = '\0';
+  return false;
+}
+
+// Wartet auf eine Zeile mit bestimmtem Anfang (im Gegensatz zu sendATCommand ohne feste Wartezeit)
+bool waitModemLine(const char* prefix, char* line, size_t size, uint32_t timeoutMs) {
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    if (!readModemLine(line, size, timeoutMs - (millis() - start))) return false;
+    if (strncmp(line, prefix, strlen(prefix)) == 0) return true;
+    if (strcmp(line, "ERROR") == 0) return false;
+  }
+  return false;
+}
+
+bool readModemBytes(uint8_t* buf, size_t len, uint32_t timeoutMs) {
+  size_t got = 0;
+  unsigned long start = millis();
+  while (got < len && millis() - start < timeoutMs) {
+    if (LTESerial.available()) {
+      got += LTESerial.read(buf + got, len - got);
+    } else {
+      delay(1);
+    }
+  }
+  return got == len;
+}
+
+// GET auf die mit AT+HTTPPARA gesetzte URL; Body liegt danach im Modem-Puffer.
+// Liefert den HTTP-Status, -1 bei Timeout/Modemfehler.
+int lteHttpGet(uint32_t& bodyLen) {
+  LTESerial.println("AT+HTTPACTION=0");
+  char line[64];
+  if (!waitModemLine("+HTTPACTION:", line, sizeof(line), 30000)) return -1;
+
+  int method = 0, status = 0;
+  unsigned long len = 0;
+  if (sscanf(line, "+HTTPACTION: %d,%d,%lu", &method, &status, &len) != 3) return -1;
+  bodyLen = len;
+  return status;
+}
+
+// Antwort: "+HTTPREAD: DATA,<n>" / n Bytes / "+HTTPREAD: 0"
+bool lteHttpRead(uint32_t offset, uint8_t* buf, size_t len) {
+  char cmd[40];
+  snprintf(cmd, sizeof(cmd), "AT+HTTPREAD=%lu,%u", (unsigned long)offset, (unsigned)len);
+  LTESerial.println(cmd);
+
+  char line[48];
+  if (!waitModemLine("+HTTPREAD:", line, sizeof(line), 5000)) return false;
+  const char* count = strchr(line, ',');
+  if (!count || (size_t)atol(count + 1) != len) return false;
+  if (!readModemBytes(buf, len, 5000)) return false;
+
+  waitModemLine("+HTTPREAD: 0", line, sizeof(line), 2000);
+  return true;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════════════
 // E-MAIL FUNKTIONEN
 // ═══════════════════════════════════════════════════════════════════════════════════
 
-void sendEmailAlert(String subject, String message) {
+void sendEmailAlert(const char* subject, const char* message) {
   if (!ENABLE_EMAIL_ALERTS) return;
   
   // Cooldown prüfen (overflow-sicher)
-  unsigned long cooldownMs = (unsigned long)EMAIL_COOLDOWN_MIN * 60UL * 1000UL;
+  unsigned long cooldownMs = (unsigned long)alarmRules.emailCooldownMin * 60UL * 1000UL;
   if (sysStatus.lastEmailSent > 0 && (millis() - sysStatus.lastEmailSent) < cooldownMs) {
     if (DEBUG_MODE) Serial.println("📧 E-Mail Cooldown aktiv");
     return;
   }
   
   // JSON Payload für IFTTT/Webhook
-  StaticJsonDocument<512> doc;
-  doc["value1"] = subject;
-  doc["value2"] = message;
-  doc["value3"] = getTimestamp();
+  char payload[1024];
+  TextBuffer out(payload, sizeof(payload));
+  out.append("{\"value1\":");
+  out.appendJsonString(subject);
+  out.append(",\"value2\":");
+  out.appendJsonString(message);
+  out.append(",\"value3\":");
+  out.appendJsonString(getTimestamp().c_str());
+  out.append("}");
   
-  String payload;
-  serializeJson(doc, payload);
-  
-  if (sendHTTPRequest(EMAIL_WEBHOOK_URL, payload.c_str())) {
+  if (sendHTTPRequest(EMAIL_WEBHOOK_URL, payload)) {
     sysStatus.lastEmailSent = millis();
-    Serial.printf("📧 E-Mail gesendet: %s\n", subject.c_str());
-    logEvent("EMAIL_SENT", subject);
+    Serial.printf("📧 E-Mail gesendet: %s\n", subject);
+    logEvent(EVT_EMAIL_SENT, subject);
   } else {
     Serial.println("⚠️  E-Mail Versand fehlgeschlagen");
   }
 }
 
-void checkAndSendAlerts() {
-  if (!sensors.alarmActive) return;
-  
-  String subject = "🚨 ForellenWächter ALARM";
-  String message = "ALARM: " + sensors.alarmReason + "\n\n";
-  message += "Aktuelle Werte:\n";
-  message += "- Wassertemperatur: " + String(sensors.waterTemp, 1) + "°C\n";
-  message += "- Lufttemperatur: " + String(sensors.airTemp, 1) + "°C\n";
-  message += "- pH-Wert: " + String(sensors.ph, 2) + "\n";
-  message += "- TDS: " + String(sensors.tds, 0) + " ppm\n";
-  if (ENABLE_DO_SENSOR) {
-    message += "- Sauerstoff: " + String(sensors.dissolvedOxygen, 1) + " mg/L\n";
-  }
-  message += "- Wasserlevel: " + String(sensors.waterLevelOK ? "OK" : "NIEDRIG") + "\n";
-  
-  sendEmailAlert(subject, message);
+// Läuft in loop() (Alarm-Meldung aus dem Regel-Task)
+void checkAndSendAlerts(const char* reason) {
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  char message[768];
+  TextBuffer out(message, sizeof(message));
+  out.appendf("ALARM: %s\n\nAktuelle Werte:\n", reason);
+  writeTextFields(out, SENSOR_FIELDS, snap, GROUP_TEMP | GROUP_WATER | GROUP_POWER, "- ");
+
+  sendEmailAlert("🚨 ForellenWächter ALARM", message);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
 // SENSOR FUNKTIONEN
 // ═══════════════════════════════════════════════════════════════════════════════════
 
+// Alle Kanäle sofort lesen (Start, Kalibrierung)
 void readAllSensors() {
   if (TEST_MODE) {
     generateTestData();
     return;
   }
 
-  readTemperatures();
-  readPH();
-  readTDS();
-  readWaterLevel();
+  uint32_t now = millis();
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (!SAMPLE_CHANNELS[ch].enabled) continue;
+    bool nearLimit = false;
+    float value = readChannel(ch, nearLimit);
+    samplers[ch].record(SAMPLE_CHANNELS[ch].policy, value, nearLimit, now);
+  }
+
+  sensors.timestamp = now;
+  publishSensorSnapshot();
 
-  if (ENABLE_DO_SENSOR) {
-    readDissolvedOxygen();
+  if (DEBUG_MODE) {
+    printSensorValues();
   }
+}
 
-  // Turbinen- und Batterie-Monitoring (v1.6)
-  if (ENABLE_TURBINE) {
-    readFlowRate();
-    calculateTurbinePower();
+// Nur fällige Kanäle lesen; true = mindestens ein Wert ist neu
+bool readDueSensors() {
+  uint32_t now = millis();
+
+  if (TEST_MODE) {
+    static uint32_t lastTestData = 0;
+    if (now - lastTestData < SENSOR_INTERVAL) return false;
+    lastTestData = now;
+    generateTestData();
+    return true;
   }
 
-  if (ENABLE_BATTERY_MONITOR) {
-    readBatteryVoltage();
+  bool updated = false;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (!SAMPLE_CHANNELS[ch].enabled || !samplers[ch].due(now)) continue;
+    bool nearLimit = false;
+    float value = readChannel(ch, nearLimit);
+    samplers[ch].record(SAMPLE_CHANNELS[ch].policy, value, nearLimit, now);
+    updated = true;
   }
 
-  sensors.timestamp = millis();
+  if (updated) sensors.timestamp = now;
+  return updated;
+}
 
-  if (DEBUG_MODE) {
-    printSensorValues();
+// Kanal lesen, Wert für die Abtast-Statistik liefern und Grenzwert-Nähe melden
+float readChannel(uint8_t ch, bool& nearLimit) {
+  switch (ch) {
+    case CH_TEMPERATURE:
+      readTemperatures();
+      nearLimit = sensors.waterTemp > controlConfig.trout.tempMax - 0.5 ||
+                  sensors.waterTemp < controlConfig.trout.tempMin + 0.5;
+      return sensors.waterTemp;
+    case CH_PH:
+      readPH();
+      nearLimit = sensors.ph > controlConfig.trout.phMax - 0.2 || sensors.ph < controlConfig.trout.phMin + 0.2;
+      return sensors.ph;
+    case CH_TDS:
+      readTDS();
+      nearLimit = sensors.tds > controlConfig.trout.tdsMax * 0.9;
+      return sensors.tds;
+    case CH_DO:
+      readDissolvedOxygen();
+      nearLimit = sensors.dissolvedOxygen < controlConfig.trout.doOptimal;  // Regler aktiv
+      return sensors.dissolvedOxygen;
+    case CH_LEVEL:
+      readWaterLevel();
+      nearLimit = !sensors.waterLevelOK;
+      return sensors.waterLevelOK ? 1 : 0;
+    case CH_FLOW:
+      readFlowRate();
+      calculateTurbinePower();
+      nearLimit = sensors.flowRate < controlConfig.alarms.flowMin + 1.0;
+      return sensors.flowRate;
+    case CH_BATTERY:
+      readBatteryVoltage();
+      nearLimit = sensors.batteryVoltage < controlConfig.alarms.batteryWarning + 0.3;
+      return sensors.batteryVoltage;
   }
+  return 0;
 }
 
 void generateTestData() {
@@ -963,75 +1944,77 @@ void readTemperatures() {
 }
 
 void readPH() {
-  // Mehrere Messungen für Stabilität
-  long sum = 0;
-  for (int i = 0; i < 10; i++) {
-    sum += analogRead(PH_PIN);
-    delay(10);
-  }
-  float rawValue = sum / 10.0;
-
-  // Kalibrierte Messung verwenden
-  if (calibration.ph_calibrated) {
-    sensors.ph = (calibration.ph_slope * rawValue) + calibration.ph_offset;
+  const CalibrationData& cal = controlConfig.calibration;  // Kopie des Regel-Tasks
+  int32_t mv = readAdcMilliVolts(PH_PIN);
+  int32_t ph100;
+
+  // Kalibrierte Messung verwenden (Pufferpunkte über die Kennlinie in mV)
+  if (cal.ph_calibrated && cal.ph_buffer1_adc != cal.ph_buffer2_adc) {
+    ph100 = linearMv(mv,
+                     adcLut.lookup(cal.ph_buffer1_adc), lroundf(cal.ph_buffer1_value * 100),
+                     adcLut.lookup(cal.ph_buffer2_adc), lroundf(cal.ph_buffer2_value * 100));
   } else {
-    // Fallback: Standard-Kalibrierung
-    float voltage = rawValue * 3.3 / 4095.0;
-    sensors.ph = 7.0 + (2.5 - voltage) * 3.5;
+    // Fallback: Standard-Kalibrierung pH = 7.0 + (2.5 V - U) * 3.5
+    ph100 = 700 + (2500 - mv) * 35 / 100;
   }
 
-  sensors.ph = constrain(sensors.ph, 0.0, 14.0);
+  sensors.ph = constrain(ph100 / 100.0f, 0.0, 14.0);
 }
 
 void readTDS() {
-  long sum = 0;
-  for (int i = 0; i < 10; i++) {
-    sum += analogRead(TDS_PIN);
-    delay(10);
+  const CalibrationData& cal = controlConfig.calibration;  // Kopie des Regel-Tasks
+  int32_t mv = readAdcMilliVolts(TDS_PIN);
+  int32_t compMv = tdsCompensateMv(mv, lroundf(sensors.waterTemp * 10));
+  int32_t tds10;
+
+  // Kalibrierte Messung verwenden (Referenzpunkt über die Kennlinie in mV)
+  int32_t refMv = cal.tds_calibrated ? adcLut.lookup(cal.tds_reference_adc) : 0;
+  if (refMv > 0) {
+    tds10 = compMv * lroundf(cal.tds_reference_value * 10) / refMv;
+  } else {
+    // Fallback: Standard-Kurve als Tabelle
+    tds10 = tdsLut.lookup(compMv);
   }
-  float rawValue = sum / 10.0;
 
-  // Kalibrierte Messung verwenden
-  if (calibration.tds_calibrated) {
-    // Einfache Faktoren-Multiplikation mit Temperaturkompensation
-    float tempCoeff = 1.0 + 0.02 * (sensors.waterTemp - 25.0);
-    sensors.tds = (rawValue * calibration.tds_factor) / tempCoeff;
-  } else {
-    // Fallback: Standard-Formel
-    float voltage = rawValue * 3.3 / 4095.0;
-    float tempCoeff = 1.0 + 0.02 * (sensors.waterTemp - 25.0);
-    float compVoltage = voltage / tempCoeff;
-    sensors.tds = (133.42 * pow(compVoltage, 3) -
-                   255.86 * pow(compVoltage, 2) +
-                   857.39 * compVoltage) * 0.5;
+  sensors.tds = constrain(tds10 / 10.0f, 0.0, 1000.0);
+}
+
+// pH-Gerade, wie readPH() sie anwendet: pH = offset + slope × U (slope in pH/V)
+void phLineVolts(const CalibrationData& cal, float& slope, float& offset) {
+  float mv1 = 2500, ph1 = 7.0, mv2 = 1500, ph2 = 10.5;  // Standard: 7.0 + (2.5 V - U) * 3.5
+  if (cal.ph_calibrated && cal.ph_buffer1_adc != cal.ph_buffer2_adc) {
+    mv1 = adcLut.lookup(cal.ph_buffer1_adc);
+    ph1 = cal.ph_buffer1_value;
+    mv2 = adcLut.lookup(cal.ph_buffer2_adc);
+    ph2 = cal.ph_buffer2_value;
   }
+  slope = mv2 != mv1 ? (ph2 - ph1) / (mv2 - mv1) * 1000 : 0;
+  offset = ph1 - slope * mv1 / 1000;
+}
 
-  sensors.tds = constrain(sensors.tds, 0.0, 1000.0);
+// TDS-Faktor, wie readTDS() ihn anwendet: ppm pro mV (auf 25 °C kompensiert).
+// 0 = unkalibriert, dann gilt die Standard-Kurve (keine Gerade).
+float tdsFactorPerMv(const CalibrationData& cal) {
+  int32_t refMv = cal.tds_calibrated ? adcLut.lookup(cal.tds_reference_adc) : 0;
+  return refMv > 0 ? cal.tds_reference_value / refMv : 0;
 }
 
 void readDissolvedOxygen() {
   // DFRobot Gravity DO Sensor
   // Kalibrierung erforderlich!
-  
-  long sum = 0;
-  for (int i = 0; i < 10; i++) {
-    sum += analogRead(DO_PIN);
-    delay(10);
-  }
-  float rawValue = sum / 10.0;
-  float voltage = rawValue * 3.3 / 4095.0;
-  
+  int32_t mv = readAdcMilliVolts(DO_PIN);
+
   // DO Berechnung (vereinfacht, muss kalibriert werden!)
   // Sättigungsspannung bei Kalibrierpunkt
-  const float V_SATURATION = 1.5;  // Anpassen!
-  const float DO_SATURATION = 9.09; // mg/L bei 20°C
-  
-  // Temperaturkompensation für Sättigung
-  float tempCompensation = 1.0 - 0.024 * (sensors.waterTemp - 20.0);
-  float doSaturation = DO_SATURATION * tempCompensation;
-  
-  sensors.dissolvedOxygen = (voltage / V_SATURATION) * doSaturation;
-  sensors.dissolvedOxygen = constrain(sensors.dissolvedOxygen, 0.0, 20.0);
+  const int32_t V_SATURATION_MV = 1500;  // Anpassen!
+  const int32_t DO_SATURATION_100 = 909; // 9.09 mg/L bei 20°C
+
+  // Temperaturkompensation für Sättigung: 1 - 0.024 * (T - 20)
+  int32_t temp10 = lroundf(sensors.waterTemp * 10);
+  int32_t doSaturation100 = (DO_SATURATION_100 * (10000 - 24 * (temp10 - 200)) + 5000) / 10000;
+
+  int32_t do100 = (mv * doSaturation100 + V_SATURATION_MV / 2) / V_SATURATION_MV;
+  sensors.dissolvedOxygen = constrain(do100 / 100.0f, 0.0, 20.0);
 }
 
 void readWaterLevel() {
@@ -1053,13 +2036,14 @@ void readFlowRate() {
   unsigned long currentTime = millis();
   unsigned long elapsed = currentTime - lastFlowCalc;
 
-  // Nur alle 1 Sekunde berechnen
+  // Höchstens jede Sekunde berechnen; bei ruhigem Durchfluss liest die adaptive
+  // Abtastung seltener, die Impulse müssen dann über die ganze Zeit gemittelt werden
   if (elapsed >= 1000) {
     unsigned long pulses = turbinePulseCount - lastTurbinePulseCount;
     lastTurbinePulseCount = turbinePulseCount;
 
     // Durchfluss berechnen: (Impulse / Zeit[s]) / (Impulse pro Liter) * 60
-    float litersPerSec = pulses / (float)TURBINE_PULSES_PER_LITER;
+    float litersPerSec = pulses / (elapsed / 1000.0f) / TURBINE_PULSES_PER_LITER;
     sensors.flowRate = litersPerSec * 60.0;  // L/min
 
     // Speichere Pulse-Count in Sensor-Daten
@@ -1072,27 +2056,18 @@ void readFlowRate() {
 void readBatteryVoltage() {
   if (!ENABLE_BATTERY_MONITOR) return;
 
-  // ADC-Wert mehrfach lesen für Stabilität
-  long sum = 0;
-  for (int i = 0; i < 10; i++) {
-    sum += analogRead(BATTERY_PIN);
-    delay(10);
-  }
-  float adcValue = sum / 10.0;
-
-  // ADC zu Spannung: 0-4095 → 0-3.3V
-  float adcVoltage = adcValue * 3.3 / 4095.0;
-
-  // Spannungsteiler: V_batt = V_adc * (R1 + R2) / R2
-  sensors.batteryVoltage = adcVoltage * (BATTERY_R1 + BATTERY_R2) / BATTERY_R2;
+  // ADC (Kennlinie) → Spannungsteiler: V_batt = V_adc * (R1 + R2) / R2
+  int32_t batteryMv = applyDividerMv(readAdcMilliVolts(BATTERY_PIN), BATTERY_DIVIDER_Q10);
+  sensors.batteryVoltage = batteryMv / 1000.0f;
 
   // Batterie-Prozent berechnen (linear zwischen EMPTY und FULL)
-  sensors.batteryPercent = (sensors.batteryVoltage - BATTERY_EMPTY) /
-                           (BATTERY_FULL - BATTERY_EMPTY) * 100.0;
-  sensors.batteryPercent = constrain(sensors.batteryPercent, 0.0, 100.0);
+  const int32_t emptyMv = BATTERY_EMPTY * 1000;
+  const int32_t fullMv = BATTERY_FULL * 1000;
+  int32_t percent = (batteryMv - emptyMv) * 100 / (fullMv - emptyMv);
+  sensors.batteryPercent = constrain(percent, 0, 100);
 
   // Low-Battery Warnung
-  sensors.batteryLow = (sensors.batteryVoltage < BATTERY_WARNING);
+  sensors.batteryLow = (sensors.batteryVoltage < controlConfig.alarms.batteryWarning);
 }
 
 void calculateTurbinePower() {
@@ -1115,33 +2090,18 @@ void calculateTurbinePower() {
 }
 
 void printSensorValues() {
-  Serial.println("────────────────────────────────────────────────");
-  Serial.printf("💧 Wasser: %.1f°C  ", sensors.waterTemp);
-  Serial.printf("🌡️ Luft: %.1f°C\n", sensors.airTemp);
-  Serial.printf("🧪 pH: %.2f       ", sensors.ph);
-  Serial.printf("📊 TDS: %.0f ppm\n", sensors.tds);
-  if (ENABLE_DO_SENSOR) {
-    Serial.printf("🫧 O₂: %.1f mg/L\n", sensors.dissolvedOxygen);
-  }
-  Serial.printf("🌊 Level: %s     ", sensors.waterLevelOK ? "OK" : "NIEDRIG!");
-  Serial.printf("💨 Belüftung: %s\n", sensors.aerationActive ? "AN" : "AUS");
-
-  // Turbinen-Daten (v1.6)
-  if (ENABLE_TURBINE) {
-    Serial.printf("⚡ Flow: %.1f L/min  ", sensors.flowRate);
-    Serial.printf("Power: %.1fW\n", sensors.turbinePower);
-  }
-
-  // Batterie-Daten (v1.6)
-  if (ENABLE_BATTERY_MONITOR) {
-    Serial.printf("🔋 Batterie: %.2fV (%.0f%%)", sensors.batteryVoltage, sensors.batteryPercent);
-    if (sensors.batteryLow) Serial.printf(" [LOW!]");
-    Serial.println();
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  char text[768];
+  TextBuffer out(text, sizeof(text));
+  writeTextFields(out, SENSOR_FIELDS, snap);
+  if (snap.alarmActive) {
+    out.appendf("🚨 Grund: %s\n", snap.alarmReason);
   }
 
-  if (sensors.alarmActive) {
-    Serial.printf("🚨 ALARM: %s\n", sensors.alarmReason.c_str());
-  }
+  Serial.println("────────────────────────────────────────────────");
+  Serial.print(text);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -1154,40 +2114,40 @@ void checkAlarms() {
   char tempBuf[64];
 
   // Temperatur
-  if (sensors.waterTemp > troutParams.tempCritical) {
+  if (sensors.waterTemp > controlConfig.trout.tempCritical) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "Temp KRITISCH (%.1f°C); ", sensors.waterTemp);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
-  } else if (sensors.waterTemp < troutParams.tempMin) {
+  } else if (sensors.waterTemp < controlConfig.trout.tempMin) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "Temp niedrig (%.1f°C); ", sensors.waterTemp);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
-  } else if (sensors.waterTemp > troutParams.tempMax) {
+  } else if (sensors.waterTemp > controlConfig.trout.tempMax) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "Temp hoch (%.1f°C); ", sensors.waterTemp);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
   }
 
   // pH
-  if (sensors.ph < troutParams.phMin) {
+  if (sensors.ph < controlConfig.trout.phMin) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "pH niedrig (%.2f); ", sensors.ph);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
-  } else if (sensors.ph > troutParams.phMax) {
+  } else if (sensors.ph > controlConfig.trout.phMax) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "pH hoch (%.2f); ", sensors.ph);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
   }
 
   // TDS
-  if (sensors.tds > troutParams.tdsMax) {
+  if (sensors.tds > controlConfig.trout.tdsMax) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "TDS hoch (%.0fppm); ", sensors.tds);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
   }
 
   // Sauerstoff
-  if (ENABLE_DO_SENSOR && sensors.dissolvedOxygen < troutParams.doMin) {
+  if (ENABLE_DO_SENSOR && sensors.dissolvedOxygen < controlConfig.trout.doMin) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "O2 niedrig (%.1fmg/L); ", sensors.dissolvedOxygen);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
@@ -1200,7 +2160,7 @@ void checkAlarms() {
   }
 
   // Durchfluss-Alarm (v1.6)
-  if (ENABLE_TURBINE && sensors.flowRate < FLOW_MIN_ALARM) {
+  if (ENABLE_TURBINE && sensors.flowRate < controlConfig.alarms.flowMin) {
     alarm = true;
     snprintf(tempBuf, sizeof(tempBuf), "Durchfluss zu niedrig (%.1fL/min); ", sensors.flowRate);
     strncat(reasons, tempBuf, sizeof(reasons) - strlen(reasons) - 1);
@@ -1222,15 +2182,16 @@ void checkAlarms() {
   // Status aktualisieren
   bool wasAlarm = sensors.alarmActive;
   sensors.alarmActive = alarm;
-  sensors.alarmReason = String(reasons);  // Nur eine String-Zuweisung am Ende
-  
-  // Bei neuem Alarm
+  strlcpy(sensors.alarmReason, reasons, sizeof(sensors.alarmReason));
+
+  // Bei neuem Alarm: Summer und Journal sofort, Versand über die Queue in loop().
+  // Die Alarmzähler schreibt nur der Regel-Task (loop() schickt CTL_*-Befehle).
   if (alarm && !wasAlarm) {
     sysStatus.alarmCount++;
     sysStatus.dailyAlarms++;
     soundAlarm();
-    logEvent("ALARM", reasons);
-    checkAndSendAlerts();
+    logEvent(EVT_ALARM, reasons);    // Nur RAM-Journal, SD schreibt loop()
+    queueAlarmNotice(reasons);
   }
   
   // Alarm-LED
@@ -1238,25 +2199,41 @@ void checkAlarms() {
 }
 
 void controlAeration() {
-  bool shouldActivate = false;
-
-  // Automatische Belüftung bei:
-  if (sensors.waterTemp > troutParams.tempMax) {
-    shouldActivate = true;
+  // Regelgröße: Sauerstoff, ohne DO-Sensor die Wassertemperatur
+  float error, band;
+  if (ENABLE_DO_SENSOR) {
+    error = controlConfig.trout.doOptimal - sensors.dissolvedOxygen;
+    band = controlConfig.aeration.doBand;
+  } else {
+    error = sensors.waterTemp - controlConfig.trout.tempMax;
+    band = controlConfig.aeration.tempBand;
   }
 
-  if (ENABLE_DO_SENSOR && sensors.dissolvedOxygen < troutParams.doOptimal) {
-    shouldActivate = true;
+  // Hitzeperiode vorhergesagt: früher belüften, bevor das Wasser nachzieht
+  if (weatherHeat) {
+    error += ENABLE_DO_SENSOR ? controlConfig.weather.doBoost : controlConfig.weather.tempShift;
   }
 
-  if (sensors.ph < troutParams.phMin || sensors.ph > troutParams.phMax) {
-    shouldActivate = true;
-  }
+  // pH außerhalb des Bereichs (CO₂ austreiben) oder kritische Temperatur: immer belüften
+  bool force = sensors.ph < controlConfig.trout.phMin || sensors.ph > controlConfig.trout.phMax ||
+               sensors.waterTemp > controlConfig.trout.tempCritical;
 
-  sensors.aerationActive = shouldActivate;
+  // Mindest-Lauf-/Pausenzeiten werden im Regler eingehalten (force schaltet sofort ein)
+  sensors.aerationActive = aerator.update(controlConfig.aeration, error, band, force, millis());
   // Belüftungs-Relay wird in updateRelays() gesetzt
 }
 
+// Zeitplan für Relais 1-3 (ohne gültige NTP-Zeit: aus)
+bool isScheduleActive(int relay) {
+  time_t now = time(nullptr);
+  if (now < 1600000000) return false;
+
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  return scheduleActive(controlConfig.schedules[relay], timeinfo.tm_wday,
+                        timeinfo.tm_hour * 60 + timeinfo.tm_min);
+}
+
 void updateRelays() {
   // Für jedes Relay: Modus prüfen und entsprechend setzen
   int pins[4] = {RELAY_1, RELAY_2, RELAY_3, RELAY_4};
@@ -1268,8 +2245,9 @@ void updateRelays() {
       case 0:  // Auto
         if (i == 3) {  // Relay 4 = Belüftung Auto
           targetState = sensors.aerationActive;
+        } else {       // Relay 1-3 = Zeitplan
+          targetState = isScheduleActive(i);
         }
-        // Andere Relays: Auto = Aus (keine Auto-Logik)
         break;
       case 1:  // An
         targetState = true;
@@ -1279,19 +2257,82 @@ void updateRelays() {
         break;
     }
 
+    // Nur bei Zustandswechsel schreiben (kein Relais-Prellen, weniger Log-Einträge)
+    if (targetState == relayStates[i]) continue;
+
     relayStates[i] = targetState;
     digitalWrite(pins[i], targetState ? HIGH : LOW);  // Invertiert: An=HIGH, Aus=LOW
+    if (i == 3 && targetState && aerationDemandPending) recordAerationLatency(micros());
+
+    char value[16];
+    snprintf(value, sizeof(value), "R%d %s", i + 1, targetState ? "AN" : "AUS");
+    logEvent(EVT_RELAY, value);
   }
+
+  aerationStats.track(relayStates[3], millis());
+}
+
+// Tagesbilanz der Belüftung (Regel-Task, CTL_RESET_DAILY)
+void logAerationDaily() {
+  char value[96];
+  snprintf(value, sizeof(value), "Duty %.1f%%, %.0f Wh, %lu Schaltungen, %lu min",
+           aerationStats.duty() * 100, aerationStats.energyWh(controlConfig.aeration.blowerWatts),
+           (unsigned long)aerationStats.switches, (unsigned long)(aerationStats.onMs / 60000));
+  logEvent(EVT_AERATION_DAILY, value);
+  Serial.printf("💨 Belüftung: %s\n", value);
+  aerationStats.reset();
+}
+
+void fillSensorSnapshot(SensorSnapshot& snap) {
+  snap.waterTemp = sensors.waterTemp;
+  snap.airTemp = sensors.airTemp;
+  snap.ph = sensors.ph;
+  snap.tds = sensors.tds;
+  snap.dissolvedOxygen = sensors.dissolvedOxygen;
+  snap.flowRate = sensors.flowRate;
+  snap.turbinePower = sensors.turbinePower;
+  snap.turbinePulseCount = sensors.turbinePulseCount;
+  snap.batteryVoltage = sensors.batteryVoltage;
+  snap.batteryPercent = sensors.batteryPercent;
+  snap.waterLevelOK = sensors.waterLevelOK;
+  snap.aerationActive = sensors.aerationActive;
+  snap.alarmActive = sensors.alarmActive;
+  snap.batteryLow = sensors.batteryLow;
+  snap.aerationRelay = relayStates[3];
+  snap.aeration = aerationStats;
+  strlcpy(snap.alarmReason, sensors.alarmReason, sizeof(snap.alarmReason));
+  snap.timestamp = sensors.timestamp;
+}
+
+void publishSensorSnapshot() {
+  SensorSnapshot snap;
+  fillSensorSnapshot(snap);
+
+  portENTER_CRITICAL(&snapshotMux);
+  sensorSnapshot = snap;
+  portEXIT_CRITICAL(&snapshotMux);
+}
+
+void readSensorSnapshot(SensorSnapshot& out) {
+  portENTER_CRITICAL(&snapshotMux);
+  out = sensorSnapshot;
+  portEXIT_CRITICAL(&snapshotMux);
 }
 
+// 3x kurzer Piep, ohne zu blockieren (Muster läuft in serviceBuzzer())
+uint8_t buzzerSteps = 0;
+unsigned long buzzerLastStep = 0;
+
 void soundAlarm() {
-  // 3x kurzer Piep
-  for (int i = 0; i < 3; i++) {
-    digitalWrite(BUZZER_PIN, HIGH);
-    delay(200);
-    digitalWrite(BUZZER_PIN, LOW);
-    delay(200);
-  }
+  buzzerSteps = 6;
+  buzzerLastStep = millis() - 200;
+}
+
+void serviceBuzzer(unsigned long now) {
+  if (buzzerSteps == 0 || now - buzzerLastStep < 200) return;
+  buzzerSteps--;
+  digitalWrite(BUZZER_PIN, buzzerSteps % 2 ? HIGH : LOW);
+  buzzerLastStep = now;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -1299,14 +2340,16 @@ void soundAlarm() {
 // ═══════════════════════════════════════════════════════════════════════════════════
 
 void updateHistory() {
-  history.waterTemp[history.index] = sensors.waterTemp;
-  history.airTemp[history.index] = sensors.airTemp;
-  history.ph[history.index] = sensors.ph;
-  history.tds[history.index] = sensors.tds;
-  history.dissolvedOxygen[history.index] = sensors.dissolvedOxygen;
-  history.flowRate[history.index] = sensors.flowRate;           // v1.6
-  history.turbinePower[history.index] = sensors.turbinePower;   // v1.6
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+  time_t now = time(nullptr);
+
+  for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+    history.values[c][history.index] = HISTORY_SERIES[c].get(snap);
+  }
   history.timestamp[history.index] = millis();
+  history.unixTime[history.index] = now > 1600000000 ? (uint32_t)now : 0;
+  appendHistoryLog(history.index, history.nextSeq++);
 
   history.index = (history.index + 1) % HISTORY_SIZE;
   if (history.index == 0) {
@@ -1314,49 +2357,640 @@ void updateHistory() {
   }
 }
 
+// Ring-Datei einmalig mit leeren Slots anlegen (feste Offsets wie STATS_FILE)
+bool ensureHistoryLogFile() {
+  if (SD.exists(HISTORY_LOG_FILE)) return true;
+  File file = SD.open(HISTORY_LOG_FILE, FILE_WRITE);
+  if (!file) return false;
+  uint8_t zeros[sizeof(HistoryLogRecord)] = {};
+  for (int i = 0; i < HISTORY_LOG_SLOTS; i++) file.write(zeros, sizeof(zeros));
+  file.close();
+  return true;
+}
+
+// Einen Punkt in seinen Slot schreiben (26 Byte). Schlägt das fehl, fehlt die seq
+// im Ring; beim nächsten Boot kommt nur die lückenlose Kette danach zurück.
+void appendHistoryLog(int slot, uint32_t seq) {
+  if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK) return;
+  StallScope phase(stallProfiler, PHASE_SD);
+
+  HistoryLogRecord rec = {};
+  rec.seq = seq;
+  rec.time = history.unixTime[slot];
+  for (uint8_t c = 0; c < HLOG_CHANNELS; c++) rec.values[c] = historyLogEncode(NAN, c);  // Nicht aktiviert
+  for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+    uint8_t column = HISTORY_SERIES[c].logChannel;
+    rec.values[column] = historyLogEncode(history.values[c][slot], column);
+  }
+  historyLogSeal(rec);
+
+  File file;
+  if (ensureHistoryLogFile()) file = SD.open(HISTORY_LOG_FILE, "r+");
+  bool ok = file && file.seek(historyLogOffset(seq)) &&
+            file.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+  if (file) file.close();
+  if (!ok) historyWriteErrors++;
+}
+
+// Beim Boot: letzte 24h aus dem SD-Ring übernehmen. Ohne NTP-Zeit werden die
+// Punkte lückenlos vor den Start gelegt, realignHistory() korrigiert das später.
+void restoreHistory() {
+  if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK) return;
+  StallScope phase(stallProfiler, PHASE_SD);
+  unsigned long start = millis();
+  File file = SD.open(HISTORY_LOG_FILE, FILE_READ);
+  if (!file) return;
+
+  HistoryLogRange range = historyLogRestore(
+    [&file](uint32_t offset, uint8_t* buf, size_t len) -> size_t {
+      return file.seek(offset) ? file.read(buf, len) : 0;
+    },
+    [](uint32_t i, const HistoryLogRecord& rec) {
+      for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+        history.values[c][i] = historyLogDecode(rec, HISTORY_SERIES[c].logChannel);
+      }
+      history.unixTime[i] = rec.time;
+    });
+  file.close();
+
+  uint32_t count = range.count();
+  unsigned long now = millis();
+  for (uint32_t i = 0; i < count; i++) {
+    history.timestamp[i] = now - (count - i) * HISTORY_INTERVAL;
+  }
+  history.index = count % HISTORY_SIZE;
+  history.full = count == HISTORY_SIZE;
+  history.nextSeq = range.last + 1;
+  historyRestored = count;
+  historyRestoreMs = millis() - start;
+  historyRealign = count > 0;
+  if (count > 0) {
+    Serial.printf("📈 Historie wiederhergestellt: %lu Punkte (seq %lu-%lu) in %lu ms\n",
+                  (unsigned long)count, (unsigned long)range.first, (unsigned long)range.last,
+                  (unsigned long)historyRestoreMs);
+  }
+}
+
+// Erste gültige Zeit: übernommene Punkte auf ihr tatsächliches Alter setzen
+// (Ausfallzeit wird sichtbar; Punkte ohne Zeitstempel bleiben, wo sie sind)
+void realignHistory() {
+  if (!historyRealign) return;
+  time_t now = time(nullptr);
+  if (now < 1600000000) return;
+  historyRealign = false;
+
+  unsigned long ms = millis();
+  for (int i = 0; i < HISTORY_SIZE; i++) {
+    uint32_t t = history.unixTime[i];
+    if (t == 0 || t > (uint32_t)now) continue;
+    history.timestamp[i] = ms - (unsigned long)((uint32_t)now - t) * 1000;
+  }
+}
+
+// Hat die Tagesdatei eine andere Kopfzeile (Datei einer älteren Firmware oder mit
+// anderen Sensor-Flags), wird sie als JJJJ-MM-TT-1.csv (-2, ...) beiseitegelegt und
+// eine neue Datei begonnen - sonst stünden zwei Spaltenlayouts in einer Datei.
+// false = Datei wurde umbenannt.
+bool keepCsvLayout(const String& filename, const char* header) {
+  File file = SD.open(filename, FILE_READ);
+  if (!file) return true;
+  char first[512];
+  size_t n = file.readBytesUntil('\n', first, sizeof(first) - 1);
+  file.close();
+  if (n > 0 && first[n - 1] == '\r') n--;
+  first[n] = '\0';
+  if (strcmp(first, header) == 0) return true;
+
+  for (int i = 1; i < 100; i++) {
+    String old = filename.substring(0, filename.length() - 4) + "-" + String(i) + ".csv";
+    if (SD.exists(old)) continue;
+    if (!SD.rename(filename, old)) break;
+    Serial.printf("📁 CSV-Spalten geändert: %s → %s\n", filename.c_str(), old.c_str());
+    return false;
+  }
+  return true;
+}
+
 void logToSD() {
   if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK) return;
+  StallScope phase(stallProfiler, PHASE_SD);
   
   String filename = "/logs/" + getDateString() + ".csv";
+  char line[512];
+  TextBuffer out(line, sizeof(line));
+
+  // Kopfzeile aus SENSOR_FIELDS; bestehende Datei einmal pro Tag und Boot prüfen
+  static String checkedFile;
+  out.append("timestamp,");
+  writeCsvHeader(out, SENSOR_FIELDS);
+  out.append(",alarmReason");
   bool newFile = !SD.exists(filename);
+  if (!newFile && filename != checkedFile) {
+    newFile = !keepCsvLayout(filename, line);
+  }
+  checkedFile = filename;
   
   File file = SD.open(filename, FILE_APPEND);
   if (!file) return;
-  
-  // Header für neue Datei
+
   if (newFile) {
-    String header = "Timestamp,WaterTemp,AirTemp,pH,TDS,";
-    if (ENABLE_DO_SENSOR) header += "DO,";
-    header += "WaterLevel,Aeration,Alarm,AlarmReason";
-    file.println(header);
+    file.println(line);
   }
-  
+
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
   // Daten
-  String line = getTimestamp() + ",";
-  line += String(sensors.waterTemp, 2) + ",";
-  line += String(sensors.airTemp, 2) + ",";
-  line += String(sensors.ph, 2) + ",";
-  line += String(sensors.tds, 0) + ",";
-  if (ENABLE_DO_SENSOR) {
-    line += String(sensors.dissolvedOxygen, 2) + ",";
-  }
-  line += String(sensors.waterLevelOK ? 1 : 0) + ",";
-  line += String(sensors.aerationActive ? 1 : 0) + ",";
-  line += String(sensors.alarmActive ? 1 : 0) + ",";
-  line += "\"" + sensors.alarmReason + "\"";
-  
+  out.clear();
+  out.appendf("%s,", getTimestamp().c_str());
+  writeCsvRow(out, SENSOR_FIELDS, snap);
+  out.appendf(",\"%s\"", snap.alarmReason);
+
   file.println(line);
   file.close();
+
+  // Binär-Datensatz für /api/export?format=bin
+  LogRecord rec;
+  time_t now = time(nullptr);
+  rec.time = now > 1600000000 ? (uint32_t)now : 0;
+  rec.waterTemp = (int16_t)lroundf(snap.waterTemp * 100);
+  rec.airTemp = (int16_t)lroundf(snap.airTemp * 100);
+  rec.ph = (uint16_t)lroundf(constrain(snap.ph, 0, 14) * 100);
+  rec.tds = (uint16_t)constrain(lroundf(snap.tds), 0, 65535);
+  rec.dissolvedOxygen = (uint16_t)lroundf(constrain(snap.dissolvedOxygen, 0, 650) * 100);
+  rec.flowRate = (uint16_t)lroundf(constrain(snap.flowRate, 0, 650) * 100);
+  rec.turbinePower = (uint16_t)lroundf(constrain(snap.turbinePower, 0, 650) * 100);
+  rec.batteryMilliVolt = (uint16_t)lroundf(constrain(snap.batteryVoltage, 0, 65) * 1000);
+  rec.flags = (snap.waterLevelOK ? LOG_FLAG_LEVEL_OK : 0) | (snap.aerationActive ? LOG_FLAG_AERATION : 0) |
+              (snap.alarmActive ? LOG_FLAG_ALARM : 0) | (snap.batteryLow ? LOG_FLAG_BATTERY_LOW : 0);
+  rec.version = LOG_RECORD_VERSION;
+
+  filename.replace(".csv", ".bin");
+  File bin = SD.open(filename, FILE_APPEND);
+  if (bin) {
+    bin.write((const uint8_t*)&rec, sizeof(rec));
+    bin.close();
+  }
 }
 
-void logEvent(String eventType, String value) {
-  if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK) return;
-  
-  File file = SD.open("/logs/events.log", FILE_APPEND);
+// Ereignis ins RAM-Journal - kein SD-Zugriff, blockiert nicht (auch im Alarmpfad)
+void logEvent(uint8_t code, const char* value) {
+  time_t now = time(nullptr);
+  bool timeValid = now > 1600000000;
+  uint32_t t = timeValid ? (uint32_t)now : millis() / 1000;
+
+  portENTER_CRITICAL(&journalMux);
+  journal.add(code, t, timeValid ? 0 : EVENT_FLAG_NO_TIME, value);
+  portEXIT_CRITICAL(&journalMux);
+}
+
+// Zeitstempel wie bisher in events.log: lokale Zeit oder Sekunden seit Boot
+void formatEventTime(const JournalEvent& e, char* buf, size_t size) {
+  if (e.flags & EVENT_FLAG_NO_TIME) {
+    snprintf(buf, size, "%lu", (unsigned long)e.time);
+    return;
+  }
+  time_t t = e.time;
+  struct tm timeinfo;
+  localtime_r(&t, &timeinfo);
+  strftime(buf, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
+}
+
+// Offene Ereignisse gebündelt an /logs/events.log anhängen (eine Datei-Öffnung)
+void flushEvents() {
+  lastEventFlush = millis();
+
+  portENTER_CRITICAL(&journalMux);
+  uint32_t from = journal.flushedSeq() + 1;
+  uint32_t first = journal.firstSeq();
+  uint32_t to = journal.lastSeq();
+  portEXIT_CRITICAL(&journalMux);
+
+  if (from > to) return;
+  if (from < first) {
+    eventsLost += first - from;
+    from = first;
+  }
+
+  if (ENABLE_SD_LOGGING && sysStatus.sdCardOK) {
+    StallScope phase(stallProfiler, PHASE_SD);
+    File file = SD.open("/logs/events.log", FILE_APPEND);
+    if (!file) return;  // Bleibt offen, nächster Versuch im nächsten Intervall
+
+    JournalEvent e;
+    char line[160];
+    for (uint32_t seq = from; seq <= to; seq++) {
+      portENTER_CRITICAL(&journalMux);
+      bool ok = journal.get(seq, e);
+      portEXIT_CRITICAL(&journalMux);
+      if (!ok) {
+        eventsLost++;
+        continue;
+      }
+
+      char timestamp[25];
+      formatEventTime(e, timestamp, sizeof(timestamp));
+      int n = snprintf(line, sizeof(line), "%s,%s,%s\n", timestamp,
+                       e.code < EVT_COUNT ? EVENT_NAMES[e.code] : "?", e.text);
+      file.write((const uint8_t*)line, min(n, (int)sizeof(line) - 1));
+    }
+    file.close();
+  }
+
+  portENTER_CRITICAL(&journalMux);
+  journal.markFlushed(to);
+  portEXIT_CRITICAL(&journalMux);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TAGESSTATISTIK
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Lokales Datum JJJJMMTT ohne zu blockieren; 0 = noch keine NTP-Zeit
+uint32_t localDate() {
+  time_t now = time(nullptr);
+  if (now < 1600000000) return 0;
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  return (timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+}
+
+// Nach jeder Auswertung: aktuelle Werte mit der Zeit seit der letzten gewichten
+void trackDailyStats(unsigned long now) {
+  uint32_t dt = lastStatsSample ? now - lastStatsSample : 0;
+  lastStatsSample = now;
+  if (dt > 10 * SAMPLE_TICK) dt = 10 * SAMPLE_TICK;  // Lange Blockade nicht hochrechnen
+
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  StatsSample s;
+  s.values[STAT_WATER_TEMP] = snap.waterTemp;
+  s.values[STAT_AIR_TEMP] = snap.airTemp;
+  s.values[STAT_PH] = snap.ph;
+  s.values[STAT_TDS] = snap.tds;
+  s.values[STAT_DO] = ENABLE_DO_SENSOR ? snap.dissolvedOxygen : NAN;
+  s.flowRate = ENABLE_TURBINE ? snap.flowRate : 0;
+  s.turbinePower = ENABLE_TURBINE ? snap.turbinePower : 0;
+  s.aeration = snap.aerationRelay;
+  s.exceed = (snap.waterTemp > troutParams.tempMax ? STATS_EXCEED_TEMP : 0) |
+             (ENABLE_DO_SENSOR && snap.dissolvedOxygen < troutParams.doMin ? STATS_EXCEED_OXYGEN : 0) |
+             (snap.ph < troutParams.phMin || snap.ph > troutParams.phMax ? STATS_EXCEED_PH : 0);
+  dailyStats.add(s, dt);
+}
+
+uint32_t statsSlotOffset(uint32_t day) {
+  int32_t n = statsDayNumber(day) % DAILY_STATS_DAYS;
+  return (n < 0 ? n + DAILY_STATS_DAYS : n) * sizeof(DailyStatsRecord);
+}
+
+// Ring-Datei einmalig mit leeren Slots anlegen (feste Offsets, Schreiben per Seek)
+bool ensureStatsFile() {
+  if (SD.exists(STATS_FILE)) return true;
+  File file = SD.open(STATS_FILE, FILE_WRITE);
+  if (!file) return false;
+  uint8_t zeros[sizeof(DailyStatsRecord)] = {};
+  for (int i = 0; i < DAILY_STATS_DAYS; i++) file.write(zeros, sizeof(zeros));
+  file.close();
+  return true;
+}
+
+bool readStatsSlot(File& file, uint32_t day, DailyStatsRecord& rec) {
+  return file.seek(statsSlotOffset(day)) &&
+         file.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec) &&
+         statsValid(rec, day);
+}
+
+// Heutigen Stand in seinen Slot schreiben (alle LOG_INTERVAL und am Tagesende)
+void saveDailyStats() {
+  if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK || dailyStats.day() == 0) return;
+  StallScope phase(stallProfiler, PHASE_SD);
+  if (!ensureStatsFile()) return;
+
+  DailyStatsRecord rec = dailyStats.summary();
+  File file = SD.open(STATS_FILE, "r+");
+  if (!file) return;
+  if (file.seek(statsSlotOffset(rec.day))) file.write((const uint8_t*)&rec, sizeof(rec));
+  file.close();
+}
+
+// Erste gültige Zeit: begonnenen Tag von SD fortsetzen; danach bei jedem Datumswechsel abschließen
+void checkDayRollover() {
+  uint32_t today = localDate();
+  if (today == 0 || today == dailyStats.day()) return;
+
+  if (dailyStats.day() == 0) {
+    dailyStats.begin(today);
+    if (ENABLE_SD_LOGGING && sysStatus.sdCardOK) {
+      StallScope phase(stallProfiler, PHASE_SD);
+      File file = SD.open(STATS_FILE, FILE_READ);
+      DailyStatsRecord rec;
+      if (file && readStatsSlot(file, today, rec)) {
+        dailyStats.restore(rec);
+        sendControlCommand(CTL_RESTORE_DAILY, rec.alarms);
+        Serial.printf("📊 Tagesstatistik fortgesetzt (%u min erfasst)\n", rec.coverageMin);
+      }
+      if (file) file.close();
+    }
+    return;
+  }
+
+  saveDailyStats();
+  DailyStatsRecord rec = dailyStats.summary();
+  Serial.printf("📊 Tag %lu: Wasser %.1f-%.1f °C, %.2f Tagesgrade, %lu L, %u Wh\n",
+                (unsigned long)rec.day, rec.minValue[STAT_WATER_TEMP] / 100.0f,
+                rec.maxValue[STAT_WATER_TEMP] / 100.0f, rec.degreeDays / 100.0f,
+                (unsigned long)rec.flowLitres, rec.turbineWh);
+
+  sendControlCommand(CTL_RESET_DAILY, 0);   // Zähler und Belüftungsbilanz im Regel-Task
+  logEvent(EVT_DAILY_RESET, "Tägliche Zähler zurückgesetzt");
+  dailyStats.begin(today);
+}
+
+void appendStatsDay(TextBuffer& out, const DailyStatsRecord& rec, bool first) {
+  out.appendf("%s{\"date\":\"%04lu-%02lu-%02lu\"", first ? "" : ",",
+    (unsigned long)(rec.day / 10000), (unsigned long)(rec.day / 100 % 100), (unsigned long)(rec.day % 100));
+  for (uint8_t m = 0; m < STAT_METRICS; m++) {
+    if (m == STAT_DO && !ENABLE_DO_SENSOR) continue;
+    float scale = STATS_SCALE[m];
+    uint8_t p = STATS_PRECISION[m];
+    out.appendf(",\"%s\":{\"min\":%.*f,\"max\":%.*f,\"mean\":%.*f}", STATS_KEYS[m],
+      p, rec.minValue[m] / scale, p, rec.maxValue[m] / scale, p, rec.meanValue[m] / scale);
+    flushHistoryChunk(out, false);
+  }
+  out.appendf(",\"coverageMin\":%u,\"tempHighMin\":%u,\"oxygenLowMin\":%u,\"phOutMin\":%u",
+    rec.coverageMin, rec.tempHighMin, rec.oxygenLowMin, rec.phOutMin);
+  out.appendf(",\"degreeDays\":%.2f,\"flowLitres\":%lu,\"turbineWh\":%u,\"aerationMin\":%u,\"alarms\":%u}",
+    rec.degreeDays / 100.0f, (unsigned long)rec.flowLitres, rec.turbineWh, rec.aerationMin, rec.alarms);
+  flushHistoryChunk(out, false);
+}
+
+// GET /api/stats?days=N  Tageswerte, neuester Tag (laufend) zuerst
+void handleAPIStats() {
+  uint32_t today = dailyStats.day();
+  if (today == 0) {
+    server.send(503, "application/json", "{\"error\":\"Time not synced\"}");
+    return;
+  }
+  int days = server.hasArg("days")
+    ? constrain(server.arg("days").toInt(), 1, DAILY_STATS_DAYS) : STATS_API_DEFAULT_DAYS;
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  char buf[768];
+  TextBuffer out(buf, sizeof(buf));
+  out.append("{\"days\":[");
+
+  // Summen über den Zeitraum (z.B. Tagesgrade seit Besatz)
+  DailyStatsRecord rec = dailyStats.summary();
+  uint32_t degreeDays = rec.degreeDays, flowLitres = rec.flowLitres, turbineWh = rec.turbineWh;
+  uint32_t found = 1;
+  appendStatsDay(out, rec, true);
+
+  File file;
+  if (ENABLE_SD_LOGGING && sysStatus.sdCardOK) file = SD.open(STATS_FILE, FILE_READ);
   if (file) {
-    file.printf("%s,%s,%s\n", getTimestamp().c_str(), eventType.c_str(), value.c_str());
+    int32_t todayNumber = statsDayNumber(today);
+    for (int d = 1; d < days; d++) {
+      uint32_t day = statsDate(todayNumber - d);
+      if (!readStatsSlot(file, day, rec)) continue;  // Kein Datensatz (z.B. Gerät aus)
+      appendStatsDay(out, rec, false);
+      degreeDays += rec.degreeDays;
+      flowLitres += rec.flowLitres;
+      turbineWh += rec.turbineWh;
+      found++;
+    }
     file.close();
   }
+
+  out.appendf("],\"requested\":%d,\"found\":%lu,\"degreeDays\":%.2f,\"flowLitres\":%lu,\"turbineWh\":%lu}",
+    days, (unsigned long)found, degreeDays / 100.0f, (unsigned long)flowLitres, (unsigned long)turbineWh);
+  flushHistoryChunk(out, true);
+  server.sendContent("");
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// WETTERVORHERSAGE
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Lokale Stunden seit 1970 (wie WeatherSlot.hour); -1 = noch keine NTP-Zeit
+int32_t localHour() {
+  time_t now = time(nullptr);
+  if (now < 1600000000) return -1;
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  uint32_t date = (timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+  return statsDayNumber(date) * 24 + timeinfo.tm_hour;
+}
+
+// Höchste vorhergesagte Lufttemperatur der nächsten WEATHER_HEAT_LEAD_HOURS (NAN = unbekannt)
+float weatherHeatMax() {
+  int32_t hour = localHour();
+  if (!weather.valid || hour < 0 || time(nullptr) - weatherFetchedAt > WEATHER_MAX_AGE) return NAN;
+  return weatherMaxTemp(weather, hour, WEATHER_HEAT_LEAD_HOURS);
+}
+
+bool weatherHeatExpected() {
+  float maxTemp = weatherHeatMax();
+  return !isnan(maxTemp) && maxTemp >= weatherConfig.heatAirTemp;
+}
+
+// URL mit Ort (Leerzeichen, Umlaute usw. prozent-kodiert)
+void buildWeatherUrl(char* url, size_t size) {
+  char location[3 * sizeof(weatherConfig.location)];
+  size_t n = 0;
+  for (const char* c = weatherConfig.location; *c && n + 4 < sizeof(location); c++) {
+    uint8_t b = *c;
+    if (isalnum(b) || b == '-' || b == '_' || b == '.' || b == ',') location[n++] = b;
+    else n += snprintf(location + n, sizeof(location) - n, "%%%02X", b);
+  }
+  location[n] = '\0';
+  snprintf(url, size, WEATHER_URL, location);
+}
+
+// HTTP/1.0: kein Chunked-Encoding, der Stream enthält nur den Body
+bool fetchWeatherWiFi(const char* url, WeatherParser& parser) {
+  StallScope phase(stallProfiler, PHASE_HTTPS);
+  WiFiClientSecure* client = nullptr;
+  if (HttpsPool::isHttps(url)) {
+    client = httpsPool.acquire(url);
+    if (!client) {                   // Pool belegt: später wieder (WEATHER_RETRY_INTERVAL)
+      weatherError = "Keine TLS-Verbindung";
+      return false;
+    }
+  }
+  HTTPClient http;
+  http.useHTTP10(true);
+  if (client) {
+    http.begin(*client, url);
+  } else {
+    http.begin(url);  // http:// (Ersatz-Server)
+  }
+  http.setTimeout(10000);
+
+  int code = http.GET();
+  bool ok = code == 200;
+  if (ok) {
+    WiFiClient* stream = http.getStreamPtr();
+    char buf[WEATHER_READ_SIZE];
+    unsigned long lastData = millis();
+    while (ok && (stream->connected() || stream->available())) {
+      size_t n = stream->available();
+      if (n == 0) {
+        if (millis() - lastData > 10000) break;
+        delay(1);
+        continue;
+      }
+      n = stream->readBytes(buf, min(n, sizeof(buf)));
+      ok = parser.feed(buf, n);
+      lastData = millis();
+      esp_task_wdt_reset();
+    }
+  } else {
+    weatherError = code > 0 ? "HTTP-Fehler" : "Keine Verbindung";
+  }
+  http.end();
+  if (client) httpsPool.release(client, false);  // HTTP/1.0: Server schließt ohnehin
+  return ok;
+}
+
+// SIM7600: Antwort liegt im Modem und wird blockweise gelesen und gefiltert
+bool fetchWeatherLTE(const char* url, WeatherParser& parser) {
+  if (lteHttpHeld) {
+    weatherError = "Modem belegt";
+    return false;
+  }
+  sendATCommand("AT+HTTPINIT", 2000);
+  String urlCmd = "AT+HTTPPARA=\"URL\",\"" + String(url) + "\"";
+  sendATCommand(urlCmd.c_str(), 1000);
+  esp_task_wdt_reset();
+
+  uint32_t bodyLen = 0;
+  int code = lteHttpGet(bodyLen);
+  bool ok = code == 200;
+  if (!ok) weatherError = code > 0 ? "HTTP-Fehler" : "Modem-Timeout";
+
+  uint8_t chunk[WEATHER_READ_SIZE];
+  for (uint32_t pos = 0; ok && pos < bodyLen; ) {
+    size_t n = min((uint32_t)sizeof(chunk), bodyLen - pos);
+    if (!lteHttpRead(pos, chunk, n)) {
+      weatherError = "Modem-Lesefehler";
+      ok = false;
+      break;
+    }
+    ok = parser.feed((const char*)chunk, n);
+    pos += n;
+    esp_task_wdt_reset();
+  }
+  sendATCommand("AT+HTTPTERM", 1000);
+  return ok;
+}
+
+// Vorhersage holen; nur ~300 Byte des ~50 KB-Dokuments werden behalten
+void updateWeather() {
+  StallScope phase(stallProfiler, PHASE_WEATHER);
+  int32_t hour = localHour();
+  bool wifi = WiFi.status() == WL_CONNECTED;
+  weatherError = "";
+
+  bool ok = false;
+  if (hour < 0) {
+    weatherError = "Keine Uhrzeit";
+  } else if (!wifi && !sysStatus.lteConnected) {
+    weatherError = "Kein Internet";
+  } else {
+    char url[160];
+    buildWeatherUrl(url, sizeof(url));
+    Serial.printf("🌦️  Wetter abrufen (%s): %s\n", wifi ? "WiFi" : "LTE", url);
+
+    static WeatherParser parser;       // ~340 Byte, unabhängig von der Antwortgröße
+    static WeatherForecast fresh;
+    parser.begin(fresh);
+    ok = wifi ? fetchWeatherWiFi(url, parser) : fetchWeatherLTE(url, parser);
+    if (ok && !parser.finish(hour)) {
+      weatherError = parser.failed() ? "Ungültiges JSON" : "Unvollständig";
+      ok = false;
+    } else if (!ok && !weatherError[0]) {
+      weatherError = parser.failed() ? "Ungültiges JSON" : "Abgebrochen";
+    }
+    if (ok) {
+      weather = fresh;
+      weatherFetchedAt = time(nullptr);
+    }
+  }
+
+  if (!ok) {
+    weatherFailures++;
+    weatherInterval = WEATHER_RETRY_INTERVAL;
+    Serial.printf("⚠️  Wetter: %s (%u. Fehlschlag)\n", weatherError, weatherFailures);
+    return;
+  }
+
+  weatherFailures = 0;
+  weatherInterval = WEATHER_UPDATE_INTERVAL;
+  float maxTemp = weatherHeatMax();
+  Serial.printf("✅ Wetter: %d°C %s, %u Slots, max. %.0f°C in %dh\n", weather.current.tempC,
+                weather.current.text, weather.count, maxTemp, WEATHER_HEAT_LEAD_HOURS);
+
+  // Hitzeperiode einmal pro Anstieg melden
+  bool heat = weatherHeatExpected();
+  if (heat && !weatherHeatLogged) {
+    char value[48];
+    snprintf(value, sizeof(value), "Max. %.0f°C in %dh erwartet", maxTemp, WEATHER_HEAT_LEAD_HOURS);
+    logEvent(EVT_HEAT_FORECAST, value);
+  }
+  weatherHeatLogged = heat;
+  weatherHeat = heat;
+}
+
+// GET /api/weather  Letzte Vorhersage (aktuell + 3-h-Raster der nächsten 48 h)
+void handleAPIWeather() {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  char buf[768];
+  TextBuffer out(buf, sizeof(buf));
+
+  out.append("{\"location\":");
+  out.appendJsonString(weatherConfig.location);
+  out.appendf(",\"valid\":%s,\"failures\":%u,\"error\":", weather.valid ? "true" : "false", weatherFailures);
+  out.appendJsonString(weatherError);
+  if (weather.valid) {
+    const WeatherCurrent& c = weather.current;
+    out.appendf(",\"age\":%ld", (long)(time(nullptr) - weatherFetchedAt));
+    out.appendf(",\"current\":{\"tempC\":%d,\"humidity\":%u,\"windKmh\":%u,\"code\":%u,\"text\":",
+      c.tempC, c.humidity, c.windKmh, c.code);
+    out.appendJsonString(c.text);
+    out.append("}");
+  }
+
+  float maxTemp = weatherHeatMax();
+  out.appendf(",\"heat\":{\"expected\":%s,\"threshold\":%.1f,\"leadHours\":%u",
+    weatherHeatExpected() ? "true" : "false", weatherConfig.heatAirTemp, WEATHER_HEAT_LEAD_HOURS);
+  if (!isnan(maxTemp)) out.appendf(",\"maxTempC\":%.0f", maxTemp);
+  out.append("},\"hourly\":[");
+  flushHistoryChunk(out, false);
+
+  for (uint8_t i = 0; i < weather.count; i++) {
+    const WeatherSlot& slot = weather.slots[i];
+    uint32_t date = statsDate(slot.hour / 24);
+    out.appendf("%s{\"time\":\"%04lu-%02lu-%02luT%02d:00\",\"tempC\":%d,\"rain\":%u,\"code\":%u}",
+      i ? "," : "", (unsigned long)(date / 10000), (unsigned long)(date / 100 % 100),
+      (unsigned long)(date % 100), (int)(slot.hour % 24), slot.tempC, slot.rainChance, slot.code);
+    flushHistoryChunk(out, false);
+  }
+  out.append("]}");
+  flushHistoryChunk(out, true);
+  server.sendContent("");
+}
+
+// POST /api/weather/refresh  Abruf in loop() anstoßen
+void handleAPIWeatherRefresh() {
+  if (!weatherConfig.location[0]) {
+    server.send(409, "application/json", "{\"error\":\"No location configured\"}");
+    return;
+  }
+  weatherRequested = true;
+  server.send(202, "application/json", "{\"success\":true}");
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -1371,6 +3005,7 @@ void syncTime() {
     return;
   }
   
+  StallScope phase(stallProfiler, PHASE_TIME);
   configTime(3600, 3600, "pool.ntp.org", "time.nist.gov");
   Serial.println("🕐 Zeitsynchronisation...");
 
@@ -1385,6 +3020,7 @@ void syncTime() {
 }
 
 String getTimestamp() {
+  StallScope phase(stallProfiler, PHASE_TIME);
   struct tm timeinfo;
   // WICHTIG: Timeout angeben! Ohne Timeout kann getLocalTime() unendlich blockieren
   if (!getLocalTime(&timeinfo, 1000)) {
@@ -1397,6 +3033,7 @@ String getTimestamp() {
 }
 
 String getDateString() {
+  StallScope phase(stallProfiler, PHASE_TIME);
   struct tm timeinfo;
   // WICHTIG: Timeout angeben! Ohne Timeout kann getLocalTime() unendlich blockieren
   if (!getLocalTime(&timeinfo, 1000)) {
@@ -1433,35 +3070,274 @@ void updateStatusLED() {
   }
 }
 
+// ═══════════════════════════════════════════════════════════════════════════════════
+// REGEL-TASK (MESSEN, ALARM, RELAIS)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+void startControlTask() {
+  alarmQueue = xQueueCreate(ALARM_QUEUE_SIZE, sizeof(AlarmNotice));
+  controlQueue = xQueueCreate(CONTROL_QUEUE_SIZE, sizeof(ControlCommand));
+  adcSampleQueue = xQueueCreate(1, sizeof(int));
+  xTaskCreatePinnedToCore(controlTaskLoop, "control", CONTROL_TASK_STACK, nullptr,
+                          CONTROL_TASK_PRIORITY, &controlTask, CONTROL_TASK_CORE);
+  Serial.printf("✅ Regel-Task: Core %d, Priorität %d\n", CONTROL_TASK_CORE, CONTROL_TASK_PRIORITY);
+}
+
+// Sensoren, Alarme, Belüftung und Relais - unabhängig davon, worauf loop() wartet
+void controlTaskLoop(void* param) {
+  esp_task_wdt_add(nullptr);
+  for (;;) {
+    // Bis zum nächsten Aufwachraster warten, Befehle aus loop() wecken sofort
+    bool relayCommand = false;
+    ControlCommand cmd;
+    if (xQueueReceive(controlQueue, &cmd, pdMS_TO_TICKS(CONTROL_TICK_MS)) == pdTRUE) {
+      do {
+        relayCommand |= applyControlCommand(cmd);
+      } while (xQueueReceive(controlQueue, &cmd, 0) == pdTRUE);
+    }
+    takeControlConfig();
+    unsigned long now = millis();
+
+    if (now - lastSensorRead >= SAMPLE_TICK) {
+      runControlCycle(now);
+    } else if (relayCommand) {
+      updateRelays();                // Modus-Wechsel aus Web/Telegram sofort schalten
+      publishSensorSnapshot();
+    }
+
+    serviceBuzzer(now);
+    esp_task_wdt_reset();
+  }
+}
+
+void runControlCycle(unsigned long now) {
+  uint32_t late = lastSensorRead ? now - lastSensorRead - SAMPLE_TICK : 0;
+  lastSensorRead = now;
+
+  uint32_t start = micros();
+  if (!readDueSensors()) return;
+  checkAlarms();
+  controlAeration();
+
+  // Neuer Belüftungsbedarf: Zeitpunkt, an dem die Messung fällig war, die ihn zeigt.
+  // Die Latenz endet mit dem digitalWrite() auf RELAY_4 (updateRelays()).
+  bool demand = sensors.aerationActive && relayModes[3] == 0;
+  if (demand && !relayStates[3] && !aerationDemandPending) {
+    aerationDemandPending = true;
+    aerationDemandUs = start - late * 1000;
+  } else if (!demand) {
+    aerationDemandPending = false;
+  }
+
+  updateRelays();
+  uint32_t cycleUs = micros() - start;
+  publishSensorSnapshot();
+
+  ControlStats& st = controlStats;
+  st.cycles++;
+  st.lastCycleUs = cycleUs;
+  st.avgCycleUs = st.avgCycleUs ? st.avgCycleUs + ((int32_t)cycleUs - (int32_t)st.avgCycleUs) / 16 : cycleUs;
+  if (cycleUs > st.maxCycleUs) st.maxCycleUs = cycleUs;
+  if (late > st.maxLateMs) st.maxLateMs = late;
+}
+
+// RELAY_4 wurde für einen offenen Belüftungsbedarf eingeschaltet
+void recordAerationLatency(uint32_t writtenUs) {
+  uint32_t latency = writtenUs - aerationDemandUs;
+  aerationDemandPending = false;
+
+  ControlStats& st = controlStats;
+  st.aerationStarts++;
+  st.lastAerationUs = latency;
+  if (latency > st.maxAerationUs) st.maxAerationUs = latency;
+  if (latency > (uint32_t)SAMPLE_TICK * 1000) st.deadlineMisses++;
+}
+
+// loop(): Konfiguration als Ganzes an den Regel-Task übergeben
+void publishControlConfig() {
+  ControlConfig next;
+  next.trout = troutParams;
+  next.alarms = alarmRules;
+  next.aeration = aerationConfig;
+  next.weather = weatherConfig;
+  memcpy(next.schedules, relaySchedules, sizeof(next.schedules));
+  next.calibration = calibration;
+
+  portENTER_CRITICAL(&configMux);
+  pendingControlConfig = next;
+  controlConfigChanged = true;
+  portEXIT_CRITICAL(&configMux);
+}
+
+// Regel-Task: neue Konfiguration zwischen zwei Zyklen übernehmen
+void takeControlConfig() {
+  portENTER_CRITICAL(&configMux);
+  if (controlConfigChanged) {
+    controlConfig = pendingControlConfig;
+    controlConfigChanged = false;
+  }
+  portEXIT_CRITICAL(&configMux);
+}
+
+// Im Regel-Task (bzw. setup() vor dem Start) ausführen; true = Relais neu setzen
+bool applyControlCommand(const ControlCommand& cmd) {
+  switch (cmd.type) {
+    case CTL_COUNT_ALARM:
+      sysStatus.alarmCount++;
+      sysStatus.dailyAlarms++;
+      return false;
+    case CTL_RESET_DAILY:
+      sysStatus.dailyAlarms = 0;
+      logAerationDaily();
+      return false;
+    case CTL_RESTORE_DAILY:
+      sysStatus.dailyAlarms = max(sysStatus.dailyAlarms, (int)cmd.value);
+      return false;
+    case CTL_SAMPLE_ADC: {
+      int raw = readAdcRaw(cmd.value);
+      xQueueOverwrite(adcSampleQueue, &raw);
+      return false;
+    }
+    default:
+      return true;
+  }
+}
+
+// loop() → Regel-Task; vor dem Start des Tasks direkt ausführen
+void sendControlCommand(uint8_t type, uint16_t value) {
+  ControlCommand cmd = {type, value};
+  if (!controlTask) {
+    if (applyControlCommand(cmd)) updateRelays();
+    return;
+  }
+  // Task hat höhere Priorität und leert die Queue sofort; voll heißt: Task hängt
+  if (xQueueSend(controlQueue, &cmd, pdMS_TO_TICKS(100)) != pdTRUE) {
+    Serial.printf("⚠️  Regel-Task: Befehl %u verworfen\n", cmd.type);
+  }
+}
+
+// loop(): ADC-Rohwert für die Kalibrierung - der Regel-Task besitzt den ADC.
+// Blockiert für eine Messung (10 x 10 ms); -1 = Task antwortet nicht.
+int sampleAdcRaw(int pin) {
+  if (!controlTask) return readAdcRaw(pin);
+  int raw;
+  xQueueReset(adcSampleQueue);
+  sendControlCommand(CTL_SAMPLE_ADC, pin);
+  return xQueueReceive(adcSampleQueue, &raw, pdMS_TO_TICKS(1000)) == pdTRUE ? raw : -1;
+}
+
+// Relais-Modus geändert (Web, Telegram): Regel-Task schaltet sofort
+void requestRelayUpdate() {
+  sendControlCommand(CTL_RELAYS, 0);
+}
+
+// Regel-Task → loop(); bei voller Queue bleibt der Alarm im Journal
+void queueAlarmNotice(const char* reason) {
+  if (!alarmQueue) return;
+  AlarmNotice notice;
+  notice.detectedMs = millis();
+  strlcpy(notice.reason, reason, sizeof(notice.reason));
+  if (xQueueSend(alarmQueue, &notice, 0) != pdTRUE) controlStats.noticesDropped++;
+}
+
+// Läuft in loop(): Meldungen mit Netzwerkzugriff versenden
+void handleAlarmNotices() {
+  AlarmNotice notice;
+  while (alarmQueue && xQueueReceive(alarmQueue, &notice, 0) == pdTRUE) {
+    dailyStats.addAlarm();
+    checkAndSendAlerts(notice.reason);
+    #if ENABLE_TELEGRAM
+    sendTelegramAlarm(notice.reason);
+    #endif
+    esp_task_wdt_reset();
+  }
+}
+
 // ═══════════════════════════════════════════════════════════════════════════════════
 // HAUPTSCHLEIFE
 // ═══════════════════════════════════════════════════════════════════════════════════
 
 void loop() {
   esp_task_wdt_reset();
+  stallProfiler.loopStart();
 
   unsigned long now = millis();
   sysStatus.uptime = (now - startTime) / 1000;
 
   // OTA Updates
   if (ENABLE_OTA && ENABLE_WIFI) {
+    StallScope phase(stallProfiler, PHASE_OTA);
     ArduinoOTA.handle();
     esp_task_wdt_reset();
   }
 
   // WebServer
-  server.handleClient();
-  esp_task_wdt_reset();
+  {
+    StallScope phase(stallProfiler, PHASE_WEB);
+    server.handleClient();
+    esp_task_wdt_reset();
+  }
+
+  // Messen, Alarme und Relais laufen im Regel-Task; hier nur Versand und Statistik
+  handleAlarmNotices();
+  if (now - lastStatsSample >= SAMPLE_TICK) {
+    trackDailyStats(now);
+  }
+
+  // Festes Raster für Telemetrie und Debug-Ausgabe
+  if (now - lastSensorCycle >= SENSOR_INTERVAL) {
+    #if ENABLE_TELEMETRY
+    sampleTelemetry();
+    #endif
+    if (DEBUG_MODE) {
+      printSensorValues();
+    }
+    lastSensorCycle = now;
+  }
+
+  // Satelliten-Frames verarbeiten
+  #if ENABLE_MULTI_TANK
+  handleTankFrames();
+  if (now - lastTankCheck >= SENSOR_INTERVAL) {
+    checkTankAlerts();
+    lastTankCheck = now;
+  }
+  #endif
+
+  // Telemetrie gebündelt hochladen
+  #if ENABLE_TELEMETRY
+  if (now - lastTelemetryUpload >= TELEMETRY_UPLOAD_INTERVAL) {
+    StallScope phase(stallProfiler, PHASE_TELEMETRY);
+    uploadTelemetry();
+    lastTelemetryUpload = now;
+    esp_task_wdt_reset();
+  }
+  #endif
 
-  // Sensoren auslesen
-  if (now - lastSensorRead >= SENSOR_INTERVAL) {
-    readAllSensors();
-    checkAlarms();
-    controlAeration();
-    updateRelays();  // Relays basierend auf Modi aktualisieren
-    lastSensorRead = now;
+  // Delta-Update über LTE: neue Firmware bestätigen, periodisch nach Patch fragen.
+  // Ein laufendes Update lädt einen Range-Block (Server ohne Range: 1 KB aus der
+  // offenen Sitzung) pro Durchlauf, Sensoren, Alarme und Webserver laufen dazwischen weiter.
+  #if ENABLE_DELTA_OTA
+  confirmFirmware();
+  if (deltaJob.active) {
+    if (sysStatus.lteConnected) stepDeltaUpdate();
+    else finishDeltaUpdate("LTE getrennt");
     esp_task_wdt_reset();
+  } else if (deltaOta.requested || now - lastDeltaOtaCheck >= DELTA_OTA_CHECK_INTERVAL) {
+    // Erst nach Bestätigung der laufenden Firmware (sonst ginge der Rückweg verloren)
+    if (sysStatus.lteConnected && !deltaOta.pendingVerify) {
+      startDeltaUpdate();
+    }
+    deltaOta.requested = false;
+    lastDeltaOtaCheck = now;
   }
+  #endif
+
+  // Geänderte Einstellungen verzögert ins NVS schreiben
+  handleSettingsCommit();
+
+  // Idle HTTPS-Verbindungen schließen
+  httpsPool.maintain();
 
   // Historie aktualisieren
   if (now - lastHistoryUpdate >= HISTORY_INTERVAL) {
@@ -1469,12 +3345,20 @@ void loop() {
     lastHistoryUpdate = now;
   }
 
-  // SD-Logging
+  // SD-Logging (inkl. Zwischenstand der Tagesstatistik)
   if (now - lastLogWrite >= LOG_INTERVAL) {
     logToSD();
+    saveDailyStats();
     lastLogWrite = now;
   }
 
+  // Ereignis-Journal gebündelt auf SD schreiben
+  uint32_t pendingEvents = journal.pending();
+  if (pendingEvents >= EVENT_FLUSH_BATCH ||
+      (pendingEvents > 0 && now - lastEventFlush >= EVENT_FLUSH_INTERVAL)) {
+    flushEvents();
+  }
+
   // LTE Status prüfen und ggf. reconnect
   if (ENABLE_LTE && now - lastLTECheck >= LTE_CHECK_INTERVAL) {
     bool wasConnected = sysStatus.lteConnected;
@@ -1497,34 +3381,39 @@ void loop() {
     esp_task_wdt_reset();
   }
 
-  // Telegram Bot (v1.6.1)
+  // Telegram Relais-Befehle (Bot läuft in eigenem Task)
   #if ENABLE_TELEGRAM
-  if (now - lastTelegramCheck >= TELEGRAM_CHECK_INTERVAL) {
-    handleTelegramMessages();
-    lastTelegramCheck = now;
-    esp_task_wdt_reset();
-  }
+  handleTelegramRelayCommands();
   #endif
 
   // DynDNS Update (v1.6.1)
   #if ENABLE_DYNDNS
   if (now - lastDynDNSUpdate >= DYNDNS_UPDATE_INTERVAL) {
+    StallScope phase(stallProfiler, PHASE_DYNDNS);
     updateDynDNS();
     lastDynDNSUpdate = now;
     esp_task_wdt_reset();
   }
   #endif
 
-  // Tägliche Zähler zurücksetzen (um Mitternacht)
-  static int lastDay = -1;
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo, 1000)) {  // 1 Sekunde Timeout
-    if (timeinfo.tm_mday != lastDay) {
-      sysStatus.dailyAlarms = 0;
-      lastDay = timeinfo.tm_mday;
-      logEvent("DAILY_RESET", "Tägliche Zähler zurückgesetzt");
-    }
+  // Wettervorhersage (alle 12h, nach Fehlschlag früher erneut)
+  if (weatherConfig.location[0] && (weatherRequested || now - lastWeatherUpdate >= weatherInterval)) {
+    weatherRequested = false;
+    updateWeather();
+    lastWeatherUpdate = millis();
+    esp_task_wdt_reset();
+  }
+
+  // Hitze-Flag für den Regel-Task (die Vorhersage rückt mit der Uhr weiter)
+  static unsigned long lastHeatCheck = 0;
+  if (now - lastHeatCheck >= 60000) {
+    weatherHeat = weatherHeatExpected();
+    lastHeatCheck = now;
   }
+
+  // Tageswechsel: Statistik abschließen, tägliche Zähler zurücksetzen
+  checkDayRollover();
+  realignHistory();
   
   // Memory-Check (alle 5 Minuten)
   static unsigned long lastMemCheck = 0;
@@ -1532,13 +3421,17 @@ void loop() {
     uint32_t freeHeap = ESP.getFreeHeap();
     if (freeHeap < 20000) {
       Serial.printf("⚠️  Niedriger Speicher: %u Bytes\n", freeHeap);
-      logEvent("LOW_MEMORY", String(freeHeap));
+      char value[16];
+      snprintf(value, sizeof(value), "%u", freeHeap);
+      logEvent(EVT_LOW_MEMORY, value);
     }
     lastMemCheck = now;
   }
 
   // Status LED
   updateStatusLED();
+
+  stallProfiler.loopEnd(LOOP_BUDGET_MS);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -1557,11 +3450,27 @@ void initWebServer() {
   server.on("/api/settings", HTTP_GET, handleAPISettings);
   server.on("/api/settings", HTTP_POST, handleAPISettingsPost);
   server.on("/api/relay", HTTP_POST, handleAPIRelay);
+  server.on("/api/aeration", HTTP_GET, handleAPIAeration);
+  server.on("/api/aeration", HTTP_POST, handleAPIAerationPost);
   server.on("/api/test-email", HTTP_POST, handleAPITestEmail);
+  server.on("/api/export", HTTP_GET, handleAPIExport);
+  server.on("/api/events", HTTP_GET, handleAPIEvents);
+  server.on("/api/stats", HTTP_GET, handleAPIStats);
+  server.on("/api/weather", HTTP_GET, handleAPIWeather);
+  server.on("/api/weather/refresh", HTTP_POST, handleAPIWeatherRefresh);
+  #if ENABLE_DELTA_OTA
+  server.on("/api/ota/delta", HTTP_POST, handleAPIDeltaOta);
+  #endif
   server.on("/api/calibration", HTTP_GET, handleAPICalibrationGet);
   server.on("/api/calibration/ph", HTTP_POST, handleAPICalibrationPH);
   server.on("/api/calibration/tds", HTTP_POST, handleAPICalibrationTDS);
   server.on("/api/calibration/reset", HTTP_POST, handleAPICalibrationReset);
+
+  #if ENABLE_MULTI_TANK
+  server.on("/api/tanks", HTTP_GET, handleAPITanks);
+  server.on("/api/tanks/history", HTTP_GET, handleAPITankHistory);
+  server.on("/api/tanks/settings", HTTP_POST, handleAPITankSettings);
+  #endif
   
   // Statische Ressourcen
   server.on("/style.css", HTTP_GET, handleCSS);
@@ -1570,140 +3479,353 @@ void initWebServer() {
   server.onNotFound([]() {
     server.send(404, "text/plain", "Nicht gefunden");
   });
-  
+
+  // Range-Header für fortsetzbaren Export
+  const char* headerKeys[] = {"Range"};
+  server.collectHeaders(headerKeys, 1);
+
   server.begin();
   Serial.println("✅ Webserver gestartet");
 }
 
 // API Handler
 void handleAPISensors() {
-  StaticJsonDocument<768> doc;
-  doc["waterTemp"] = sensors.waterTemp;
-  doc["airTemp"] = sensors.airTemp;
-  doc["ph"] = sensors.ph;
-  doc["tds"] = sensors.tds;
-  doc["dissolvedOxygen"] = sensors.dissolvedOxygen;
-  doc["waterLevel"] = sensors.waterLevelOK;
-  doc["aeration"] = sensors.aerationActive;
-  doc["alarm"] = sensors.alarmActive;
-  doc["alarmReason"] = sensors.alarmReason;
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
 
-  // Turbinen-Daten (v1.6)
-  if (ENABLE_TURBINE) {
-    doc["flowRate"] = sensors.flowRate;
-    doc["turbinePower"] = sensors.turbinePower;
-    doc["turbinePulseCount"] = sensors.turbinePulseCount;
-  }
+  char json[768];
+  TextBuffer out(json, sizeof(json));
+  out.append("{");
+  writeJsonFields(out, SENSOR_FIELDS, snap);
+  out.append(",\"alarmReason\":");
+  out.appendJsonString(snap.alarmReason);
+  out.appendf(",\"timestamp\":%lu}", snap.timestamp);
 
-  // Batterie-Daten (v1.6)
-  if (ENABLE_BATTERY_MONITOR) {
-    doc["batteryVoltage"] = sensors.batteryVoltage;
-    doc["batteryPercent"] = sensors.batteryPercent;
-    doc["batteryLow"] = sensors.batteryLow;
+  server.send(200, "application/json", json);
+}
+
+void handleAPIStatus() {
+  char json[3072];
+  TextBuffer out(json, sizeof(json));
+  out.appendf("{\"uptime\":%lu,\"freeHeap\":%lu", sysStatus.uptime, (unsigned long)ESP.getFreeHeap());
+  out.appendf(",\"wifiConnected\":%s,\"wifiRSSI\":%d",
+    sysStatus.wifiConnected ? "true" : "false", (int)WiFi.RSSI());
+  out.appendf(",\"lteConnected\":%s,\"lteSignal\":%d",
+    sysStatus.lteConnected ? "true" : "false", sysStatus.lteSignal);
+  out.append(",\"lteOperator\":");
+  out.appendJsonString(sysStatus.lteOperator.c_str());
+  out.append(",\"publicIP\":");
+  out.appendJsonString(sysStatus.publicIP.c_str());
+  out.appendf(",\"sdCard\":%s,\"alarmCount\":%d,\"dailyAlarms\":%d",
+    sysStatus.sdCardOK ? "true" : "false", sysStatus.alarmCount, sysStatus.dailyAlarms);
+  out.append(",\"firmware\":");
+  out.appendJsonString(sysStatus.firmwareVersion.c_str());
+  out.appendf(",\"adcCalibration\":\"%s\"", getAdcCalName());
+
+  // Effektive Abtastraten je Kanal
+  out.append(",\"sampling\":{");
+  bool firstChannel = true;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (!SAMPLE_CHANNELS[ch].enabled) continue;
+    out.appendf("%s\"%s\":{\"intervalMs\":%lu,\"fast\":%s,\"reads\":%lu}",
+      firstChannel ? "" : ",", SAMPLE_CHANNELS[ch].name,
+      (unsigned long)samplers[ch].interval(), samplers[ch].isFast() ? "true" : "false",
+      (unsigned long)samplers[ch].count());
+    firstChannel = false;
   }
+  out.append("}");
+
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+  out.appendf(",\"aerationDuty\":%.3f,\"aerationEnergyWh\":%.1f,\"aerationSwitches\":%lu",
+    snap.aeration.duty(), snap.aeration.energyWh(aerationConfig.blowerWatts),
+    (unsigned long)snap.aeration.switches);
+
+  HttpsPoolStats https = httpsPool.getStats();
+  out.appendf(",\"httpsRequests\":%lu,\"httpsHandshakes\":%lu,\"httpsReuseRate\":%.2f,"
+    "\"httpsHandshakeMs\":%lu,\"httpsOpen\":%d",
+    (unsigned long)https.requests, (unsigned long)https.handshakes,
+    https.requests ? (float)https.reuses / https.requests : 0.0f,
+    (unsigned long)(https.handshakes ? https.handshakeTotalMs / https.handshakes : 0),
+    httpsPool.openConnections());
+  #if ENABLE_TELEMETRY
+  out.appendf(",\"telemetryPending\":%lu,\"telemetrySpooled\":%lu,\"telemetrySent\":%lu,"
+    "\"telemetryBytes\":%lu,\"telemetryDropped\":%lu",
+    (unsigned long)telemetryBatch.records(), (unsigned long)(spoolTail - spoolHead),
+    (unsigned long)telemetryStats.batchesSent, (unsigned long)telemetryStats.bytesSent,
+    (unsigned long)telemetryStats.batchesDropped);
+  #endif
+  out.appendf(",\"export\":{\"count\":%lu,\"lastBytes\":%lu,\"lastMs\":%lu,\"lastKBps\":%.1f}",
+    (unsigned long)exportStats.count, (unsigned long)exportStats.lastBytes,
+    (unsigned long)exportStats.lastMs,
+    exportStats.lastMs ? exportStats.lastBytes / (float)exportStats.lastMs : 0.0f);
+
+  // Hänger-Analyse: laufender Betrieb und (falls vorhanden) der Lauf vor dem letzten Reset
+  const StallRecord& run = stallProfiler.current();
+  out.appendf(",\"loop\":{\"budgetMs\":%d,\"count\":%lu,\"overBudget\":%lu,\"maxMs\":%lu}",
+    LOOP_BUDGET_MS, (unsigned long)run.loops, (unsigned long)run.loopsOverBudget,
+    (unsigned long)run.maxLoopMs);
+  out.appendf(",\"lastReset\":{\"reason\":\"%s\",\"resets\":%lu",
+    resetReasonName(resetReason), (unsigned long)run.boots);
+  if (stallProfiler.hasPrevious()) {
+    const StallRecord& last = stallProfiler.previous();
+    out.appendf(",\"phase\":\"%s\",\"phaseEnterMs\":%lu,\"lastMarkMs\":%lu,"
+      "\"loops\":%lu,\"loopsOverBudget\":%lu,\"maxLoopMs\":%lu,\"slowest\":[",
+      last.phase < PHASE_COUNT ? LOOP_PHASE_NAMES[last.phase] : "?",
+      (unsigned long)last.phaseEnterMs, (unsigned long)last.lastMarkMs, (unsigned long)last.loops,
+      (unsigned long)last.loopsOverBudget, (unsigned long)last.maxLoopMs);
+    uint8_t slow[3];
+    uint8_t n = StallProfiler::slowest(last, slow, 3);
+    for (uint8_t i = 0; i < n; i++) {
+      out.appendf("%s{\"phase\":\"%s\",\"ms\":%lu}", i ? "," : "",
+        slow[i] < PHASE_COUNT ? LOOP_PHASE_NAMES[slow[i]] : "?", (unsigned long)last.maxPhaseMs[slow[i]]);
+    }
+    out.append("]");
+  }
+  out.append("}");
+
+  // Regel-Task: Messbeginn → Relais, Belüftungsbedarf → RELAY_4, Verspätung gegenüber dem Raster
+  const ControlStats& ctl = controlStats;
+  out.appendf(",\"control\":{\"core\":%d,\"priority\":%d,\"periodMs\":%d,\"cycles\":%lu,"
+    "\"cycleUs\":{\"last\":%lu,\"avg\":%lu,\"max\":%lu},\"maxLateMs\":%lu,"
+    "\"aerationUs\":{\"starts\":%lu,\"last\":%lu,\"max\":%lu},"
+    "\"deadlineMisses\":%lu,\"noticesDropped\":%lu,\"stackFree\":%lu}",
+    CONTROL_TASK_CORE, CONTROL_TASK_PRIORITY, SAMPLE_TICK, (unsigned long)ctl.cycles,
+    (unsigned long)ctl.lastCycleUs, (unsigned long)ctl.avgCycleUs, (unsigned long)ctl.maxCycleUs,
+    (unsigned long)ctl.maxLateMs, (unsigned long)ctl.aerationStarts, (unsigned long)ctl.lastAerationUs,
+    (unsigned long)ctl.maxAerationUs, (unsigned long)ctl.deadlineMisses, (unsigned long)ctl.noticesDropped,
+    (unsigned long)(controlTask ? uxTaskGetStackHighWaterMark(controlTask) : 0));
+
+  out.appendf(",\"history\":{\"seq\":%lu,\"restored\":%lu,\"restoreMs\":%lu,\"writeErrors\":%lu}",
+    (unsigned long)(history.nextSeq - 1), (unsigned long)historyRestored,
+    (unsigned long)historyRestoreMs, (unsigned long)historyWriteErrors);
+
+  out.appendf(",\"events\":{\"last\":%lu,\"pending\":%lu,\"lost\":%lu}",
+    (unsigned long)journal.lastSeq(), (unsigned long)journal.pending(), (unsigned long)eventsLost);
+
+  #if ENABLE_DELTA_OTA
+  out.append(",\"deltaOta\":{\"result\":");
+  out.appendJsonString(deltaOta.lastResult);
+  out.appendf(",\"running\":%s,\"patchBytes\":%lu,\"imageBytes\":%lu,\"pendingVerify\":%s,\"rolledBack\":%s}",
+    deltaJob.active ? "true" : "false", (unsigned long)deltaOta.patchBytes, (unsigned long)deltaOta.imageBytes,
+    deltaOta.pendingVerify ? "true" : "false", deltaOta.rolledBack ? "true" : "false");
+  #endif
+  #if ENABLE_TELEGRAM
+  out.appendf(",\"telegramSent\":%lu,\"telegramDropped\":%lu,\"telegramQueued\":%lu",
+    (unsigned long)telegramSent.load(), (unsigned long)telegramDropped.load(),
+    (unsigned long)(telegramOutbox ? uxQueueMessagesWaiting(telegramOutbox) : 0));
+  #endif
+  out.append("}");
 
-  doc["timestamp"] = sensors.timestamp;
+  server.send(200, "application/json", json);
+}
 
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response);
-}
-
-void handleAPIStatus() {
-  StaticJsonDocument<512> doc;
-  doc["uptime"] = sysStatus.uptime;
-  doc["freeHeap"] = ESP.getFreeHeap();
-  doc["wifiConnected"] = sysStatus.wifiConnected;
-  doc["wifiRSSI"] = WiFi.RSSI();
-  doc["lteConnected"] = sysStatus.lteConnected;
-  doc["lteSignal"] = sysStatus.lteSignal;
-  doc["lteOperator"] = sysStatus.lteOperator;
-  doc["publicIP"] = sysStatus.publicIP;
-  doc["sdCard"] = sysStatus.sdCardOK;
-  doc["alarmCount"] = sysStatus.alarmCount;
-  doc["dailyAlarms"] = sysStatus.dailyAlarms;
-  doc["firmware"] = sysStatus.firmwareVersion;
-  
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response);
+// Sendet den Puffer als Chunk, sobald er fast voll ist
+void flushHistoryChunk(TextBuffer& out, bool force) {
+  if (out.length() == 0 || (!force && out.length() < 400)) return;
+  server.sendContent(out.c_str());
+  out.clear();
 }
 
+// GET /api/history?points=N           alle Reihen, Min/Max je Bucket auf gemeinsamer Zeitachse
+// GET /api/history?series=ph&points=N  eine Reihe per LTTB mit eigener Zeitachse
+// GET /api/history?since=SEQ&boot=ID   nur Punkte nach SEQ, unverändert (Dashboard-Polling)
+// Jede Antwort enthält "boot" (= eventBootId): ohne SD-Ring beginnt seq nach einem
+// Neustart wieder bei 1, ein alter Cursor würde sonst Punkte überspringen.
 void handleAPIHistory() {
-  // Kompakte Antwort für Performance
-  String json = "{";
   int count = history.full ? HISTORY_SIZE : history.index;
   int start = history.full ? history.index : 0;
-  
-  // Nur jeden 3. Wert für schnellere Übertragung (96 Punkte = 8h)
-  json += "\"waterTemp\":[";
-  for (int i = 0; i < count; i += 3) {
-    int idx = (start + i) % HISTORY_SIZE;
-    if (i > 0) json += ",";
-    json += String(history.waterTemp[idx], 1);
-  }
-  
-  json += "],\"airTemp\":[";
-  for (int i = 0; i < count; i += 3) {
-    int idx = (start + i) % HISTORY_SIZE;
-    if (i > 0) json += ",";
-    json += String(history.airTemp[idx], 1);
-  }
-  
-  json += "],\"ph\":[";
-  for (int i = 0; i < count; i += 3) {
-    int idx = (start + i) % HISTORY_SIZE;
-    if (i > 0) json += ",";
-    json += String(history.ph[idx], 2);
-  }
-  
-  json += "],\"tds\":[";
-  for (int i = 0; i < count; i += 3) {
-    int idx = (start + i) % HISTORY_SIZE;
-    if (i > 0) json += ",";
-    json += String(history.tds[idx], 0);
-  }
-  json += "]";  // TDS-Array schließen
+  uint32_t points = server.hasArg("points")
+    ? constrain(server.arg("points").toInt(), 4, HISTORY_SIZE) : HISTORY_POINTS;
+  unsigned long now = millis();
+  uint32_t last = history.nextSeq - 1;             // seq des neuesten Punkts (Index count - 1)
+
+  auto slot = [start](uint32_t i) { return (start + i) % HISTORY_SIZE; };
+  auto ageSec = [now, &slot](uint32_t i) { return (float)((now - history.timestamp[slot(i)]) / 1000); };
+
+  // Energie aus allen Messpunkten, nicht aus den ausgedünnten (nur mit Turbine)
+  auto appendEnergy = [count, &slot](TextBuffer& out) {
+    for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+      if (HISTORY_SERIES[c].logChannel != HLOG_POWER) continue;
+      float energyWh = 0;
+      for (int i = 0; i < count; i++) energyWh += history.values[c][slot(i)] * HISTORY_INTERVAL / 3600000.0f;
+      out.appendf(",\"turbineEnergyWh\":%.1f", energyWh);
+    }
+  };
 
-  if (ENABLE_DO_SENSOR) {
-    json += ",\"do\":[";  // DO-Array nur wenn enabled
-    for (int i = 0; i < count; i += 3) {
-      int idx = (start + i) % HISTORY_SIZE;
-      if (i > 0) json += ",";
-      json += String(history.dissolvedOxygen[idx], 1);
+  if (server.hasArg("since")) {
+    long sinceArg = server.arg("since").toInt();
+    uint32_t since = sinceArg > 0 ? (uint32_t)sinceArg : 0;
+    uint32_t boot = server.hasArg("boot") ? strtoul(server.arg("boot").c_str(), nullptr, 10) : 0;
+    uint32_t first = last + 1 - count;
+
+    // Cursor aus der Zeit vor einem Neustart oder schon aus dem Puffer gefallen
+    if ((boot != 0 && boot != eventBootId) || since > last || since + 1 < first) {
+      char json[80];
+      snprintf(json, sizeof(json), "{\"seq\":%lu,\"boot\":%lu,\"reset\":true}",
+               (unsigned long)last, (unsigned long)eventBootId);
+      server.send(200, "application/json", json);
+      return;
+    }
+
+    uint32_t from = count - (last - since);        // Index des ersten neuen Punkts
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    char buf[512];
+    TextBuffer out(buf, sizeof(buf));
+    out.appendf("{\"seq\":%lu,\"boot\":%lu,\"since\":%lu,\"points\":%lu,\"t\":[",
+      (unsigned long)last, (unsigned long)eventBootId, (unsigned long)since, (unsigned long)(count - from));
+    for (uint32_t i = from; i < (uint32_t)count; i++) {
+      out.appendf("%s%.0f", i > from ? "," : "", ageSec(i));
+      flushHistoryChunk(out, false);
+    }
+    out.append("]");
+    for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+      const HistoryChannel& hs = HISTORY_SERIES[c];
+      out.appendf(",\"%s\":[", hs.key);
+      for (uint32_t i = from; i < (uint32_t)count; i++) {
+        out.appendf("%s%.*f", i > from ? "," : "", hs.precision, history.values[c][slot(i)]);
+        flushHistoryChunk(out, false);
+      }
+      out.append("]");
     }
-    json += "]";  // DO-Array schließen
+    appendEnergy(out);
+    out.append("}");
+    flushHistoryChunk(out, true);
+    server.sendContent("");
+    return;
   }
 
-  // Flow Rate Array (v1.6)
-  if (ENABLE_TURBINE) {
-    json += ",\"flowRate\":[";
-    for (int i = 0; i < count; i += 3) {
-      int idx = (start + i) % HISTORY_SIZE;
-      if (i > 0) json += ",";
-      json += String(history.flowRate[idx], 1);
+  int single = -1;
+  if (server.hasArg("series")) {
+    for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+      if (server.arg("series") == HISTORY_SERIES[c].key) single = c;
+    }
+    if (single < 0) {
+      server.send(404, "application/json", "{\"error\":\"Unknown series\"}");
+      return;
     }
-    json += "]";
   }
 
-  // Turbine Power Array (v1.6)
-  if (ENABLE_TURBINE) {
-    json += ",\"turbinePower\":[";
-    for (int i = 0; i < count; i += 3) {
-      int idx = (start + i) % HISTORY_SIZE;
-      if (i > 0) json += ",";
-      json += String(history.turbinePower[idx], 1);
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  char buf[512];
+  TextBuffer out(buf, sizeof(buf));
+
+  if (single >= 0) {
+    // LTTB: ein Durchlauf, jeder ausgewählte Punkt als [Alter, Wert]
+    const HistoryChannel& hs = HISTORY_SERIES[single];
+    auto value = [single, &slot](uint32_t i) { return history.values[single][slot(i)]; };
+    auto negAge = [&ageSec](uint32_t i) { return -ageSec(i); };
+    out.appendf("{\"series\":\"%s\",\"seq\":%lu,\"boot\":%lu,\"data\":[", hs.key,
+      (unsigned long)last, (unsigned long)eventBootId);
+    bool first = true;
+    lttbSelect(count, points, negAge, value, [&](uint32_t i) {
+      out.appendf("%s[%.0f,%.*f]", first ? "" : ",", ageSec(i), hs.precision, value(i));
+      first = false;
+      flushHistoryChunk(out, false);
+    });
+    out.append("]}");
+    flushHistoryChunk(out, true);
+    server.sendContent("");
+    return;
+  }
+
+  // Zeitachse: Alter (s) des früheren/späteren Extremwerts je Bucket = Bucket-Anfang/-Ende
+  MinMaxDecimator decimator;
+  decimator.begin(count, points);
+  out.appendf("{\"seq\":%lu,\"boot\":%lu,\"points\":%lu,\"t\":[", (unsigned long)last,
+    (unsigned long)eventBootId, (unsigned long)decimator.outputCount());
+  bool first = true;
+  for (int i = 0; i < count; i++) {
+    decimator.push(ageSec(i), [&](uint32_t, float age) {
+      out.appendf("%s%.0f", first ? "" : ",", age);
+      first = false;
+    });
+    flushHistoryChunk(out, false);
+  }
+  out.append("]");
+
+  for (size_t c = 0; c < HISTORY_SERIES.size(); c++) {
+    const HistoryChannel& hs = HISTORY_SERIES[c];
+    out.appendf(",\"%s\":[", hs.key);
+    decimator.begin(count, points);
+    first = true;
+    for (int i = 0; i < count; i++) {
+      decimator.push(history.values[c][slot(i)], [&](uint32_t, float v) {
+        out.appendf("%s%.*f", first ? "" : ",", hs.precision, v);
+        first = false;
+      });
+      flushHistoryChunk(out, false);
     }
-    json += "]";
+    out.append("]");
   }
 
-  json += "}";
+  appendEnergy(out);
+  out.append("}");
+  flushHistoryChunk(out, true);
+  server.sendContent("");
+}
 
-  server.send(200, "application/json", json);
+// GET /api/events?since=<seq>&boot=<id>&limit=N  nur Ereignisse nach seq
+// (Dashboard pollt mit "next" und "boot" der vorigen Antwort)
+void handleAPIEvents() {
+  long sinceArg = server.hasArg("since") ? server.arg("since").toInt() : 0;
+  uint32_t since = sinceArg > 0 ? (uint32_t)sinceArg : 0;
+  uint32_t boot = server.hasArg("boot") ? strtoul(server.arg("boot").c_str(), nullptr, 10) : 0;
+  uint32_t limit = server.hasArg("limit")
+    ? constrain(server.arg("limit").toInt(), 1, EVENT_API_LIMIT) : EVENT_API_LIMIT;
+
+  portENTER_CRITICAL(&journalMux);
+  uint32_t first = journal.firstSeq();
+  uint32_t last = journal.lastSeq();
+  portEXIT_CRITICAL(&journalMux);
+
+  // Cursor aus der Zeit vor einem Neustart: von vorne beginnen. Die Boot-ID
+  // erkennt auch Neustarts, nach denen schon wieder mehr als since Ereignisse anfielen.
+  bool restarted = since > last || (boot != 0 && boot != eventBootId);
+  if (restarted) since = 0;
+  uint32_t from = since + 1;
+  uint32_t missed = 0;
+  if (from < first) {
+    missed = first - from;
+    from = first;
+  }
+  uint32_t to = min(last, from + limit - 1);
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  char buf[512];
+  TextBuffer out(buf, sizeof(buf));
+
+  out.appendf("{\"boot\":%lu,\"first\":%lu,\"last\":%lu,\"missed\":%lu,\"restarted\":%s,\"events\":[",
+    (unsigned long)eventBootId, (unsigned long)first, (unsigned long)last, (unsigned long)missed,
+    restarted ? "true" : "false");
+
+  uint32_t next = since;
+  JournalEvent e;
+  for (uint32_t seq = from; seq <= to; seq++) {
+    portENTER_CRITICAL(&journalMux);
+    bool ok = journal.get(seq, e);
+    portEXIT_CRITICAL(&journalMux);
+    if (!ok) continue;  // Inzwischen überschrieben
+
+    out.appendf("%s{\"seq\":%lu,\"%s\":%lu,\"type\":\"%s\",\"text\":", next > since ? "," : "",
+      (unsigned long)e.seq, (e.flags & EVENT_FLAG_NO_TIME) ? "uptime" : "time", (unsigned long)e.time,
+      e.code < EVT_COUNT ? EVENT_NAMES[e.code] : "?");
+    out.appendJsonString(e.text);
+    out.append("}");
+    next = seq;
+    flushHistoryChunk(out, false);
+  }
+
+  out.appendf("],\"next\":%lu,\"more\":%s}", (unsigned long)next, next < last ? "true" : "false");
+  flushHistoryChunk(out, true);
+  server.sendContent("");
 }
 
 void handleAPISettings() {
-  StaticJsonDocument<256> doc;
+  StaticJsonDocument<512> doc;
   doc["tempMin"] = troutParams.tempMin;
   doc["tempMax"] = troutParams.tempMax;
   doc["tempCritical"] = troutParams.tempCritical;
@@ -1712,6 +3834,13 @@ void handleAPISettings() {
   doc["tdsMax"] = troutParams.tdsMax;
   doc["doMin"] = troutParams.doMin;
   doc["doOptimal"] = troutParams.doOptimal;
+  doc["flowMin"] = alarmRules.flowMin;
+  doc["batteryWarning"] = alarmRules.batteryWarning;
+  doc["emailCooldownMin"] = alarmRules.emailCooldownMin;
+  doc["weatherLocation"] = weatherConfig.location;
+  doc["heatAirTemp"] = weatherConfig.heatAirTemp;
+  doc["heatDoBoost"] = weatherConfig.doBoost;
+  doc["heatTempShift"] = weatherConfig.tempShift;
   
   String response;
   serializeJson(doc, response);
@@ -1720,7 +3849,7 @@ void handleAPISettings() {
 
 void handleAPISettingsPost() {
   if (server.hasArg("plain")) {
-    StaticJsonDocument<256> doc;
+    StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     
     if (error) {
@@ -1736,6 +3865,23 @@ void handleAPISettingsPost() {
     if (doc.containsKey("tdsMax")) troutParams.tdsMax = doc["tdsMax"];
     if (doc.containsKey("doMin")) troutParams.doMin = doc["doMin"];
     if (doc.containsKey("doOptimal")) troutParams.doOptimal = doc["doOptimal"];
+    if (doc.containsKey("flowMin")) alarmRules.flowMin = doc["flowMin"];
+    if (doc.containsKey("batteryWarning")) alarmRules.batteryWarning = doc["batteryWarning"];
+    if (doc.containsKey("emailCooldownMin")) alarmRules.emailCooldownMin = doc["emailCooldownMin"];
+    if (doc.containsKey("weatherLocation")) {
+      const char* location = doc["weatherLocation"] | "";
+      if (strcmp(location, weatherConfig.location) != 0) {
+        strlcpy(weatherConfig.location, location, sizeof(weatherConfig.location));
+        weather.valid = false;           // Alte Vorhersage gehört zu einem anderen Ort
+        weather.count = 0;
+        weatherRequested = weatherConfig.location[0] != '\0';
+      }
+    }
+    if (doc.containsKey("heatAirTemp")) weatherConfig.heatAirTemp = doc["heatAirTemp"];
+    if (doc.containsKey("heatDoBoost")) weatherConfig.doBoost = doc["heatDoBoost"];
+    if (doc.containsKey("heatTempShift")) weatherConfig.tempShift = doc["heatTempShift"];
+
+    markSettingsDirty();  // Wird verzögert gespeichert (mehrere Änderungen = 1 Commit)
     
     server.send(200, "application/json", "{\"success\":true}");
   } else {
@@ -1758,310 +3904,1315 @@ void handleAPIRelay() {
   // Toggle-Modus: Auto → An → Aus → Auto
   relayModes[relay - 1]++;
   if (relayModes[relay - 1] > 2) relayModes[relay - 1] = 0;
+  markSettingsDirty();
 
   // Sofort anwenden
-  updateRelays();
+  requestRelayUpdate();
 
   String response = "{\"relay\":" + String(relay) + ",\"mode\":" + String(relayModes[relay - 1]) + "}";
   server.send(200, "application/json", response);
 }
 
+void handleAPIAeration() {
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  StaticJsonDocument<768> doc;
+  doc["mode"] = aerationConfig.mode;
+  doc["doBand"] = aerationConfig.doBand;
+  doc["tempBand"] = aerationConfig.tempBand;
+  doc["kp"] = aerationConfig.kp;
+  doc["ki"] = aerationConfig.ki;
+  doc["minOnSec"] = aerationConfig.minOnMs / 1000;
+  doc["minOffSec"] = aerationConfig.minOffMs / 1000;
+  doc["cycleSec"] = aerationConfig.cycleMs / 1000;
+  doc["blowerWatts"] = aerationConfig.blowerWatts;
+  doc["active"] = snap.aerationActive;
+  doc["piDuty"] = aerator.duty();
+  doc["dutyToday"] = snap.aeration.duty();
+  doc["energyWhToday"] = snap.aeration.energyWh(aerationConfig.blowerWatts);
+  doc["switchesToday"] = snap.aeration.switches;
+
+  JsonArray schedules = doc.createNestedArray("schedules");
+  for (int i = 0; i < 3; i++) {
+    JsonObject s = schedules.createNestedObject();
+    s["relay"] = i + 1;
+    s["on"] = relaySchedules[i].onMinute;
+    s["off"] = relaySchedules[i].offMinute;
+    s["days"] = relaySchedules[i].days;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  server.send(200, "application/json", response);
+}
+
+void handleAPIAerationPost() {
+  if (!server.hasArg("plain")) {
+    server.send(400, "application/json", "{\"error\":\"No data\"}");
+    return;
+  }
+
+  StaticJsonDocument<768> doc;
+  if (deserializeJson(doc, server.arg("plain"))) {
+    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    return;
+  }
+
+  if (doc.containsKey("mode")) aerationConfig.mode = doc["mode"] == 1 ? AERATION_PI : AERATION_HYSTERESIS;
+  if (doc.containsKey("doBand")) aerationConfig.doBand = doc["doBand"];
+  if (doc.containsKey("tempBand")) aerationConfig.tempBand = doc["tempBand"];
+  if (doc.containsKey("kp")) aerationConfig.kp = doc["kp"];
+  if (doc.containsKey("ki")) aerationConfig.ki = doc["ki"];
+  if (doc.containsKey("minOnSec")) aerationConfig.minOnMs = (uint32_t)doc["minOnSec"] * 1000;
+  if (doc.containsKey("minOffSec")) aerationConfig.minOffMs = (uint32_t)doc["minOffSec"] * 1000;
+  if (doc.containsKey("cycleSec")) aerationConfig.cycleMs = max((uint32_t)doc["cycleSec"], (uint32_t)60) * 1000;
+  if (doc.containsKey("blowerWatts")) aerationConfig.blowerWatts = doc["blowerWatts"];
+
+  // Zeitpläne: [{"relay":1,"on":360,"off":1320,"days":127}, ...]
+  for (JsonObject s : doc["schedules"].as<JsonArray>()) {
+    int relay = s["relay"] | 0;
+    if (relay < 1 || relay > 3) continue;
+    RelaySchedule& target = relaySchedules[relay - 1];
+    target.onMinute = constrain((int)(s["on"] | 0), 0, 1439);
+    target.offMinute = constrain((int)(s["off"] | 0), 0, 1439);
+    target.days = (s["days"] | 0) & 0x7F;
+  }
+
+  markSettingsDirty();
+  requestRelayUpdate();
+  server.send(200, "application/json", "{\"success\":true}");
+}
+
 void handleAPITestEmail() {
   sendEmailAlert("Test-Email", "Dies ist eine Test-Nachricht vom ForellenWächter.");
   server.send(200, "application/json", "{\"success\":true}");
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
-// KALIBRIERUNGS-API
+// KALIBRIERUNGS-API
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+void handleAPICalibrationGet() {
+  StaticJsonDocument<512> doc;
+  float phSlope, phOffset;
+  phLineVolts(calibration, phSlope, phOffset);
+
+  doc["ph"]["calibrated"] = calibration.ph_calibrated;
+  doc["ph"]["slope"] = phSlope;      // pH/V
+  doc["ph"]["offset"] = phOffset;    // pH bei 0 V
+  doc["ph"]["buffer1_adc"] = calibration.ph_buffer1_adc;
+  doc["ph"]["buffer2_adc"] = calibration.ph_buffer2_adc;
+  doc["ph"]["buffer1_value"] = calibration.ph_buffer1_value;
+  doc["ph"]["buffer2_value"] = calibration.ph_buffer2_value;
+
+  doc["tds"]["calibrated"] = calibration.tds_calibrated;
+  doc["tds"]["factor"] = tdsFactorPerMv(calibration);  // ppm/mV, 0 = Standard-Kurve
+  doc["tds"]["reference_adc"] = calibration.tds_reference_adc;
+  doc["tds"]["reference_value"] = calibration.tds_reference_value;
+
+  if (ENABLE_DO_SENSOR) {
+    doc["do"]["calibrated"] = calibration.do_calibrated;
+    doc["do"]["slope"] = calibration.do_slope;
+    doc["do"]["offset"] = calibration.do_offset;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  server.send(200, "application/json", response);
+}
+
+void handleAPICalibrationPH() {
+  if (!server.hasArg("plain")) {
+    server.send(400, "application/json", "{\"error\":\"No body\"}");
+    return;
+  }
+
+  StaticJsonDocument<256> doc;
+  DeserializationError error = deserializeJson(doc, server.arg("plain"));
+
+  if (error) {
+    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    return;
+  }
+
+  int step = doc["step"];  // 1 oder 2
+  float buffer_value = doc["buffer_value"];  // z.B. 4.0 oder 7.0
+  int adc_reading = sampleAdcRaw(PH_PIN);
+  if (adc_reading < 0) {
+    server.send(503, "application/json", "{\"error\":\"ADC busy\"}");
+    return;
+  }
+
+  if (step == 1) {
+    calibration.ph_buffer1_adc = adc_reading;
+    calibration.ph_buffer1_value = buffer_value;
+    Serial.printf("pH Kalibrierung Schritt 1: ADC=%d, pH=%.1f\n", adc_reading, buffer_value);
+    server.send(200, "application/json", "{\"success\":true,\"message\":\"Schritt 1 gespeichert\",\"adc\":" + String(adc_reading) + "}");
+  }
+  else if (step == 2) {
+    if (adc_reading == calibration.ph_buffer1_adc) {
+      server.send(400, "application/json", "{\"error\":\"Same ADC value as step 1\"}");
+      return;
+    }
+    calibration.ph_buffer2_adc = adc_reading;
+    calibration.ph_buffer2_value = buffer_value;
+    calibration.ph_calibrated = true;
+
+    saveCalibration();
+
+    // Gerade durch die Pufferpunkte in mV, wie readPH() sie ab jetzt anwendet
+    float m, b;
+    phLineVolts(calibration, m, b);
+    Serial.printf("pH Kalibrierung Schritt 2: ADC=%d, pH=%.1f\n", adc_reading, buffer_value);
+    Serial.printf("✅ pH kalibriert: %.3f pH/V, %.3f pH bei 0 V\n", m, b);
+
+    server.send(200, "application/json", "{\"success\":true,\"message\":\"Kalibrierung abgeschlossen\",\"slope\":" + String(m, 4) + ",\"offset\":" + String(b, 4) + "}");
+  }
+  else {
+    server.send(400, "application/json", "{\"error\":\"Invalid step (1 or 2)\"}");
+  }
+}
+
+void handleAPICalibrationTDS() {
+  if (!server.hasArg("plain")) {
+    server.send(400, "application/json", "{\"error\":\"No body\"}");
+    return;
+  }
+
+  StaticJsonDocument<256> doc;
+  DeserializationError error = deserializeJson(doc, server.arg("plain"));
+
+  if (error) {
+    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    return;
+  }
+
+  float reference_value = doc["reference_value"];  // z.B. 1413 ppm (1413 µS/cm Lösung)
+  int adc_reading = sampleAdcRaw(TDS_PIN);
+  if (adc_reading <= 0) {            // 0 = Sonde nicht eingetaucht (Division)
+    server.send(adc_reading < 0 ? 503 : 400, "application/json",
+                adc_reading < 0 ? "{\"error\":\"ADC busy\"}" : "{\"error\":\"No TDS signal\"}");
+    return;
+  }
+
+  calibration.tds_reference_adc = adc_reading;
+  calibration.tds_reference_value = reference_value;
+  calibration.tds_calibrated = true;
+
+  saveCalibration();
+
+  float factor = tdsFactorPerMv(calibration);
+  Serial.printf("✅ TDS kalibriert: ADC=%d, Referenz=%.0f ppm, Faktor=%.4f ppm/mV\n",
+                adc_reading, reference_value, factor);
+
+  server.send(200, "application/json", "{\"success\":true,\"message\":\"TDS kalibriert\",\"factor\":" + String(factor, 4) + "}");
+}
+
+void handleAPICalibrationReset() {
+  calibration.ph_calibrated = false;
+  calibration.tds_calibrated = false;
+
+  calibration.do_calibrated = false;
+  calibration.do_slope = 1.0;
+  calibration.do_offset = 0.0;
+
+  saveCalibration();
+
+  Serial.println("🔄 Kalibrierung zurückgesetzt");
+  server.send(200, "application/json", "{\"success\":true,\"message\":\"Kalibrierung zur\\u00fcckgesetzt\"}");
+}
+
+void handleCSS() {
+  server.send(200, "text/css", getCSS());
+}
+
+void handleJS() {
+  server.send(200, "application/javascript", getJS());
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TELEGRAM BOT FUNCTIONS (v1.6.1)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#if ENABLE_TELEGRAM
+void initTelegram() {
+  telegramPollClient.setInsecure();  // Für ESP32 (keine Zertifikatsprüfung)
+  telegramSendClient.setInsecure();
+  if (!TELEGRAM_API_TLS) {           // Lokaler Stand-in ohne TLS
+    telegramPollClient.setPlainStart();
+    telegramSendClient.setPlainStart();
+  }
+  bot = new UniversalTelegramBot(TELEGRAM_BOT_TOKEN, telegramPollClient);
+  bot->longPoll = TELEGRAM_LONG_POLL_SEC;
+  botSender = new UniversalTelegramBot(TELEGRAM_BOT_TOKEN, telegramSendClient);
+
+  telegramOutbox = xQueueCreate(TELEGRAM_QUEUE_SIZE, sizeof(TelegramMessage));
+  telegramRelayQueue = xQueueCreate(4, sizeof(uint8_t));
+
+  xTaskCreatePinnedToCore(telegramPollTask, "tg_poll", 8192, nullptr, 1, nullptr, TELEGRAM_TASK_CORE);
+  xTaskCreatePinnedToCore(telegramSendTask, "tg_send", 8192, nullptr, 1, nullptr, TELEGRAM_TASK_CORE);
+  Serial.println("✅ Telegram Bot initialisiert (Long Polling)");
+}
+
+// Nachricht in die Outbox legen - blockiert nie (Queue voll → verwerfen)
+bool queueTelegramMessage(const char* chatId, const char* text, bool markdown) {
+  if (!telegramOutbox) return false;
+
+  TelegramMessage msg;
+  strlcpy(msg.chatId, chatId, sizeof(msg.chatId));
+  strlcpy(msg.text, text, sizeof(msg.text));
+  msg.markdown = markdown;
+
+  if (xQueueSend(telegramOutbox, &msg, 0) != pdTRUE) {
+    telegramDropped++;
+    return false;
+  }
+  return true;
+}
+
+// Anbindung von src/telegram_tasks.h: Bot, WiFi, HTTPS-Pool und FreeRTOS
+struct TelegramPollLink {
+  bool connected() { return WiFi.status() == WL_CONNECTED; }
+  bool reserve() { return httpsPool.reserveExternal(); }
+  void release() {
+    telegramPollClient.stop();
+    httpsPool.releaseExternal();
+  }
+  uint32_t millis() { return ::millis(); }
+  int getUpdates() { return bot->getUpdates(bot->last_message_received + 1); }
+  void handle(int i) { handleTelegramCommand(bot->messages[i].chat_id, bot->messages[i].text); }
+};
+
+struct TelegramSendLink {
+  bool connected() { return WiFi.status() == WL_CONNECTED; }
+  bool reserve() { return httpsPool.reserveExternal(); }
+  void release() {
+    telegramSendClient.stop();
+    httpsPool.releaseExternal();
+  }
+  uint32_t millis() { return ::millis(); }
+  void sleep(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+  bool receive(TelegramMessage& msg, uint32_t waitMs) {
+    TickType_t wait = waitMs == TELEGRAM_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+    return xQueueReceive(telegramOutbox, &msg, wait) == pdTRUE;
+  }
+  bool send(const TelegramMessage& msg) {
+    return botSender->sendMessage(msg.chatId, msg.text, msg.markdown ? "Markdown" : "");
+  }
+};
+
+// Long Polling: eine gehaltene Anfrage statt 30 Anfragen pro Minute.
+// Die Verbindung bleibt offen und belegt solange einen Platz im HTTPS-Pool.
+void telegramPollTask(void* param) {
+  TelegramPollLink link;
+  TelegramPollState state;
+  for (;;) {
+    uint32_t wait = telegramPollStep(link, state);
+    if (wait) vTaskDelay(pdMS_TO_TICKS(wait));
+  }
+}
+
+// Versand mit Telegram-Rate-Limit und Backoff bei Fehlern. Die Verbindung
+// (und ihr Pool-Platz) wird nur bei Bedarf geöffnet.
+void telegramSendTask(void* param) {
+  TelegramSendLink link;
+  TelegramSendState state;
+  TelegramMessage msg;
+  for (;;) {
+    TelegramSendResult result = telegramSendStep(link, state, msg);
+    if (result == TELEGRAM_SENT) telegramSent++;
+    else if (result == TELEGRAM_DROPPED) telegramDropped++;
+  }
+}
+
+void handleTelegramCommand(const String& chatId, const String& text) {
+  // Nur auf konfigurierte Chat-ID reagieren
+  if (chatId != TELEGRAM_CHAT_ID) {
+    queueTelegramMessage(chatId.c_str(), "⛔ Nicht autorisiert!", false);
+    return;
+  }
+
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  char msg[480];
+  TextBuffer out(msg, sizeof(msg));
+
+  // Befehle verarbeiten
+  if (text == "/start") {
+    out.append("🐟 ForellenWächter Bot aktiv!\n\n");
+    out.append("Verfügbare Befehle:\n");
+    out.append("/status - Alle Sensordaten\n");
+    out.append("/temp - Temperaturen\n");
+    out.append("/water - Wasserqualität\n");
+    out.append("/power - Turbine & Batterie\n");
+    out.append("/alarm - Alarm-Status\n");
+    out.append("/relay1-4 - Relais-Modus wechseln");
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, false);
+  }
+  else if (text == "/status") {
+    out.append("📊 *ForellenWächter Status*\n\n");
+    writeTextFields(out, SENSOR_FIELDS, snap);
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+  }
+  else if (text == "/temp") {
+    out.append("🌡️ *Temperaturen*\n\n");
+    writeTextFields(out, SENSOR_FIELDS, snap, GROUP_TEMP);
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+  }
+  else if (text == "/water") {
+    out.append("💧 *Wasserqualität*\n\n");
+    writeTextFields(out, SENSOR_FIELDS, snap, GROUP_WATER);
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+  }
+  else if (text == "/power") {
+    out.append("⚡ *Turbine & Batterie*\n\n");
+    writeTextFields(out, SENSOR_FIELDS, snap, GROUP_POWER);
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+  }
+  else if (text == "/alarm") {
+    out.append("🚨 *Alarm-Status*\n\n");
+    if (snap.alarmActive) {
+      out.appendf("Status: AKTIV\nGrund: %s", snap.alarmReason);
+    } else {
+      out.append("Status: Kein Alarm");
+    }
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+  }
+  else if (text.startsWith("/relay")) {
+    // Relais gehören dem Haupt-Task → Befehl an loop() übergeben
+    int relayNum = text.substring(6).toInt() - 1;
+    if (relayNum >= 0 && relayNum < 4) {
+      uint8_t relay = relayNum;
+      xQueueSend(telegramRelayQueue, &relay, 0);
+    }
+  }
+  else {
+    queueTelegramMessage(TELEGRAM_CHAT_ID, "❓ Unbekannter Befehl. Sende /start für Hilfe.", false);
+  }
+}
+
+// Läuft in loop(): Relais-Modus wechseln wie über /api/relay (Auto → An → Aus)
+void handleTelegramRelayCommands() {
+  if (!telegramRelayQueue) return;
+
+  uint8_t relay;
+  while (xQueueReceive(telegramRelayQueue, &relay, 0) == pdTRUE) {
+    relayModes[relay]++;
+    if (relayModes[relay] > 2) relayModes[relay] = 0;
+    markSettingsDirty();
+    requestRelayUpdate();
+
+    static const char* modeNames[3] = {"Auto", "An", "Aus"};
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Relais %d: %s", relay + 1, modeNames[relayModes[relay]]);
+    queueTelegramMessage(TELEGRAM_CHAT_ID, msg, false);
+  }
+}
+
+// Aufruf aus loop() (Alarm-Meldung aus dem Regel-Task)
+void sendTelegramAlarm(const char* reason) {
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+  char msg[480];
+  snprintf(msg, sizeof(msg), "🚨 *ALARM!*\n\n%s\n\n💧 Wasser: %.1f°C\n🧪 pH: %.2f",
+           reason, snap.waterTemp, snap.ph);
+  queueTelegramMessage(TELEGRAM_CHAT_ID, msg, true);
+}
+#endif
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DYNDNS UPDATE FUNCTION (v1.6.1)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#if ENABLE_DYNDNS
+void updateDynDNS() {
+  if (!WiFi.isConnected() && !sysStatus.lteConnected) {
+    Serial.println("⚠️  DynDNS: Keine Internetverbindung");
+    return;
+  }
+
+  HTTPClient http;
+  String url = "https://www.duckdns.org/update?domains=" + String(DYNDNS_DOMAIN).substring(0, String(DYNDNS_DOMAIN).indexOf('.'));
+  url += "&token=" + String(DYNDNS_TOKEN);
+  url += "&ip=";  // IP wird automatisch erkannt
+
+  esp_task_wdt_reset();    // WDT reset vor Verbindungsaufbau
+  // Verbindung bis zum nächsten Update halten, sonst gäbe es nie eine Wiederverwendung
+  WiFiClientSecure* client = httpsPool.acquire(url.c_str(), DYNDNS_UPDATE_INTERVAL + 30000);
+  if (!client) {
+    Serial.println("❌ DynDNS: Keine TLS-Verbindung");
+    return;
+  }
+
+  http.setReuse(true);
+  http.begin(*client, url);
+  http.setTimeout(10000);  // 10 Sekunden Timeout
+  esp_task_wdt_reset();    // WDT reset vor GET
+  int httpCode = http.GET();
+  esp_task_wdt_reset();    // WDT reset nach GET
+
+  if (httpCode == 200) {
+    String response = http.getString();
+    if (response == "OK") {
+      Serial.println("✅ DynDNS Update erfolgreich");
+      Serial.println("🌐 Domain: " + String(DYNDNS_DOMAIN));
+    } else {
+      Serial.println("❌ DynDNS Update fehlgeschlagen: " + response);
+    }
+  } else {
+    Serial.printf("❌ DynDNS HTTP Error: %d\n", httpCode);
+  }
+
+  http.end();
+  httpsPool.release(client, httpCode > 0);
+}
+#endif
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DATEN-EXPORT (SD → HTTP)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// "JJJJ-MM-TT" → tm (12 Uhr, damit Sommerzeit den Tag nicht verschiebt)
+bool parseExportDate(const String& text, struct tm& day) {
+  int year, month, mday;
+  if (sscanf(text.c_str(), "%4d-%2d-%2d", &year, &month, &mday) != 3) return false;
+  memset(&day, 0, sizeof(day));
+  day.tm_year = year - 1900;
+  day.tm_mon = month - 1;
+  day.tm_mday = mday;
+  day.tm_hour = 12;
+  day.tm_isdst = -1;
+  return mktime(&day) != (time_t)-1;
+}
+
+// Datei des n-ten Tags ab from. CSV-Kopfzeile nur in der ersten Datei und dort,
+// wo sich die Spalten ändern (Tage vor einem Firmware-Update). headerCrc = CRC der
+// zuletzt ausgegebenen Kopfzeile, 0 = noch keine.
+bool getExportPart(const struct tm& from, int dayOffset, bool csv, uint32_t& headerCrc, ExportPart& part) {
+  struct tm day = from;
+  day.tm_mday += dayOffset;
+  mktime(&day);
+  snprintf(part.path, sizeof(part.path), "/logs/%04d-%02d-%02d.%s",
+           day.tm_year + 1900, day.tm_mon + 1, day.tm_mday, csv ? "csv" : "bin");
+  if (!SD.exists(part.path)) return false;
+
+  File file = SD.open(part.path);
+  if (!file) return false;
+  uint32_t size = file.size();
+  part.skip = 0;
+  if (csv) {
+    uint32_t crc = 0;
+    uint32_t lineLen = 0;
+    int c;
+    while ((c = file.read()) >= 0) {
+      uint8_t b = c;
+      crc = esp_rom_crc32_le(crc, &b, 1);
+      lineLen++;
+      if (c == '\n') break;
+    }
+    if (crc == headerCrc) part.skip = lineLen;
+    else headerCrc = crc;
+  }
+  file.close();
+
+  part.len = size > part.skip ? size - part.skip : 0;
+  return part.len > 0;
+}
+
+// GET /api/export?from=JJJJ-MM-TT&to=JJJJ-MM-TT&format=csv|bin
+// Tagesdateien werden als eine fortlaufende Datei gestreamt (Chunked Transfer),
+// "Range: bytes=N-" setzt einen abgebrochenen Download fort, "bytes=-N" liefert
+// die letzten N Bytes.
+void handleAPIExport() {
+  StallScope phase(stallProfiler, PHASE_EXPORT);
+  if (!ENABLE_SD_LOGGING || !sysStatus.sdCardOK) {
+    server.send(503, "application/json", "{\"error\":\"SD card not available\"}");
+    return;
+  }
+
+  String format = server.hasArg("format") ? server.arg("format") : "csv";
+  if (format != "csv" && format != "bin") {
+    server.send(400, "application/json", "{\"error\":\"format must be csv or bin\"}");
+    return;
+  }
+  bool csv = format == "csv";
+
+  String today = getDateString();
+  struct tm from, to;
+  if (!parseExportDate(server.hasArg("from") ? server.arg("from") : today, from) ||
+      !parseExportDate(server.hasArg("to") ? server.arg("to") : today, to)) {
+    server.send(400, "application/json", "{\"error\":\"Invalid date (YYYY-MM-DD)\"}");
+    return;
+  }
+  int days = (int)lround(difftime(mktime(&to), mktime(&from)) / 86400.0) + 1;
+  if (days < 1 || days > EXPORT_MAX_DAYS) {
+    server.send(400, "application/json", "{\"error\":\"Invalid date range\"}");
+    return;
+  }
+
+  // Durchgang 1: Gesamtgröße (Stand jetzt; die heutige Datei kann danach noch wachsen)
+  ExportPart part;
+  uint32_t total = 0;
+  uint32_t headerCrc = 0;
+  for (int d = 0; d < days; d++) {
+    esp_task_wdt_reset();
+    if (!getExportPart(from, d, csv, headerCrc, part)) continue;
+    total += part.len;
+  }
+  if (total == 0) {
+    server.send(404, "application/json", "{\"error\":\"No logs in range\"}");
+    return;
+  }
+
+  // Range: "bytes=START-", "bytes=START-END" oder "bytes=-N" (die letzten N Bytes)
+  uint32_t start = 0, end = total - 1;
+  bool partial = false;
+  if (server.hasHeader("Range")) {
+    String range = server.header("Range");
+    unsigned long a = 0, b = 0;
+    int n = 0;
+    if (range.startsWith("bytes=-")) {
+      if (sscanf(range.c_str(), "bytes=-%lu", &b) == 1) {
+        n = 1;
+        a = b == 0 ? total : (b < total ? total - b : 0);   // N = 0 → nicht erfüllbar
+      }
+    } else {
+      n = sscanf(range.c_str(), "bytes=%lu-%lu", &a, &b);
+    }
+    if (n >= 1) {
+      start = a;
+      if (n == 2 && b < end) end = b;
+      if (start > end) {
+        server.sendHeader("Content-Range", "bytes */" + String(total));
+        server.send(416, "application/json", "{\"error\":\"Range not satisfiable\"}");
+        return;
+      }
+      partial = true;
+    }
+  }
+
+  char header[96];
+  snprintf(header, sizeof(header), "attachment; filename=\"forellenwaechter_%s_%s.%s\"",
+           (server.hasArg("from") ? server.arg("from") : today).c_str(),
+           (server.hasArg("to") ? server.arg("to") : today).c_str(), format.c_str());
+  server.sendHeader("Content-Disposition", header);
+  server.sendHeader("Accept-Ranges", "bytes");
+  if (partial) {
+    snprintf(header, sizeof(header), "bytes %lu-%lu/%lu",
+             (unsigned long)start, (unsigned long)end, (unsigned long)total);
+    server.sendHeader("Content-Range", header);
+  }
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(partial ? 206 : 200, csv ? "text/csv" : "application/octet-stream", "");
+
+  // Durchgang 2: Streamen mit festem Puffer (Alarme laufen im Steuer-Task weiter,
+  // hier nur Watchdog und Verbindung prüfen)
+  static uint8_t chunk[EXPORT_CHUNK_SIZE];
+  uint32_t pos = 0, remaining = end - start + 1, sent = 0;
+  unsigned long startMs = millis();
+  bool aborted = false;
+  headerCrc = 0;
+
+  for (int d = 0; d < days && remaining > 0 && !aborted; d++) {
+    if (!getExportPart(from, d, csv, headerCrc, part)) continue;
+    if (pos + part.len <= start) {
+      pos += part.len;
+      continue;
+    }
+
+    uint32_t offset = start > pos ? start - pos : 0;
+    uint32_t left = min(part.len - offset, remaining);
+    File file = SD.open(part.path);
+    if (!file || !file.seek(part.skip + offset)) {
+      aborted = true;
+      break;
+    }
+    while (left > 0) {
+      size_t got = file.read(chunk, min((uint32_t)sizeof(chunk), left));
+      if (got == 0) {
+        aborted = true;
+        break;
+      }
+      server.sendContent((const char*)chunk, got);
+      left -= got;
+      remaining -= got;
+      sent += got;
+
+      if (!server.client().connected()) {
+        aborted = true;
+        break;
+      }
+      esp_task_wdt_reset();
+    }
+    file.close();
+    pos += part.len;
+  }
+  server.sendContent("");
+
+  unsigned long elapsed = millis() - startMs;
+  exportStats.count++;
+  exportStats.lastBytes = sent;
+  exportStats.lastMs = elapsed;
+
+  char report[96];
+  snprintf(report, sizeof(report), "%s %lu Bytes ab %lu in %lu ms (%.1f KB/s)%s",
+           format.c_str(), (unsigned long)sent, (unsigned long)start, elapsed,
+           elapsed ? sent / (float)elapsed : 0.0f, aborted ? " - abgebrochen" : "");
+  Serial.printf("📤 Export: %s\n", report);
+  logEvent(EVT_EXPORT, report);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TELEMETRIE UPLINK
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#if ENABLE_TELEMETRY
+uint32_t telemetryTime(uint8_t& flags) {
+  time_t now = time(nullptr);
+  if (now > 1600000000) return (uint32_t)now;  // NTP-Zeit vorhanden
+  flags |= TELEMETRY_FLAG_NO_TIME;
+  return millis() / 1000;
+}
+
+void startTelemetryBatch() {
+  uint8_t flags = 0;
+  telemetryBatch.begin(MDNS_NAME, telemetryTime(flags));
+}
+
+void getSpoolFilename(uint32_t seq, char* buf, size_t len) {
+  snprintf(buf, len, "/spool/%08lu.mpk", (unsigned long)seq);
+}
+
+void initTelemetry() {
+  startTelemetryBatch();
+
+  if (!sysStatus.sdCardOK) return;
+  if (!SD.exists("/spool")) SD.mkdir("/spool");
+
+  // Spool-Bereich aus vorhandenen Dateien bestimmen
+  File dir = SD.open("/spool");
+  bool found = false;
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    const char* name = strrchr(f.name(), '/');
+    uint32_t seq = strtoul(name ? name + 1 : f.name(), nullptr, 10);
+    f.close();
+    if (!found || seq < spoolHead) spoolHead = seq;
+    if (!found || seq + 1 > spoolTail) spoolTail = seq + 1;
+    found = true;
+  }
+  dir.close();
+
+  Serial.printf("✅ Telemetrie: %lu Batches im Spool\n", (unsigned long)(spoolTail - spoolHead));
+}
+
+void sampleTelemetry() {
+  SensorSnapshot snap;
+  readSensorSnapshot(snap);
+
+  TelemetrySample sample;
+  sample.flags = 0;
+  sample.time = telemetryTime(sample.flags);
+  sample.values[0] = lroundf(snap.waterTemp * 100);
+  sample.values[1] = lroundf(snap.airTemp * 100);
+  sample.values[2] = lroundf(snap.ph * 100);
+  sample.values[3] = lroundf(snap.tds);
+  sample.values[4] = lroundf(snap.dissolvedOxygen * 100);
+  sample.values[5] = lroundf(snap.flowRate * 100);
+  sample.values[6] = lroundf(snap.batteryVoltage * 1000);
+  if (snap.waterLevelOK) sample.flags |= TELEMETRY_FLAG_LEVEL_OK;
+  if (snap.aerationActive) sample.flags |= TELEMETRY_FLAG_AERATION;
+  if (snap.alarmActive) sample.flags |= TELEMETRY_FLAG_ALARM;
+
+  if (!telemetryBatch.add(sample)) {
+    // Batch voll vor dem Upload-Intervall → in den Spool
+    size_t len;
+    const uint8_t* data = telemetryBatch.finish(len);
+    spoolTelemetryBatch(data, len);
+    startTelemetryBatch();
+    telemetryBatch.add(sample);
+  }
+}
+
+void spoolTelemetryBatch(const uint8_t* data, size_t len) {
+  if (!sysStatus.sdCardOK) {
+    telemetryStats.batchesDropped++;
+    return;
+  }
+
+  // Spool begrenzen: ältesten Batch verwerfen
+  char filename[24];
+  if (spoolTail - spoolHead >= TELEMETRY_SPOOL_MAX) {
+    getSpoolFilename(spoolHead++, filename, sizeof(filename));
+    SD.remove(filename);
+    telemetryStats.batchesDropped++;
+  }
+
+  getSpoolFilename(spoolTail, filename, sizeof(filename));
+  File file = SD.open(filename, FILE_WRITE);
+  if (!file) {
+    telemetryStats.batchesDropped++;
+    return;
+  }
+  bool ok = file.write(data, len) == len;
+  file.close();
+
+  if (ok) {
+    spoolTail++;
+  } else {
+    SD.remove(filename);
+    telemetryStats.batchesDropped++;
+  }
+}
+
+bool postTelemetry(const uint8_t* data, size_t len) {
+  if (!sendHTTPPost(TELEMETRY_URL, data, len, "application/msgpack")) return false;
+  telemetryStats.batchesSent++;
+  telemetryStats.bytesSent += len;
+  return true;
+}
+
+// Ältester Batch zuerst, dann der aktuelle - ein Verbindungsfenster für alles
+void uploadTelemetry() {
+  size_t len;
+  const uint8_t* data;
+
+  if (!isInternetAvailable()) {
+    if (telemetryBatch.records() > 0) {
+      data = telemetryBatch.finish(len);
+      spoolTelemetryBatch(data, len);
+      startTelemetryBatch();
+    }
+    return;
+  }
+
+  bool online = true;
+  char filename[24];
+  for (int i = 0; i < TELEMETRY_CATCHUP_PER_UPLOAD && spoolHead < spoolTail; i++) {
+    getSpoolFilename(spoolHead, filename, sizeof(filename));
+    File file = SD.open(filename, FILE_READ);
+    if (file) {
+      size_t size = file.read(telemetrySpoolBuffer, sizeof(telemetrySpoolBuffer));
+      file.close();
+      if (!postTelemetry(telemetrySpoolBuffer, size)) {
+        online = false;
+        break;
+      }
+      SD.remove(filename);
+    }
+    spoolHead++;
+    esp_task_wdt_reset();
+  }
+
+  if (telemetryBatch.records() == 0) return;
+
+  data = telemetryBatch.finish(len);
+  if (!online || spoolHead < spoolTail || !postTelemetry(data, len)) {
+    // Reihenfolge wahren: hinter die noch offenen Batches einreihen
+    spoolTelemetryBatch(data, len);
+  }
+  startTelemetryBatch();
+
+  if (DEBUG_MODE) {
+    Serial.printf("📤 Telemetrie: %lu Batches gesendet, %lu im Spool\n",
+                  (unsigned long)telemetryStats.batchesSent,
+                  (unsigned long)(spoolTail - spoolHead));
+  }
+}
+#endif
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DELTA-UPDATES ÜBER LTE
 // ═══════════════════════════════════════════════════════════════════════════════════
 
-void handleAPICalibrationGet() {
-  StaticJsonDocument<512> doc;
+#if ENABLE_DELTA_OTA
+// Arduino-Core: Rollback-Bestätigung selbst übernehmen (confirmFirmware)
+extern "C" bool verifyRollbackLater() {
+  return true;
+}
 
-  doc["ph"]["calibrated"] = calibration.ph_calibrated;
-  doc["ph"]["slope"] = calibration.ph_slope;
-  doc["ph"]["offset"] = calibration.ph_offset;
-  doc["ph"]["buffer1_adc"] = calibration.ph_buffer1_adc;
-  doc["ph"]["buffer2_adc"] = calibration.ph_buffer2_adc;
-  doc["ph"]["buffer1_value"] = calibration.ph_buffer1_value;
-  doc["ph"]["buffer2_value"] = calibration.ph_buffer2_value;
+// Beim Start: unbestätigte neue Firmware bzw. erfolgten Rollback erkennen
+void checkFirmwareRollback() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  esp_ota_img_states_t state;
+  if (esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+    deltaOta.pendingVerify = true;
+    Serial.printf("🔄 Neue Firmware in %s - Bestätigung nach Probelauf\n", running->label);
+  }
 
-  doc["tds"]["calibrated"] = calibration.tds_calibrated;
-  doc["tds"]["factor"] = calibration.tds_factor;
-  doc["tds"]["reference_adc"] = calibration.tds_reference_adc;
-  doc["tds"]["reference_value"] = calibration.tds_reference_value;
+  const esp_partition_t* invalid = esp_ota_get_last_invalid_partition();
+  if (invalid) {
+    deltaOta.rolledBack = true;
+    Serial.printf("⚠️  Firmware in %s wurde verworfen (Rollback)\n", invalid->label);
+  }
+}
 
-  if (ENABLE_DO_SENSOR) {
-    doc["do"]["calibrated"] = calibration.do_calibrated;
-    doc["do"]["slope"] = calibration.do_slope;
-    doc["do"]["offset"] = calibration.do_offset;
+// Probelauf bestanden: Hauptschleife läuft, Sensoren liefern, LTE erreichbar.
+// Stürzt die neue Firmware vorher ab, startet der Bootloader die alte.
+void confirmFirmware() {
+  if (!deltaOta.pendingVerify) return;
+  unsigned long running = millis() - startTime;
+  if (running < DELTA_OTA_CONFIRM_MS) return;
+
+  bool healthy = samplers[CH_TEMPERATURE].count() > 1 && (!ENABLE_LTE || sysStatus.lteConnected);
+  if (healthy) {
+    esp_ota_mark_app_valid_cancel_rollback();
+    deltaOta.pendingVerify = false;
+    Serial.println("✅ Neue Firmware bestätigt");
+    logEvent(EVT_OTA_CONFIRMED, FIRMWARE_VERSION);
+  } else if (running > 5 * DELTA_OTA_CONFIRM_MS) {
+    // Ohne LTE wäre die Anlage aus der Ferne nicht mehr erreichbar
+    Serial.println("❌ Probelauf fehlgeschlagen - zurück zur alten Firmware");
+    logEvent(EVT_OTA_ROLLBACK, FIRMWARE_VERSION);
+    if (settingsDirty) saveSettings();
+    esp_ota_mark_app_invalid_rollback_and_reboot();
   }
+}
 
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response);
+// GET mit Range-Header; Body liegt danach im Modem-Puffer (AT+HTTPREAD)
+int lteHttpGetRange(uint32_t from, uint32_t to, uint32_t& bodyLen) {
+  char cmd[80];
+  snprintf(cmd, sizeof(cmd), "AT+HTTPPARA=\"USERDATA\",\"Range: bytes=%lu-%lu\"",
+           (unsigned long)from, (unsigned long)to);
+  sendATCommand(cmd, 500);
+
+  return lteHttpGet(bodyLen);
 }
 
-void handleAPICalibrationPH() {
-  if (!server.hasArg("plain")) {
-    server.send(400, "application/json", "{\"error\":\"No body\"}");
-    return;
+// Patch-Kopf: Basis gegen laufende Firmware prüfen, erst dann die OTA-Partition öffnen
+bool onDeltaHeader(void* ctx, const DeltaHeader& header) {
+  DeltaOtaTarget* target = (DeltaOtaTarget*)ctx;
+  if (header.oldSize > target->running->size || header.newSize > target->update->size) {
+    Serial.println("❌ Delta-Update: Image passt nicht in die Partition");
+    return false;
   }
 
-  StaticJsonDocument<256> doc;
-  DeserializationError error = deserializeJson(doc, server.arg("plain"));
-
-  if (error) {
-    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-    return;
+  Sha256 hash;
+  uint8_t buf[1024];
+  for (uint32_t pos = 0; pos < header.oldSize; pos += sizeof(buf)) {
+    size_t n = min((uint32_t)sizeof(buf), header.oldSize - pos);
+    if (esp_partition_read(target->running, pos, buf, n) != ESP_OK) return false;
+    hash.update(buf, n);
+    if ((pos & 0xFFFF) == 0) esp_task_wdt_reset();
+  }
+  uint8_t digest[32];
+  hash.finish(digest);
+  if (memcmp(digest, header.oldHash, sizeof(digest)) != 0) {
+    Serial.println("❌ Delta-Update: Patch gehört zu einer anderen Firmware");
+    return false;
   }
 
-  int step = doc["step"];  // 1 oder 2
-  float buffer_value = doc["buffer_value"];  // z.B. 4.0 oder 7.0
-  int adc_reading = analogRead(PH_PIN);
+  // Löscht nur die Sektoren für newSize
+  esp_task_wdt_reset();
+  if (esp_ota_begin(target->update, header.newSize, &target->handle) != ESP_OK) return false;
+  esp_task_wdt_reset();
+  target->begun = true;
+  deltaOta.imageBytes = header.newSize;
+  Serial.printf("   Basis OK, neue Firmware %lu Bytes → %s\n",
+                (unsigned long)header.newSize, target->update->label);
+  return true;
+}
 
-  if (step == 1) {
-    calibration.ph_buffer1_adc = adc_reading;
-    calibration.ph_buffer1_value = buffer_value;
-    Serial.printf("pH Kalibrierung Schritt 1: ADC=%d, pH=%.1f\n", adc_reading, buffer_value);
-    server.send(200, "application/json", "{\"success\":true,\"message\":\"Schritt 1 gespeichert\",\"adc\":" + String(adc_reading) + "}");
+bool readOldImage(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+  DeltaOtaTarget* target = (DeltaOtaTarget*)ctx;
+  return esp_partition_read(target->running, offset, buf, len) == ESP_OK;
+}
+
+bool writeNewImage(void* ctx, const uint8_t* buf, size_t len) {
+  DeltaOtaTarget* target = (DeltaOtaTarget*)ctx;
+  return esp_ota_write(target->handle, buf, len) == ESP_OK;
+}
+
+void setDeltaResult(const char* result) {
+  strncpy(deltaOta.lastResult, result, sizeof(deltaOta.lastResult) - 1);
+  deltaOta.lastResult[sizeof(deltaOta.lastResult) - 1] = '\0';
+}
+
+// Patch für die laufende Version anfordern. Die Blöcke werden danach in
+// stepDeltaUpdate() geladen und direkt in die OTA-Partition geschrieben.
+void startDeltaUpdate() {
+  deltaJob.target = {esp_ota_get_running_partition(), esp_ota_get_next_update_partition(nullptr), 0, false};
+  if (!deltaJob.target.update) {
+    setDeltaResult("Keine OTA-Partition");
+    return;
   }
-  else if (step == 2) {
-    calibration.ph_buffer2_adc = adc_reading;
-    calibration.ph_buffer2_value = buffer_value;
 
-    // Berechne Slope und Offset (y = mx + b)
-    float m = (calibration.ph_buffer2_value - calibration.ph_buffer1_value) /
-              (calibration.ph_buffer2_adc - calibration.ph_buffer1_adc);
-    float b = calibration.ph_buffer1_value - (m * calibration.ph_buffer1_adc);
+  Serial.printf("🔄 Delta-Update: %s%s.fwd\n", DELTA_OTA_URL, FIRMWARE_VERSION);
+  deltaPatcher.begin(readOldImage, writeNewImage, onDeltaHeader, &deltaJob.target);
+  deltaJob.active = true;
+  deltaJob.offset = 0;
+  deltaJob.status = DELTA_OK;
+  deltaJob.wholeBody = false;
+  deltaOta.patchBytes = 0;
+  deltaOta.imageBytes = 0;
+  setDeltaResult("Läuft");
+}
 
-    calibration.ph_slope = m;
-    calibration.ph_offset = b;
-    calibration.ph_calibrated = true;
+// Einen Range-Block laden und verrechnen. Jeder Block hat seine eigene
+// HTTP-Sitzung im Modem, damit Telemetrie, Wetter und Alarme das Modem
+// zwischen zwei Blöcken nutzen können. Antwortet der Server mit 200 (Range
+// ignoriert), liegt der ganze Patch im Modem: die Sitzung bleibt offen und jeder
+// weitere Durchlauf liest nur einen AT+HTTPREAD-Block daraus, statt den Patch
+// pro Block neu zu laden.
+void stepDeltaUpdate() {
+  StallScope phase(stallProfiler, PHASE_DELTA_OTA);
+  static uint8_t chunk[LTE_HTTP_READ_SIZE];
+  const char* error = nullptr;
+  uint32_t from = deltaJob.offset;
+  uint32_t pos, last;                // Lesebereich im Modem-Puffer
+
+  if (deltaJob.wholeBody) {
+    pos = from;
+    last = min(deltaJob.bodyLen, from + (uint32_t)sizeof(chunk));
+  } else {
+    char url[160];
+    snprintf(url, sizeof(url), "%s%s.fwd", DELTA_OTA_URL, FIRMWARE_VERSION);
+    sendATCommand("AT+HTTPINIT", 2000);
+    String urlCmd = "AT+HTTPPARA=\"URL\",\"" + String(url) + "\"";
+    sendATCommand(urlCmd.c_str(), 1000);
+    esp_task_wdt_reset();
 
-    saveCalibration();
+    uint32_t bodyLen = 0;
+    int code = lteHttpGetRange(from, from + DELTA_OTA_RANGE_SIZE - 1, bodyLen);
+    esp_task_wdt_reset();
 
-    Serial.printf("pH Kalibrierung Schritt 2: ADC=%d, pH=%.1f\n", adc_reading, buffer_value);
-    Serial.printf("✅ pH kalibriert: Slope=%.4f, Offset=%.4f\n", m, b);
+    pos = 0;
+    last = bodyLen;
+    if (code == 404 && from == 0) {
+      error = "Kein Update";
+    } else if (code == 200 && bodyLen > from) {
+      // Ab hier Modem-Offset = Patch-Offset; erster Block sofort
+      deltaJob.wholeBody = true;
+      deltaJob.bodyLen = bodyLen;
+      lteHttpHeld = true;
+      pos = from;
+      last = min(bodyLen, from + (uint32_t)sizeof(chunk));
+      Serial.printf("   Server ohne Range: %lu Bytes, Rest aus derselben Sitzung\n",
+                    (unsigned long)(bodyLen - from));
+    } else if (code != 206 || bodyLen == 0) {
+      error = "HTTP-Fehler";
+    }
+  }
 
-    server.send(200, "application/json", "{\"success\":true,\"message\":\"Kalibrierung abgeschlossen\",\"slope\":" + String(m, 4) + ",\"offset\":" + String(b, 4) + "}");
+  while (!error && pos < last && deltaJob.status == DELTA_OK) {
+    size_t n = min((uint32_t)sizeof(chunk), last - pos);
+    if (!lteHttpRead(pos, chunk, n)) {
+      error = "Modem-Lesefehler";
+      break;
+    }
+    deltaJob.status = deltaPatcher.feed(chunk, n);
+    pos += n;
+    deltaJob.offset += n;
+    deltaOta.patchBytes = deltaJob.offset;
+    esp_task_wdt_reset();
   }
-  else {
-    server.send(400, "application/json", "{\"error\":\"Invalid step (1 or 2)\"}");
+  if (!deltaJob.wholeBody) {
+    sendATCommand("AT+HTTPTERM", 1000);
+  } else if (!error && deltaJob.status == DELTA_OK && deltaJob.offset >= deltaJob.bodyLen) {
+    error = "Patch unvollständig";
+  }
+
+  if (error) {
+    finishDeltaUpdate(error);
+  } else if (deltaJob.status == DELTA_DONE) {
+    finishDeltaUpdate(nullptr);
+  } else if (deltaJob.status != DELTA_OK) {
+    finishDeltaUpdate(deltaStatusName(deltaJob.status));
   }
 }
 
-void handleAPICalibrationTDS() {
-  if (!server.hasArg("plain")) {
-    server.send(400, "application/json", "{\"error\":\"No body\"}");
-    return;
+// Abschluss: Image prüfen und Boot-Partition umstellen (error == nullptr) oder
+// verwerfen. Bei jedem Fehler bleibt die laufende Firmware unverändert aktiv.
+void finishDeltaUpdate(const char* error) {
+  DeltaOtaTarget& target = deltaJob.target;
+  deltaJob.active = false;
+  if (deltaJob.wholeBody) {
+    sendATCommand("AT+HTTPTERM", 1000);  // Modem wieder für Telemetrie und Wetter frei
+    deltaJob.wholeBody = false;
+    lteHttpHeld = false;
   }
 
-  StaticJsonDocument<256> doc;
-  DeserializationError error = deserializeJson(doc, server.arg("plain"));
+  if (!error) {
+    // esp_ota_end prüft zusätzlich das ESP-Image (Segmente, Prüfsumme)
+    target.begun = false;
+    if (esp_ota_end(target.handle) != ESP_OK) error = "Image ungültig";
+    else if (esp_ota_set_boot_partition(target.update) != ESP_OK) error = "Boot-Partition";
+  }
+  if (target.begun) esp_ota_abort(target.handle);
+  target.begun = false;
 
+  uint32_t offset = deltaJob.offset;
   if (error) {
-    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    setDeltaResult(error);
+    if (strcmp(error, "Kein Update") == 0) {
+      Serial.println("   Kein Update verfügbar");
+      return;
+    }
+    Serial.printf("❌ Delta-Update fehlgeschlagen: %s (%lu Bytes geladen)\n",
+                  error, (unsigned long)offset);
+    logEvent(EVT_OTA_DELTA_FAIL, error);
     return;
   }
 
-  float reference_value = doc["reference_value"];  // z.B. 1413 ppm (1413 µS/cm Lösung)
-  int adc_reading = analogRead(TDS_PIN);
+  setDeltaResult("Neustart");
+  Serial.printf("✅ Delta-Update: %lu Bytes Patch → %lu Bytes Firmware, SHA-256 OK\n",
+                (unsigned long)offset, (unsigned long)deltaOta.imageBytes);
+  char value[24];
+  snprintf(value, sizeof(value), "%lu Bytes", (unsigned long)offset);
+  logEvent(EVT_OTA_DELTA, value);
+
+  // Wie ArduinoOTA.onStart: Einstellungen und Ereignisse sichern, SD sauber beenden
+  if (settingsDirty) saveSettings();
+  flushEvents();
+  if (sysStatus.sdCardOK) SD.end();
+  delay(500);
+  ESP.restart();
+}
 
-  calibration.tds_reference_adc = adc_reading;
-  calibration.tds_reference_value = reference_value;
-  calibration.tds_factor = reference_value / adc_reading;
-  calibration.tds_calibrated = true;
+void handleAPIDeltaOta() {
+  if (!sysStatus.lteConnected) {
+    server.send(503, "application/json", "{\"error\":\"LTE not connected\"}");
+    return;
+  }
+  if (deltaOta.pendingVerify) {
+    server.send(409, "application/json", "{\"error\":\"Firmware not confirmed yet\"}");
+    return;
+  }
+  if (deltaJob.active) {
+    server.send(409, "application/json", "{\"error\":\"Update already running\"}");
+    return;
+  }
+  deltaOta.requested = true;         // Ausführung in loop(), nicht im Request
+  server.send(202, "application/json", "{\"success\":true}");
+}
+#endif
 
-  saveCalibration();
+// ═══════════════════════════════════════════════════════════════════════════════════
+// MULTI-BECKEN AGGREGATION
+// ═══════════════════════════════════════════════════════════════════════════════════
 
-  Serial.printf("✅ TDS kalibriert: ADC=%d, Referenz=%.0f ppm, Faktor=%.4f\n",
-                adc_reading, reference_value, calibration.tds_factor);
+#if ENABLE_MULTI_TANK
+void initTanks() {
+  static EspNowTankTransport espNowTransport;
+  static UdpTankTransport udpTransport;
 
-  server.send(200, "application/json", "{\"success\":true,\"message\":\"TDS kalibriert\",\"factor\":" + String(calibration.tds_factor, 4) + "}");
-}
+  if (TANK_TRANSPORT_ESPNOW) {
+    tankTransport = &espNowTransport;
+  } else {
+    tankTransport = &udpTransport;
+  }
 
-void handleAPICalibrationReset() {
-  calibration.ph_calibrated = false;
-  calibration.ph_slope = 3.5;
-  calibration.ph_offset = 0.0;
+  if (tankTransport->begin()) {
+    Serial.printf("✅ Multi-Becken: %s (max. %d Becken)\n",
+                  TANK_TRANSPORT_ESPNOW ? "ESP-NOW" : "UDP", MAX_TANKS);
+  } else {
+    Serial.println("⚠️  Multi-Becken Transport fehlgeschlagen");
+    tankTransport = nullptr;
+  }
+}
 
-  calibration.tds_calibrated = false;
-  calibration.tds_factor = 0.5;
+// Auswertung mit den Grenzwerten des jeweiligen Beckens
+uint16_t evaluateTankAlarms(const TankFrame& f, const TroutParameters& p) {
+  uint16_t mask = f.alarmMask & (TANK_ALARM_FLOW_LOW | TANK_ALARM_BATTERY_LOW);
+  float waterTemp = f.waterTemp / 100.0;
+  float ph = f.ph / 100.0;
 
-  calibration.do_calibrated = false;
-  calibration.do_slope = 1.0;
-  calibration.do_offset = 0.0;
+  if (waterTemp > p.tempCritical) mask |= TANK_ALARM_TEMP_CRITICAL;
+  else if (waterTemp > p.tempMax) mask |= TANK_ALARM_TEMP_HIGH;
+  else if (waterTemp < p.tempMin) mask |= TANK_ALARM_TEMP_LOW;
 
-  saveCalibration();
+  if (ph < p.phMin || ph > p.phMax) mask |= TANK_ALARM_PH;
+  if (f.tds > p.tdsMax) mask |= TANK_ALARM_TDS;
+  if (f.dissolvedOxygen > 0 && f.dissolvedOxygen / 100.0 < p.doMin) mask |= TANK_ALARM_DO_LOW;
+  if (!(f.flags & TANK_FLAG_LEVEL_OK)) mask |= TANK_ALARM_LEVEL_LOW;
 
-  Serial.println("🔄 Kalibrierung zurückgesetzt");
-  server.send(200, "application/json", "{\"success\":true,\"message\":\"Kalibrierung zur\\u00fcckgesetzt\"}");
+  return mask;
 }
 
-void handleCSS() {
-  server.send(200, "text/css", getCSS());
+void processTankFrame(const TankFrame& frame) {
+  if (frame.tankId < 1 || frame.tankId > MAX_TANKS) return;
+  TankState& tank = tanks[frame.tankId - 1];
+
+  if (tank.active) {
+    uint16_t lost;
+    TankSeqStatus status = tankSequenceCheck(tank.latest.sequence, frame.sequence, lost);
+    if (status == TANK_SEQ_DUPLICATE) return;
+    if (status == TANK_SEQ_RESET) tank.restarts++;
+    tank.framesLost += lost;
+  }
+
+  tank.active = true;
+  tank.latest = frame;
+  tank.lastSeen = millis();
+  tank.framesReceived++;
+  tank.alarmMask = evaluateTankAlarms(frame, tankParams[frame.tankId - 1]);
+
+  if (tank.lastHistory == 0 || millis() - tank.lastHistory >= HISTORY_INTERVAL) {
+    TankHistoryPoint& point = tank.history[tank.historyIndex];
+    point.waterTemp = frame.waterTemp;
+    point.ph = frame.ph;
+    point.dissolvedOxygen = frame.dissolvedOxygen;
+    tank.historyIndex = (tank.historyIndex + 1) % TANK_HISTORY_SIZE;
+    if (tank.historyIndex == 0) tank.historyFull = true;
+    tank.lastHistory = millis();
+  }
 }
 
-void handleJS() {
-  server.send(200, "application/javascript", getJS());
+void handleTankFrames() {
+  if (!tankTransport) return;
+
+  TankFrame frames[8];
+  int count = tankTransport->poll(frames, 8);
+  for (int i = 0; i < count; i++) {
+    processTankFrame(frames[i]);
+  }
 }
 
-// ═══════════════════════════════════════════════════════════════════════════════════
-// TELEGRAM BOT FUNCTIONS (v1.6.1)
-// ═══════════════════════════════════════════════════════════════════════════════════
+void formatTankAlarms(uint16_t mask, char* buf, size_t len) {
+  static const struct { uint16_t bit; const char* text; } names[] = {
+    {TANK_ALARM_TEMP_CRITICAL, "Temp KRITISCH"}, {TANK_ALARM_TEMP_HIGH, "Temp hoch"},
+    {TANK_ALARM_TEMP_LOW, "Temp niedrig"}, {TANK_ALARM_PH, "pH"},
+    {TANK_ALARM_TDS, "TDS hoch"}, {TANK_ALARM_DO_LOW, "O2 niedrig"},
+    {TANK_ALARM_LEVEL_LOW, "Wasserlevel NIEDRIG"}, {TANK_ALARM_FLOW_LOW, "Durchfluss niedrig"},
+    {TANK_ALARM_BATTERY_LOW, "Batterie NIEDRIG"}, {TANK_ALARM_OFFLINE, "OFFLINE"}
+  };
 
-#if ENABLE_TELEGRAM
-void handleTelegramMessages() {
-  if (!bot) return;
+  buf[0] = '\0';
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (!(mask & names[i].bit)) continue;
+    if (buf[0]) strncat(buf, ", ", len - strlen(buf) - 1);
+    strncat(buf, names[i].text, len - strlen(buf) - 1);
+  }
+}
 
-  // getUpdates() kann blockieren - WDT reset davor
-  esp_task_wdt_reset();
-  int numNewMessages = bot->getUpdates(bot->last_message_received + 1);
+// Eine Sammelmeldung für alle Becken mit neuen Alarmen (statt N einzelner E-Mails)
+void checkTankAlerts() {
+  char message[512] = "";
+  char line[96];
+  char reasons[64];
+  int newAlarms = 0;
 
-  for (int i = 0; i < numNewMessages; i++) {
-    // WDT reset bei jeder Nachricht (falls viele Nachrichten)
-    esp_task_wdt_reset();
-    String chat_id = String(bot->messages[i].chat_id);
-    String text = bot->messages[i].text;
+  for (int i = 0; i < MAX_TANKS; i++) {
+    TankState& tank = tanks[i];
+    if (!tank.active) continue;
 
-    // Nur auf konfigurierte Chat-ID reagieren
-    if (chat_id != String(TELEGRAM_CHAT_ID)) {
-      bot->sendMessage(chat_id, "⛔ Nicht autorisiert!", "");
-      continue;
+    if (millis() - tank.lastSeen >= TANK_TIMEOUT) {
+      tank.alarmMask |= TANK_ALARM_OFFLINE;
     }
 
-    // Befehle verarbeiten
-    if (text == "/start") {
-      String welcome = "🐟 ForellenWächter Bot aktiv!\n\n";
-      welcome += "Verfügbare Befehle:\n";
-      welcome += "/status - Alle Sensordaten\n";
-      welcome += "/temp - Temperaturen\n";
-      welcome += "/water - Wasserqualität\n";
-      welcome += "/power - Turbine & Batterie\n";
-      welcome += "/alarm - Alarm-Status\n";
-      welcome += "/relay1-4 - Relais schalten";
-      bot->sendMessage(chat_id, welcome, "");
-    }
-    else if (text == "/status") {
-      String msg = "📊 *ForellenWächter Status*\n\n";
-      msg += "💧 Wasser: " + String(sensors.waterTemp, 1) + "°C\n";
-      msg += "🌡️ Luft: " + String(sensors.airTemp, 1) + "°C\n";
-      msg += "🧪 pH: " + String(sensors.ph, 2) + "\n";
-      msg += "📊 TDS: " + String(sensors.tds, 0) + " ppm\n";
-      if (ENABLE_DO_SENSOR) {
-        msg += "🫧 O₂: " + String(sensors.dissolvedOxygen, 1) + " mg/L\n";
-      }
-      if (ENABLE_TURBINE) {
-        msg += "⚡ Flow: " + String(sensors.flowRate, 1) + " L/min\n";
-        msg += "🔌 Power: " + String(sensors.turbinePower, 1) + " W\n";
-      }
-      if (ENABLE_BATTERY_MONITOR) {
-        msg += "🔋 Batterie: " + String(sensors.batteryVoltage, 2) + "V (" + String(sensors.batteryPercent, 0) + "%)\n";
-      }
-      msg += "🌊 Level: " + String(sensors.waterLevelOK ? "OK" : "NIEDRIG") + "\n";
-      msg += "🚨 Alarm: " + String(sensors.alarmActive ? "AKTIV" : "Kein Alarm");
-      bot->sendMessage(chat_id, msg, "Markdown");
-    }
-    else if (text == "/temp") {
-      String msg = "🌡️ *Temperaturen*\n\n";
-      msg += "💧 Wasser: " + String(sensors.waterTemp, 1) + "°C\n";
-      msg += "🌡️ Luft: " + String(sensors.airTemp, 1) + "°C";
-      bot->sendMessage(chat_id, msg, "Markdown");
-    }
-    else if (text == "/water") {
-      String msg = "💧 *Wasserqualität*\n\n";
-      msg += "🧪 pH: " + String(sensors.ph, 2) + "\n";
-      msg += "📊 TDS: " + String(sensors.tds, 0) + " ppm\n";
-      if (ENABLE_DO_SENSOR) {
-        msg += "🫧 O₂: " + String(sensors.dissolvedOxygen, 1) + " mg/L";
-      }
-      bot->sendMessage(chat_id, msg, "Markdown");
-    }
-    else if (text == "/power") {
-      String msg = "⚡ *Turbine & Batterie*\n\n";
-      if (ENABLE_TURBINE) {
-        msg += "💧 Durchfluss: " + String(sensors.flowRate, 1) + " L/min\n";
-        msg += "🔌 Leistung: " + String(sensors.turbinePower, 1) + " W\n";
-      }
-      if (ENABLE_BATTERY_MONITOR) {
-        msg += "🔋 Spannung: " + String(sensors.batteryVoltage, 2) + " V\n";
-        msg += "📊 Ladung: " + String(sensors.batteryPercent, 0) + " %\n";
-        msg += "⚠️ Status: " + String(sensors.batteryLow ? "NIEDRIG" : "OK");
-      }
-      bot->sendMessage(chat_id, msg, "Markdown");
-    }
-    else if (text == "/alarm") {
-      String msg = "🚨 *Alarm-Status*\n\n";
-      if (sensors.alarmActive) {
-        msg += "Status: AKTIV\n";
-        msg += "Grund: " + sensors.alarmReason;
-      } else {
-        msg += "Status: Kein Alarm";
-      }
-      bot->sendMessage(chat_id, msg, "Markdown");
-    }
-    else if (text.startsWith("/relay")) {
-      int relayNum = text.substring(6).toInt() - 1;
-      if (relayNum >= 0 && relayNum < 4) {
-        relayStates[relayNum] = !relayStates[relayNum];
-        updateRelays();
-        bot->sendMessage(chat_id, "Relais " + String(relayNum + 1) + ": " + (relayStates[relayNum] ? "AN" : "AUS"), "");
-      }
-    }
-    else {
-      bot->sendMessage(chat_id, "❓ Unbekannter Befehl. Sende /start für Hilfe.", "");
-    }
+    uint16_t fresh = tank.alarmMask & ~tank.notifiedMask;
+    tank.notifiedMask = tank.alarmMask;  // Behobene Alarme dürfen erneut melden
+    if (!fresh) continue;
+
+    formatTankAlarms(fresh, reasons, sizeof(reasons));
+    snprintf(line, sizeof(line), "Becken %d: %s (%.1f°C)\n", i + 1, reasons,
+             tank.latest.waterTemp / 100.0);
+    strncat(message, line, sizeof(message) - strlen(message) - 1);
+    newAlarms++;
   }
-}
 
-void sendTelegramAlarm(String reason) {
-  if (!bot || !ENABLE_TELEGRAM) return;
+  if (newAlarms == 0) return;
 
-  String msg = "🚨 *ALARM!*\n\n";
-  msg += reason + "\n\n";
-  msg += "💧 Wasser: " + String(sensors.waterTemp, 1) + "°C\n";
-  msg += "🧪 pH: " + String(sensors.ph, 2);
+  sendControlCommand(CTL_COUNT_ALARM, 0);  // Zähler gehören dem Regel-Task
+  dailyStats.addAlarm();
+  logEvent(EVT_TANK_ALARM, message);
+  sendEmailAlert("🚨 ForellenWächter Becken-ALARM", message);
 
-  bot->sendMessage(TELEGRAM_CHAT_ID, msg, "Markdown");
+  #if ENABLE_TELEGRAM
+  sendTelegramAlarm(message);
+  #endif
 }
-#endif
 
-// ═══════════════════════════════════════════════════════════════════════════════════
-// DYNDNS UPDATE FUNCTION (v1.6.1)
-// ═══════════════════════════════════════════════════════════════════════════════════
+// GET /api/tanks - gestreamt, damit der RAM-Bedarf nicht mit der Becken-Anzahl wächst
+void handleAPITanks() {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  server.sendContent("[");
+
+  char buf[320];
+  bool first = true;
+  for (int i = 0; i < MAX_TANKS; i++) {
+    const TankState& tank = tanks[i];
+    if (!tank.active) continue;
+    const TankFrame& f = tank.latest;
+
+    snprintf(buf, sizeof(buf),
+      "%s{\"id\":%d,\"seq\":%u,\"age\":%lu,\"waterTemp\":%.2f,\"airTemp\":%.2f,"
+      "\"ph\":%.2f,\"tds\":%u,\"dissolvedOxygen\":%.2f,\"flowRate\":%.2f,"
+      "\"batteryVoltage\":%.2f,\"waterLevel\":%s,\"aeration\":%s,"
+      "\"alarmMask\":%u,\"received\":%lu,\"lost\":%lu,\"restarts\":%u}",
+      first ? "" : ",", i + 1, f.sequence, (millis() - tank.lastSeen) / 1000,
+      f.waterTemp / 100.0, f.airTemp / 100.0, f.ph / 100.0, f.tds,
+      f.dissolvedOxygen / 100.0, f.flowRate / 100.0, f.batteryMilliVolt / 1000.0,
+      (f.flags & TANK_FLAG_LEVEL_OK) ? "true" : "false",
+      (f.flags & TANK_FLAG_AERATION) ? "true" : "false",
+      tank.alarmMask, (unsigned long)tank.framesReceived, (unsigned long)tank.framesLost, tank.restarts);
+    server.sendContent(buf);
+    first = false;
+  }
 
-#if ENABLE_DYNDNS
-void updateDynDNS() {
-  if (!WiFi.isConnected() && !sysStatus.lteConnected) {
-    Serial.println("⚠️  DynDNS: Keine Internetverbindung");
+  server.sendContent("]");
+  server.sendContent("");
+}
+
+// GET /api/tanks/history?id=N
+void handleAPITankHistory() {
+  int id = server.arg("id").toInt();
+  if (id < 1 || id > MAX_TANKS || !tanks[id - 1].active) {
+    server.send(404, "application/json", "{\"error\":\"Unknown tank\"}");
     return;
   }
 
-  HTTPClient http;
-  String url = "https://www.duckdns.org/update?domains=" + String(DYNDNS_DOMAIN).substring(0, String(DYNDNS_DOMAIN).indexOf('.'));
-  url += "&token=" + String(DYNDNS_TOKEN);
-  url += "&ip=";  // IP wird automatisch erkannt
+  const TankState& tank = tanks[id - 1];
+  int count = tank.historyFull ? TANK_HISTORY_SIZE : tank.historyIndex;
+  int start = tank.historyFull ? tank.historyIndex : 0;
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  char buf[40];
+  const char* keys[3] = {"waterTemp", "ph", "do"};
+  for (int k = 0; k < 3; k++) {
+    snprintf(buf, sizeof(buf), "%s\"%s\":[", k == 0 ? "{" : "],", keys[k]);
+    server.sendContent(buf);
+    for (int i = 0; i < count; i++) {
+      const TankHistoryPoint& p = tank.history[(start + i) % TANK_HISTORY_SIZE];
+      int raw = k == 0 ? p.waterTemp : (k == 1 ? p.ph : p.dissolvedOxygen);
+      snprintf(buf, sizeof(buf), "%s%.2f", i > 0 ? "," : "", raw / 100.0);
+      server.sendContent(buf);
+    }
+  }
+  server.sendContent("]}");
+  server.sendContent("");
+}
 
-  http.begin(url);
-  http.setTimeout(10000);  // 10 Sekunden Timeout
-  esp_task_wdt_reset();    // WDT reset vor GET
-  int httpCode = http.GET();
-  esp_task_wdt_reset();    // WDT reset nach GET
+// POST /api/tanks/settings?id=N - Grenzwerte je Becken (Felder wie /api/settings)
+void handleAPITankSettings() {
+  int id = server.arg("id").toInt();
+  if (id < 1 || id > MAX_TANKS || !server.hasArg("plain")) {
+    server.send(400, "application/json", "{\"error\":\"Invalid tank or body\"}");
+    return;
+  }
 
-  if (httpCode == 200) {
-    String response = http.getString();
-    if (response == "OK") {
-      Serial.println("✅ DynDNS Update erfolgreich");
-      Serial.println("🌐 Domain: " + String(DYNDNS_DOMAIN));
-    } else {
-      Serial.println("❌ DynDNS Update fehlgeschlagen: " + response);
-    }
-  } else {
-    Serial.printf("❌ DynDNS HTTP Error: %d\n", httpCode);
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, server.arg("plain"))) {
+    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    return;
   }
 
-  http.end();
+  TroutParameters& p = tankParams[id - 1];
+  if (doc.containsKey("tempMin")) p.tempMin = doc["tempMin"];
+  if (doc.containsKey("tempMax")) p.tempMax = doc["tempMax"];
+  if (doc.containsKey("tempCritical")) p.tempCritical = doc["tempCritical"];
+  if (doc.containsKey("phMin")) p.phMin = doc["phMin"];
+  if (doc.containsKey("phMax")) p.phMax = doc["phMax"];
+  if (doc.containsKey("tdsMax")) p.tdsMax = doc["tdsMax"];
+  if (doc.containsKey("doMin")) p.doMin = doc["doMin"];
+  if (doc.containsKey("doOptimal")) p.doOptimal = doc["doOptimal"];
+
+  markSettingsDirty();
+  server.send(200, "application/json", "{\"success\":true}");
 }
 #endif
 
@@ -2722,10 +5873,15 @@ String getHTML() {
             <div id="weatherDashboardData" style="font-size: 0.9em;"></div>
           </div>
           <p id="weatherConfigHint" style="color: rgba(255,255,255,0.6); font-size: 0.9em; margin-bottom: 10px;">
-            PLZ in <a href="/settings" style="color: #0ea5e9;">Einstellungen</a> konfigurieren
+            PLZ oder Ort in <a href="/settings" style="color: #0ea5e9;">Einstellungen</a> konfigurieren
           </p>
         </div>
       </div>
+
+      <div class="info-card">
+        <h3>📋 Ereignisse</h3>
+        <div id="eventList" style="max-height: 320px; overflow-y: auto; font-size: 0.85em;"></div>
+      </div>
     </div>
 
     <footer>
@@ -2877,31 +6033,49 @@ String getHTML() {
       } catch (e) {}
     }
     
+    // Historie: einmal komplett, danach nur neue Punkte (?since=<seq>&boot=<id>)
+    let historyCursor = null;
+    let historyBoot = 0;
+    let historyTimes = [];  // Zeitpunkte der Chart-Punkte (ms, Browser-Uhr)
+
     async function fetchHistory() {
       try {
-        const res = await fetch('/api/history');
+        const full = historyCursor === null;
+        const res = await fetch(full ? '/api/history' : `/api/history?since=${historyCursor}&boot=${historyBoot}`);
         const data = await res.json();
-        updateCharts(data);
+        if (data.reset) {  // Neustart oder Cursor älter als 24h
+          historyCursor = null;
+          return fetchHistory();
+        }
+        updateCharts(data, !full);
+        historyCursor = data.seq;
+        historyBoot = data.boot;
       } catch (e) {}
     }
     
+    // Fehlender Messwert kommt als null
+    function fixed(v, digits) {
+      return v === null || v === undefined ? '--' : v.toFixed(digits);
+    }
+
     // Anzeige aktualisieren
     function updateSensorDisplay(data) {
-      document.getElementById('waterTemp').textContent = data.waterTemp.toFixed(1);
-      document.getElementById('airTemp').textContent = data.airTemp.toFixed(1);
-      document.getElementById('phValue').textContent = data.ph.toFixed(2);
-      document.getElementById('tdsValue').textContent = Math.round(data.tds);
-      document.getElementById('doValue').textContent = data.dissolvedOxygen.toFixed(1);
+      document.getElementById('waterTemp').textContent = fixed(data.waterTemp, 1);
+      document.getElementById('airTemp').textContent = fixed(data.airTemp, 1);
+      document.getElementById('phValue').textContent = fixed(data.ph, 2);
+      document.getElementById('tdsValue').textContent = fixed(data.tds, 0);
+      const hasDO = data.dissolvedOxygen !== undefined && data.dissolvedOxygen !== null;
+      document.getElementById('doValue').textContent = fixed(data.dissolvedOxygen, 1);
       document.getElementById('waterLevel').textContent = data.waterLevel ? 'OK' : 'NIEDRIG';
 
       // Turbine & Batterie (v1.6)
       if (data.flowRate !== undefined) {
-        document.getElementById('flowRate').textContent = data.flowRate.toFixed(1);
-        document.getElementById('turbinePower').textContent = data.turbinePower.toFixed(1);
+        document.getElementById('flowRate').textContent = fixed(data.flowRate, 1);
+        document.getElementById('turbinePower').textContent = fixed(data.turbinePower, 1);
       }
       if (data.batteryVoltage !== undefined) {
-        document.getElementById('batteryVoltage').textContent = data.batteryVoltage.toFixed(2);
-        document.getElementById('batteryPercent').textContent = Math.round(data.batteryPercent) + ' %';
+        document.getElementById('batteryVoltage').textContent = fixed(data.batteryVoltage, 2);
+        document.getElementById('batteryPercent').textContent = fixed(data.batteryPercent, 0) + ' %';
       }
 
       // Wasserqualitäts-Score berechnen (0-100%)
@@ -2928,15 +6102,17 @@ String getHTML() {
       }
       scoreCount++;
 
-      // DO Score (Optimal: >9 mg/L)
-      if (data.dissolvedOxygen > 9) {
-        scoreTotal += 100;
-      } else if (data.dissolvedOxygen > 6) {
-        scoreTotal += 70;
-      } else {
-        scoreTotal += 30;
+      // DO Score (Optimal: >9 mg/L) - nur mit DO-Sensor
+      if (hasDO) {
+        if (data.dissolvedOxygen > 9) {
+          scoreTotal += 100;
+        } else if (data.dissolvedOxygen > 6) {
+          scoreTotal += 70;
+        } else {
+          scoreTotal += 30;
+        }
+        scoreCount++;
       }
-      scoreCount++;
 
       // Temperatur Score (Optimal: 8-14°C)
       if (data.waterTemp >= 8 && data.waterTemp <= 14) {
@@ -2965,7 +6141,7 @@ String getHTML() {
       updateCardStatus('cardWater', data.waterTemp, 8, 14, 16);
       updateCardStatus('cardPH', data.ph, 6.5, 8.5);
       updateCardStatus('cardTDS', data.tds, 0, 500);
-      updateCardStatus('cardDO', data.dissolvedOxygen, 6, 999);
+      if (hasDO) updateCardStatus('cardDO', data.dissolvedOxygen, 6, 999);
 
       // Turbine/Batterie Status
       if (data.flowRate !== undefined) {
@@ -3035,39 +6211,54 @@ String getHTML() {
       document.getElementById('dailyAlarms').textContent = data.dailyAlarms + ' x';
     }
     
-    function updateCharts(data) {
-      // Labels: Wir zeigen jeden 3. Datenpunkt = 15 min Intervall
-      const labels = data.waterTemp.map((_, i) => {
-        const minutes = i * 15;  // Jeder Punkt = 15 min (weil API jeden 3. samplet)
+    // append = Antwort auf ?since: neue Punkte anhängen, über 24h alte vorne entfernen
+    function updateCharts(data, append) {
+      const now = Date.now();
+      const times = data.t.map(age => now - age * 1000);
+      if (append) historyTimes.push(...times);
+      else historyTimes = times;
+      let drop = 0;
+      while (drop < historyTimes.length && now - historyTimes[drop] > 86400000) drop++;
+      historyTimes.splice(0, drop);
+
+      const series = [
+        [tempChart, 0, 'waterTemp'], [tempChart, 1, 'airTemp'],
+        [qualityChart, 0, 'ph'], [qualityChart, 1, 'do'], [qualityChart, 2, 'tds'],
+        [powerChart, 0, 'flowRate'], [powerChart, 1, 'turbinePower']
+      ];
+      series.forEach(([chart, index, key]) => {
+        const values = data[key] || [];
+        const dataset = chart.data.datasets[index];
+        if (append) {
+          dataset.data.push(...values);
+          dataset.data.splice(0, drop);
+        } else {
+          dataset.data = values;
+        }
+      });
+
+      // Labels: Alter in Minuten/Stunden, rücken bei jedem Abruf weiter
+      const labels = historyTimes.map(t => {
+        const minutes = Math.round((now - t) / 60000);
         if (minutes >= 60) {
-          return Math.floor(minutes / 60) + 'h';
+          return '-' + Math.floor(minutes / 60) + 'h';
         }
-        return minutes + 'm';
+        return '-' + minutes + 'm';
       });
-      
+
       tempChart.data.labels = labels;
-      tempChart.data.datasets[0].data = data.waterTemp;
-      tempChart.data.datasets[1].data = data.airTemp;
       tempChart.update('none');
-      
+
       qualityChart.data.labels = labels;
-      qualityChart.data.datasets[0].data = data.ph;
-      qualityChart.data.datasets[1].data = data.do || [];
-      qualityChart.data.datasets[2].data = data.tds || [];
       qualityChart.update('none');
 
       // Turbine Chart (v1.6.2)
       if (data.flowRate && data.turbinePower) {
         powerChart.data.labels = labels;
-        powerChart.data.datasets[0].data = data.flowRate;
-        powerChart.data.datasets[1].data = data.turbinePower;
         powerChart.update('none');
 
-        // Energie 24h berechnen (Power in W, jeder Sample = 5 min = 1/12 Stunde)
-        let totalEnergy = 0;
-        data.turbinePower.forEach(power => {
-          totalEnergy += power * (5 / 60);  // W × h = Wh
-        });
+        // Energie 24h (vom ESP32 aus allen Messpunkten berechnet)
+        const totalEnergy = data.turbineEnergyWh || 0;
         const energyDisplay = totalEnergy >= 1000
           ? (totalEnergy / 1000).toFixed(2) + ' k'  // kWh
           : Math.round(totalEnergy);
@@ -3126,36 +6317,72 @@ String getHTML() {
       }
     }
 
-    // Wetter im Dashboard laden
+    // Wetter im Dashboard laden (vom Gerät, auch ohne Internet im Browser)
     async function fetchDashboardWeather() {
-      const zip = localStorage.getItem('weatherZip');
-      if (!zip) return;  // Keine PLZ konfiguriert
-
       const weatherDashboard = document.getElementById('weatherDashboard');
       const weatherConfigHint = document.getElementById('weatherConfigHint');
       const weatherDashboardData = document.getElementById('weatherDashboardData');
 
       try {
-        weatherDashboardData.innerHTML = '⏳ Lade...';
-        weatherDashboard.style.display = 'block';
-        weatherConfigHint.style.display = 'none';
-
-        const response = await fetch(`https://wttr.in/${zip}?format=j1`);
+        const response = await fetch('/api/weather');
         const data = await response.json();
+        if (!data.location || !data.valid) {
+          weatherDashboard.style.display = 'none';
+          weatherConfigHint.style.display = 'block';
+          return;
+        }
 
-        const current = data.current_condition[0];
+        const current = data.current;
+        const heat = data.heat.expected
+          ? `<p style="margin: 5px 0; font-size: 0.9em; color: #f97316;">🔥 Bis ${data.heat.maxTempC}°C erwartet - Belüftung vorgezogen</p>`
+          : (data.heat.maxTempC !== undefined ? `<p style="margin: 5px 0; font-size: 0.9em;">📈 Max. ${data.heat.leadHours}h: ${data.heat.maxTempC}°C</p>` : '');
 
         weatherDashboardData.innerHTML = `
-          <p style="margin: 5px 0; font-size: 1.05em;">🌡️ <strong>${current.temp_C}°C</strong> (gefühlt ${current.FeelsLikeC}°C)</p>
-          <p style="margin: 5px 0; font-size: 0.95em;">☁️ ${current.lang_de[0].value}</p>
-          <p style="margin: 5px 0; font-size: 0.9em;">💧 ${current.humidity}% | 💨 ${current.windspeedKmph} km/h</p>
+          <p style="margin: 5px 0; font-size: 1.05em;">🌡️ <strong>${current.tempC}°C</strong></p>
+          <p style="margin: 5px 0; font-size: 0.95em;">☁️ ${current.text}</p>
+          <p style="margin: 5px 0; font-size: 0.9em;">💧 ${current.humidity}% | 💨 ${current.windKmh} km/h</p>
+          ${heat}
         `;
+        weatherDashboard.style.display = 'block';
+        weatherConfigHint.style.display = 'none';
       } catch (e) {
         weatherDashboard.style.display = 'none';
         weatherConfigHint.style.display = 'block';
       }
     }
 
+    // Ereignisse: nur neue seit dem letzten Abruf (Cursor "next" + Boot-ID)
+    let eventCursor = 0;
+    let eventBoot = 0;
+    async function fetchEvents() {
+      try {
+        const res = await fetch(`/api/events?since=${eventCursor}&boot=${eventBoot}`);
+        const data = await res.json();
+        if (data.restarted) document.getElementById('eventList').innerHTML = '';
+        updateEventList(data.events);
+        eventCursor = data.next;
+        eventBoot = data.boot;
+        if (data.more) fetchEvents();
+      } catch (e) {}
+    }
+
+    function updateEventList(events) {
+      const list = document.getElementById('eventList');
+      events.forEach(ev => {
+        const row = document.createElement('div');
+        row.className = 'info-row';
+        const label = document.createElement('span');
+        label.className = 'info-label';
+        label.textContent = (ev.time ? new Date(ev.time * 1000).toLocaleString('de-DE') : '+' + formatUptime(ev.uptime)) + ' ' + ev.type;
+        const value = document.createElement('span');
+        value.className = 'info-value';
+        value.textContent = ev.text;
+        row.append(label, value);
+        list.prepend(row);  // Neueste oben
+      });
+      while (list.children.length > 20) list.lastChild.remove();
+    }
+
     function setRange(chart, hours) {
       // Tab-Status aktualisieren
       event.target.parentNode.querySelectorAll('.chart-tab').forEach(t => t.classList.remove('active'));
@@ -3169,10 +6396,12 @@ String getHTML() {
     fetchStatus();
     fetchHistory();
     fetchDashboardWeather();
+    fetchEvents();
 
     setInterval(fetchSensors, 2000);
     setInterval(fetchStatus, 10000);
     setInterval(fetchHistory, 60000);
+    setInterval(fetchEvents, 10000);
     setInterval(fetchDashboardWeather, 1800000);  // Wetter alle 30 Minuten aktualisieren
   </script>
 </body>
@@ -3451,14 +6680,19 @@ String getSettingsHTML() {
       <div class="card">
         <h2>🌤️ Wetter-Vorhersage</h2>
         <div class="info">
-          💡 Zeigt rudimentäre Wetterinfo für die nächsten 24h (experimentell).
+          💡 Das Gerät holt die Vorhersage alle 12h selbst (WiFi oder LTE). Ist Hitze
+          angesagt, wird die Belüftung vorausschauend früher eingeschaltet.
+        </div>
+        <div class="form-group">
+          <label>Postleitzahl oder Ort</label>
+          <input type="text" id="zipCode" placeholder="z.B. 10115" maxlength="23">
         </div>
         <div class="form-group">
-          <label>Postleitzahl (DE)</label>
-          <input type="text" id="zipCode" placeholder="z.B. 10115" maxlength="5">
+          <label>Hitze ab Lufttemperatur (°C)</label>
+          <input type="number" id="heatAirTemp" step="0.5" value="28">
         </div>
         <button onclick="saveWeatherSettings()">Speichern & Wetter laden</button>
-        <button onclick="fetchWeather()" class="relay-btn" style="width: 100%; margin-top: 10px; background: rgba(14, 165, 233, 0.2);">🔄 Wetter aktualisieren</button>
+        <button onclick="fetchWeather(true)" class="relay-btn" style="width: 100%; margin-top: 10px; background: rgba(14, 165, 233, 0.2);">🔄 Wetter aktualisieren</button>
         <div id="weatherSuccess" class="success">✅ Gespeichert!</div>
         <div id="weatherInfo" style="margin-top:20px; display:none;">
           <h3>Aktuelles Wetter:</h3>
@@ -3635,51 +6869,72 @@ String getSettingsHTML() {
     }
 
     async function saveWeatherSettings() {
-      const zip = document.getElementById('zipCode').value;
-      localStorage.setItem('weatherZip', zip);
-      document.getElementById('weatherSuccess').style.display = 'block';
-      setTimeout(() => document.getElementById('weatherSuccess').style.display = 'none', 3000);
+      const data = {
+        weatherLocation: document.getElementById('zipCode').value.trim(),
+        heatAirTemp: parseFloat(document.getElementById('heatAirTemp').value)
+      };
+      try {
+        const res = await fetch('/api/settings', {
+          method: 'POST',
+          headers: { 'Content-Type': 'application/json' },
+          body: JSON.stringify(data)
+        });
+        if (res.ok) {
+          document.getElementById('weatherSuccess').style.display = 'block';
+          setTimeout(() => document.getElementById('weatherSuccess').style.display = 'none', 3000);
+        }
+      } catch (e) {
+        alert('Fehler: ' + e);
+      }
 
-      // Wetter direkt anzeigen
-      await fetchWeather();
+      // Neuer Ort wird vom Gerät sofort abgerufen
+      setTimeout(fetchWeather, 5000);
     }
 
-    async function fetchWeather() {
-      const zip = document.getElementById('zipCode').value || localStorage.getItem('weatherZip') || '10115';
+    async function fetchWeather(refresh) {
       const weatherInfo = document.getElementById('weatherInfo');
       const weatherData = document.getElementById('weatherData');
 
       try {
-        weatherData.innerHTML = '⏳ Lade Wetterdaten...';
         weatherInfo.style.display = 'block';
+        if (refresh) {
+          weatherData.innerHTML = '⏳ Gerät ruft Wetterdaten ab...';
+          await fetch('/api/weather/refresh', { method: 'POST' });
+          await new Promise(r => setTimeout(r, 8000));
+        }
 
-        // Nutze wttr.in JSON API für deutsche Wetterdaten
-        const response = await fetch(`https://wttr.in/${zip}?format=j1`);
+        const response = await fetch('/api/weather');
         const data = await response.json();
+        if (!data.valid) {
+          weatherData.innerHTML = `⏳ Noch keine Vorhersage${data.error ? ' (' + data.error + ')' : ''}`;
+          return;
+        }
 
-        const current = data.current_condition[0];
-        const today = data.weather[0];
+        const current = data.current;
+        const hourly = data.hourly.map(h => {
+          const t = new Date(h.time);
+          return `<tr><td>${t.toLocaleDateString('de-DE', { weekday: 'short' })} ${String(t.getHours()).padStart(2, '0')}:00</td>` +
+                 `<td><strong>${h.tempC}°C</strong></td><td>🌧️ ${h.rain}%</td></tr>`;
+        }).join('');
 
         weatherData.innerHTML = `
           <div style="display: grid; gap: 15px;">
             <div style="background: rgba(255,255,255,0.1); padding: 15px; border-radius: 8px;">
-              <h4 style="margin: 0 0 10px 0;">Aktuell:</h4>
-              <p style="margin: 5px 0; font-size: 1.1em;">🌡️ Temperatur: <strong>${current.temp_C}°C</strong> (gefühlt ${current.FeelsLikeC}°C)</p>
-              <p style="margin: 5px 0;">☁️ ${current.lang_de[0].value}</p>
+              <h4 style="margin: 0 0 10px 0;">Aktuell (${data.location}, vor ${Math.round(data.age / 60)} min):</h4>
+              <p style="margin: 5px 0; font-size: 1.1em;">🌡️ Temperatur: <strong>${current.tempC}°C</strong></p>
+              <p style="margin: 5px 0;">☁️ ${current.text}</p>
               <p style="margin: 5px 0;">💧 Luftfeuchtigkeit: ${current.humidity}%</p>
-              <p style="margin: 5px 0;">💨 Wind: ${current.windspeedKmph} km/h aus ${current.winddir16Point}</p>
-              <p style="margin: 5px 0;">🌧️ Niederschlag: ${current.precipMM} mm</p>
+              <p style="margin: 5px 0;">💨 Wind: ${current.windKmh} km/h</p>
+              <p style="margin: 5px 0;">${data.heat.expected ? '🔥 Hitze erwartet - Belüftung vorgezogen' : '✅ Keine Hitzeperiode in Sicht'}</p>
             </div>
             <div style="background: rgba(255,255,255,0.1); padding: 15px; border-radius: 8px;">
-              <h4 style="margin: 0 0 10px 0;">Heute (${today.date}):</h4>
-              <p style="margin: 5px 0;">🌡️ Max: <strong>${today.maxtempC}°C</strong> / Min: <strong>${today.mintempC}°C</strong></p>
-              <p style="margin: 5px 0;">🌅 Sonnenaufgang: ${today.astronomy[0].sunrise}</p>
-              <p style="margin: 5px 0;">🌇 Sonnenuntergang: ${today.astronomy[0].sunset}</p>
+              <h4 style="margin: 0 0 10px 0;">Nächste 48 Stunden:</h4>
+              <table style="width: 100%;">${hourly}</table>
             </div>
           </div>
         `;
       } catch (e) {
-        weatherData.innerHTML = `❌ Fehler beim Laden der Wetterdaten: ${e.message}<br><small>Bitte überprüfen Sie die Postleitzahl.</small>`;
+        weatherData.innerHTML = `❌ Fehler beim Laden der Wetterdaten: ${e.message}`;
       }
     }
 
@@ -3693,14 +6948,12 @@ String getSettingsHTML() {
         document.getElementById('tempMax').value = data.tempMax || 16;
         document.getElementById('phMin').value = data.phMin || 6.5;
         document.getElementById('phMax').value = data.phMax || 8.5;
+        // Bisher nur im Browser gespeicherte PLZ übernehmen
+        document.getElementById('zipCode').value = data.weatherLocation || localStorage.getItem('weatherZip') || '';
+        document.getElementById('heatAirTemp').value = data.heatAirTemp || 28;
+        // Wetter automatisch laden wenn ein Ort gespeichert ist
+        if (data.weatherLocation) fetchWeather();
       } catch (e) {}
-
-      const zip = localStorage.getItem('weatherZip');
-      if (zip) {
-        document.getElementById('zipCode').value = zip;
-        // Wetter automatisch laden wenn ZIP gespeichert ist
-        fetchWeather();
-      }
     }
 
     loadSettings();
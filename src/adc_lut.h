@@ -0,0 +1,119 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * adc_lut.h - ForellenWächter ADC-Kennlinien & Lookup-Tabellen
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Der ESP32-ADC ist nicht linear (Offset unten, Abflachung oberhalb ~2.5 V).
+ * Statt "raw * 3.3 / 4095" wird die Kennlinie einmal beim Start aus den
+ * eFuse-Kalibrierdaten (esp_adc_cal) in eine Tabelle geschrieben. Messwerte
+ * werden danach nur noch per Tabelle + Festkomma-Interpolation umgerechnet:
+ *
+ *   raw (0-4095) ──AdcLut──► mV ──CurveLut/Festkomma──► pH, ppm, mg/L, V
+ *
+ * Beide Tabellen haben 65 Stützstellen im Abstand von 64 (12-Bit-Eingang),
+ * Interpolationsfehler der TDS-Kurve < 0.5 ppm. Vergleich mit den bisherigen
+ * Gleitkomma-Formeln: examples/adc_lut_compare.cpp
+ */
+
+#ifndef ADC_LUT_H
+#define ADC_LUT_H
+
+#include <stdint.h>
+
+#define LUT_SHIFT 6                              // Stützstellen-Abstand 64
+#define LUT_SIZE ((4096 >> LUT_SHIFT) + 1)       // 65 Stützstellen für 0..4096
+
+// 12-Bit-Eingang (0-4095) → uint16 Ausgang, linear interpoliert
+struct Lut12 {
+  uint16_t y[LUT_SIZE];
+
+  uint16_t lookup(int32_t x) const {
+    if (x <= 0) return y[0];
+    if (x >= 4095) x = 4095;
+    uint32_t i = (uint32_t)x >> LUT_SHIFT;
+    int32_t frac = x & ((1 << LUT_SHIFT) - 1);
+    int32_t diff = (int32_t)y[i + 1] - y[i];
+    return y[i] + ((diff * frac + (1 << (LUT_SHIFT - 1))) >> LUT_SHIFT);
+  }
+
+  // Tabelle aus beliebiger Funktion füllen (nur beim Start / bei Kalibrierung)
+  template <typename F>
+  void build(F fn) {
+    for (int i = 0; i < LUT_SIZE; i++) {
+      float v = fn(i << LUT_SHIFT);
+      y[i] = v <= 0 ? 0 : (v >= 65535 ? 65535 : (uint16_t)(v + 0.5f));
+    }
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// UMRECHNUNG IN MESSGRÖSSEN (Festkomma)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// TDS-Kurve (DFRobot): ppm = (133.42 V³ - 255.86 V² + 857.39 V) * 0.5
+// Eingang: temperaturkompensierte mV, Ausgang: ppm × 10
+inline void buildTdsLut(Lut12& lut) {
+  lut.build([](int mv) {
+    float v = mv / 1000.0f;
+    return (133.42f * v * v * v - 255.86f * v * v + 857.39f * v) * 0.5f * 10.0f;
+  });
+}
+
+// Temperaturkompensation 2%/K bezogen auf 25°C: mV / (1 + 0.02 (T - 25))
+// waterTemp10 = Temperatur × 10
+inline int32_t tdsCompensateMv(int32_t mv, int32_t waterTemp10) {
+  int32_t coeff = 1000 + 2 * (waterTemp10 - 250);   // Promille
+  if (coeff < 100) coeff = 100;
+  return mv * 1000 / coeff;
+}
+
+// Zwei-Punkt-Gerade in mV: y = y1 + (mv - mv1) * (y2 - y1) / (mv2 - mv1)
+// y-Werte in beliebigem Festkomma (z.B. pH × 100)
+inline int32_t linearMv(int32_t mv, int32_t mv1, int32_t y1, int32_t mv2, int32_t y2) {
+  if (mv2 == mv1) return y1;
+  return y1 + (int64_t)(mv - mv1) * (y2 - y1) / (mv2 - mv1);
+}
+
+// Spannungsteiler: V_batt (mV) = V_adc (mV) × (R1 + R2) / R2, Faktor als Q10
+constexpr int32_t dividerQ10(double r1, double r2) {
+  return (int32_t)((r1 + r2) / r2 * 1024.0 + 0.5);
+}
+
+inline int32_t applyDividerMv(int32_t mv, int32_t factorQ10) {
+  return (mv * factorQ10 + 512) >> 10;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// ESP32: KENNLINIE AUS eFuse
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#if defined(ARDUINO)
+
+#include <esp_adc_cal.h>
+
+enum AdcCalSource : uint8_t {
+  ADC_CAL_LINEAR = 0,                // Vor initADC(): noch keine Kennlinie
+  ADC_CAL_DEFAULT_VREF,              // Standard-Vref 1100 mV
+  ADC_CAL_EFUSE_VREF,                // Vref aus eFuse
+  ADC_CAL_TWO_POINT                  // Zwei-Punkt-Werte aus eFuse
+};
+
+// ADC1, 11/12 dB Dämpfung (analogRead()-Standard), 12 Bit
+inline AdcCalSource buildAdcLut(Lut12& lut) {
+  esp_adc_cal_characteristics_t chars;
+  esp_adc_cal_value_t type = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12,
+                                                      ADC_WIDTH_BIT_12, 1100, &chars);
+  lut.build([&chars](int raw) {
+    return (float)esp_adc_cal_raw_to_voltage(raw > 4095 ? 4095 : raw, &chars);
+  });
+
+  switch (type) {
+    case ESP_ADC_CAL_VAL_EFUSE_TP:   return ADC_CAL_TWO_POINT;
+    case ESP_ADC_CAL_VAL_EFUSE_VREF: return ADC_CAL_EFUSE_VREF;
+    default:                         return ADC_CAL_DEFAULT_VREF;
+  }
+}
+
+#endif  // ARDUINO
+
+#endif  // ADC_LUT_H
@@ -0,0 +1,192 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * aeration.h - ForellenWächter Belüftungsregler & Relais-Zeitpläne
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Regelt die Belüftung auf gelösten Sauerstoff (oder Wassertemperatur, wenn kein
+ * DO-Sensor verbaut ist) und verhindert Takten des Gebläses:
+ * - Hysterese (Zweipunkt mit Totband) oder PI mit Zeit-Proportional-Ausgang
+ * - Mindest-Lauf- und Mindest-Pausenzeit (Notfall-Anforderung überspringt die Pause)
+ * - Laufzeit-, Schaltzyklen- und Energie-Statistik (ActuatorStats)
+ *
+ * Ohne Arduino-Abhängigkeiten: Zeit wird als Millisekunden übergeben, damit der
+ * Regler auch in der Host-Simulation (examples/aeration_sim.cpp) läuft.
+ */
+
+#ifndef AERATION_H
+#define AERATION_H
+
+#include <stdint.h>
+
+enum AerationMode : uint8_t {
+  AERATION_HYSTERESIS = 0,
+  AERATION_PI = 1
+};
+
+struct AerationConfig {
+  uint8_t mode = AERATION_HYSTERESIS;
+  float doBand = 1.0;                // Einschalten unter doOptimal - doBand (mg/L)
+  float tempBand = 0.5;              // Einschalten über tempMax + tempBand (°C)
+  float kp = 0.5;                    // PI: Duty pro Einheit Regelabweichung
+  float ki = 0.0002;                 // PI: Duty pro Einheit·Sekunde
+  uint32_t minOnMs = 300000;         // Mindest-Laufzeit (5 min)
+  uint32_t minOffMs = 600000;        // Mindest-Pause (10 min)
+  uint32_t cycleMs = 3600000;        // PI: Zeit-Proportional-Fenster (60 min)
+  float blowerWatts = 60;            // Leistungsaufnahme Gebläse (Energie-Schätzung)
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// LAUFZEIT & ENERGIE
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct ActuatorStats {
+  uint32_t onMs = 0;
+  uint32_t totalMs = 0;
+  uint32_t switches = 0;
+
+  // Bei jeder Auswertung mit dem tatsächlichen Ausgangszustand aufrufen
+  void track(bool on, uint32_t nowMs) {
+    if (started) {
+      uint32_t dt = nowMs - lastMs;
+      totalMs += dt;
+      if (lastOn) onMs += dt;
+      if (on != lastOn) switches++;
+    }
+    started = true;
+    lastOn = on;
+    lastMs = nowMs;
+  }
+
+  float duty() const { return totalMs ? (float)onMs / totalMs : 0; }
+  float energyWh(float watts) const { return watts * onMs / 3600000.0f; }
+
+  // Neuer Zeitraum (z.B. täglich), Zustand bleibt erhalten
+  void reset() {
+    onMs = 0;
+    totalMs = 0;
+    switches = 0;
+  }
+
+private:
+  bool started = false;
+  bool lastOn = false;
+  uint32_t lastMs = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// REGLER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class AerationController {
+public:
+  // error > 0 = mehr Belüftung nötig (z.B. doOptimal - DO oder Temp - tempMax)
+  // band = Hysterese (aus bei error <= 0), force = Belüftung unabhängig vom Regler anfordern
+  // (Notfall: schaltet sofort ein, auch während der Mindest-Pause)
+  bool update(const AerationConfig& cfg, float error, float band, bool force, uint32_t nowMs) {
+    bool request = cfg.mode == AERATION_PI ? updatePI(cfg, error, nowMs)
+                                           : updateHysteresis(error, band);
+    if (force) request = true;
+
+    // Mindestzeiten: Umschalten erst nach minOnMs bzw. minOffMs, Notfall-Einschalten sofort
+    if (request != output && switched && !(force && !output)) {
+      uint32_t held = nowMs - lastSwitchMs;
+      if (held < (output ? cfg.minOnMs : cfg.minOffMs)) return output;
+    }
+
+    if (request != output) {
+      output = request;
+      lastSwitchMs = nowMs;
+      switched = true;
+    }
+    return output;
+  }
+
+  bool active() const { return output; }
+  float duty() const { return piDuty; }
+
+  void reset() {
+    output = false;
+    switched = false;
+    integral = 0;
+    piDuty = 0;
+    lastUpdateMs = 0;
+    cycleStartMs = 0;
+    piStarted = false;
+  }
+
+private:
+  bool output = false;
+  bool switched = false;
+  uint32_t lastSwitchMs = 0;
+
+  float integral = 0;                // Einheit·Sekunden
+  float piDuty = 0;
+  uint32_t lastUpdateMs = 0;
+  uint32_t cycleStartMs = 0;
+  bool piStarted = false;
+
+  // Einschalten erst bei Abweichung > band, Ausschalten sobald der Sollwert erreicht ist
+  bool updateHysteresis(float error, float band) {
+    if (error > band) return true;
+    if (error <= 0) return false;
+    return output;                   // Im Band: Zustand halten
+  }
+
+  bool updatePI(const AerationConfig& cfg, float error, uint32_t nowMs) {
+    if (!piStarted) {
+      piStarted = true;
+      lastUpdateMs = nowMs;
+      cycleStartMs = nowMs;
+    }
+
+    float dt = (nowMs - lastUpdateMs) / 1000.0f;
+    lastUpdateMs = nowMs;
+
+    // Anti-Windup: nur integrieren, wenn der Ausgang nicht in die gleiche Richtung sättigt
+    float p = cfg.kp * error;
+    float next = integral + error * dt;
+    float u = p + cfg.ki * next;
+    if ((u < 1 || error < 0) && (u > 0 || error > 0)) integral = next;
+    if (cfg.ki > 0) {
+      // Integralanteil allein darf den Ausgang nicht über [0, 1] hinaus treiben
+      float limit = 1.0f / cfg.ki;
+      if (integral > limit) integral = limit;
+      if (integral < -limit) integral = -limit;
+    }
+
+    float duty = p + cfg.ki * integral;
+    piDuty = duty < 0 ? 0 : (duty > 1 ? 1 : duty);
+
+    // Zeit-Proportional: im Fenster die ersten duty·cycleMs einschalten
+    uint32_t phase = nowMs - cycleStartMs;
+    if (phase >= cfg.cycleMs) {
+      cycleStartMs = nowMs;
+      phase = 0;
+    }
+    return phase < (uint32_t)(piDuty * cfg.cycleMs);
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// ZEITPLÄNE (Relais 1-3 im Auto-Modus)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct RelaySchedule {
+  uint16_t onMinute = 0;             // Minute des Tages (0-1439)
+  uint16_t offMinute = 0;            // Über Mitternacht erlaubt (off < on)
+  uint8_t days = 0;                  // Bit 0 = Sonntag ... Bit 6 = Samstag, 0 = deaktiviert
+};
+
+// weekday wie tm_wday (0 = Sonntag)
+inline bool scheduleActive(const RelaySchedule& s, int weekday, int minuteOfDay) {
+  if (s.days == 0 || s.onMinute == s.offMinute) return false;
+  if (s.onMinute < s.offMinute) {
+    return (s.days & (1 << weekday)) && minuteOfDay >= s.onMinute && minuteOfDay < s.offMinute;
+  }
+  // Über Mitternacht: Abschnitt nach Mitternacht gehört zum Starttag
+  if (minuteOfDay >= s.onMinute) return s.days & (1 << weekday);
+  if (minuteOfDay < s.offMinute) return s.days & (1 << ((weekday + 6) % 7));
+  return false;
+}
+
+#endif  // AERATION_H
@@ -0,0 +1,228 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * daily_stats.h - ForellenWächter Tagesstatistik (laufend, O(1) pro Messung)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Aggregiert über den Tag, ohne Messwerte zu speichern:
+ * - Min/Max/Mittel (zeitgewichtet) für Wasser-, Lufttemperatur, pH, TDS, O₂
+ * - Minuten außerhalb der Grenzwerte (Temperatur hoch, O₂ niedrig, pH)
+ * - Tagesgrade (°C·d der Wassertemperatur) für Fütterung und Wachstum
+ * - Durchfluss in Litern, Turbinenenergie in Wh, Laufzeit der Belüftung
+ *
+ * Am Tagesende wird summary() als DailyStatsRecord (56 Byte, CRC) abgelegt -
+ * 365 Tage passen in gut 20 KB. restore() setzt einen begonnenen Tag nach einem
+ * Neustart fort. Ohne Arduino-Abhängigkeiten.
+ */
+
+#ifndef DAILY_STATS_H
+#define DAILY_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define DAILY_STATS_VERSION 1
+#define DAILY_STATS_DAYS 365          // Ringgröße der Ablage (Slot = Tagesnummer % 365)
+
+enum StatsMetric : uint8_t {
+  STAT_WATER_TEMP, STAT_AIR_TEMP, STAT_PH, STAT_TDS, STAT_DO,
+  STAT_METRICS
+};
+
+// Ablage-Skalierung je Kennzahl (int16): °C×100, pH×100, ppm, mg/L×100
+const float STATS_SCALE[STAT_METRICS] = {100, 100, 100, 1, 100};
+
+#define STATS_EXCEED_TEMP   0x01       // Wassertemperatur über Maximum
+#define STATS_EXCEED_OXYGEN 0x02       // Sauerstoff unter Minimum
+#define STATS_EXCEED_PH     0x04       // pH außerhalb des Bereichs
+
+struct StatsSample {
+  float values[STAT_METRICS];          // NAN = ungültig (wird übersprungen)
+  float flowRate;                      // L/min
+  float turbinePower;                  // W
+  bool aeration;
+  uint8_t exceed;                      // STATS_EXCEED_*
+};
+
+struct __attribute__((packed)) DailyStatsRecord {
+  uint32_t day;                        // JJJJMMTT, 0 = leer
+  int16_t minValue[STAT_METRICS];
+  int16_t maxValue[STAT_METRICS];
+  int16_t meanValue[STAT_METRICS];
+  uint16_t coverageMin;                // Minuten mit Messungen
+  uint16_t tempHighMin;
+  uint16_t oxygenLowMin;
+  uint16_t phOutMin;
+  uint16_t degreeDays;                 // °C·d × 100
+  uint32_t flowLitres;
+  uint16_t turbineWh;
+  uint16_t aerationMin;
+  uint8_t alarms;
+  uint8_t version;
+  uint16_t crc;                        // CRC-16/CCITT über alle Bytes davor
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// DATUM UND PRÜFSUMME
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// JJJJMMTT ↔ Tage seit 1970-01-01 (proleptisch gregorianisch, H. Hinnant)
+inline int32_t statsDayNumber(uint32_t yyyymmdd) {
+  int32_t y = yyyymmdd / 10000, m = (yyyymmdd / 100) % 100, d = yyyymmdd % 100;
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  int32_t yoe = y - era * 400;
+  int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+inline uint32_t statsDate(int32_t dayNumber) {
+  int32_t z = dayNumber + 719468;
+  int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int32_t doe = z - era * 146097;
+  int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int32_t mp = (5 * doy + 2) / 153;
+  int32_t d = doy - (153 * mp + 2) / 5 + 1;
+  int32_t m = mp < 10 ? mp + 3 : mp - 9;
+  int32_t y = yoe + era * 400 + (m <= 2);
+  return y * 10000 + m * 100 + d;
+}
+
+inline uint16_t statsCrc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (int i = 0; i < 8; i++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+inline void statsSeal(DailyStatsRecord& r) {
+  r.version = DAILY_STATS_VERSION;
+  r.crc = statsCrc16((const uint8_t*)&r, sizeof(r) - sizeof(r.crc));
+}
+
+// Gültiger Datensatz für genau diesen Tag?
+inline bool statsValid(const DailyStatsRecord& r, uint32_t day) {
+  return r.day == day && r.version == DAILY_STATS_VERSION &&
+         r.crc == statsCrc16((const uint8_t*)&r, sizeof(r) - sizeof(r.crc));
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// AGGREGATOR
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class DailyStats {
+public:
+  void begin(uint32_t yyyymmdd) {
+    memset(this, 0, sizeof(*this));
+    today = yyyymmdd;
+    for (uint8_t m = 0; m < STAT_METRICS; m++) {
+      minValue[m] = INFINITY;
+      maxValue[m] = -INFINITY;
+    }
+  }
+
+  uint32_t day() const { return today; }
+
+  // Messung mit der Zeit seit der vorherigen gewichten
+  void add(const StatsSample& s, uint32_t dtMs) {
+    if (today == 0 || dtMs == 0) return;
+
+    for (uint8_t m = 0; m < STAT_METRICS; m++) {
+      float v = s.values[m];
+      if (isnan(v)) continue;
+      if (v < minValue[m]) minValue[m] = v;
+      if (v > maxValue[m]) maxValue[m] = v;
+      weightedSum[m] += (double)v * dtMs;
+      weightMs[m] += dtMs;
+    }
+
+    coverageMs += dtMs;
+    if (s.exceed & STATS_EXCEED_TEMP) tempHighMs += dtMs;
+    if (s.exceed & STATS_EXCEED_OXYGEN) oxygenLowMs += dtMs;
+    if (s.exceed & STATS_EXCEED_PH) phOutMs += dtMs;
+    if (s.aeration) aerationMs += dtMs;
+    if (s.flowRate > 0) flowLitres += (double)s.flowRate * dtMs / 60000.0;
+    if (s.turbinePower > 0) turbineWh += (double)s.turbinePower * dtMs / 3600000.0;
+  }
+
+  void addAlarm() {
+    if (alarms < 255) alarms++;
+  }
+
+  float mean(uint8_t m) const { return weightMs[m] ? weightedSum[m] / weightMs[m] : NAN; }
+
+  // Tagesgrade: Integral der Wassertemperatur über die Zeit
+  float degreeDays() const { return weightedSum[STAT_WATER_TEMP] / 86400000.0; }
+
+  DailyStatsRecord summary() const {
+    DailyStatsRecord r;
+    memset(&r, 0, sizeof(r));
+    r.day = today;
+    for (uint8_t m = 0; m < STAT_METRICS; m++) {
+      bool any = weightMs[m] > 0;
+      r.minValue[m] = any ? scaled(minValue[m], m) : 0;
+      r.maxValue[m] = any ? scaled(maxValue[m], m) : 0;
+      r.meanValue[m] = any ? scaled(mean(m), m) : 0;
+    }
+    r.coverageMin = coverageMs / 60000;
+    r.tempHighMin = tempHighMs / 60000;
+    r.oxygenLowMin = oxygenLowMs / 60000;
+    r.phOutMin = phOutMs / 60000;
+    float dd = degreeDays() * 100;
+    r.degreeDays = dd > 0 ? (dd < 65535 ? (uint16_t)lroundf(dd) : 65535) : 0;
+    r.flowLitres = (uint32_t)flowLitres;
+    r.turbineWh = turbineWh < 65535 ? (uint16_t)lround(turbineWh) : 65535;
+    r.aerationMin = aerationMs / 60000;
+    r.alarms = alarms;
+    statsSeal(r);
+    return r;
+  }
+
+  // Begonnenen Tag nach Neustart fortsetzen (Mittelwerte über die Abdeckung)
+  void restore(const DailyStatsRecord& r) {
+    begin(r.day);
+    uint32_t covered = (uint32_t)r.coverageMin * 60000;
+    for (uint8_t m = 0; m < STAT_METRICS; m++) {
+      if (r.minValue[m] == 0 && r.maxValue[m] == 0 && r.meanValue[m] == 0) continue;
+      minValue[m] = r.minValue[m] / STATS_SCALE[m];
+      maxValue[m] = r.maxValue[m] / STATS_SCALE[m];
+      weightMs[m] = covered;
+      weightedSum[m] = (double)(r.meanValue[m] / STATS_SCALE[m]) * covered;
+    }
+    coverageMs = covered;
+    tempHighMs = (uint32_t)r.tempHighMin * 60000;
+    oxygenLowMs = (uint32_t)r.oxygenLowMin * 60000;
+    phOutMs = (uint32_t)r.phOutMin * 60000;
+    aerationMs = (uint32_t)r.aerationMin * 60000;
+    flowLitres = r.flowLitres;
+    turbineWh = r.turbineWh;
+    alarms = r.alarms;
+  }
+
+  uint8_t alarmCount() const { return alarms; }
+
+private:
+  uint32_t today;
+  float minValue[STAT_METRICS];
+  float maxValue[STAT_METRICS];
+  double weightedSum[STAT_METRICS];    // Σ Wert × ms
+  uint32_t weightMs[STAT_METRICS];
+  uint32_t coverageMs;
+  uint32_t tempHighMs, oxygenLowMs, phOutMs, aerationMs;
+  double flowLitres;
+  double turbineWh;
+  uint8_t alarms;
+
+  static int16_t scaled(float v, uint8_t m) {
+    float s = v * STATS_SCALE[m];
+    if (s > 32767) return 32767;
+    if (s < -32768) return -32768;
+    return (int16_t)lroundf(s);
+  }
+};
+
+#endif  // DAILY_STATS_H
@@ -0,0 +1,366 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * delta_patch.h - ForellenWächter Delta-Firmware (bsdiff-artig, streamend)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Wendet einen Binär-Patch gegen die laufende Firmware an, während er
+ * heruntergeladen wird. RAM-Bedarf fest (~1 KB), unabhängig von der Image-Größe.
+ *
+ * Patch-Format (Little Endian), erzeugt mit examples/fw_delta.cpp:
+ *   Header:  "FWD1" | oldSize u32 | newSize u32 | SHA-256(old) | SHA-256(new)
+ *   Blöcke:  diffLen u32 | extraLen u32 | seek i32
+ *            diff-Daten  (RLE, ergibt diffLen Bytes; new = old + diff)
+ *            extra-Daten (extraLen Bytes, unverändert übernommen)
+ *            danach oldPos += seek
+ *   RLE:     Token t < 0x80 → t+1 Literal-Bytes folgen
+ *            Token t ≥ 0x80 → t-0x7F Null-Bytes (unveränderte Bytes)
+ *
+ * Ohne Arduino-Abhängigkeiten: alter Stand wird über readOld() gelesen, der
+ * neue über writeNew() geschrieben (ESP32: Partitionen, Linux: Dateien).
+ */
+
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// SHA-256 (portabel, für Image-Prüfung auf ESP32 und Host)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class Sha256 {
+public:
+  Sha256() { reset(); }
+
+  void reset() {
+    static const uint32_t init[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(state, init, sizeof(state));
+    total = 0;
+    used = 0;
+  }
+
+  void update(const uint8_t* data, size_t len) {
+    total += len;
+    while (len > 0) {
+      size_t n = 64 - used;
+      if (n > len) n = len;
+      memcpy(block + used, data, n);
+      used += n;
+      data += n;
+      len -= n;
+      if (used == 64) {
+        transform();
+        used = 0;
+      }
+    }
+  }
+
+  void finish(uint8_t out[32]) {
+    uint64_t bits = total * 8;
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    pad = 0;
+    while (used != 56) update(&pad, 1);
+    uint8_t length[8];
+    for (int i = 0; i < 8; i++) length[i] = bits >> (56 - i * 8);
+    update(length, 8);
+    for (int i = 0; i < 8; i++) {
+      out[i * 4] = state[i] >> 24;
+      out[i * 4 + 1] = state[i] >> 16;
+      out[i * 4 + 2] = state[i] >> 8;
+      out[i * 4 + 3] = state[i];
+    }
+  }
+
+private:
+  uint32_t state[8];
+  uint8_t block[64];
+  uint64_t total;
+  size_t used;
+
+  static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void transform() {
+    static const uint32_t k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+             (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+      uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+      uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+      uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+  }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// PATCH-FORMAT
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+#define DELTA_MAGIC "FWD1"
+#define DELTA_HEADER_SIZE 76
+#define DELTA_CTRL_SIZE 12
+#define DELTA_RLE_ZERO 0x80
+
+struct DeltaHeader {
+  uint32_t oldSize;
+  uint32_t newSize;
+  uint8_t oldHash[32];
+  uint8_t newHash[32];
+};
+
+enum DeltaStatus : uint8_t {
+  DELTA_OK = 0,                      // Weitere Daten erwartet
+  DELTA_DONE,                        // Image vollständig und Hash korrekt
+  DELTA_ERR_MAGIC,
+  DELTA_ERR_HEADER,                  // Vom Aufrufer abgelehnt (z.B. falsche Basis)
+  DELTA_ERR_FORMAT,                  // Blockgrenzen außerhalb der Images
+  DELTA_ERR_READ,
+  DELTA_ERR_WRITE,
+  DELTA_ERR_HASH,
+  DELTA_ERR_TRAILING                 // Daten nach Ende des Images
+};
+
+inline const char* deltaStatusName(DeltaStatus s) {
+  static const char* names[] = {"OK", "DONE", "MAGIC", "HEADER", "FORMAT", "READ", "WRITE", "HASH", "TRAILING"};
+  return names[s];
+}
+
+inline uint32_t deltaGet32(const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+inline void deltaPut32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// STREAMENDER PATCHER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class DeltaPatcher {
+public:
+  typedef bool (*ReadFn)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+  typedef bool (*WriteFn)(void* ctx, const uint8_t* buf, size_t len);
+  typedef bool (*HeaderFn)(void* ctx, const DeltaHeader& header);
+
+  // onHeader: Basis prüfen / Ziel vorbereiten, false = Abbruch
+  void begin(ReadFn read, WriteFn write, HeaderFn onHeader, void* context) {
+    readOld = read;
+    writeNew = write;
+    headerCb = onHeader;
+    ctx = context;
+    state = ST_HEADER;
+    need = DELTA_HEADER_SIZE;
+    have = 0;
+    oldPos = 0;
+    newPos = 0;
+    outLen = 0;
+    cacheLen = 0;
+    hash.reset();
+    status = DELTA_OK;
+  }
+
+  // Nächstes Stück des Patches verarbeiten (beliebige Größe)
+  DeltaStatus feed(const uint8_t* data, size_t len) {
+    while (len > 0 && status == DELTA_OK) {
+      switch (state) {
+        case ST_HEADER:
+        case ST_CTRL: {
+          size_t n = need - have < len ? need - have : len;
+          memcpy(scratch + have, data, n);
+          have += n; data += n; len -= n;
+          if (have == need) {
+            if (state == ST_HEADER) parseHeader();
+            else parseCtrl();
+          }
+          break;
+        }
+        case ST_DIFF_TOKEN: {
+          uint8_t token = *data++; len--;
+          if (token >= DELTA_RLE_ZERO) {
+            uint32_t zeros = token - (DELTA_RLE_ZERO - 1);
+            if (zeros > diffLeft) { status = DELTA_ERR_FORMAT; break; }
+            for (uint32_t i = 0; i < zeros && status == DELTA_OK; i++) emitDiff(0);
+            afterDiff();
+          } else {
+            literalLeft = token + 1;
+            if (literalLeft > diffLeft) { status = DELTA_ERR_FORMAT; break; }
+            state = ST_DIFF_LITERAL;
+          }
+          break;
+        }
+        case ST_DIFF_LITERAL:
+          while (len > 0 && literalLeft > 0 && status == DELTA_OK) {
+            emitDiff(*data++); len--;
+            literalLeft--;
+          }
+          if (literalLeft == 0) afterDiff();
+          break;
+        case ST_EXTRA:
+          while (len > 0 && extraLeft > 0 && status == DELTA_OK) {
+            emit(*data++); len--;
+            extraLeft--;
+          }
+          if (extraLeft == 0) afterExtra();
+          break;
+        case ST_DONE:
+          status = DELTA_ERR_TRAILING;
+          break;
+      }
+    }
+    if (status == DELTA_OK && state == ST_DONE) status = DELTA_DONE;
+    return status;
+  }
+
+  const DeltaHeader& header() const { return hdr; }
+  uint32_t written() const { return newPos; }
+  DeltaStatus result() const { return status; }
+
+private:
+  enum State : uint8_t { ST_HEADER, ST_CTRL, ST_DIFF_TOKEN, ST_DIFF_LITERAL, ST_EXTRA, ST_DONE };
+
+  ReadFn readOld = nullptr;
+  WriteFn writeNew = nullptr;
+  HeaderFn headerCb = nullptr;
+  void* ctx = nullptr;
+
+  State state = ST_HEADER;
+  DeltaStatus status = DELTA_OK;
+  DeltaHeader hdr;
+  Sha256 hash;
+
+  uint8_t scratch[DELTA_HEADER_SIZE];
+  size_t need = 0;
+  size_t have = 0;
+
+  uint32_t oldPos = 0;
+  uint32_t newPos = 0;
+  uint32_t diffLeft = 0;
+  uint32_t literalLeft = 0;
+  uint32_t extraLeft = 0;
+  int32_t seek = 0;
+
+  uint8_t out[512];                  // Schreibpuffer (Flash-Seitengröße)
+  size_t outLen = 0;
+  uint8_t cache[256];                // Lesepuffer alter Stand
+  uint32_t cacheStart = 0;
+  size_t cacheLen = 0;
+
+  void parseHeader() {
+    if (memcmp(scratch, DELTA_MAGIC, 4) != 0) { status = DELTA_ERR_MAGIC; return; }
+    hdr.oldSize = deltaGet32(scratch + 4);
+    hdr.newSize = deltaGet32(scratch + 8);
+    memcpy(hdr.oldHash, scratch + 12, 32);
+    memcpy(hdr.newHash, scratch + 44, 32);
+    if (headerCb && !headerCb(ctx, hdr)) { status = DELTA_ERR_HEADER; return; }
+    nextCtrl();
+  }
+
+  void nextCtrl() {
+    if (newPos == hdr.newSize) {
+      finishImage();
+      return;
+    }
+    state = ST_CTRL;
+    need = DELTA_CTRL_SIZE;
+    have = 0;
+  }
+
+  void parseCtrl() {
+    diffLeft = deltaGet32(scratch);
+    extraLeft = deltaGet32(scratch + 4);
+    seek = (int32_t)deltaGet32(scratch + 8);
+    if ((uint64_t)oldPos + diffLeft > hdr.oldSize ||
+        (uint64_t)newPos + diffLeft + extraLeft > hdr.newSize) {
+      status = DELTA_ERR_FORMAT;
+      return;
+    }
+    afterDiff();
+  }
+
+  // Nach jedem RLE-Token: weiter mit Diff, Extra oder nächstem Block
+  void afterDiff() {
+    if (diffLeft > 0) { state = ST_DIFF_TOKEN; return; }
+    if (extraLeft > 0) { state = ST_EXTRA; return; }
+    afterExtra();
+  }
+
+  void afterExtra() {
+    int64_t next = (int64_t)oldPos + seek;
+    if (next < 0 || next > hdr.oldSize) { status = DELTA_ERR_FORMAT; return; }
+    oldPos = (uint32_t)next;
+    nextCtrl();
+  }
+
+  void emitDiff(uint8_t delta) {
+    uint8_t base;
+    if (!oldByte(oldPos, base)) { status = DELTA_ERR_READ; return; }
+    oldPos++;
+    diffLeft--;
+    emit(base + delta);
+  }
+
+  void emit(uint8_t b) {
+    out[outLen++] = b;
+    newPos++;
+    if (outLen == sizeof(out)) flush();
+  }
+
+  void flush() {
+    if (outLen == 0) return;
+    hash.update(out, outLen);
+    if (!writeNew(ctx, out, outLen)) status = DELTA_ERR_WRITE;
+    outLen = 0;
+  }
+
+  bool oldByte(uint32_t pos, uint8_t& b) {
+    if (pos < cacheStart || pos >= cacheStart + cacheLen) {
+      size_t n = hdr.oldSize - pos < sizeof(cache) ? hdr.oldSize - pos : sizeof(cache);
+      if (!readOld(ctx, pos, cache, n)) return false;
+      cacheStart = pos;
+      cacheLen = n;
+    }
+    b = cache[pos - cacheStart];
+    return true;
+  }
+
+  void finishImage() {
+    flush();
+    if (status != DELTA_OK) return;
+    uint8_t digest[32];
+    hash.finish(digest);
+    if (memcmp(digest, hdr.newHash, 32) != 0) { status = DELTA_ERR_HASH; return; }
+    state = ST_DONE;
+  }
+};
+
+#endif  // DELTA_PATCH_H
@@ -0,0 +1,137 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * downsample.h - ForellenWächter Ausdünnen von Zeitreihen für Charts
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Statt jeden n-ten Wert zu senden (verschluckt kurze Temperaturspitzen und
+ * Sauerstoff-Einbrüche) werden die Daten formerhaltend reduziert:
+ *
+ * - MinMaxDecimator: pro Bucket Minimum und Maximum in zeitlicher Reihenfolge.
+ *   Streamend (push), O(1) Zustand - auch für zeilenweise gelesene SD-Logs.
+ *   Alle Reihen mit gleicher Länge ergeben gleich viele Punkte → gemeinsame
+ *   Zeitachse für mehrere Reihen in einem Chart.
+ * - lttbSelect(): Largest-Triangle-Three-Buckets für eine einzelne Reihe.
+ *   Erster und letzter Punkt bleiben, pro Bucket der Punkt mit der größten
+ *   Dreiecksfläche. Wahlfreier Zugriff über Callbacks, kein Zwischenspeicher.
+ *
+ * Ohne Arduino-Abhängigkeiten (Host-Vergleich: examples/history_downsample.cpp).
+ */
+
+#ifndef DOWNSAMPLE_H
+#define DOWNSAMPLE_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// MIN/MAX JE BUCKET (streamend)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class MinMaxDecimator {
+public:
+  // total = Anzahl Eingangswerte, target = gewünschte Ausgabepunkte (≥ 2)
+  void begin(uint32_t total, uint32_t target) {
+    n = total;
+    buckets = target < 2 ? 1 : target / 2;
+    passthrough = n <= target;
+    pos = 0;
+    bucket = 0;
+    bucketEnd = passthrough ? n : bucketBoundary(1);
+    used = 0;
+  }
+
+  // Anzahl Ausgabepunkte (für Array-Größen vorab)
+  uint32_t outputCount() const { return passthrough ? n : buckets * 2; }
+
+  // Nächsten Wert einspeisen; emit(index, value) wird 0-2 mal aufgerufen
+  template <typename Emit>
+  void push(float value, Emit emit) {
+    if (pos >= n) return;
+    if (passthrough) {
+      emit(pos++, value);
+      return;
+    }
+
+    if (used == 0 || value < minValue) { minValue = value; minIndex = pos; }
+    if (used == 0 || value > maxValue) { maxValue = value; maxIndex = pos; }
+    used++;
+    pos++;
+
+    if (pos == bucketEnd) {
+      // Zeitliche Reihenfolge beibehalten: früherer Extremwert zuerst
+      if (minIndex <= maxIndex) {
+        emit(minIndex, minValue);
+        emit(maxIndex, maxValue);
+      } else {
+        emit(maxIndex, maxValue);
+        emit(minIndex, minValue);
+      }
+      used = 0;
+      bucket++;
+      bucketEnd = bucketBoundary(bucket + 1);
+    }
+  }
+
+private:
+  uint32_t n = 0;
+  uint32_t buckets = 1;
+  uint32_t pos = 0;
+  uint32_t bucket = 0;
+  uint32_t bucketEnd = 0;
+  uint32_t used = 0;
+  bool passthrough = true;
+  float minValue = 0, maxValue = 0;
+  uint32_t minIndex = 0, maxIndex = 0;
+
+  // Gleichmäßige Aufteilung: jeder Bucket hat ≥ 2 Werte, weil n > 2 × buckets
+  uint32_t bucketBoundary(uint32_t b) const { return (uint64_t)b * n / buckets; }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// LARGEST-TRIANGLE-THREE-BUCKETS (Steinarsson 2013)
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// x(i), y(i): Zeit und Wert des i-ten Eingangspunkts; emit(i) für jeden gewählten Index
+template <typename GetX, typename GetY, typename Emit>
+void lttbSelect(uint32_t n, uint32_t target, GetX x, GetY y, Emit emit) {
+  if (target >= n || target < 3) {
+    for (uint32_t i = 0; i < n; i++) emit(i);
+    return;
+  }
+
+  // Innere Punkte 1..n-2 auf target-2 Buckets verteilen
+  const uint32_t inner = n - 2, buckets = target - 2;
+  auto boundary = [inner, buckets](uint32_t b) { return 1 + (uint32_t)((uint64_t)b * inner / buckets); };
+
+  uint32_t a = 0;
+  emit(a);
+  for (uint32_t b = 0; b < buckets; b++) {
+    uint32_t start = boundary(b), end = boundary(b + 1);
+
+    // Dritter Eckpunkt: Mittelwert des nächsten Buckets (bzw. letzter Punkt)
+    float avgX = 0, avgY = 0;
+    uint32_t nextStart = end, nextEnd = b + 1 < buckets ? boundary(b + 2) : n;
+    for (uint32_t i = nextStart; i < nextEnd; i++) {
+      avgX += x(i);
+      avgY += y(i);
+    }
+    avgX /= (nextEnd - nextStart);
+    avgY /= (nextEnd - nextStart);
+
+    float ax = x(a), ay = y(a);
+    float bestArea = -1;
+    uint32_t best = start;
+    for (uint32_t i = start; i < end; i++) {
+      float area = fabsf((ax - avgX) * (y(i) - ay) - (ax - x(i)) * (avgY - ay));
+      if (area > bestArea) {
+        bestArea = area;
+        best = i;
+      }
+    }
+    emit(best);
+    a = best;
+  }
+  emit(n - 1);
+}
+
+#endif  // DOWNSAMPLE_H
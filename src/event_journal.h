@@ -0,0 +1,87 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * event_journal.h - ForellenWächter Ereignis-Journal im RAM
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Ringpuffer fester Größe mit binären Ereignissen (Code, Zeit, kurzer Text).
+ * Jedes Ereignis bekommt eine fortlaufende Nummer (seq, ab 1 seit Boot):
+ * - Abfrage: "alles nach seq X" für /api/events?since=X (Dashboard-Polling)
+ * - SD: Ereignisse werden gesammelt und gebündelt geschrieben (flushedSeq /
+ *   markFlushed), nicht mehr eine Datei-Öffnung pro Ereignis im Alarmpfad
+ *
+ * Ist der Ring voll, wird das älteste Ereignis überschrieben. Ohne Arduino-
+ * Abhängigkeiten; Sperren (mehrere Tasks) übernimmt der Aufrufer.
+ */
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef EVENT_JOURNAL_SIZE
+#define EVENT_JOURNAL_SIZE 48          // Ereignisse im RAM (je 96 Byte)
+#endif
+
+#define EVENT_TEXT_SIZE 84             // Inkl. Nullterminator, längere Texte werden gekürzt
+#define EVENT_FLAG_NO_TIME 0x01        // time = Sekunden seit Boot (kein NTP)
+
+struct JournalEvent {
+  uint32_t seq;
+  uint32_t time;                       // Unix-Zeit oder Sekunden seit Boot
+  uint8_t code;                        // Ereignis-Typ (Tabelle beim Aufrufer)
+  uint8_t flags;
+  uint8_t reserved[2];
+  char text[EVENT_TEXT_SIZE];
+};
+
+class EventJournal {
+public:
+  // Ereignis anhängen, liefert seine Nummer
+  uint32_t add(uint8_t code, uint32_t time, uint8_t flags, const char* text) {
+    JournalEvent& e = ring[head % EVENT_JOURNAL_SIZE];
+    e.seq = ++head;
+    e.time = time;
+    e.code = code;
+    e.flags = flags;
+    e.reserved[0] = e.reserved[1] = 0;
+    if (!text) text = "";
+
+    // Kürzen ohne UTF-8-Zeichen (Umlaute, Emojis) zu zerschneiden
+    size_t n = strlen(text);
+    if (n > EVENT_TEXT_SIZE - 1) {
+      n = EVENT_TEXT_SIZE - 1;
+      while (n > 0 && ((uint8_t)text[n] & 0xC0) == 0x80) n--;
+    }
+    memcpy(e.text, text, n);
+    e.text[n] = '\0';
+    return e.seq;
+  }
+
+  // Neuestes Ereignis (0 = leer) und ältestes noch im Ring
+  uint32_t lastSeq() const { return head; }
+  uint32_t firstSeq() const { return head > EVENT_JOURNAL_SIZE ? head - EVENT_JOURNAL_SIZE + 1 : 1; }
+
+  // Ereignis per Nummer kopieren; false = nie vergeben oder schon überschrieben
+  bool get(uint32_t seq, JournalEvent& out) const {
+    if (seq == 0 || seq > head || seq < firstSeq()) return false;
+    out = ring[(seq - 1) % EVENT_JOURNAL_SIZE];
+    return true;
+  }
+
+  // SD-Abgleich: bis hierhin geschrieben; noch offene Ereignisse
+  uint32_t flushedSeq() const { return flushed; }
+  uint32_t pending() const { return head - flushed; }
+
+  // Nach dem Schreiben bis einschließlich seq (Lücke flushedSeq+1 < firstSeq = verloren)
+  void markFlushed(uint32_t seq) {
+    if (seq > flushed && seq <= head) flushed = seq;
+  }
+
+private:
+  JournalEvent ring[EVENT_JOURNAL_SIZE];
+  uint32_t head = 0;                   // Zuletzt vergebene Nummer
+  uint32_t flushed = 0;
+};
+
+#endif  // EVENT_JOURNAL_H
@@ -0,0 +1,141 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * history_log.h - ForellenWächter Chart-Historie neustartfest auf SD
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Jeder History-Punkt (alle 5 min) wird als HistoryLogRecord (26 Byte, CRC)
+ * angehängt - ein kleiner Schreibzugriff statt den ganzen Puffer zu sichern:
+ * - Fortlaufende Nummer seq (ab 1, über Neustarts hinweg)
+ * - Ablage als Ring mit festen Offsets: Slot = seq % HISTORY_LOG_SLOTS. Es gibt
+ *   HISTORY_LOG_SPARE Slots mehr als Punkte im RAM, ein abgerissener Schreib-
+ *   zugriff (Reset, Brownout) trifft also nie einen der Punkte, die noch gebraucht werden
+ * - Wiederherstellen: neueste gültige seq suchen, dann die lückenlose Kette
+ *   davor (max. HISTORY_LOG_POINTS). Halbe Datensätze fallen über die CRC raus,
+ *   der nächste Punkt überschreibt den Slot wieder
+ *
+ * Messwerte als int16 (°C×100, pH×100, ppm, mg/L×100, L/min×10, W×10),
+ * INT16_MIN = kein Wert. Ohne Arduino-Abhängigkeiten; Lesen und Schreiben
+ * übernimmt der Aufrufer (SD in der Firmware, Datei in examples/history_crash.cpp).
+ */
+
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "daily_stats.h"              // statsCrc16()
+
+#ifndef HISTORY_LOG_POINTS
+#define HISTORY_LOG_POINTS 288        // = HISTORY_SIZE (24h bei 5 min)
+#endif
+#define HISTORY_LOG_SPARE 16
+#define HISTORY_LOG_SLOTS (HISTORY_LOG_POINTS + HISTORY_LOG_SPARE)
+#define HISTORY_LOG_VERSION 1
+#define HISTORY_LOG_READ_RECORDS 16   // Datensätze pro Lesezugriff beim Wiederherstellen
+
+enum HistoryLogChannel : uint8_t {
+  HLOG_WATER_TEMP, HLOG_AIR_TEMP, HLOG_PH, HLOG_TDS, HLOG_DO, HLOG_FLOW, HLOG_POWER,
+  HLOG_CHANNELS
+};
+
+const float HISTORY_LOG_SCALE[HLOG_CHANNELS] = {100, 100, 100, 1, 100, 10, 10};
+
+struct __attribute__((packed)) HistoryLogRecord {
+  uint32_t seq;                        // 0 = leer
+  uint32_t time;                       // Unix-Zeit, 0 = ohne NTP-Zeit aufgezeichnet
+  int16_t values[HLOG_CHANNELS];
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t crc;                        // CRC-16/CCITT über alle Bytes davor
+};
+
+inline uint32_t historyLogOffset(uint32_t seq) {
+  return (seq % HISTORY_LOG_SLOTS) * sizeof(HistoryLogRecord);
+}
+
+inline int16_t historyLogEncode(float v, uint8_t channel) {
+  if (isnan(v)) return INT16_MIN;
+  float s = v * HISTORY_LOG_SCALE[channel];
+  if (s > 32767) return 32767;
+  if (s < -32767) return -32767;
+  return (int16_t)lroundf(s);
+}
+
+inline float historyLogDecode(const HistoryLogRecord& r, uint8_t channel) {
+  int16_t v = r.values[channel];
+  return v == INT16_MIN ? NAN : v / HISTORY_LOG_SCALE[channel];
+}
+
+inline void historyLogSeal(HistoryLogRecord& r) {
+  r.version = HISTORY_LOG_VERSION;
+  r.reserved = 0;
+  r.crc = statsCrc16((const uint8_t*)&r, sizeof(r) - sizeof(r.crc));
+}
+
+inline bool historyLogValid(const HistoryLogRecord& r) {
+  return r.seq != 0 && r.version == HISTORY_LOG_VERSION &&
+         r.crc == statsCrc16((const uint8_t*)&r, sizeof(r) - sizeof(r.crc));
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// WIEDERHERSTELLEN
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+struct HistoryLogRange {
+  uint32_t first;                      // Älteste wiederhergestellte seq
+  uint32_t last;                       // Neueste, 0 = nichts gefunden
+  uint32_t count() const { return last ? last - first + 1 : 0; }
+};
+
+// Liest die Ring-Datei (8 KB) dreimal sequentiell:
+// 1. neueste gültige seq
+// 2. welche der HISTORY_LOG_SLOTS Nummern davor vorhanden sind → lückenlose Kette
+// 3. onRecord(index, record) für jede seq der Kette, index = seq - first
+//    (Reihenfolge wie in der Datei, nicht nach seq)
+// read(offset, buf, len) liefert die gelesenen Bytes (kurze Datei = leere Slots).
+template <typename ReadFn, typename RecordFn>
+HistoryLogRange historyLogRestore(ReadFn read, RecordFn onRecord) {
+  HistoryLogRange range = {0, 0};
+  HistoryLogRecord buf[HISTORY_LOG_READ_RECORDS];
+
+  // Ruft fn(slot, record) für jeden gültigen Datensatz an seinem richtigen Slot auf
+  auto scan = [&](auto fn) {
+    for (uint32_t slot = 0; slot < HISTORY_LOG_SLOTS; slot += HISTORY_LOG_READ_RECORDS) {
+      uint32_t want = HISTORY_LOG_SLOTS - slot;
+      if (want > HISTORY_LOG_READ_RECORDS) want = HISTORY_LOG_READ_RECORDS;
+      size_t got = read(slot * sizeof(HistoryLogRecord), (uint8_t*)buf, want * sizeof(HistoryLogRecord));
+      uint32_t n = got / sizeof(HistoryLogRecord);
+      for (uint32_t i = 0; i < n; i++) {
+        if (historyLogValid(buf[i]) && buf[i].seq % HISTORY_LOG_SLOTS == slot + i) fn(slot + i, buf[i]);
+      }
+      if (n < want) break;
+    }
+  };
+
+  uint32_t newest = 0;
+  scan([&](uint32_t, const HistoryLogRecord& r) { if (r.seq > newest) newest = r.seq; });
+  if (newest == 0) return range;
+
+  // Slot-Bitmap der Nummern (newest - SLOTS, newest]; älteres steht nur noch von früheren Runden drin
+  uint32_t present[(HISTORY_LOG_SLOTS + 31) / 32] = {};
+  scan([&](uint32_t slot, const HistoryLogRecord& r) {
+    if (r.seq + HISTORY_LOG_SLOTS > newest) present[slot / 32] |= 1UL << (slot % 32);
+  });
+
+  uint32_t first = newest;
+  while (first > 1 && newest - first + 1 < HISTORY_LOG_POINTS) {
+    uint32_t slot = (first - 1) % HISTORY_LOG_SLOTS;
+    if (!(present[slot / 32] & (1UL << (slot % 32)))) break;
+    first--;
+  }
+  range.first = first;
+  range.last = newest;
+
+  scan([&](uint32_t, const HistoryLogRecord& r) {
+    if (r.seq >= first) onRecord(r.seq - first, r);
+  });
+  return range;
+}
+
+#endif  // HISTORY_LOG_H
@@ -0,0 +1,288 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * https_pool.h - ForellenWächter HTTPS Verbindungs-Pool
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Hält pro Host eine Keep-Alive TLS-Verbindung offen, damit Webhook, DynDNS &
+ * Co. nicht bei jedem Request einen neuen Handshake (2-4 s, ~40 KB Heap) zahlen.
+ *
+ * - Max. HTTPS_POOL_SIZE gleichzeitige TLS-Kontexte (LRU-Verdrängung), auch
+ *   dauerhafte Verbindungen außerhalb des Pools (Telegram) zählen mit: vorher
+ *   reserveExternal(), nach stop() releaseExternal()
+ * - Neue Verbindungen nur bei ausreichend freiem Heap
+ * - Idle-Verbindungen werden nach HTTPS_IDLE_TIMEOUT geschlossen. Wer seltener
+ *   sendet (DynDNS alle 5 min), gibt bei acquire() eine längere Haltezeit an -
+ *   sonst ist die Verbindung beim nächsten Request immer schon zu. Schließt der
+ *   Server früher, erkennt acquire() das und baut neu auf.
+ *
+ * Nutzung mit HTTPClient:
+ *   WiFiClientSecure* client = httpsPool.acquire(url);
+ *   HTTPClient http;
+ *   http.setReuse(true);
+ *   http.begin(*client, url);
+ *   int code = http.POST(payload);
+ *   http.end();
+ *   httpsPool.release(client, code > 0);
+ *
+ * nullptr bei einer https://-URL heißt: kein TLS-Platz oder Handshake
+ * fehlgeschlagen - dann nicht unverschlüsselt und ohne Pool-Limit weitermachen.
+ *
+ * Auf dem PC (examples/https_pool_tls.cpp) stellt der Test WiFiClientSecure,
+ * Mutex, millis() und ESP.getFreeHeap() selbst bereit.
+ */
+
+#ifndef HTTPS_POOL_H
+#define HTTPS_POOL_H
+
+#if defined(ARDUINO)
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+#ifndef HTTPS_POOL_SIZE
+#define HTTPS_POOL_SIZE 2             // Gleichzeitige TLS-Kontexte (Pool + externe)
+#endif
+#ifndef HTTPS_IDLE_TIMEOUT
+#define HTTPS_IDLE_TIMEOUT 60000      // Idle-Verbindung schließen (ms, Standard für acquire())
+#endif
+#ifndef HTTPS_MIN_FREE_HEAP
+#define HTTPS_MIN_FREE_HEAP 50000     // Kein neuer Handshake unter dieser Grenze
+#endif
+#ifndef HTTPS_CONNECT_TIMEOUT
+#define HTTPS_CONNECT_TIMEOUT 10000   // ms
+#endif
+
+struct HttpsPoolStats {
+  uint32_t requests = 0;
+  uint32_t reuses = 0;
+  uint32_t handshakes = 0;
+  uint32_t failures = 0;
+  uint32_t handshakeTotalMs = 0;
+  uint32_t lastHandshakeMs = 0;
+};
+
+class HttpsPool {
+public:
+  HttpsPool() {
+    mutex = xSemaphoreCreateMutex();
+  }
+
+  // Liefert eine verbundene TLS-Verbindung zum Host der URL (nullptr bei Fehler).
+  // keepAliveMs: so lange bleibt die Verbindung nach release() offen.
+  WiFiClientSecure* acquire(const char* url, unsigned long keepAliveMs = HTTPS_IDLE_TIMEOUT) {
+    char host[64];
+    uint16_t port;
+    if (!parseUrl(url, host, sizeof(host), port)) return nullptr;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats.requests++;
+
+    Slot* slot = findSlot(host, port);
+    if (slot && slot->client.connected()) {
+      slot->inUse = true;
+      slot->keepAliveMs = keepAliveMs;
+      stats.reuses++;
+      xSemaphoreGive(mutex);
+      return &slot->client;
+    }
+
+    if (!slot) slot = evictSlot();
+    if (!slot) {
+      stats.failures++;
+      xSemaphoreGive(mutex);
+      return nullptr;  // Alle Slots belegt
+    }
+    slot->inUse = true;
+    slot->keepAliveMs = keepAliveMs;
+    xSemaphoreGive(mutex);
+
+    // Handshake außerhalb des Mutex (dauert Sekunden)
+    slot->client.stop();
+    if (ESP.getFreeHeap() < HTTPS_MIN_FREE_HEAP) {
+      closeIdle(true);
+    }
+    if (ESP.getFreeHeap() < HTTPS_MIN_FREE_HEAP) {
+      return failSlot(slot);
+    }
+
+    strlcpy(slot->host, host, sizeof(slot->host));
+    slot->port = port;
+    slot->client.setInsecure();  // Wie bisher: keine Zertifikatsprüfung
+    slot->client.setTimeout(HTTPS_CONNECT_TIMEOUT / 1000);
+
+    unsigned long start = millis();
+    if (!slot->client.connect(host, port, HTTPS_CONNECT_TIMEOUT)) {
+      return failSlot(slot);
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats.handshakes++;
+    stats.lastHandshakeMs = millis() - start;
+    stats.handshakeTotalMs += stats.lastHandshakeMs;
+    xSemaphoreGive(mutex);
+
+    return &slot->client;
+  }
+
+  // keepAlive = false schließt die Verbindung (z.B. nach Fehler)
+  void release(WiFiClientSecure* client, bool keepAlive) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      if (&slots[i].client != client) continue;
+      if (!keepAlive) {
+        slots[i].client.stop();
+        slots[i].host[0] = '\0';
+      }
+      slots[i].inUse = false;
+      slots[i].lastUsed = millis();
+    }
+    xSemaphoreGive(mutex);
+  }
+
+  // Aus loop() aufrufen: Idle-Verbindungen schließen, Heap freigeben
+  void maintain() {
+    closeIdle(false);
+  }
+
+  HttpsPoolStats getStats() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    HttpsPoolStats copy = stats;
+    xSemaphoreGive(mutex);
+    return copy;
+  }
+
+  int openConnections() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int count = external;
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      if (slots[i].host[0] && (slots[i].inUse || slots[i].client.connected())) count++;
+    }
+    xSemaphoreGive(mutex);
+    return count;
+  }
+
+  // Eigene TLS-Verbindung außerhalb des Pools anmelden (z.B. Telegram Long
+  // Polling). Verdrängt bei Bedarf eine Idle-Verbindung; false = alles belegt.
+  bool reserveExternal() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool ok = liveSlots() + external < HTTPS_POOL_SIZE;
+    if (!ok) {
+      Slot* idle = oldestIdle();
+      if (idle) {
+        idle->client.stop();
+        idle->host[0] = '\0';
+        ok = true;
+      }
+    }
+    if (ok) external++;
+    xSemaphoreGive(mutex);
+    return ok;
+  }
+
+  // Nach client.stop() der externen Verbindung
+  void releaseExternal() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (external > 0) external--;
+    xSemaphoreGive(mutex);
+  }
+
+  static bool isHttps(const char* url) {
+    return strncmp(url, "https://", 8) == 0;
+  }
+
+  // "https://host[:port]/pfad" → host, port
+  static bool parseUrl(const char* url, char* host, size_t hostLen, uint16_t& port) {
+    if (!isHttps(url)) return false;
+    const char* start = url + 8;
+    const char* end = start;
+    while (*end && *end != '/' && *end != ':' && *end != '?') end++;
+
+    size_t len = end - start;
+    if (len == 0 || len >= hostLen) return false;
+    memcpy(host, start, len);
+    host[len] = '\0';
+
+    port = 443;
+    if (*end == ':') port = atoi(end + 1);
+    return port > 0;
+  }
+
+private:
+  struct Slot {
+    WiFiClientSecure client;
+    char host[64] = "";
+    uint16_t port = 0;
+    bool inUse = false;
+    unsigned long lastUsed = 0;
+    unsigned long keepAliveMs = HTTPS_IDLE_TIMEOUT;
+  };
+
+  Slot slots[HTTPS_POOL_SIZE];
+  HttpsPoolStats stats;
+  SemaphoreHandle_t mutex;
+  int external = 0;                    // Angemeldete TLS-Verbindungen außerhalb des Pools
+
+  Slot* findSlot(const char* host, uint16_t port) {
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      if (!slots[i].inUse && slots[i].port == port && strcmp(slots[i].host, host) == 0) {
+        return &slots[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Slots mit TLS-Kontext (verbunden oder gerade in Benutzung)
+  int liveSlots() {
+    int count = 0;
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      if (slots[i].inUse || slots[i].host[0]) count++;
+    }
+    return count;
+  }
+
+  Slot* oldestIdle() {
+    Slot* oldest = nullptr;
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      if (slots[i].inUse || slots[i].host[0] == '\0') continue;
+      if (!oldest || slots[i].lastUsed < oldest->lastUsed) oldest = &slots[i];
+    }
+    return oldest;
+  }
+
+  // Freien Slot (nur solange TLS-Kontexte frei sind) oder am längsten unbenutzten wählen
+  Slot* evictSlot() {
+    if (liveSlots() + external < HTTPS_POOL_SIZE) {
+      for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+        if (!slots[i].inUse && slots[i].host[0] == '\0') return &slots[i];
+      }
+    }
+    return oldestIdle();
+  }
+
+  WiFiClientSecure* failSlot(Slot* slot) {
+    slot->client.stop();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    slot->host[0] = '\0';
+    slot->inUse = false;
+    stats.failures++;
+    xSemaphoreGive(mutex);
+    return nullptr;
+  }
+
+  // all = true: jede ungenutzte Verbindung schließen (Heap knapp)
+  void closeIdle(bool all) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < HTTPS_POOL_SIZE; i++) {
+      Slot& slot = slots[i];
+      if (slot.inUse || slot.host[0] == '\0') continue;
+      if (all || millis() - slot.lastUsed >= slot.keepAliveMs || !slot.client.connected()) {
+        slot.client.stop();
+        slot.host[0] = '\0';
+      }
+    }
+    xSemaphoreGive(mutex);
+  }
+};
+
+#endif  // HTTPS_POOL_H
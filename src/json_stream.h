@@ -0,0 +1,259 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * json_stream.h - ForellenWächter streamender JSON-Parser (Push, fester Speicher)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Für große Antworten (z.B. Wettervorhersage, ~50 KB), von denen nur wenige Werte
+ * gebraucht werden. Das Dokument wird nie vollständig gehalten:
+ * - feed() nimmt beliebig geschnittene Stücke an (WiFi-Stream, AT+HTTPREAD-Blöcke)
+ * - Für jeden skalaren Wert (String, Zahl, true/false/null) wird der Callback
+ *   mit dem aktuellen Pfad aufgerufen; der Aufrufer filtert über keyAt()/indexAt()
+ * - Speicher: ca. 300 Byte, unabhängig von der Dokumentgröße
+ *
+ * Pfad-Beispiel für {"weather":[{"hourly":[{"tempC":"12"}]}]} beim Wert "12":
+ *   Ebene 0 Schlüssel "weather", 1 Index 0, 2 Schlüssel "hourly", 3 Index 0, 4 Schlüssel "tempC"
+ *
+ * Zu lange Schlüssel/Werte werden gekürzt. Ebenen tiefer als JSON_STREAM_DEPTH
+ * werden geparst, aber nicht gemeldet (Verschachtelung max. 32). Ohne
+ * Arduino-Abhängigkeiten.
+ */
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define JSON_STREAM_DEPTH 8
+#define JSON_STREAM_KEY 24
+#define JSON_STREAM_VALUE 48
+#define JSON_STREAM_MAX_NESTING 32    // Bits in arrayBits
+
+class JsonStreamParser {
+public:
+  typedef void (*ValueFn)(void* ctx, const JsonStreamParser& parser, const char* value);
+
+  void begin(ValueFn fn, void* context) {
+    onValue = fn;
+    ctx = context;
+    depth = 0;
+    arrayBits = 0;
+    state = S_VALUE;
+    len = 0;
+  }
+
+  // false = Syntaxfehler (weitere Daten werden ignoriert)
+  bool feed(const char* data, size_t n) {
+    for (size_t i = 0; i < n && state != S_ERROR; i++) step(data[i]);
+    return state != S_ERROR;
+  }
+
+  bool complete() const { return state == S_DONE; }
+  bool failed() const { return state == S_ERROR; }
+
+  // Im Callback: Tiefe des Werts, Schlüssel bzw. Array-Index je Ebene
+  uint8_t levels() const { return depth < JSON_STREAM_DEPTH ? depth : JSON_STREAM_DEPTH; }
+  bool keyAt(uint8_t level, const char* key) const {
+    return level < levels() && !stack[level].array && strcmp(stack[level].key, key) == 0;
+  }
+  int indexAt(uint8_t level) const {
+    return level < levels() && stack[level].array ? stack[level].index : -1;
+  }
+  bool isString() const { return valueIsString; }
+
+private:
+  enum State : uint8_t {
+    S_VALUE, S_AFTER_VALUE, S_KEY, S_COLON, S_STRING, S_ESCAPE, S_UNICODE, S_LITERAL, S_DONE, S_ERROR
+  };
+
+  struct Level {
+    bool array;
+    uint16_t index;
+    char key[JSON_STREAM_KEY];
+  };
+
+  ValueFn onValue = nullptr;
+  void* ctx = nullptr;
+  Level stack[JSON_STREAM_DEPTH];
+  uint8_t depth = 0;                 // Kann JSON_STREAM_DEPTH überschreiten
+  uint32_t arrayBits = 0;            // Bit d = Ebene d ist ein Array (alle Ebenen)
+  State state = S_VALUE;
+  bool inKey = false;
+  bool valueIsString = false;
+  char buf[JSON_STREAM_VALUE];
+  uint8_t len = 0;
+  uint16_t unicode = 0;
+  uint8_t unicodeDigits = 0;
+
+  static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+  void put(char c) {
+    if (len < JSON_STREAM_VALUE - 1) buf[len++] = c;
+  }
+
+  void putUtf8(uint16_t cp) {
+    if (cp < 0x80) {
+      put(cp);
+    } else if (cp < 0x800) {
+      put(0xC0 | (cp >> 6));
+      put(0x80 | (cp & 0x3F));
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+      put('?');                      // Surrogat-Paare (Emojis) werden nicht gebraucht
+    } else {
+      put(0xE0 | (cp >> 12));
+      put(0x80 | ((cp >> 6) & 0x3F));
+      put(0x80 | (cp & 0x3F));
+    }
+  }
+
+  void push(bool array) {
+    if (depth >= JSON_STREAM_MAX_NESTING) {
+      state = S_ERROR;
+      return;
+    }
+    if (array) arrayBits |= 1UL << depth;
+    else arrayBits &= ~(1UL << depth);
+    if (depth < JSON_STREAM_DEPTH) {
+      stack[depth].array = array;
+      stack[depth].index = 0;
+      stack[depth].key[0] = '\0';
+    }
+    depth++;
+  }
+
+  bool pop(bool array) {
+    if (depth == 0) return false;
+    depth--;
+    if (((arrayBits >> depth) & 1) != (array ? 1u : 0u)) return false;
+    state = depth == 0 ? S_DONE : S_AFTER_VALUE;
+    return true;
+  }
+
+  void emit(bool isStr) {
+    buf[len] = '\0';
+    valueIsString = isStr;
+    if (onValue && depth <= JSON_STREAM_DEPTH) onValue(ctx, *this, buf);
+    len = 0;
+    state = depth == 0 ? S_DONE : S_AFTER_VALUE;
+  }
+
+  void startValue(char c) {
+    if (c == '{') { state = S_KEY; push(false); }
+    else if (c == '[') { state = S_VALUE; push(true); }
+    else if (c == '"') { inKey = false; len = 0; state = S_STRING; }
+    else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+      len = 0;
+      put(c);
+      state = S_LITERAL;
+    } else {
+      state = S_ERROR;
+    }
+  }
+
+  void afterValue(char c) {
+    if (c == ',') {
+      if (depth == 0) { state = S_ERROR; return; }
+      if ((arrayBits >> (depth - 1)) & 1) {
+        if (depth <= JSON_STREAM_DEPTH) stack[depth - 1].index++;
+        state = S_VALUE;
+      } else {
+        state = S_KEY;
+      }
+    } else if (c == '}' || c == ']') {
+      if (!pop(c == ']')) state = S_ERROR;
+    } else if (!isSpace(c)) {
+      state = S_ERROR;
+    }
+  }
+
+  void step(char c) {
+    switch (state) {
+      case S_VALUE:
+        if (isSpace(c)) return;
+        if (c == ']' && depth > 0) { if (!pop(true)) state = S_ERROR; return; }  // Leeres Array
+        startValue(c);
+        return;
+
+      case S_KEY:
+        if (isSpace(c)) return;
+        if (c == '}') { if (!pop(false)) state = S_ERROR; return; }             // Leeres Objekt
+        if (c != '"') { state = S_ERROR; return; }
+        inKey = true;
+        len = 0;
+        state = S_STRING;
+        return;
+
+      case S_COLON:
+        if (isSpace(c)) return;
+        state = c == ':' ? S_VALUE : S_ERROR;
+        return;
+
+      case S_STRING:
+        if (c == '\\') { state = S_ESCAPE; return; }
+        if (c != '"') { put(c); return; }
+        if (inKey) {
+          buf[len] = '\0';
+          if (depth > 0 && depth <= JSON_STREAM_DEPTH) {
+            uint8_t n = len < JSON_STREAM_KEY - 1 ? len : JSON_STREAM_KEY - 1;
+            memcpy(stack[depth - 1].key, buf, n);
+            stack[depth - 1].key[n] = '\0';
+          }
+          len = 0;
+          state = S_COLON;
+        } else {
+          emit(true);
+        }
+        return;
+
+      case S_ESCAPE:
+        state = S_STRING;
+        switch (c) {
+          case 'n': put('\n'); break;
+          case 't': put('\t'); break;
+          case 'r': put('\r'); break;
+          case 'b': put('\b'); break;
+          case 'f': put('\f'); break;
+          case 'u': unicode = 0; unicodeDigits = 0; state = S_UNICODE; break;
+          default: put(c);           // \" \\ \/
+        }
+        return;
+
+      case S_UNICODE: {
+        int v = c >= '0' && c <= '9' ? c - '0'
+              : c >= 'a' && c <= 'f' ? c - 'a' + 10
+              : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (v < 0) { state = S_ERROR; return; }
+        unicode = (unicode << 4) | v;
+        if (++unicodeDigits == 4) {
+          putUtf8(unicode);
+          state = S_STRING;
+        }
+        return;
+      }
+
+      case S_LITERAL:
+        if (c == ',' || c == '}' || c == ']' || isSpace(c)) {
+          emit(false);
+          if (state == S_AFTER_VALUE) afterValue(c);
+          else if (!isSpace(c)) state = S_ERROR;   // Daten nach dem Dokumentende
+          return;
+        }
+        put(c);
+        return;
+
+      case S_AFTER_VALUE:
+        afterValue(c);
+        return;
+
+      case S_DONE:
+        if (!isSpace(c)) state = S_ERROR;
+        return;
+
+      case S_ERROR:
+        return;
+    }
+  }
+};
+
+#endif  // JSON_STREAM_H
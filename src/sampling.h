@@ -0,0 +1,78 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * sampling.h - ForellenWächter adaptive Abtastraten pro Messkanal
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Langsame Größen (Wassertemperatur, TDS) werden selten gelesen, schnelle
+ * (Durchfluss, Wasserstand) oft. Jeder Kanal wechselt automatisch auf seine
+ * schnelle Rate, wenn
+ * - sich der Wert schneller als rateLimit pro Minute ändert,
+ * - die Streuung (EWMA-Standardabweichung) über noiseLimit steigt oder
+ * - ein Grenzwert in der Nähe ist (vom Aufrufer gemeldet).
+ * Nach holdMs ohne neuen Auslöser geht der Kanal zurück auf die Basisrate.
+ */
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <stdint.h>
+#include <math.h>
+
+struct SamplePolicy {
+  uint32_t baseMs;                   // Ruhige Phase
+  uint32_t fastMs;                   // Bei Änderung / nahe Grenzwert
+  uint32_t holdMs;                   // Mindestdauer der schnellen Phase
+  float rateLimit;                   // Änderung pro Minute (Einheit des Kanals)
+  float noiseLimit;                  // EWMA-Standardabweichung
+};
+
+class AdaptiveSampler {
+public:
+  // Fällig? Erste Messung immer sofort
+  bool due(uint32_t nowMs) const {
+    return samples == 0 || nowMs - lastMs >= interval();
+  }
+
+  // Neue Messung verbuchen; nearLimit = Grenzwert in der Nähe/überschritten
+  void record(const SamplePolicy& p, float value, bool nearLimit, uint32_t nowMs) {
+    bool trigger = nearLimit;
+
+    if (samples > 0) {
+      float minutes = (nowMs - lastMs) / 60000.0f;
+      if (minutes > 0 && fabsf(value - lastValue) / minutes > p.rateLimit) trigger = true;
+
+      // Exponentiell gewichteter Mittelwert und Varianz (alpha = 1/4)
+      float diff = value - mean;
+      mean += diff / 4;
+      variance = 0.75f * (variance + diff * diff / 4);
+      if (sqrtf(variance) > p.noiseLimit) trigger = true;
+    } else {
+      mean = value;
+      variance = 0;
+    }
+
+    if (trigger) fastUntilMs = nowMs + p.holdMs;
+    fast = trigger || (int32_t)(fastUntilMs - nowMs) > 0;
+    currentMs = fast ? p.fastMs : p.baseMs;
+
+    lastValue = value;
+    lastMs = nowMs;
+    samples++;
+  }
+
+  uint32_t interval() const { return currentMs; }
+  bool isFast() const { return fast; }
+  uint32_t count() const { return samples; }
+
+private:
+  float lastValue = 0;
+  float mean = 0;
+  float variance = 0;
+  uint32_t lastMs = 0;
+  uint32_t fastUntilMs = 0;
+  uint32_t currentMs = 0;
+  uint32_t samples = 0;
+  bool fast = false;
+};
+
+#endif  // SAMPLING_H
@@ -0,0 +1,56 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * sd_batch.h - ForellenWächter Batch-Anhängen an SD-Dateien (resetfest)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * v1.3 sammelt Messungen und Ereignisse im RTC-RAM und hängt sie gebündelt an
+ * eine Datei an. Ein Reset mitten im Schreiben darf weder Zeilen verdoppeln
+ * noch welche verlieren. Dazu merkt sich SdPendingBatch (im RTC-RAM) die
+ * Dateigröße vor dem Batch. Wird ein Batch unterbrochen, kürzt der nächste
+ * Versuch die Datei auf diesen Stand und schreibt die gepufferten Datensätze
+ * noch einmal - egal wie weit der erste kam (auch wenn er schon fertig war,
+ * aber der Reset vor sdBatchDone kam). Erst nach dem Schließen der Datei gilt
+ * der Batch als geschrieben, dann nimmt der Aufrufer die Datensätze aus dem Puffer.
+ *
+ * Ein Batch betrifft genau eine Datei (Kennung file); Tages-CSV und events.log
+ * haben je einen eigenen SdPendingBatch. Ohne Arduino-Abhängigkeiten; Dateizugriffe
+ * übernimmt der Aufrufer (SD in der Firmware, Simulation in examples/sd_batch_sim.cpp).
+ */
+
+#ifndef SD_BATCH_H
+#define SD_BATCH_H
+
+#include <stdint.h>
+
+struct SdPendingBatch {
+  uint32_t file;                       // Kennung der Datei (z.B. Tag der CSV)
+  uint32_t offset;                     // Dateigröße vor dem Batch
+  uint8_t active;                      // 1 = begonnen, noch nicht abgeschlossen
+};
+
+// Wird gerade ein unterbrochener Batch dieser Datei wiederholt?
+inline bool sdBatchPending(const SdPendingBatch& p, uint32_t file) {
+  return p.active && p.file == file;
+}
+
+// Vor dem Schreiben mit der aktuellen Dateigröße (0 = neue Datei) aufrufen.
+// Liefert true, wenn die Datei erst auf p.offset gekürzt werden muss.
+inline bool sdBatchBegin(SdPendingBatch& p, uint32_t file, uint32_t fileSize) {
+  if (sdBatchPending(p, file) && fileSize >= p.offset) {
+    return fileSize > p.offset;        // Unterbrochener Batch: Reste abschneiden
+  }
+  // Neuer Batch. Auch wenn der offene Batch eine andere Datei betraf (ihre
+  // Datensätze sind bei vollem Puffer verworfen worden) oder die Datei kleiner
+  // ist als gemerkt (andere Karte): dann gibt es nichts zu kürzen.
+  p.file = file;
+  p.offset = fileSize;
+  p.active = 1;
+  return false;
+}
+
+// Nach dem Schließen der Datei - direkt danach die Datensätze aus dem Puffer nehmen
+inline void sdBatchDone(SdPendingBatch& p) {
+  p.active = 0;
+}
+
+#endif  // SD_BATCH_H
@@ -0,0 +1,235 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * sensor_format.h - ForellenWächter Feld-Tabelle & allokationsfreie Serialisierung
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Eine constexpr-Tabelle beschreibt jedes Messfeld (Name, Einheit, Präzision,
+ * Feature-Flag). Daraus erzeugen die Writer JSON, CSV und Klartext direkt in
+ * einen vom Aufrufer bereitgestellten Puffer - ohne String, ohne Heap.
+ * selectEnabled() reduziert solche Tabellen zur Compile-Zeit auf die
+ * aktivierten Einträge.
+ *
+ * Beispiel:
+ *   char buf[512];
+ *   TextBuffer out(buf, sizeof(buf));
+ *   writeJsonFields(out, SENSOR_FIELDS, snapshot);
+ */
+
+#ifndef SENSOR_FORMAT_H
+#define SENSOR_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// AUSGABEPUFFER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class TextBuffer {
+public:
+  TextBuffer(char* buffer, size_t capacity) : buf(buffer), cap(capacity), len(0) {
+    if (cap > 0) buf[0] = '\0';
+  }
+
+  void append(const char* s) {
+    while (*s && len + 1 < cap) buf[len++] = *s++;
+    if (*s) truncated = true;
+    buf[len] = '\0';
+  }
+
+  void appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    if (len + 1 >= cap) { truncated = true; return; }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, cap - len, fmt, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t)n >= cap - len) { len = cap - 1; truncated = true; }
+    else len += n;
+  }
+
+  // JSON-String inkl. Anführungszeichen und Escaping
+  void appendJsonString(const char* s) {
+    append("\"");
+    char esc[8];
+    for (; *s; s++) {
+      unsigned char c = *s;
+      if (c == '"' || c == '\\') { esc[0] = '\\'; esc[1] = c; esc[2] = '\0'; append(esc); }
+      else if (c == '\n') append("\\n");
+      else if (c < 0x20) { snprintf(esc, sizeof(esc), "\\u%04x", c); append(esc); }
+      else { esc[0] = c; esc[1] = '\0'; append(esc); }
+    }
+    append("\"");
+  }
+
+  void clear() {
+    len = 0;
+    truncated = false;
+    if (cap > 0) buf[0] = '\0';
+  }
+
+  const char* c_str() const { return buf; }
+  size_t length() const { return len; }
+  bool overflowed() const { return truncated; }
+
+private:
+  char* buf;
+  size_t cap;
+  size_t len;
+  bool truncated = false;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// FELD-TABELLE
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+enum FieldKind : uint8_t { FIELD_FLOAT, FIELD_BOOL, FIELD_COUNT };
+
+// Ausgabeformate, in denen ein Feld erscheint
+#define FMT_JSON 0x01
+#define FMT_CSV  0x02
+#define FMT_TEXT 0x04
+#define FMT_ALL  (FMT_JSON | FMT_CSV | FMT_TEXT)
+
+// Gruppen für Teil-Ausgaben (z.B. Telegram /temp, /water, /power)
+#define GROUP_TEMP  0x01
+#define GROUP_WATER 0x02
+#define GROUP_POWER 0x04
+#define GROUP_STATE 0x08
+#define GROUP_ALL   0xFF
+
+template <typename T>
+struct FieldDef {
+  const char* key;                   // JSON-Schlüssel / CSV-Spalte
+  const char* label;                 // Klartext-Bezeichnung
+  const char* icon;
+  const char* unit;
+  uint8_t precision;                 // Nachkommastellen (FIELD_FLOAT)
+  FieldKind kind;
+  bool enabled;                      // Feature-Flag (zur Compile-Zeit bekannt)
+  uint8_t formats;                   // FMT_*
+  uint8_t group;                     // GROUP_*
+  double (*get)(const T&);
+  const char* onText;                // FIELD_BOOL: Klartext für true/false
+  const char* offText;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// AUSWAHL ZUR COMPILE-ZEIT
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// Aus einer Tabelle mit allen Einträgen (Feld .enabled = Feature-Flag) nur die
+// aktivierten übernehmen. Abgeschaltete Sensoren kosten damit weder Flash für
+// ihre Zeilen noch Speicher, der pro Eintrag angelegt wird:
+//   constexpr auto SET = selectEnabled<enabledCount(LIST)>(LIST);
+//   float values[SET.size()][N];
+template <typename Def, size_t N>
+constexpr size_t enabledCount(const Def (&defs)[N]) {
+  size_t n = 0;
+  for (size_t i = 0; i < N; i++) n += defs[i].enabled ? 1 : 0;
+  return n;
+}
+
+template <typename Def, size_t Count>
+struct EnabledSet {
+  Def items[Count];                  // Als Array an writeJsonFields() & Co. übergebbar
+
+  static constexpr size_t size() { return Count; }
+  constexpr const Def& operator[](size_t i) const { return items[i]; }
+  constexpr const Def* begin() const { return items; }
+  constexpr const Def* end() const { return items + Count; }
+};
+
+template <size_t Count, typename Def, size_t N>
+constexpr EnabledSet<Def, Count> selectEnabled(const Def (&defs)[N]) {
+  EnabledSet<Def, Count> set = {};
+  size_t k = 0;
+  for (size_t i = 0; i < N && k < Count; i++) {
+    if (defs[i].enabled) set.items[k++] = defs[i];
+  }
+  return set;
+}
+
+// Fehlende Messwerte (NaN, z.B. Sensor nicht angeschlossen) bzw. ±inf:
+// JSON null, CSV leeres Feld, Klartext "--"
+template <typename T>
+inline void appendFieldValue(TextBuffer& out, const FieldDef<T>& f, const T& obj, bool json) {
+  double value = f.get(obj);
+  if (f.kind != FIELD_BOOL && !isfinite(value)) {
+    if (json) out.append("null");
+    return;
+  }
+  switch (f.kind) {
+    case FIELD_FLOAT:
+      out.appendf("%.*f", f.precision, value);
+      break;
+    case FIELD_COUNT:
+      out.appendf("%lu", (unsigned long)value);
+      break;
+    case FIELD_BOOL:
+      out.append(json ? (value != 0 ? "true" : "false") : (value != 0 ? "1" : "0"));
+      break;
+  }
+}
+
+// "key":value,"key":value (ohne Klammern, damit Aufrufer weitere Felder anhängen können)
+template <typename T, size_t N>
+void writeJsonFields(TextBuffer& out, const FieldDef<T> (&fields)[N], const T& obj) {
+  bool first = true;
+  for (size_t i = 0; i < N; i++) {
+    const FieldDef<T>& f = fields[i];
+    if (!f.enabled || !(f.formats & FMT_JSON)) continue;
+    out.appendf("%s\"%s\":", first ? "" : ",", f.key);
+    appendFieldValue(out, f, obj, true);
+    first = false;
+  }
+}
+
+template <typename T, size_t N>
+void writeCsvHeader(TextBuffer& out, const FieldDef<T> (&fields)[N]) {
+  bool first = true;
+  for (size_t i = 0; i < N; i++) {
+    const FieldDef<T>& f = fields[i];
+    if (!f.enabled || !(f.formats & FMT_CSV)) continue;
+    out.appendf("%s%s", first ? "" : ",", f.key);
+    first = false;
+  }
+}
+
+template <typename T, size_t N>
+void writeCsvRow(TextBuffer& out, const FieldDef<T> (&fields)[N], const T& obj) {
+  bool first = true;
+  for (size_t i = 0; i < N; i++) {
+    const FieldDef<T>& f = fields[i];
+    if (!f.enabled || !(f.formats & FMT_CSV)) continue;
+    if (!first) out.append(",");
+    appendFieldValue(out, f, obj, false);
+    first = false;
+  }
+}
+
+// Eine Zeile pro Feld: "<prefix><icon> <label>: <wert> <einheit>\n"
+template <typename T, size_t N>
+void writeTextFields(TextBuffer& out, const FieldDef<T> (&fields)[N], const T& obj,
+                     uint8_t groups = GROUP_ALL, const char* prefix = "") {
+  for (size_t i = 0; i < N; i++) {
+    const FieldDef<T>& f = fields[i];
+    if (!f.enabled || !(f.formats & FMT_TEXT) || !(f.group & groups)) continue;
+    out.appendf("%s%s %s: ", prefix, f.icon, f.label);
+    if (f.kind == FIELD_BOOL) {
+      out.append(f.get(obj) != 0 ? f.onText : f.offText);
+    } else if (!isfinite(f.get(obj))) {
+      out.append("--");
+    } else {
+      appendFieldValue(out, f, obj, false);
+      if (f.unit[0]) out.appendf(" %s", f.unit);
+    }
+    out.append("\n");
+  }
+}
+
+#endif  // SENSOR_FORMAT_H
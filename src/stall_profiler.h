@@ -0,0 +1,134 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * stall_profiler.h - ForellenWächter Phasen-Marker, die einen Watchdog-Reset überleben
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * loop() markiert, in welcher Phase es gerade steckt (AT-Befehl, TLS, SD, NTP ...).
+ * Der Zustand liegt in einem StallRecord im RTC_NOINIT-Speicher: er übersteht
+ * Watchdog-, Panic- und Software-Resets (nicht Power-On). Nach dem Neustart
+ * zeigt boot(), wo der vorige Lauf hing:
+ * - Phase beim Reset und ihr Eintrittszeitpunkt
+ * - Längste ununterbrochene Dauer je Phase
+ * - loop()-Durchläufe über dem Zeitbudget
+ *
+ * Ohne Arduino-Abhängigkeiten: Uhr wird als Funktion übergeben, der Speicher als
+ * Referenz - die Host-Simulation (examples/stall_sim.cpp) setzt beides selbst.
+ *
+ * Nutzung:
+ *   { StallScope phase(profiler, PHASE_SD); file.write(...); }   // verschachtelbar
+ */
+
+#ifndef STALL_PROFILER_H
+#define STALL_PROFILER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define STALL_MAX_PHASES 16
+#define STALL_MAGIC 0x5741FE11u      // Gültigkeit nach Power-On (Speicher zufällig)
+
+struct StallRecord {
+  uint32_t magic;
+  uint32_t magicInv;                 // ~magic: zufälliger Speicher passt praktisch nie
+  uint32_t boots;                    // Neustarts ohne Power-On
+  uint8_t phase;                     // Aktuelle Phase
+  uint32_t phaseEnterMs;             // Uptime beim Eintritt in die aktuelle Phase
+  uint32_t lastMarkMs;               // Uptime des letzten Markers (letztes Lebenszeichen)
+  uint32_t loops;
+  uint32_t loopsOverBudget;
+  uint32_t maxLoopMs;
+  uint32_t maxPhaseMs[STALL_MAX_PHASES];
+};
+
+class StallProfiler {
+public:
+  typedef uint32_t (*ClockFn)();
+
+  StallProfiler(StallRecord& storage, ClockFn clockFn) : rec(storage), clock(clockFn) {}
+
+  // Beim Start: vorigen Lauf sichern, Aufzeichnung neu beginnen; true = Daten gültig
+  bool boot() {
+    valid = rec.magic == STALL_MAGIC && rec.magicInv == ~STALL_MAGIC && rec.phase < STALL_MAX_PHASES;
+    uint32_t boots = 0;
+    if (valid) {
+      last = rec;
+      boots = rec.boots + 1;
+    } else {
+      memset(&last, 0, sizeof(last));
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    rec.boots = boots;
+    rec.phaseEnterMs = clock();
+    rec.lastMarkMs = rec.phaseEnterMs;
+    rec.magic = STALL_MAGIC;
+    rec.magicInv = ~STALL_MAGIC;
+    return valid;
+  }
+
+  // In neue Phase wechseln; liefert die bisherige (für Rückkehr nach verschachtelten Phasen)
+  uint8_t enter(uint8_t phase) {
+    uint32_t now = clock();
+    uint8_t previous = rec.phase;
+    uint32_t spent = now - rec.phaseEnterMs;
+    if (spent > rec.maxPhaseMs[previous]) rec.maxPhaseMs[previous] = spent;
+    rec.phase = phase < STALL_MAX_PHASES ? phase : 0;
+    rec.phaseEnterMs = now;
+    rec.lastMarkMs = now;
+    return previous;
+  }
+
+  void loopStart() {
+    loopStartMs = clock();
+  }
+
+  // Am Ende von loop(): Durchlauf über budgetMs zählen
+  void loopEnd(uint32_t budgetMs) {
+    uint32_t now = clock();
+    uint32_t duration = now - loopStartMs;
+    rec.loops++;
+    if (duration > budgetMs) rec.loopsOverBudget++;
+    if (duration > rec.maxLoopMs) rec.maxLoopMs = duration;
+    rec.lastMarkMs = now;
+  }
+
+  bool hasPrevious() const { return valid; }
+  const StallRecord& previous() const { return last; }
+  const StallRecord& current() const { return rec; }
+
+  // Die n Phasen mit der längsten Dauer (absteigend); liefert die Anzahl > 0 ms
+  static uint8_t slowest(const StallRecord& r, uint8_t* phases, uint8_t n) {
+    uint8_t found = 0;
+    bool used[STALL_MAX_PHASES] = {};
+    while (found < n) {
+      int best = -1;
+      for (uint8_t p = 0; p < STALL_MAX_PHASES; p++) {
+        if (!used[p] && r.maxPhaseMs[p] > 0 && (best < 0 || r.maxPhaseMs[p] > r.maxPhaseMs[best])) best = p;
+      }
+      if (best < 0) break;
+      used[best] = true;
+      phases[found++] = best;
+    }
+    return found;
+  }
+
+private:
+  StallRecord& rec;
+  StallRecord last = {};
+  ClockFn clock;
+  uint32_t loopStartMs = 0;
+  bool valid = false;
+};
+
+// Phase für die Dauer eines Blocks, danach zurück zur umgebenden Phase
+class StallScope {
+public:
+  StallScope(StallProfiler& p, uint8_t phase) : profiler(p), previous(p.enter(phase)) {}
+  ~StallScope() { profiler.enter(previous); }
+
+private:
+  StallProfiler& profiler;
+  uint8_t previous;
+};
+
+#endif  // STALL_PROFILER_H
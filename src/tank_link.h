@@ -0,0 +1,207 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * tank_link.h - ForellenWächter Multi-Becken Datenrahmen & Transport
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Satelliten-Knoten senden ihre Messwerte als gepackte Binär-Frames (24 Byte)
+ * an den Master. Der Transport ist austauschbar:
+ * - EspNowTankTransport: ESP-NOW (kein Router nötig, ~200m Reichweite)
+ * - UdpTankTransport:    UDP Broadcast/Unicast (WLAN, Loopback für Tests)
+ *
+ * Frame-Format ist Little Endian, Werte sind quantisiert (siehe TankFrame).
+ */
+
+#ifndef TANK_LINK_H
+#define TANK_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TANK_FRAME_MAGIC 0xF5
+#define TANK_FRAME_VERSION 1
+#define TANK_LINK_UDP_PORT 4210
+#define TANK_RX_QUEUE_SIZE 32        // Frames zwischen zwei poll()-Aufrufen
+
+// Alarm-Bits (vom Satelliten gemeldet bzw. vom Master ausgewertet)
+enum TankAlarmBits : uint16_t {
+  TANK_ALARM_TEMP_HIGH     = 1 << 0,
+  TANK_ALARM_TEMP_LOW      = 1 << 1,
+  TANK_ALARM_TEMP_CRITICAL = 1 << 2,
+  TANK_ALARM_PH            = 1 << 3,
+  TANK_ALARM_TDS           = 1 << 4,
+  TANK_ALARM_DO_LOW        = 1 << 5,
+  TANK_ALARM_LEVEL_LOW     = 1 << 6,
+  TANK_ALARM_FLOW_LOW      = 1 << 7,
+  TANK_ALARM_BATTERY_LOW   = 1 << 8,
+  TANK_ALARM_OFFLINE       = 1 << 15   // Nur Master: keine Frames mehr empfangen
+};
+
+#define TANK_FLAG_LEVEL_OK  0x01
+#define TANK_FLAG_AERATION  0x02
+
+struct __attribute__((packed)) TankFrame {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t tankId;                    // 1..MAX_TANKS
+  uint8_t flags;                     // TANK_FLAG_*
+  uint16_t sequence;                 // Fortlaufend, Überlauf erlaubt
+  int16_t waterTemp;                 // °C × 100
+  int16_t airTemp;                   // °C × 100
+  uint16_t ph;                       // pH × 100
+  uint16_t tds;                      // ppm
+  uint16_t dissolvedOxygen;          // mg/L × 100
+  uint16_t flowRate;                 // L/min × 100
+  uint16_t batteryMilliVolt;         // mV
+  uint16_t alarmMask;                // TankAlarmBits
+  uint16_t crc;                      // CRC-16/CCITT über alle vorherigen Bytes
+};
+
+static_assert(sizeof(TankFrame) == 24, "TankFrame muss gepackt sein");
+
+inline uint16_t tankFrameCRC(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+inline void sealTankFrame(TankFrame& frame) {
+  frame.magic = TANK_FRAME_MAGIC;
+  frame.version = TANK_FRAME_VERSION;
+  frame.crc = tankFrameCRC((const uint8_t*)&frame, offsetof(TankFrame, crc));
+}
+
+inline bool decodeTankFrame(const uint8_t* data, size_t len, TankFrame& out) {
+  if (len != sizeof(TankFrame)) return false;
+  memcpy(&out, data, sizeof(TankFrame));
+  return out.magic == TANK_FRAME_MAGIC &&
+         out.version == TANK_FRAME_VERSION &&
+         out.crc == tankFrameCRC(data, offsetof(TankFrame, crc));
+}
+
+// Einordnung einer neuen Sequenznummer gegenüber der zuletzt empfangenen.
+// Vorwärts (auch über den Überlauf 65535 → 0) zählen die übersprungenen Nummern
+// als verloren. Ein Sprung zurück heißt: Satellit neu gestartet, Zähler beginnt
+// wieder bei 0 - das ist kein Verlust von ~65000 Frames.
+enum TankSeqStatus : uint8_t { TANK_SEQ_NEXT, TANK_SEQ_DUPLICATE, TANK_SEQ_RESET };
+
+inline TankSeqStatus tankSequenceCheck(uint16_t last, uint16_t seq, uint16_t& lost) {
+  int16_t step = (int16_t)(uint16_t)(seq - last);
+  lost = 0;
+  if (step == 0) return TANK_SEQ_DUPLICATE;
+  if (step < 0) return TANK_SEQ_RESET;
+  lost = step - 1;
+  return TANK_SEQ_NEXT;
+}
+
+// Quantisierung (gemeinsam für Satellit und Master)
+inline int16_t tankQuantize100(float value) {
+  return (int16_t)(value * 100.0f + (value >= 0 ? 0.5f : -0.5f));
+}
+inline uint16_t tankQuantizeU100(float value) {
+  return value <= 0 ? 0 : (uint16_t)(value * 100.0f + 0.5f);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// TRANSPORT
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class TankTransport {
+public:
+  virtual ~TankTransport() {}
+  virtual bool begin() = 0;
+  virtual bool send(const TankFrame& frame) = 0;       // Satellit → Master
+  virtual int poll(TankFrame* out, int maxFrames) = 0; // Empfangene Frames abholen
+};
+
+#if defined(ARDUINO)
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <esp_now.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// ESP-NOW: Empfang im WiFi-Task, Übergabe an loop() über FreeRTOS-Queue
+class EspNowTankTransport : public TankTransport {
+public:
+  bool begin() override {
+    rxQueue = xQueueCreate(TANK_RX_QUEUE_SIZE, sizeof(TankFrame));
+    if (!rxQueue || esp_now_init() != ESP_OK) return false;
+    esp_now_register_recv_cb(onReceive);
+
+    esp_now_peer_info_t peer = {};
+    memset(peer.peer_addr, 0xFF, 6);  // Broadcast
+    peer.channel = 0;                 // Aktueller WiFi-Kanal
+    peer.encrypt = false;
+    esp_now_add_peer(&peer);
+    return true;
+  }
+
+  bool send(const TankFrame& frame) override {
+    static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    return esp_now_send(broadcast, (const uint8_t*)&frame, sizeof(frame)) == ESP_OK;
+  }
+
+  int poll(TankFrame* out, int maxFrames) override {
+    int n = 0;
+    while (n < maxFrames && xQueueReceive(rxQueue, &out[n], 0) == pdTRUE) n++;
+    return n;
+  }
+
+private:
+  static QueueHandle_t rxQueue;
+
+  static void onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+    TankFrame frame;
+    if (decodeTankFrame(data, len, frame)) {
+      xQueueSend(rxQueue, &frame, 0);  // Queue voll → Frame verwerfen
+    }
+  }
+};
+
+QueueHandle_t EspNowTankTransport::rxQueue = nullptr;
+
+// UDP: Satelliten im WLAN oder Simulation über Loopback
+class UdpTankTransport : public TankTransport {
+public:
+  explicit UdpTankTransport(IPAddress target = IPAddress(255, 255, 255, 255),
+                            uint16_t port = TANK_LINK_UDP_PORT)
+    : target(target), port(port) {}
+
+  bool begin() override {
+    return udp.begin(port);
+  }
+
+  bool send(const TankFrame& frame) override {
+    if (!udp.beginPacket(target, port)) return false;
+    udp.write((const uint8_t*)&frame, sizeof(frame));
+    return udp.endPacket();
+  }
+
+  int poll(TankFrame* out, int maxFrames) override {
+    int n = 0;
+    uint8_t buffer[sizeof(TankFrame)];
+    int size;
+    while (n < maxFrames && (size = udp.parsePacket()) > 0) {
+      if (size != sizeof(TankFrame)) continue;  // Fremdes Paket verwerfen
+      int len = udp.read(buffer, sizeof(buffer));
+      if (decodeTankFrame(buffer, len, out[n])) n++;
+    }
+    return n;
+  }
+
+private:
+  WiFiUDP udp;
+  IPAddress target;
+  uint16_t port;
+};
+
+#endif  // ARDUINO
+
+#endif  // TANK_LINK_H
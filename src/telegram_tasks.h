@@ -0,0 +1,113 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * telegram_tasks.h - ForellenWächter Empfangs- und Versand-Schleife des Telegram-Bots
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Je ein Durchlauf von telegramPollTask() und telegramSendTask():
+ * - Empfang: Long Polling über eine gehaltene Verbindung, die einen Platz im
+ *   HTTPS-Pool belegt (freigegeben, sobald WiFi weg ist). Kommt getUpdates()
+ *   sofort leer zurück, war es ein Fehler (ein leerer Long Poll dauert
+ *   ~TELEGRAM_LONG_POLL_SEC) - dann exponentielles Backoff 2 s, 4 s, ... 60 s
+ * - Versand: Telegram-Rate-Limit (1 Nachricht/s pro Chat), Wiederholung mit
+ *   Backoff, Verbindung und Pool-Platz nach TELEGRAM_SEND_KEEP_MS ohne Nachricht frei
+ *
+ * Ohne Arduino-Abhängigkeiten: Bot, Queue, Uhr und Pool stellt ein Link-Objekt
+ * bereit - in der Firmware UniversalTelegramBot/FreeRTOS, im Host-Test
+ * (examples/telegram_standin.cpp) Sockets und Threads.
+ *
+ * Link für telegramPollStep():
+ *   bool connected(); bool reserve(); void release();   // release: Verbindung zu, Pool-Platz frei
+ *   uint32_t millis(); int getUpdates(); void handle(int i);
+ * Link für telegramSendStep() zusätzlich:
+ *   bool receive(Message&, uint32_t waitMs); bool send(const Message&); void sleep(uint32_t ms);
+ */
+
+#ifndef TELEGRAM_TASKS_H
+#define TELEGRAM_TASKS_H
+
+#include <stdint.h>
+
+#ifndef TELEGRAM_LONG_POLL_SEC
+#define TELEGRAM_LONG_POLL_SEC 25     // Long Polling: Server hält Anfrage bis zu 25s offen
+#endif
+#ifndef TELEGRAM_SEND_GAP_MS
+#define TELEGRAM_SEND_GAP_MS 1100     // Telegram-Limit: ~1 Nachricht/Sekunde pro Chat
+#endif
+#ifndef TELEGRAM_MAX_RETRIES
+#define TELEGRAM_MAX_RETRIES 3        // Sendeversuche pro Nachricht
+#endif
+#ifndef TELEGRAM_SEND_KEEP_MS
+#define TELEGRAM_SEND_KEEP_MS 30000   // Versand-Verbindung nach 30s ohne Nachricht schließen
+#endif
+#define TELEGRAM_BACKOFF_MS 2000      // Erste Wartezeit nach einem Fehler (Empfang und Versand)
+#define TELEGRAM_BACKOFF_MAX_MS 60000
+#define TELEGRAM_OFFLINE_WAIT_MS 5000 // Kein WiFi oder alle TLS-Plätze belegt
+#define TELEGRAM_WAIT_FOREVER 0xFFFFFFFFu
+
+struct TelegramPollState {
+  bool leased = false;
+  uint8_t failures = 0;              // Fehlversuche in Folge (Backoff-Stufe)
+};
+
+struct TelegramSendState {
+  bool leased = false;
+  uint32_t lastSend = 0;
+};
+
+enum TelegramSendResult : uint8_t { TELEGRAM_IDLE, TELEGRAM_SENT, TELEGRAM_DROPPED };
+
+// Ein Empfangs-Durchlauf; liefert die Wartezeit in ms vor dem nächsten
+template <typename Link>
+uint32_t telegramPollStep(Link& link, TelegramPollState& st) {
+  if (!link.connected()) {
+    if (st.leased) {
+      link.release();
+      st.leased = false;
+    }
+    return TELEGRAM_OFFLINE_WAIT_MS;
+  }
+  if (!st.leased && !(st.leased = link.reserve())) return TELEGRAM_OFFLINE_WAIT_MS;
+
+  uint32_t start = link.millis();
+  int count = link.getUpdates();
+  for (int i = 0; i < count; i++) link.handle(i);
+  if (count > 0 || link.millis() - start >= TELEGRAM_LONG_POLL_SEC * 500UL) {
+    st.failures = 0;
+    return 0;
+  }
+
+  uint32_t wait = (uint32_t)TELEGRAM_BACKOFF_MS << st.failures;
+  if (wait >= TELEGRAM_BACKOFF_MAX_MS) return TELEGRAM_BACKOFF_MAX_MS;
+  st.failures++;
+  return wait;
+}
+
+// Ein Versand-Durchlauf: auf die nächste Nachricht warten und zustellen
+template <typename Link, typename Message>
+TelegramSendResult telegramSendStep(Link& link, TelegramSendState& st, Message& msg) {
+  uint32_t wait = st.leased ? TELEGRAM_SEND_KEEP_MS : TELEGRAM_WAIT_FOREVER;
+  if (!link.receive(msg, wait)) {
+    if (st.leased) {
+      link.release();
+      st.leased = false;
+    }
+    return TELEGRAM_IDLE;
+  }
+
+  for (int attempt = 0; attempt < TELEGRAM_MAX_RETRIES; attempt++) {
+    uint32_t sinceLast = link.millis() - st.lastSend;
+    if (sinceLast < TELEGRAM_SEND_GAP_MS) link.sleep(TELEGRAM_SEND_GAP_MS - sinceLast);
+
+    if (!st.leased) st.leased = link.reserve();
+    bool ok = st.leased && link.connected() && link.send(msg);
+    st.lastSend = link.millis();
+    if (ok) return TELEGRAM_SENT;
+
+    if (attempt < TELEGRAM_MAX_RETRIES - 1) {
+      link.sleep((uint32_t)TELEGRAM_BACKOFF_MS << attempt);  // 2s, 4s, ...
+    }
+  }
+  return TELEGRAM_DROPPED;
+}
+
+#endif // TELEGRAM_TASKS_H
@@ -0,0 +1,138 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * telemetry.h - ForellenWächter Telemetrie-Encoder (MessagePack, delta-kodiert)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Sammelt Messungen in einem Batch fester Größe. Jeder Datensatz speichert nur
+ * die Differenz zum vorherigen, so dass stabile Werte 1 Byte (fixint) kosten.
+ *
+ * Batch-Format (MessagePack):
+ *   [ version, deviceId, t0, [ record, record, ... ] ]
+ *   record = [ dt, dWaterTemp, dAirTemp, dPh, dTds, dDO, dFlow, dBattery, flags ]
+ *
+ * Der erste Datensatz enthält absolute Werte (Differenz zu 0), dt in Sekunden.
+ * Einheiten: Temperaturen °C×100, pH×100, TDS ppm, DO mg/L×100,
+ *            Flow L/min×100, Batterie mV.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TELEMETRY_FORMAT_VERSION 1
+#define TELEMETRY_FIELDS 7            // Messwerte pro Datensatz (ohne dt, flags)
+
+#ifndef TELEMETRY_BATCH_BYTES
+#define TELEMETRY_BATCH_BYTES 4096    // Max. Größe eines Batches
+#endif
+
+#define TELEMETRY_FLAG_LEVEL_OK  0x01
+#define TELEMETRY_FLAG_AERATION  0x02
+#define TELEMETRY_FLAG_ALARM     0x04
+#define TELEMETRY_FLAG_NO_TIME   0x08  // t0 = Sekunden seit Boot (kein NTP)
+
+struct TelemetrySample {
+  uint32_t time;                      // Unix-Zeit oder Sekunden seit Boot
+  int32_t values[TELEMETRY_FIELDS];
+  uint8_t flags;
+};
+
+class TelemetryEncoder {
+public:
+  void begin(const char* deviceId, uint32_t t0) {
+    len = 0;
+    count = 0;
+    overflow = false;
+    memset(prev, 0, sizeof(prev));
+    prevTime = t0;
+
+    putByte(0x94);                    // fixarray(4)
+    putInt(TELEMETRY_FORMAT_VERSION);
+    putStr(deviceId);
+    putUInt(t0);
+    countPos = len;
+    putByte(0xdd);                    // array32, Anzahl wird in finish() gesetzt
+    putByte(0); putByte(0); putByte(0); putByte(0);
+  }
+
+  // false = Batch voll (Datensatz wurde nicht übernommen)
+  bool add(const TelemetrySample& s) {
+    size_t mark = len;
+
+    putByte(0x90 | (TELEMETRY_FIELDS + 2));  // fixarray
+    putInt((int32_t)(s.time - prevTime));
+    for (int i = 0; i < TELEMETRY_FIELDS; i++) {
+      putInt(s.values[i] - prev[i]);
+    }
+    putUInt(s.flags);
+
+    if (overflow) {
+      len = mark;
+      overflow = false;
+      return false;
+    }
+
+    prevTime = s.time;
+    memcpy(prev, s.values, sizeof(prev));
+    count++;
+    return true;
+  }
+
+  // Anzahl eintragen, liefert fertigen Batch
+  const uint8_t* finish(size_t& outLen) {
+    buf[countPos + 1] = count >> 24;
+    buf[countPos + 2] = count >> 16;
+    buf[countPos + 3] = count >> 8;
+    buf[countPos + 4] = count;
+    outLen = len;
+    return buf;
+  }
+
+  uint32_t records() const { return count; }
+  size_t size() const { return len; }
+
+private:
+  uint8_t buf[TELEMETRY_BATCH_BYTES];
+  size_t len = 0;
+  size_t countPos = 0;
+  uint32_t count = 0;
+  bool overflow = false;
+  int32_t prev[TELEMETRY_FIELDS];
+  uint32_t prevTime = 0;
+
+  void putByte(uint8_t b) {
+    if (len < sizeof(buf)) buf[len++] = b;
+    else overflow = true;
+  }
+
+  void putBE(uint32_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) putByte(v >> (i * 8));
+  }
+
+  void putUInt(uint32_t v) {
+    if (v < 0x80) putByte(v);
+    else if (v <= 0xFF) { putByte(0xcc); putByte(v); }
+    else if (v <= 0xFFFF) { putByte(0xcd); putBE(v, 2); }
+    else { putByte(0xce); putBE(v, 4); }
+  }
+
+  void putInt(int32_t v) {
+    if (v >= 0) { putUInt(v); return; }
+    if (v >= -32) putByte((uint8_t)(int8_t)v);               // negative fixint
+    else if (v >= -128) { putByte(0xd0); putByte((uint8_t)v); }
+    else if (v >= -32768) { putByte(0xd1); putBE((uint16_t)v, 2); }
+    else { putByte(0xd2); putBE((uint32_t)v, 4); }
+  }
+
+  void putStr(const char* s) {
+    size_t n = strlen(s);
+    if (n > 31) n = 31;
+    putByte(0xa0 | n);                // fixstr
+    for (size_t i = 0; i < n; i++) putByte(s[i]);
+  }
+};
+
+#endif  // TELEMETRY_H
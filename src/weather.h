@@ -0,0 +1,168 @@
+/*
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ * weather.h - ForellenWächter Wettervorhersage (wttr.in j1, gefiltert)
+ * ═══════════════════════════════════════════════════════════════════════════════════
+ *
+ * Die j1-Antwort von wttr.in ist ~50 KB groß, gebraucht werden davon ~300 Byte:
+ * - current_condition[0]: Temperatur, Luftfeuchte, Wind, Wettercode, Text (lang_de)
+ * - weather[d].hourly[h]: Lufttemperatur, Regenwahrscheinlichkeit, Wettercode
+ *   (3-Stunden-Raster, 3 Tage)
+ *
+ * WeatherParser filtert diese Werte beim Empfang über JsonStreamParser heraus;
+ * finish() behält nur die Slots der nächsten 48 Stunden. Stunden werden als
+ * lokale Stunden seit 1970 gezählt (Tagesnummer × 24 + Stunde), so lassen sie
+ * sich ohne Zeitzonen-Rechnung mit der lokalen Uhr vergleichen.
+ * Ohne Arduino-Abhängigkeiten.
+ */
+
+#ifndef WEATHER_H
+#define WEATHER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "json_stream.h"
+#include "daily_stats.h"              // statsDayNumber()
+
+#define WEATHER_DAYS 3                // wttr.in liefert heute + 2 Tage
+#define WEATHER_HOURLY 8              // 3-Stunden-Raster
+#define WEATHER_SLOTS (WEATHER_DAYS * WEATHER_HOURLY)
+#define WEATHER_TEXT_SIZE 40
+
+struct WeatherSlot {
+  int32_t hour;                       // Lokale Stunden seit 1970
+  int8_t tempC;
+  uint8_t rainChance;                 // %
+  uint16_t code;                      // WWO-Wettercode
+};
+
+struct WeatherCurrent {
+  int8_t tempC;
+  uint8_t humidity;                   // %
+  uint16_t windKmh;
+  uint16_t code;
+  char text[WEATHER_TEXT_SIZE];
+};
+
+struct WeatherForecast {
+  WeatherCurrent current;
+  WeatherSlot slots[WEATHER_SLOTS];   // Chronologisch, nur die nächsten Stunden
+  uint8_t count;
+  bool valid;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// PARSER
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+class WeatherParser {
+public:
+  void begin(WeatherForecast& target) {
+    out = &target;
+    memset(out, 0, sizeof(*out));
+    memset(days, 0, sizeof(days));
+    filled = 0;
+    textFromLang = false;
+    json.begin(onValue, this);
+  }
+
+  // false = kein gültiges JSON (Abbruch lohnt sich)
+  bool feed(const char* data, size_t n) { return json.feed(data, n); }
+
+  // Slots einordnen: ab dem laufenden 3-h-Slot bis nowHour + keepHours
+  bool finish(int32_t nowHour, int32_t keepHours = 48) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WEATHER_SLOTS; i++) {
+      if (!(filled & (1UL << i)) || days[i / WEATHER_HOURLY] == 0) continue;
+      WeatherSlot s = out->slots[i];
+      s.hour += statsDayNumber(days[i / WEATHER_HOURLY]) * 24;
+      if (s.hour + 3 <= nowHour || s.hour >= nowHour + keepHours) continue;
+      out->slots[n++] = s;            // n <= i, Reihenfolge bleibt erhalten
+    }
+    out->count = n;
+    out->valid = json.complete() && n > 0;
+    return out->valid;
+  }
+
+  bool failed() const { return json.failed(); }
+
+private:
+  JsonStreamParser json;
+  WeatherForecast* out = nullptr;
+  uint32_t days[WEATHER_DAYS];        // JJJJMMTT je weather[d]
+  uint32_t filled;                    // Bit i = Slot i hat eine Uhrzeit
+  bool textFromLang;
+
+  static void copyText(char* dst, const char* src) {
+    strncpy(dst, src, WEATHER_TEXT_SIZE - 1);
+    dst[WEATHER_TEXT_SIZE - 1] = '\0';
+    size_t n = strlen(dst);           // Abgeschnittenes UTF-8-Zeichen entfernen
+    if (n == WEATHER_TEXT_SIZE - 1) {
+      while (n > 0 && ((uint8_t)dst[n] & 0xC0) == 0x80) n--;
+      dst[n] = '\0';
+    }
+  }
+
+  static void onValue(void* ctx, const JsonStreamParser& p, const char* value) {
+    WeatherParser* self = (WeatherParser*)ctx;
+    WeatherForecast* f = self->out;
+    long v = strtol(value, nullptr, 10);
+
+    // current_condition[0].<feld>, Text aus lang_de[0].value bzw. weatherDesc[0].value
+    if (p.keyAt(0, "current_condition") && p.indexAt(1) == 0) {
+      WeatherCurrent& c = f->current;
+      if (p.levels() == 3) {
+        if (p.keyAt(2, "temp_C")) c.tempC = v;
+        else if (p.keyAt(2, "humidity")) c.humidity = v;
+        else if (p.keyAt(2, "windspeedKmph")) c.windKmh = v;
+        else if (p.keyAt(2, "weatherCode")) c.code = v;
+      } else if (p.levels() == 5 && p.indexAt(3) == 0 && p.keyAt(4, "value")) {
+        if (p.keyAt(2, "lang_de")) {
+          copyText(c.text, value);
+          self->textFromLang = true;
+        } else if (p.keyAt(2, "weatherDesc") && !self->textFromLang) {
+          copyText(c.text, value);
+        }
+      }
+      return;
+    }
+
+    if (!p.keyAt(0, "weather")) return;
+    int d = p.indexAt(1);
+    if (d < 0 || d >= WEATHER_DAYS) return;
+
+    // weather[d].date = "JJJJ-MM-TT"
+    if (p.levels() == 3 && p.keyAt(2, "date")) {
+      int y = 0, m = 0, day = 0;
+      if (sscanf(value, "%d-%d-%d", &y, &m, &day) == 3) self->days[d] = y * 10000 + m * 100 + day;
+      return;
+    }
+
+    // weather[d].hourly[h].<feld>, time = "0", "300" ... "2100"
+    int h = p.indexAt(3);
+    if (p.levels() != 5 || !p.keyAt(2, "hourly") || h < 0 || h >= WEATHER_HOURLY) return;
+    uint8_t i = d * WEATHER_HOURLY + h;
+    WeatherSlot& s = f->slots[i];
+    if (p.keyAt(4, "tempC")) s.tempC = v;
+    else if (p.keyAt(4, "chanceofrain")) s.rainChance = v;
+    else if (p.keyAt(4, "weatherCode")) s.code = v;
+    else if (p.keyAt(4, "time")) {
+      s.hour = v / 100;
+      self->filled |= 1UL << i;
+    }
+  }
+};
+
+// Höchste Lufttemperatur der nächsten hours Stunden (NAN = keine Daten)
+inline float weatherMaxTemp(const WeatherForecast& f, int32_t nowHour, int32_t hours) {
+  float maxTemp = NAN;
+  for (uint8_t i = 0; i < f.count; i++) {
+    if (f.slots[i].hour >= nowHour + hours) break;
+    if (isnan(maxTemp) || f.slots[i].tempC > maxTemp) maxTemp = f.slots[i].tempC;
+  }
+  return maxTemp;
+}
+
+#endif  // WEATHER_H